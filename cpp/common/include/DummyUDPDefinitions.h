@@ -20,6 +20,9 @@ static const std::size_t max_packet_size = 8964;
 // Maximum packets sized for 4096*4096*2 bytes frame with 8000 byte packets
 static const std::size_t max_packets = 4195;
 
+// Number of 64-bit words in the packet state bitmap of the frame header
+static const std::size_t packet_state_words = (max_packets + 63) / 64;
+
 static const uint32_t start_of_frame_mask = 1 << 31;
 static const uint32_t end_of_frame_mask = 1 << 30;
 static const uint32_t packet_number_mask = 0x3FFFFFFF;
@@ -39,7 +42,7 @@ typedef struct {
     uint32_t total_packets_expected;
     uint32_t total_packets_received;
     std::size_t packet_size;
-    uint8_t packet_state[max_packets];
+    uint64_t packet_state[packet_state_words];
 } FrameHeader;
 
 inline const std::size_t max_frame_size(void)
@@ -0,0 +1,173 @@
+/*!
+ * FrameNotifyBatch.h - coalesced frame ready and release notifications
+ *
+ * This class accumulates frame ready or release notifications, each a pair of frame number and
+ * buffer ID, and sends them as a single batched IpcMessage carrying arrays of frame numbers and
+ * buffer IDs. A batch is sent when it reaches a configured number of frames or when its oldest
+ * notification reaches a latency bound; owners should also call flush() periodically from a
+ * reactor timer so that a partial batch is not held indefinitely when notifications stop. Access
+ * is serialised with an internal mutex, so a batch may be shared by threads releasing frames.
+ */
+
+#ifndef FRAMENOTIFYBATCH_H_
+#define FRAMENOTIFYBATCH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "IpcChannel.h"
+#include "IpcMessage.h"
+#include "gettime.h"
+
+namespace OdinData {
+
+class FrameNotifyBatch {
+public:
+    typedef std::vector<std::pair<int, int>> FrameList; //!< List of (frame number, buffer ID) pairs
+
+    static const size_t default_max_frames = 1; //!< Default maximum frames per batch, i.e. no batching
+    static const unsigned int default_max_latency_ms = 1; //!< Default maximum batch latency in ms
+
+    //! Construct a batch sending messages with the specified value
+    FrameNotifyBatch(
+        IpcMessage::MsgVal msg_val,
+        size_t max_frames = default_max_frames,
+        unsigned int max_latency_ms = default_max_latency_ms
+    ) :
+        msg_val_(msg_val),
+        max_frames_(max_frames),
+        max_latency_ns_(static_cast<uint64_t>(max_latency_ms) * 1000000),
+        first_frame_ns_(0),
+        messages_sent_(0),
+        frames_sent_(0)
+    {
+    }
+
+    //! Set the maximum number of frames and latency of a batch
+    void configure(size_t max_frames, unsigned int max_latency_ms)
+    {
+        boost::lock_guard<boost::mutex> lock(mutex_);
+        max_frames_ = max_frames;
+        max_latency_ns_ = static_cast<uint64_t>(max_latency_ms) * 1000000;
+    }
+
+    //! Indicate if batching is enabled, i.e. more than one frame may be sent per message
+    bool enabled(void) const
+    {
+        return max_frames_ > 1;
+    }
+
+    //! Return the maximum latency of a batch in milliseconds
+    unsigned int get_max_latency_ms(void) const
+    {
+        return static_cast<unsigned int>(max_latency_ns_ / 1000000);
+    }
+
+    //! Add a notification to the batch, sending the batch on the channel if it is full or the
+    //! latency bound of its oldest notification has been reached
+    void add(int frame, int buffer_id, IpcChannel& channel, const std::string& identity = std::string())
+    {
+        boost::lock_guard<boost::mutex> lock(mutex_);
+        uint64_t now_ns = monotonic_ns();
+        if (frames_.empty()) {
+            first_frame_ns_ = now_ns;
+        }
+        frames_.push_back(std::make_pair(frame, buffer_id));
+        if ((frames_.size() >= max_frames_) || ((now_ns - first_frame_ns_) >= max_latency_ns_)) {
+            send(channel, identity);
+        }
+    }
+
+    //! Send any pending notifications on the channel
+    void flush(IpcChannel& channel, const std::string& identity = std::string())
+    {
+        boost::lock_guard<boost::mutex> lock(mutex_);
+        if (!frames_.empty()) {
+            send(channel, identity);
+        }
+    }
+
+    //! Return the number of batched messages sent
+    uint64_t get_messages_sent(void) const
+    {
+        return messages_sent_;
+    }
+
+    //! Return the number of frames sent in batched messages
+    uint64_t get_frames_sent(void) const
+    {
+        return frames_sent_;
+    }
+
+    //! Encode a list of frames into the parameters of a batched message
+    static void encode(const FrameList& frames, IpcMessage& msg)
+    {
+        for (FrameList::const_iterator frame_iter = frames.begin(); frame_iter != frames.end(); ++frame_iter) {
+            msg.set_param("frame[]", frame_iter->first);
+            msg.set_param("buffer_id[]", frame_iter->second);
+        }
+    }
+
+    //! Decode the frames in a batched message, appending them to a list and returning the number found
+    static size_t decode(const IpcMessage& msg, FrameList& frames)
+    {
+        if (!msg.has_param("frame") || !msg.has_param("buffer_id")) {
+            return 0;
+        }
+        const rapidjson::Value& frame_vals = msg.get_param<const rapidjson::Value&>("frame");
+        const rapidjson::Value& buffer_id_vals = msg.get_param<const rapidjson::Value&>("buffer_id");
+        if (!frame_vals.IsArray() || !buffer_id_vals.IsArray() || (frame_vals.Size() != buffer_id_vals.Size())) {
+            return 0;
+        }
+        for (rapidjson::SizeType idx = 0; idx < frame_vals.Size(); idx++) {
+            frames.push_back(std::make_pair(frame_vals[idx].GetInt(), buffer_id_vals[idx].GetInt()));
+        }
+        return frame_vals.Size();
+    }
+
+private:
+    //! Send the pending notifications as a single message and clear the batch; the caller must
+    //! hold the mutex
+    void send(IpcChannel& channel, const std::string& identity)
+    {
+        IpcMessage batch_msg(IpcMessage::MsgTypeNotify, msg_val_);
+        encode(frames_, batch_msg);
+        std::string batch_msg_encoded = batch_msg.encode();
+        channel.send(batch_msg_encoded, 0, identity);
+
+        messages_sent_++;
+        frames_sent_ += frames_.size();
+        frames_.clear();
+    }
+
+    //! Get the current monotonic time in nanoseconds
+    static uint64_t monotonic_ns(void)
+    {
+        struct timespec now;
+        gettime(&now, true);
+        return (static_cast<uint64_t>(now.tv_sec) * 1000000000) + now.tv_nsec;
+    }
+
+    boost::mutex mutex_; //!< Mutex serialising access to the batch
+    IpcMessage::MsgVal msg_val_; //!< Value of batched messages sent
+    size_t max_frames_; //!< Maximum number of frames in a batch
+    uint64_t max_latency_ns_; //!< Maximum time in ns a notification is held in the batch
+    uint64_t first_frame_ns_; //!< Time in ns the oldest notification in the batch was added
+    FrameList frames_; //!< Pending notifications
+    uint64_t messages_sent_; //!< Number of batched messages sent
+    uint64_t frames_sent_; //!< Number of frames sent in batched messages
+};
+
+typedef boost::shared_ptr<FrameNotifyBatch> FrameNotifyBatchPtr;
+
+} // namespace OdinData
+
+#endif /* FRAMENOTIFYBATCH_H_ */
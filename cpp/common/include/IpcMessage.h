@@ -94,6 +94,8 @@ public:
         MsgValNotifyIdentity, //!< Identity notification message
         MsgValNotifyFrameReady, //!< Frame ready notification message
         MsgValNotifyFrameRelease, //!< Frame release notification message
+        MsgValNotifyFrameReadyBatch, //!< Batched frame ready notification message
+        MsgValNotifyFrameReleaseBatch, //!< Batched frame release notification message
         MsgValNotifyBufferConfig, //!< Buffer configuration notification
         MsgValNotifyBufferPrecharge, //!< Buffer precharge notification
         MsgValNotifyStatus, //!< Status notification
@@ -8,7 +8,19 @@
  * is the responsibility of the handler. Periodic timers can also be added to the reactor to
  * track e.g. timeouts or execute actions. Timers can expire after a certain number of firings
  * or run indefinitely. The reactor polls all registered channels with a 'tickless' event
- * loop to minimise load.
+ * loop to minimise load. A channel can be registered with a drain budget, in which case its
+ * callback is called repeatedly on each wakeup while the channel still has messages pending,
+ * up to the budget, so that a busy channel does not cost a full poll per message.
+ *
+ * Two polling backends are available. The default backend rebuilds a ZeroMQ poll item list
+ * when registrations change and scans all timers on each loop. The epoll backend, available
+ * on Linux, registers raw sockets and the ZMQ_FD of channels with an epoll instance as they
+ * are added, and keeps timers in a min-heap ordered by when they are next due, so that the
+ * cost of each loop does not grow with the number of sockets and timers registered.
+ *
+ * A caller running its own busy loop, for example around non-blocking socket receives, can
+ * instead call the service method periodically to handle ready channels, sockets and timers
+ * without the reactor blocking in a poll.
  *
  *  Created on: Feb 16, 2015
  *      Author: Tim Nicholls, STFC Application Engineering Group
@@ -17,10 +29,14 @@
 #ifndef IPCREACTOR_H_
 #define IPCREACTOR_H_
 
+#include <functional>
 #include <iostream>
 #include <map>
+#include <queue>
+#include <set>
 #include <sstream>
 #include <time.h>
+#include <vector>
 
 #include "zmq/zmq.hpp"
 #include <boost/bind/bind.hpp>
@@ -91,21 +107,63 @@ typedef boost::function<void()> ReactorCallback;
 //! Pointer to underlying ZMQ socket of a channel
 typedef zmq::socket_t* SocketPtr;
 
+//! IpcReactorChannelStats - per-channel batching statistics of the reactor
+struct IpcReactorChannelStats {
+    uint64_t wakeups; //!< Number of reactor wakeups on which the channel had messages pending
+    uint64_t messages; //!< Number of times the channel callback has been called
+    uint64_t max_batch; //!< Largest number of callbacks made on a single wakeup
+
+    IpcReactorChannelStats() :
+        wakeups(0),
+        messages(0),
+        max_batch(0)
+    {
+    }
+};
+
+//! Internal record of a channel registered with the reactor
+struct IpcReactorChannel {
+    SocketPtr socket; //!< Underlying ZMQ socket of the channel
+    int fd; //!< ZMQ_FD of the channel socket registered with the epoll backend, -1 otherwise
+    ReactorCallback callback; //!< Callback method for the channel
+    std::size_t drain_budget; //!< Maximum number of callbacks per reactor wakeup
+    IpcReactorChannelStats stats; //!< Batching statistics for the channel
+};
+
 //! Internal map to associate channel socket with a callback method
-typedef std::map<SocketPtr, ReactorCallback> ChannelMap;
+typedef std::map<SocketPtr, IpcReactorChannel> ChannelMap;
 
 typedef std::map<int, ReactorCallback> SocketMap;
 
 //! Internal map to associate timer ID with a timer
 typedef std::map<int, boost::shared_ptr<IpcReactorTimer>> TimerMap;
 
+//! Internal timer queue entry of the time a timer is due and its ID
+typedef std::pair<TimeMs, int> TimerQueueEntry;
+
+//! Internal min-heap of timers ordered by when they are due
+typedef std::priority_queue<TimerQueueEntry, std::vector<TimerQueueEntry>, std::greater<TimerQueueEntry>>
+    TimerQueue;
+
 class IpcReactor {
 public:
-    IpcReactor(void);
+    //! Polling backends available to the reactor
+    enum ReactorBackend {
+        ReactorBackendPoll, //!< ZeroMQ poll over a rebuilt poll item list
+        ReactorBackendEpoll //!< Linux epoll with edge-triggered ZMQ_FD channels and a timer heap
+    };
+
+    IpcReactor(ReactorBackend backend = ReactorBackendPoll);
     ~IpcReactor();
 
+    //! Returns the polling backend in use
+    ReactorBackend get_backend(void) const;
+
+    //! Default drain budget for channels registered to drain pending messages
+    static const std::size_t default_drain_budget = 64;
+
     //! Adds an IPC channel and associated callback to the reactor
-    void register_channel(IpcChannel& channel, ReactorCallback callback);
+    void register_channel(IpcChannel& channel, ReactorCallback callback, std::size_t drain_budget = 1);
 
     //! Removes an IPC chanel from the reactor
     void remove_channel(IpcChannel& channel);
@@ -114,6 +172,9 @@ public:
 
     void remove_socket(int socket_fd);
 
+    //! Returns the batching statistics of a registered channel
+    IpcReactorChannelStats get_channel_stats(IpcChannel& channel);
+
     //! Adds a timer to the reactor
     int register_timer(size_t delay_ms, size_t times, ReactorCallback callback);
 
@@ -123,26 +184,58 @@ public:
     //! Runs the reactor polling loop
     int run(void);
 
+    //! Services ready channels, sockets and timers once without blocking
+    bool service(void);
+
     //! Signals that the reactor polling loop should stop gracefully
     void stop(void);
 
 private:
+    //! Polls the registered channels and sockets with the poll backend
+    int poll_items(void);
+
+    //! Polls the registered channels and sockets with the epoll backend
+    int poll_epoll(void);
+
+    //! Marks every registered channel as possibly having messages pending
+    void mark_channels_pending(void);
+
+    //! Adds a file descriptor to the epoll instance
+    void epoll_add(int fd, uint32_t events);
+
+    //! Removes a file descriptor from the epoll instance
+    void epoll_remove(int fd);
+
+    //! Calls the callbacks of any timers that have fired
+    void handle_timers(void);
+
     //! Rebuilds the internal list of polling items
     void rebuild_pollitems(void);
 
     //! Calculates the next poll timeout based on the tickless pattern
     long calculate_timeout(void);
 
+    //! Calls the callback of a ready channel until drained or its budget is reached
+    bool drain_channel(IpcReactorChannel& channel);
+
+    static const int max_epoll_events = 64; //!< Maximum number of events returned by each epoll wait
+
     // Private member variables
 
+    ReactorBackend backend_; //!< Polling backend in use
     bool terminate_reactor_; //!< Indicates that the reactor loop should terminate
     ChannelMap channels_; //!< Map of channels associated with the reactor
     SocketMap sockets_;
     TimerMap timers_; //!< Map of timers associated with the reactor
     zmq::pollitem_t* pollitems_; //!< Ptr to array of pollitems to use in poll call
     ReactorCallback* callbacks_; //!< Ptr to matched array of callbacks
+    IpcReactorChannel** channel_items_; //!< Ptr to matched array of channel records, null for sockets
     std::size_t pollsize_; //!< Number if active items to poll
     bool needs_rebuild_; //!< Indicates that the poll item list needs rebuilding
+    int epoll_fd_; //!< File descriptor of the epoll instance, -1 with the poll backend
+    std::map<int, SocketPtr> channel_fds_; //!< Map of channel ZMQ_FDs to channel sockets for the epoll backend
+    std::set<SocketPtr> pending_channels_; //!< Channels to check for pending messages with the epoll backend
+    TimerQueue timer_queue_; //!< Min-heap of timers by when they are due for the epoll backend
     boost::mutex mutex_; //!< Mutex used to make some calls in this class thread safe
 };
 
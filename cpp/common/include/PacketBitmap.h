@@ -0,0 +1,115 @@
+/*!
+ * PacketBitmap.h - compact packet arrival bitmap for frame headers
+ *
+ * This class tracks which packets of a frame have arrived as one bit per packet in an array of
+ * 64-bit words owned by the caller, typically placed in a frame header in shared memory so that
+ * downstream processing can determine which packets were lost. Clearing the bitmap only touches
+ * the words covering the packets of the frame, completeness is determined with a population count
+ * and missing packets are enumerated a word at a time by scanning for clear bits.
+ */
+
+#ifndef PACKETBITMAP_H_
+#define PACKETBITMAP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+
+namespace OdinData {
+
+class PacketBitmap {
+public:
+    static const size_t bits_per_word = 64; //!< Number of packets tracked by each bitmap word
+
+    //! Construct a bitmap over a caller-owned word array tracking the specified number of packets
+    PacketBitmap(uint64_t* words, size_t num_packets) :
+        words_(words),
+        num_packets_(num_packets)
+    {
+    }
+
+    //! Return the number of words required to track the specified number of packets
+    static size_t words_for(size_t num_packets)
+    {
+        return (num_packets + bits_per_word - 1) / bits_per_word;
+    }
+
+    //! Clear the bitmap, marking all packets as missing
+    void clear(void)
+    {
+        memset(words_, 0, words_for(num_packets_) * sizeof(uint64_t));
+    }
+
+    //! Mark a packet as received, returning false if it had already been received
+    bool set(size_t packet)
+    {
+        uint64_t& word = words_[packet / bits_per_word];
+        uint64_t bit = static_cast<uint64_t>(1) << (packet % bits_per_word);
+        bool is_new = !(word & bit);
+        word |= bit;
+        return is_new;
+    }
+
+    //! Indicate if a packet has been received
+    bool test(size_t packet) const
+    {
+        return (words_[packet / bits_per_word] >> (packet % bits_per_word)) & 1;
+    }
+
+    //! Return the number of packets received
+    size_t count(void) const
+    {
+        size_t count = 0;
+        size_t num_words = words_for(num_packets_);
+        for (size_t word_idx = 0; word_idx < num_words; word_idx++) {
+            count += __builtin_popcountll(words_[word_idx] & word_mask(word_idx));
+        }
+        return count;
+    }
+
+    //! Indicate if all packets have been received
+    bool complete(void) const
+    {
+        return count() == num_packets_;
+    }
+
+    //! Append the numbers of any missing packets to a vector, returning the number found
+    size_t missing(std::vector<size_t>& missing_packets) const
+    {
+        size_t num_missing = 0;
+        size_t num_words = words_for(num_packets_);
+        for (size_t word_idx = 0; word_idx < num_words; word_idx++) {
+            uint64_t clear_bits = ~words_[word_idx] & word_mask(word_idx);
+            while (clear_bits) {
+                missing_packets.push_back((word_idx * bits_per_word) + __builtin_ctzll(clear_bits));
+                clear_bits &= clear_bits - 1;
+                num_missing++;
+            }
+        }
+        return num_missing;
+    }
+
+    //! Return the number of packets tracked by the bitmap
+    size_t num_packets(void) const
+    {
+        return num_packets_;
+    }
+
+private:
+    //! Return the mask of bits in a word that correspond to packets of the frame
+    uint64_t word_mask(size_t word_idx) const
+    {
+        size_t remaining = num_packets_ - (word_idx * bits_per_word);
+        return (remaining >= bits_per_word) ? ~static_cast<uint64_t>(0)
+                                            : ((static_cast<uint64_t>(1) << remaining) - 1);
+    }
+
+    uint64_t* words_; //!< Caller-owned array of bitmap words
+    size_t num_packets_; //!< Number of packets tracked
+};
+
+} // namespace OdinData
+
+#endif /* PACKETBITMAP_H_ */
@@ -0,0 +1,142 @@
+/*!
+ * SharedBufferAllocator.h - allocator of contiguous block runs for variable-length shared buffer frames
+ *
+ * This class allocates frames of varying length from a shared memory segment divided into equal
+ * blocks. Each frame occupies a contiguous run of blocks, identified by the ID of its first block,
+ * which is used as the buffer ID of the frame in notifications. A frame can be allocated at its
+ * maximum size when reception starts and shrunk to its actual size when complete, so that the
+ * segment holds many more frames than if every buffer had to be sized for the worst case.
+ *
+ * Allocation is next-fit, continuing from the end of the last allocation. When frames are released
+ * in roughly the order they were allocated, the allocator behaves as a ring over the segment and
+ * finds a free run immediately.
+ *
+ * All blocks are initially held outside the allocator and are made available by releasing them, in
+ * the same way that shared buffers are precharged onto a frame decoder empty buffer queue.
+ */
+
+#ifndef SHAREDBUFFERALLOCATOR_H_
+#define SHAREDBUFFERALLOCATOR_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace OdinData {
+
+class SharedBufferAllocator {
+public:
+    //! Construct an allocator with no blocks
+    SharedBufferAllocator() :
+        free_blocks_(0),
+        cursor_(0)
+    {
+    }
+
+    //! Reset the allocator to manage the specified number of blocks, all held outside the allocator
+    void reset(size_t num_blocks)
+    {
+        run_length_.assign(num_blocks, 1);
+        free_blocks_ = 0;
+        cursor_ = 0;
+    }
+
+    //! Allocate a contiguous run of blocks, returning false if no free run is long enough
+    bool allocate(size_t num_blocks, size_t& first_block)
+    {
+        size_t total_blocks = run_length_.size();
+        if ((num_blocks == 0) || (num_blocks > free_blocks_)) {
+            return false;
+        }
+
+        // Search for a free run from the cursor to the end of the blocks, then from the start, far
+        // enough past the cursor to find a run spanning it. Runs in use are skipped in a single step.
+        size_t start = (cursor_ < total_blocks) ? cursor_ : 0;
+        for (int pass = 0; pass < 2; pass++) {
+            size_t end = (pass == 0) ? total_blocks : std::min(total_blocks, start + num_blocks - 1);
+            size_t block = (pass == 0) ? start : 0;
+            size_t run_start = block;
+            while (block < end) {
+                if (run_length_[block] != 0) {
+                    block += (run_length_[block] == held_block) ? 1 : run_length_[block];
+                    run_start = block;
+                    continue;
+                }
+                block++;
+                if ((block - run_start) == num_blocks) {
+                    run_length_[run_start] = num_blocks;
+                    for (size_t idx = run_start + 1; idx < block; idx++) {
+                        run_length_[idx] = held_block;
+                    }
+                    free_blocks_ -= num_blocks;
+                    cursor_ = block;
+                    first_block = run_start;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    //! Shrink an allocated run to the specified number of blocks, freeing the blocks beyond it
+    void shrink(size_t first_block, size_t num_blocks)
+    {
+        size_t run_length = get_run_length(first_block);
+        if ((num_blocks == 0) || (num_blocks >= run_length)) {
+            return;
+        }
+        run_length_[first_block] = num_blocks;
+        for (size_t idx = first_block + num_blocks; idx < first_block + run_length; idx++) {
+            run_length_[idx] = 0;
+        }
+        free_blocks_ += run_length - num_blocks;
+    }
+
+    //! Release an allocated run, returning false if the block is not the first of an allocated run
+    bool release(size_t first_block)
+    {
+        size_t run_length = get_run_length(first_block);
+        if (run_length == 0) {
+            return false;
+        }
+        for (size_t idx = first_block; idx < first_block + run_length; idx++) {
+            run_length_[idx] = 0;
+        }
+        free_blocks_ += run_length;
+        return true;
+    }
+
+    //! Return the number of blocks in the run starting at a block, or zero if no run starts there
+    size_t get_run_length(size_t first_block) const
+    {
+        if ((first_block >= run_length_.size()) || (run_length_[first_block] == held_block)) {
+            return 0;
+        }
+        return run_length_[first_block];
+    }
+
+    //! Return the number of blocks managed by the allocator
+    size_t num_blocks(void) const
+    {
+        return run_length_.size();
+    }
+
+    //! Return the number of free blocks
+    size_t free_blocks(void) const
+    {
+        return free_blocks_;
+    }
+
+private:
+    //! Marker for blocks in an allocated run other than the first
+    static const size_t held_block = static_cast<size_t>(-1);
+
+    std::vector<size_t> run_length_; //!< Length of the allocated run starting at each block, zero if free
+    size_t free_blocks_; //!< Number of free blocks
+    size_t cursor_; //!< Block following the last allocation, where the next search starts
+};
+
+} // namespace OdinData
+#endif /* SHAREDBUFFERALLOCATOR_H_ */
@@ -9,13 +9,16 @@
 #define SHAREDBUFFERMANAGER_H_
 
 #include <stddef.h>
+#include <stdint.h>
 #include <string>
 
+#include <boost/interprocess/file_mapping.hpp>
 #include <boost/interprocess/mapped_region.hpp>
 #include <boost/interprocess/shared_memory_object.hpp>
 #include <boost/shared_ptr.hpp>
 
 #include "OdinDataException.h"
+#include "SharedBufferRing.h"
 
 namespace OdinData {
 
@@ -34,31 +37,89 @@ public:
         size_t manager_id;
         size_t num_buffers;
         size_t buffer_size;
+        size_t buffer_offset; //!< Offset of the first buffer from the start of the segment
+        size_t variable_frames; //!< Non-zero if buffers are blocks holding variable-length frames
     } Header;
 
+    //! Options controlling how the shared memory segment is backed and mapped
+    struct MappingOptions {
+        MappingOptions() :
+            huge_page_dir(""),
+            numa_node(-1),
+            lock_memory(false),
+            prefault(false)
+        {
+        }
+
+        std::string huge_page_dir; //!< hugetlbfs mount to back the segment with, empty for POSIX shared memory
+        int numa_node; //!< NUMA node to bind the segment to, -1 for no binding
+        bool lock_memory; //!< Lock the segment into memory
+        bool prefault; //!< Fault in every page of the segment when it is mapped
+    };
+
     SharedBufferManager(
         const std::string& shared_mem_name,
         const size_t shared_mem_size,
         const size_t buffer_size,
-        bool remove_when_deleted = true
+        bool remove_when_deleted = true,
+        bool notify_rings = false,
+        const MappingOptions& options = MappingOptions(),
+        bool variable_frames = false
     );
-    SharedBufferManager(const std::string& shared_mem_name);
+    SharedBufferManager(const std::string& shared_mem_name, const MappingOptions& options = MappingOptions());
 
     ~SharedBufferManager();
 
+    const std::string& get_shared_mem_name(void) const;
     const size_t get_manager_id(void) const;
     const size_t get_num_buffers(void) const;
     const size_t get_buffer_size(void) const;
+    const size_t get_page_size(void) const;
+    const int get_numa_node(void) const;
+    const unsigned int get_prefault_duration(void) const;
 
     void* get_buffer_address(const unsigned int buffer) const;
 
+    const bool has_variable_frames(void) const;
+    void set_frame_length(const unsigned int buffer, const size_t length);
+    const size_t get_frame_length(const unsigned int buffer) const;
+
+    const bool has_notify_rings(void) const;
+    SharedBufferRing* get_ready_ring(void) const;
+    SharedBufferRing* get_release_ring(void) const;
+
 private:
+    //! Trailer at the end of the shared memory segment describing the notification ring region
+    typedef struct {
+        uint64_t magic;
+        uint64_t ring_size;
+        uint64_t ring_offset; //!< Offset of the rings from the start of the segment
+    } RingTrailer;
+
+    static const uint64_t ring_trailer_magic = 0x4f44494e52494e47; //!< Magic value marking a valid ring trailer
+    static const size_t ring_alignment = 64; //!< Alignment of notification rings in the segment
+
+    static size_t align_ring_offset(size_t offset);
+
+    void map_segment(bool create, size_t segment_size = 0);
+    void bind_segment(void);
+    void lock_segment(void);
+    void prefault_segment(bool write);
+    std::string huge_page_path(void) const;
+
     std::string shared_mem_name_;
     size_t shared_mem_size_;
     bool remove_when_deleted_;
+    MappingOptions options_; //!< Options the segment was mapped with
+    size_t page_size_; //!< Size of the pages backing the segment
+    unsigned int prefault_duration_; //!< Time taken to fault in the segment in microseconds
     boost::interprocess::shared_memory_object shared_mem_;
+    boost::interprocess::file_mapping huge_page_file_; //!< hugetlbfs file backing the segment, if used
     boost::interprocess::mapped_region shared_mem_region_;
     Header* manager_hdr_;
+    uint64_t* frame_lengths_; //!< Table of frame lengths indexed by first buffer, if frames are variable-length
+    SharedBufferRing* ready_ring_; //!< Ring of frame ready notifications, if present
+    SharedBufferRing* release_ring_; //!< Ring of frame release notifications, if present
 
     static size_t last_manager_id;
 };
@@ -0,0 +1,75 @@
+/*!
+ * SharedBufferNotifier.h - frame ready and release notifications via shared memory rings
+ *
+ * This class passes frame ready and release notifications between a frame receiver and a frame
+ * processor through the descriptor rings held in a shared buffer manager segment, avoiding the
+ * encoding and decoding of JSON IPC messages for every frame. Each ring has an eventfd doorbell
+ * which is signalled when descriptors are posted, allowing the consumer to wait for notifications
+ * in an IpcReactor. The doorbells are created by the receiver and passed to the processor over a
+ * local UNIX domain socket when it connects.
+ */
+
+#ifndef SHAREDBUFFERNOTIFIER_H_
+#define SHAREDBUFFERNOTIFIER_H_
+
+#include <stdint.h>
+#include <string>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "OdinDataException.h"
+#include "SharedBufferManager.h"
+#include "SharedBufferRing.h"
+
+namespace OdinData {
+
+//! SharedBufferNotifierException - custom exception class implementing "what" for error string
+class SharedBufferNotifierException : public OdinDataException {
+public:
+    SharedBufferNotifierException(const std::string what) :
+        OdinDataException(what)
+    {
+    }
+};
+
+class SharedBufferNotifier {
+public:
+    //! Identifies the notification rings
+    enum RingId {
+        ReadyRing = 0, //!< Frame ready notifications, posted by the receiver
+        ReleaseRing = 1 //!< Frame release notifications, posted by the processor
+    };
+
+    SharedBufferNotifier(SharedBufferManagerPtr buffer_manager, bool create);
+    ~SharedBufferNotifier();
+
+    bool post(RingId ring_id, uint32_t buffer_id, uint64_t frame_number, uint32_t flags = 0);
+    bool take(RingId ring_id, SharedBufferRing::Descriptor& desc);
+
+    int get_doorbell_fd(RingId ring_id) const;
+    void clear_doorbell(RingId ring_id);
+
+    int get_listen_fd(void) const;
+    void handle_connection(void);
+
+private:
+    static const std::size_t num_rings = 2; //!< Number of notification rings
+
+    std::string socket_name(void) const;
+    void create_doorbells(void);
+    void connect_doorbells(void);
+    void close_fds(void);
+    SharedBufferRing* get_ring(RingId ring_id) const;
+
+    SharedBufferManagerPtr buffer_manager_; //!< Shared buffer manager holding the rings
+    int doorbell_fds_[num_rings]; //!< Eventfd doorbells for each ring
+    int listen_fd_; //!< Socket on which doorbells are passed to connecting processes
+    boost::mutex post_mutex_[num_rings]; //!< Mutexes serialising posting to each ring within a process
+};
+
+typedef boost::shared_ptr<SharedBufferNotifier> SharedBufferNotifierPtr;
+
+} // namespace OdinData
+#endif /* SHAREDBUFFERNOTIFIER_H_ */
@@ -0,0 +1,104 @@
+/*!
+ * SharedBufferRing.h - lock-free single-producer/single-consumer descriptor ring for shared memory
+ *
+ * This class implements a bounded ring of frame buffer descriptors intended to be placed inside a
+ * shared memory segment and shared between a producer and a consumer in different processes. Head
+ * and tail indices are held in separate cache lines and updated with acquire/release atomics, so
+ * no locking is required provided there is only one producer and one consumer.
+ */
+
+#ifndef SHAREDBUFFERRING_H_
+#define SHAREDBUFFERRING_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+namespace OdinData {
+
+class SharedBufferRing {
+public:
+    //! Descriptor of a frame buffer passed through the ring
+    typedef struct {
+        uint64_t frame_number; //!< Frame number contained in the buffer
+        uint32_t buffer_id; //!< Shared buffer ID
+        uint32_t flags; //!< Notification flags
+    } Descriptor;
+
+    //! Initialise an empty ring in place. Must only be called by the creator of the ring memory.
+    void initialise(size_t capacity)
+    {
+        capacity_ = capacity;
+        mask_ = capacity - 1;
+        head_.store(0, std::memory_order_relaxed);
+        tail_.store(0, std::memory_order_release);
+    }
+
+    //! Push a descriptor onto the ring, returning false if the ring is full. Producer only.
+    bool push(const Descriptor& desc)
+    {
+        uint64_t tail = tail_.load(std::memory_order_relaxed);
+        if ((tail - head_.load(std::memory_order_acquire)) >= capacity_) {
+            return false;
+        }
+        entries()[tail & mask_] = desc;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    //! Pop a descriptor from the ring, returning false if the ring is empty. Consumer only.
+    bool pop(Descriptor& desc)
+    {
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        desc = entries()[head & mask_];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    //! Return the number of descriptors currently in the ring
+    size_t size(void) const
+    {
+        return static_cast<size_t>(tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire));
+    }
+
+    //! Return the capacity of the ring
+    size_t capacity(void) const
+    {
+        return capacity_;
+    }
+
+    //! Return the ring capacity, a power of two, required to hold at least the specified number of entries
+    static size_t capacity_for(size_t num_entries)
+    {
+        size_t capacity = 1;
+        while (capacity < num_entries) {
+            capacity <<= 1;
+        }
+        return capacity;
+    }
+
+    //! Return the number of bytes of memory occupied by a ring of the specified capacity
+    static size_t required_size(size_t capacity)
+    {
+        return sizeof(SharedBufferRing) + (capacity * sizeof(Descriptor));
+    }
+
+private:
+    //! Return a pointer to the descriptor entries, which immediately follow the ring control block
+    Descriptor* entries(void)
+    {
+        return reinterpret_cast<Descriptor*>(this + 1);
+    }
+
+    alignas(64) std::atomic<uint64_t> head_; //!< Index of the next entry to pop, written by the consumer
+    alignas(64) std::atomic<uint64_t> tail_; //!< Index of the next entry to push, written by the producer
+    alignas(64) uint64_t capacity_; //!< Number of entries in the ring, a power of two
+    uint64_t mask_; //!< Mask applied to indices to obtain an entry position
+};
+
+} // namespace OdinData
+#endif /* SHAREDBUFFERRING_H_ */
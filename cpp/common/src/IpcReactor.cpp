@@ -5,6 +5,15 @@
  *      Author: Tim Nicholls, STFC Application Engineering Group
  */
 
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+
 #include "IpcReactor.h"
 #include "gettime.h"
 
@@ -126,15 +135,32 @@ int IpcReactorTimer::last_timer_id_ = 0;
 
 //! Constructor
 //!
-//! This constructs an IpcReactor object ready for use
+//! This constructs an IpcReactor object ready for use. The epoll backend is only available
+//! on Linux; on other platforms the poll backend is used regardless of that requested.
+//!
+//! \param backend polling backend to use (default ReactorBackendPoll)
 
-IpcReactor::IpcReactor() :
+IpcReactor::IpcReactor(ReactorBackend backend) :
+    backend_(ReactorBackendPoll),
     terminate_reactor_(false),
     pollitems_(0),
     callbacks_(0),
+    channel_items_(0),
     pollsize_(0),
-    needs_rebuild_(true)
+    needs_rebuild_(true),
+    epoll_fd_(-1)
 {
+#ifdef __linux__
+    if (backend == ReactorBackendEpoll) {
+        epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+        if (epoll_fd_ < 0) {
+            std::stringstream ss;
+            ss << "IpcReactor failed to create epoll instance: " << strerror(errno);
+            throw IpcReactorException(ss.str());
+        }
+        backend_ = ReactorBackendEpoll;
+    }
+#endif
 }
 
 //! Destructor
@@ -145,20 +171,60 @@ IpcReactor::~IpcReactor()
 {
     delete[] pollitems_;
     delete[] callbacks_;
+    delete[] channel_items_;
+    if (epoll_fd_ >= 0) {
+        close(epoll_fd_);
+    }
+}
+
+//! Returns the polling backend in use
+//!
+//! \return ReactorBackend value of the backend in use
+
+IpcReactor::ReactorBackend IpcReactor::get_backend(void) const
+{
+    return backend_;
 }
 
 //! Adds an IPC channel and associated callback to the reactor
 //!
 //! This method adds an IPC channel and associated callback method with the appropriate
-//! signature to the reactor.
+//! signature to the reactor. The callback should receive one message from the channel. If
+//! a drain budget greater than one is given, the callback is called repeatedly on each
+//! wakeup while the channel has messages pending, up to the budget, before the reactor
+//! moves on to other channels and timers.
 //!
 //! \param channel IpcChannel to add to reactor
 //! \param callback function reference to callback method
+//! \param drain_budget maximum number of callbacks per reactor wakeup (default 1)
 
-void IpcReactor::register_channel(IpcChannel& channel, ReactorCallback callback)
+void IpcReactor::register_channel(IpcChannel& channel, ReactorCallback callback, std::size_t drain_budget)
 {
     // Add channel to channel map
-    channels_[&(channel.socket_)] = callback;
+    SocketPtr socket = &(channel.socket_);
+    bool registered = (channels_.count(socket) > 0);
+    IpcReactorChannel& channel_item = channels_[socket];
+    channel_item.socket = socket;
+    channel_item.callback = callback;
+    channel_item.drain_budget = (drain_budget > 0) ? drain_budget : 1;
+    channel_item.stats = IpcReactorChannelStats();
+
+    // With the epoll backend, add the channel ZMQ_FD to the epoll instance. The ZMQ_FD only signals
+    // edge-triggered changes in the socket events, so the reactor tracks channels which may still
+    // have messages pending itself.
+    if (!registered) {
+        channel_item.fd = -1;
+        if (backend_ == ReactorBackendEpoll) {
+            int fd = -1;
+            std::size_t fd_size = sizeof(fd);
+            channel.socket_.getsockopt(ZMQ_FD, &fd, &fd_size);
+#ifdef __linux__
+            this->epoll_add(fd, EPOLLIN | EPOLLET);
+#endif
+            channel_item.fd = fd;
+            channel_fds_[fd] = socket;
+        }
+    }
 
     // Signal a rebuild is required
     needs_rebuild_ = true;
@@ -173,6 +239,13 @@ void IpcReactor::register_channel(IpcChannel& channel, ReactorCallback callback)
 
 void IpcReactor::remove_channel(IpcChannel& channel)
 {
+    ChannelMap::iterator it = channels_.find(&(channel.socket_));
+    if ((it != channels_.end()) && (it->second.fd >= 0)) {
+        this->epoll_remove(it->second.fd);
+        channel_fds_.erase(it->second.fd);
+    }
+    pending_channels_.erase(&(channel.socket_));
+
     // Erase the channel from the map
     channels_.erase(&(channel.socket_));
 
@@ -180,20 +253,63 @@ void IpcReactor::remove_channel(IpcChannel& channel)
     needs_rebuild_ = true;
 }
 
+//! Adds a raw socket and associated callback to the reactor
+//!
+//! This method adds a raw socket file descriptor and associated callback method to the
+//! reactor. The callback is called when the socket is readable.
+//!
+//! \param socket_fd socket file descriptor to add to the reactor
+//! \param callback function reference to callback method
+
 void IpcReactor::register_socket(int socket_fd, ReactorCallback callback)
 {
+    if ((backend_ == ReactorBackendEpoll) && !sockets_.count(socket_fd)) {
+#ifdef __linux__
+        this->epoll_add(socket_fd, EPOLLIN);
+#endif
+    }
+
     sockets_[socket_fd] = callback;
 
     needs_rebuild_ = true;
 }
 
+//! Removes a raw socket from the reactor
+//!
+//! This method removes a raw socket and its associated callback method from the reactor.
+//! With the epoll backend this must be called before the socket is closed.
+//!
+//! \param socket_fd socket file descriptor to remove from the reactor
+
 void IpcReactor::remove_socket(int socket_fd)
 {
+    if ((backend_ == ReactorBackendEpoll) && sockets_.count(socket_fd)) {
+        this->epoll_remove(socket_fd);
+    }
+
     sockets_.erase(socket_fd);
 
     needs_rebuild_ = true;
 }
 
+//! Returns the batching statistics of a registered channel
+//!
+//! This method returns the number of wakeups on which the channel had messages pending,
+//! the number of callbacks made and the largest number of callbacks made on one wakeup.
+//! The ratio of messages to wakeups shows the effect of the drain budget.
+//!
+//! \param channel IpcChannel to return statistics for
+//! \return IpcReactorChannelStats for the channel, all zero if the channel is not registered
+
+IpcReactorChannelStats IpcReactor::get_channel_stats(IpcChannel& channel)
+{
+    ChannelMap::iterator it = channels_.find(&(channel.socket_));
+    if (it == channels_.end()) {
+        return IpcReactorChannelStats();
+    }
+    return it->second.stats;
+}
+
 //! Adds a timer to the reactor
 //!
 //! This method adds a timer to the reactor. The periodic delay of the timer, the
@@ -216,13 +332,19 @@ int IpcReactor::register_timer(size_t delay_ms, size_t times, TimerCallback call
     // Add the timer to the timer map
     timers_[timer->get_id()] = timer;
 
+    // With the epoll backend, also add the timer to the queue of timers ordered by when they are due
+    if (backend_ == ReactorBackendEpoll) {
+        timer_queue_.push(TimerQueueEntry(timer->when(), timer->get_id()));
+    }
+
     // Return the unique ID
     return timer->get_id();
 }
 
 //! Removes a timer from the reactor
 //!
-//! This method removes a timer from the reactor, based on the timer ID
+//! This method removes a timer from the reactor, based on the timer ID. With the epoll
+//! backend the entry for the timer in the timer queue is discarded when it reaches the top.
 //
 //! \param timer_id integer unique timer ID that was returned by the add_timer() method
 void IpcReactor::remove_timer(int timer_id)
@@ -244,60 +366,32 @@ void IpcReactor::remove_timer(int timer_id)
 int IpcReactor::run(void)
 {
     int rc = 0;
-    boost::unique_lock<boost::mutex> lock(mutex_, boost::defer_lock);
 
     // Loop until the terminate flag is set
     while (!terminate_reactor_) {
-        // If the poll items list needs rebuilding, do it now
-        if (needs_rebuild_) {
-            rebuild_pollitems();
-        }
 
         // If there are no channels to poll and no timers currently active, break out of the
         // reactor loop cleanly
-        if ((pollsize_ == 0) && (timers_.size() == 0)) {
+        if (channels_.empty() && sockets_.empty() && timers_.empty()) {
             rc = 0;
             break;
         }
 
         try {
 
-            // Poll the registered channels, using the tickless timeout based
-            // on the next pending timer
-            int pollrc = zmq::poll(pollitems_, pollsize_, calculate_timeout());
+            // Poll the registered channels and sockets with the selected backend, using the
+            // tickless timeout based on the next pending timer
+            int pollrc = (backend_ == ReactorBackendEpoll) ? this->poll_epoll() : this->poll_items();
 
-            if (pollrc > 0) {
-                // If there were any channels ready to read, execute their callbacks
-                for (size_t item = 0; item < pollsize_; ++item) {
-                    // TODO handle error flag on pollitems
-                    if (pollitems_[item].revents & ZMQ_POLLIN) {
-                        callbacks_[item]();
-                    }
-                }
-            } else if (pollrc == 0) {
-                // Poll timed out, do nothing as we handle timers firing unconditionally below
-            } else {
+            if (pollrc < 0) {
                 // An error occurred, terminate the reactor loop
                 rc = -1;
                 terminate_reactor_ = true;
             }
 
-            // Take lock while accessing timers_
-            lock.lock();
-            // Handle any timers that have now fired, calling their callbacks. Erase any timers
-            // that have now expired
-            TimerMap::iterator it = timers_.begin();
-            while (it != timers_.end()) {
-                if ((it->second)->has_fired()) {
-                    (it->second)->do_callback();
-                }
-                if ((it->second)->has_expired()) {
-                    timers_.erase(it++);
-                } else {
-                    ++it;
-                }
-            }
-            lock.unlock();
+            // Handle any timers that have now fired
+            this->handle_timers();
+
         } catch (zmq::error_t& e) {
             // If the exception was thrown with errno EINTR, i.e. interrupted system call, this is
             // because we have installed a custom signal handler, so terminate the reactor gracefully
@@ -317,6 +411,90 @@ int IpcReactor::run(void)
     return rc;
 }
 
+//! Services ready channels, sockets and timers once without blocking
+//!
+//! This method allows a caller running its own event loop to service the reactor in place of
+//! run(). Each registered channel is checked with the ZMQ_EVENTS socket option, which does not
+//! require a system call, and drained up to its budget if messages are pending. Raw sockets are
+//! checked with a zero-timeout poll, and any timers that have fired are then handled. The
+//! method never blocks, so the caller is responsible for calling it often enough to meet the
+//! timer periods and channel latency it needs.
+//!
+//! \return boolean value, false if the reactor has been signalled to stop
+bool IpcReactor::service(void)
+{
+    if (terminate_reactor_) {
+        return false;
+    }
+
+    // Clear a pending rebuild as the selected backend would, so that channel draining is not cut
+    // short and the backend state is consistent if the reactor is subsequently run
+    if (needs_rebuild_) {
+        if (backend_ == ReactorBackendEpoll) {
+            this->mark_channels_pending();
+            needs_rebuild_ = false;
+        } else {
+            rebuild_pollitems();
+        }
+    }
+
+    // Check every channel for pending messages, taking a copy of the registered sockets since a
+    // callback may change the registrations. With the epoll backend, channels drained here are
+    // no longer pending, while those left at their budget are kept pending.
+    std::vector<SocketPtr> channel_sockets;
+    for (ChannelMap::iterator it = channels_.begin(); it != channels_.end(); ++it) {
+        channel_sockets.push_back(it->first);
+    }
+    for (std::vector<SocketPtr>::iterator it = channel_sockets.begin(); it != channel_sockets.end(); ++it) {
+        if (terminate_reactor_) {
+            break;
+        }
+        ChannelMap::iterator channel_it = channels_.find(*it);
+        if (channel_it == channels_.end()) {
+            continue;
+        }
+
+        int zmq_events = 0;
+        std::size_t zmq_events_size = sizeof(zmq_events);
+        (*it)->getsockopt(ZMQ_EVENTS, &zmq_events, &zmq_events_size);
+        bool pending = (zmq_events & ZMQ_POLLIN) && this->drain_channel(channel_it->second);
+        if (backend_ == ReactorBackendEpoll) {
+            if (pending) {
+                pending_channels_.insert(*it);
+            } else {
+                pending_channels_.erase(*it);
+            }
+        }
+    }
+
+    // Check the raw sockets with a zero-timeout poll and call the callbacks of those ready to read,
+    // looking each up since an earlier callback may have removed it
+    if (!sockets_.empty() && !terminate_reactor_) {
+        std::vector<struct pollfd> poll_fds;
+        for (SocketMap::iterator it = sockets_.begin(); it != sockets_.end(); ++it) {
+            struct pollfd poll_fd = { it->first, POLLIN, 0 };
+            poll_fds.push_back(poll_fd);
+        }
+        if (::poll(&poll_fds[0], poll_fds.size(), 0) > 0) {
+            for (std::size_t idx = 0; idx < poll_fds.size(); ++idx) {
+                SocketMap::iterator socket_it = sockets_.find(poll_fds[idx].fd);
+                if ((poll_fds[idx].revents & POLLIN) && (socket_it != sockets_.end())) {
+                    ReactorCallback callback = socket_it->second;
+                    callback();
+                    if (backend_ == ReactorBackendEpoll) {
+                        this->mark_channels_pending();
+                    }
+                }
+            }
+        }
+    }
+
+    // Handle any timers that have now fired
+    this->handle_timers();
+
+    return !terminate_reactor_;
+}
+
 //! Signals that the reactor polling loop should stop gracefully
 //!
 //! This method is used to signal that the reactor polling loop should stop gracefully.
@@ -326,6 +504,235 @@ void IpcReactor::stop(void)
     terminate_reactor_ = true;
 }
 
+//! Polls the registered channels and sockets with the poll backend
+//!
+//! This private method rebuilds the poll item list if registrations have changed, polls
+//! all items with ZeroMQ poll and calls the callbacks of those ready to read.
+//!
+//! \return integer return code of the poll, -1 on error
+
+int IpcReactor::poll_items(void)
+{
+    // If the poll items list needs rebuilding, do it now
+    if (needs_rebuild_) {
+        rebuild_pollitems();
+    }
+
+    int pollrc = zmq::poll(pollitems_, pollsize_, calculate_timeout());
+
+    if (pollrc > 0) {
+        // If there were any channels ready to read, execute their callbacks
+        for (size_t item = 0; item < pollsize_; ++item) {
+            // TODO handle error flag on pollitems
+            if (pollitems_[item].revents & ZMQ_POLLIN) {
+                // Channel records are only valid while the registered channels are unchanged
+                if (channel_items_[item] && !needs_rebuild_) {
+                    drain_channel(*channel_items_[item]);
+                } else {
+                    callbacks_[item]();
+                }
+            }
+        }
+    }
+
+    return pollrc;
+}
+
+//! Polls the registered channels and sockets with the epoll backend
+//!
+//! This private method waits on the epoll instance and calls the callbacks of raw sockets
+//! ready to read. Channels whose ZMQ_FD has signalled, or which may still have messages
+//! pending from an earlier wakeup, are checked with the ZMQ_EVENTS socket option and
+//! drained up to their budget. The wait does not block while any channel may still have
+//! messages pending, since its ZMQ_FD will not signal again for them.
+//!
+//! \return integer number of events returned by the wait, -1 on error
+
+int IpcReactor::poll_epoll(void)
+{
+    int num_events = 0;
+
+#ifdef __linux__
+    // If registrations have changed, check every channel for pending messages, since a callback
+    // changing them may have left messages on a channel for which ZMQ_FD will not signal again
+    if (needs_rebuild_) {
+        this->mark_channels_pending();
+        needs_rebuild_ = false;
+    }
+
+    struct epoll_event events[max_epoll_events];
+    int timeout = pending_channels_.empty() ? (int)calculate_timeout() : 0;
+    num_events = epoll_wait(epoll_fd_, events, max_epoll_events, timeout);
+
+    if (num_events < 0) {
+        return -1;
+    }
+
+    bool callbacks_called = false;
+    for (int event = 0; event < num_events; ++event) {
+        int fd = events[event].data.fd;
+
+        // Call the callback of a ready raw socket, looking it up since an earlier callback in
+        // this wakeup may have removed it
+        SocketMap::iterator socket_it = sockets_.find(fd);
+        if (socket_it != sockets_.end()) {
+            ReactorCallback callback = socket_it->second;
+            callback();
+            callbacks_called = true;
+            continue;
+        }
+
+        std::map<int, SocketPtr>::iterator channel_it = channel_fds_.find(fd);
+        if (channel_it != channel_fds_.end()) {
+            pending_channels_.insert(channel_it->second);
+        }
+    }
+
+    // Drain each channel that may have messages pending, keeping those that reached their budget
+    std::set<SocketPtr> ready_channels;
+    ready_channels.swap(pending_channels_);
+    for (std::set<SocketPtr>::iterator it = ready_channels.begin(); it != ready_channels.end(); ++it) {
+        ChannelMap::iterator channel_it = channels_.find(*it);
+        if (channel_it == channels_.end()) {
+            continue;
+        }
+        if (terminate_reactor_) {
+            pending_channels_.insert(*it);
+            continue;
+        }
+
+        int zmq_events = 0;
+        std::size_t zmq_events_size = sizeof(zmq_events);
+        (*it)->getsockopt(ZMQ_EVENTS, &zmq_events, &zmq_events_size);
+        if (zmq_events & ZMQ_POLLIN) {
+            if (this->drain_channel(channel_it->second)) {
+                pending_channels_.insert(*it);
+            }
+            callbacks_called = true;
+        }
+    }
+
+    // Any callback may have sent or received on a channel, which processes its pending commands
+    // and can consume the edge of its ZMQ_FD without reading the messages now waiting on it, so
+    // check every channel again before the next wait blocks
+    if (callbacks_called) {
+        this->mark_channels_pending();
+    }
+#endif
+
+    return num_events;
+}
+
+//! Marks every registered channel as possibly having messages pending
+//!
+//! This private method is used with the epoll backend when the edge-triggered ZMQ_FD of a channel
+//! may have been consumed without its messages being read, so that the next poll checks every
+//! channel with the ZMQ_EVENTS socket option rather than blocking.
+
+void IpcReactor::mark_channels_pending(void)
+{
+    for (ChannelMap::iterator it = channels_.begin(); it != channels_.end(); ++it) {
+        pending_channels_.insert(it->first);
+    }
+}
+
+//! Adds a file descriptor to the epoll instance
+//!
+//! \param fd file descriptor to add
+//! \param events epoll events to wait for on the file descriptor
+
+void IpcReactor::epoll_add(int fd, uint32_t events)
+{
+#ifdef __linux__
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = events;
+    event.data.fd = fd;
+
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) < 0) {
+        std::stringstream ss;
+        ss << "IpcReactor failed to add file descriptor " << fd << " to epoll instance: " << strerror(errno);
+        throw IpcReactorException(ss.str());
+    }
+#endif
+}
+
+//! Removes a file descriptor from the epoll instance
+//!
+//! Errors are ignored, since a closed file descriptor has already been removed by the kernel.
+//!
+//! \param fd file descriptor to remove
+
+void IpcReactor::epoll_remove(int fd)
+{
+#ifdef __linux__
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, &event);
+#endif
+}
+
+//! Calls the callbacks of any timers that have fired
+//!
+//! This private method calls the callbacks of timers that have fired and erases any
+//! timers that have expired. The poll backend checks every timer. The epoll backend only
+//! takes timers that are due from the top of the timer queue, discarding entries for
+//! timers that have since been removed, and requeues those that will fire again. As with
+//! the poll backend, each timer fires at most once per call.
+
+void IpcReactor::handle_timers(void)
+{
+    // Take lock while accessing timers_
+    boost::lock_guard<boost::mutex> lock(mutex_);
+
+    if (backend_ == ReactorBackendEpoll) {
+        TimeMs now = IpcReactorTimer::clock_mono_ms();
+        std::vector<TimerQueueEntry> requeue;
+        bool timers_fired = false;
+
+        while (!timer_queue_.empty() && (timer_queue_.top().first <= now)) {
+            TimerQueueEntry entry = timer_queue_.top();
+            timer_queue_.pop();
+
+            TimerMap::iterator it = timers_.find(entry.second);
+            if ((it == timers_.end()) || ((it->second)->when() != entry.first)) {
+                continue;
+            }
+
+            (it->second)->do_callback();
+            timers_fired = true;
+            if ((it->second)->has_expired()) {
+                timers_.erase(it);
+            } else {
+                requeue.push_back(TimerQueueEntry((it->second)->when(), entry.second));
+            }
+        }
+
+        for (std::vector<TimerQueueEntry>::iterator it = requeue.begin(); it != requeue.end(); ++it) {
+            timer_queue_.push(*it);
+        }
+
+        // A timer callback may have consumed the ZMQ_FD edge of a channel by using it
+        if (timers_fired) {
+            this->mark_channels_pending();
+        }
+    } else {
+        // Handle any timers that have now fired, calling their callbacks. Erase any timers
+        // that have now expired
+        TimerMap::iterator it = timers_.begin();
+        while (it != timers_.end()) {
+            if ((it->second)->has_fired()) {
+                (it->second)->do_callback();
+            }
+            if ((it->second)->has_expired()) {
+                timers_.erase(it++);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
 //! Rebuilds the internal list of polling item
 //!
 //! This private method rebuilds the internal list of items to poll in the reactor
@@ -347,6 +754,12 @@ void IpcReactor::rebuild_pollitems(void)
         callbacks_ = 0;
     }
 
+    // If the existing channel record array is valid, delete it
+    if (channel_items_) {
+        delete[] channel_items_;
+        channel_items_ = 0;
+    }
+
     // Set the number of items to poll to the number of channels registered
     pollsize_ = channels_.size() + sockets_.size();
 
@@ -357,6 +770,7 @@ void IpcReactor::rebuild_pollitems(void)
 
         pollitems_ = new zmq::pollitem_t[pollsize_];
         callbacks_ = new ReactorCallback[pollsize_];
+        channel_items_ = new IpcReactorChannel*[pollsize_];
 
         // Iterate over the channel map and build the pollitems and callback arrays. These have
         // a one-to-one correspondence, allowing the reactor loop to easy associate an active
@@ -365,36 +779,98 @@ void IpcReactor::rebuild_pollitems(void)
         for (ChannelMap::iterator it = channels_.begin(); it != channels_.end(); ++item, ++it) {
             zmq::pollitem_t pollitem = { *(it->first), 0, ZMQ_POLLIN, 0 };
             pollitems_[item] = pollitem;
-            callbacks_[item] = it->second;
+            callbacks_[item] = it->second.callback;
+            channel_items_[item] = &(it->second);
         }
 
         for (SocketMap::iterator it = sockets_.begin(); it != sockets_.end(); ++item, ++it) {
             zmq::pollitem_t pollitem = { 0, it->first, ZMQ_POLLIN, 0 };
             pollitems_[item] = pollitem;
             callbacks_[item] = it->second;
+            channel_items_[item] = 0;
         }
     }
+
+    // Clear the rebuild flag so that the lists are only rebuilt when channels or sockets change
+    needs_rebuild_ = false;
+}
+
+//! Calls the callback of a ready channel until drained or its budget is reached
+//!
+//! This private method calls the callback of a channel which the poll reported as ready to
+//! read. While the channel still has messages pending, as indicated by the ZMQ_EVENTS socket
+//! option which does not require a system call, the callback is called again, up to the drain
+//! budget of the channel. Draining stops early if a callback stops the reactor or changes the
+//! registered channels, since the channel may no longer be valid. The batching statistics of
+//! the channel are updated.
+//!
+//! \param channel reference to the record of the ready channel
+//! \return boolean value, true if the channel may still have messages pending
+
+bool IpcReactor::drain_channel(IpcReactorChannel& channel)
+{
+    // Take a copy of the callback, since the record may be erased by the callback removing the channel
+    ReactorCallback callback = channel.callback;
+    IpcReactorChannelStats& stats = channel.stats;
+    std::size_t drain_budget = channel.drain_budget;
+    SocketPtr socket = channel.socket;
+
+    std::size_t batch = 0;
+    bool pending = true;
+
+    while (pending) {
+        callback();
+        batch++;
+
+        if ((batch >= drain_budget) || terminate_reactor_ || needs_rebuild_) {
+            break;
+        }
+
+        int events = 0;
+        std::size_t events_size = sizeof(events);
+        socket->getsockopt(ZMQ_EVENTS, &events, &events_size);
+        pending = (events & ZMQ_POLLIN);
+    }
+
+    // The channel record is only guaranteed to still exist if the channels are unchanged
+    if (!needs_rebuild_) {
+        stats.wakeups++;
+        stats.messages += batch;
+        if (batch > stats.max_batch) {
+            stats.max_batch = batch;
+        }
+    }
+
+    return pending;
 }
 
 //! Calculates the next poll timeout based on the tickless pattern
 //!
 //! This private method calculates the next reactor poll timeout based on the
 //! 'tickless' idiom in the CZMQ zloop implementation. The timeout is set
-//! to match the next timer due to fire.
+//! to match the next timer due to fire, which with the epoll backend is at
+//! the top of the timer queue.
 //!
 //! \return long timeout value in milliseconds
 
 long IpcReactor::calculate_timeout(void)
 {
-    // Take lock while accessing timers_
+    // Take lock while accessing timers_ and timer_queue_, which register_timer() may modify from
+    // another thread
     boost::lock_guard<boost::mutex> lock(mutex_);
 
     // Calculate shortest timeout up to one hour (!!), looping through
     // current timers to see which fires first
     TimeMs tickless = IpcReactorTimer::clock_mono_ms() + (1000 * 3600);
-    for (TimerMap::iterator it = timers_.begin(); it != timers_.end(); ++it) {
-        if (tickless > (it->second)->when()) {
-            tickless = (it->second)->when();
+    if (backend_ == ReactorBackendEpoll) {
+        if (!timer_queue_.empty() && (tickless > timer_queue_.top().first)) {
+            tickless = timer_queue_.top().first;
+        }
+    } else {
+        for (TimerMap::iterator it = timers_.begin(); it != timers_.end(); ++it) {
+            if (tickless > (it->second)->when()) {
+                tickless = (it->second)->when();
+            }
         }
     }
 
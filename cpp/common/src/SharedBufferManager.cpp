@@ -5,48 +5,141 @@
  *      Author: Tim Nicholls, STFC Application Engineering Group
  */
 
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <sys/statfs.h>
+#include <sys/syscall.h>
+#endif
+
 #include <sstream>
+#include <vector>
 
 #include "SharedBufferManager.h"
+#include "gettime.h"
 
 using namespace OdinData;
 using namespace boost::interprocess;
 
+//! Constructor for the SharedBufferManager class.
+//!
+//! This constructor creates (or reuses) a shared memory segment and divides it into buffers of the
+//! requested size. If requested, a pair of descriptor rings for frame ready and release
+//! notifications is placed after the buffers, with a trailer at the end of the segment allowing
+//! other processes mapping the segment to locate them. The buffer layout is unchanged by the
+//! presence of the rings.
+//!
+//! If variable-length frames are requested, the buffers are instead blocks from which frames are
+//! allocated as contiguous runs, identified by the ID of their first block. A table of frame lengths
+//! indexed by block is placed between the header and the blocks, so that a process receiving a
+//! frame notification can find the length of the frame without it being carried in the notification.
+//!
+//! The mapping options allow the segment to be backed by huge pages from a hugetlbfs mount, bound
+//! to a NUMA node, locked into memory and pre-faulted, so that the first pass of frames through the
+//! buffers does not incur page faults.
+//!
+//! \param[in] shared_mem_name - name of the shared memory segment
+//! \param[in] shared_mem_size - size of the buffer area of the segment in bytes
+//! \param[in] buffer_size - size of each buffer in bytes
+//! \param[in] remove_when_deleted - remove the segment when the manager is destroyed
+//! \param[in] notify_rings - create frame ready and release notification rings in the segment
+//! \param[in] options - options controlling how the segment is backed and mapped
+//! \param[in] variable_frames - divide the segment into blocks holding variable-length frames
+//!
 SharedBufferManager::SharedBufferManager(
     const std::string& shared_mem_name,
     const size_t shared_mem_size,
     const size_t buffer_size,
-    bool remove_when_deleted
+    bool remove_when_deleted,
+    bool notify_rings,
+    const MappingOptions& options,
+    bool variable_frames
 )
 try :
     shared_mem_name_(shared_mem_name),
     shared_mem_size_(shared_mem_size),
     remove_when_deleted_(remove_when_deleted),
-    shared_mem_(open_or_create, shared_mem_name_.c_str(), read_write),
-    manager_hdr_(0) {
+    options_(options),
+    page_size_(0),
+    prefault_duration_(0),
+    manager_hdr_(0),
+    frame_lengths_(0),
+    ready_ring_(0),
+    release_ring_(0) {
 
     // Check that the buffer size specified is non-zero
     if (buffer_size == 0) {
         throw SharedBufferManagerException("Zero shared memory buffer size specified");
     }
 
-    // Set the size of the shared memory object
-    shared_mem_.truncate(sizeof(Header) + shared_mem_size_);
-
-    // Map the whole shared memory region into this process
-    shared_mem_region_ = mapped_region(shared_mem_, read_write);
-
     // Determine how many buffers of the requested size fit into the shared memory region
     size_t num_buffers = shared_mem_size_ / buffer_size;
     if (!num_buffers) {
         throw SharedBufferManagerException("Buffer size requested exceeds size of shared memory");
     }
 
+    // Place the frame length table after the header if variable-length frames are requested, aligning
+    // the buffers that follow it
+    size_t buffer_offset = sizeof(Header);
+    if (variable_frames) {
+        buffer_offset = align_ring_offset(sizeof(Header) + (num_buffers * sizeof(uint64_t)));
+    }
+
+    // Determine the size of the notification rings, if requested. Each ring can hold a descriptor
+    // for every buffer, so can never overflow.
+    size_t ring_capacity = 0;
+    size_t ring_size = 0;
+    size_t ring_offset = align_ring_offset(buffer_offset + shared_mem_size_);
+    if (notify_rings) {
+        ring_capacity = SharedBufferRing::capacity_for(num_buffers);
+        ring_size = align_ring_offset(SharedBufferRing::required_size(ring_capacity));
+    }
+
+    // Create, size and map the whole shared memory segment into this process
+    if (notify_rings) {
+        map_segment(true, ring_offset + (2 * ring_size) + sizeof(RingTrailer));
+    } else {
+        map_segment(true, buffer_offset + shared_mem_size_);
+    }
+
+    // Apply the NUMA binding before any pages are faulted in, so that they are allocated on the node
+    bind_segment();
+    lock_segment();
+    prefault_segment(true);
+
     // Initialise the buffer manager header
     manager_hdr_ = reinterpret_cast<Header*>(shared_mem_region_.get_address());
     manager_hdr_->manager_id = last_manager_id++;
     manager_hdr_->num_buffers = num_buffers;
     manager_hdr_->buffer_size = buffer_size;
+    manager_hdr_->buffer_offset = buffer_offset;
+    manager_hdr_->variable_frames = variable_frames ? 1 : 0;
+
+    // Initialise the frame length table, with each block holding an empty frame
+    if (variable_frames) {
+        frame_lengths_ = reinterpret_cast<uint64_t*>(manager_hdr_ + 1);
+        memset(frame_lengths_, 0, num_buffers * sizeof(uint64_t));
+    }
+
+    // Initialise the notification rings and the trailer locating them
+    if (notify_rings) {
+        char* base = reinterpret_cast<char*>(shared_mem_region_.get_address());
+        ready_ring_ = reinterpret_cast<SharedBufferRing*>(base + ring_offset);
+        release_ring_ = reinterpret_cast<SharedBufferRing*>(base + ring_offset + ring_size);
+        ready_ring_->initialise(ring_capacity);
+        release_ring_->initialise(ring_capacity);
+
+        RingTrailer* trailer
+            = reinterpret_cast<RingTrailer*>(base + shared_mem_region_.get_size() - sizeof(RingTrailer));
+        trailer->ring_size = ring_size;
+        trailer->ring_offset = ring_offset;
+        trailer->magic = ring_trailer_magic;
+    }
 
 } catch (interprocess_exception& e) {
     // Catch, transform and rethrow any exceptions thrown during the member initializer list
@@ -55,20 +148,56 @@ try :
     throw(SharedBufferManagerException(ss.str()));
 }
 
-SharedBufferManager::SharedBufferManager(const std::string& shared_mem_name)
+//! Constructor for the SharedBufferManager class mapping an existing segment.
+//!
+//! This constructor maps a shared memory segment created by another process. The mapping options
+//! should match those the segment was created with, so that a segment backed by huge pages can be
+//! found.
+//!
+//! \param[in] shared_mem_name - name of the shared memory segment
+//! \param[in] options - options controlling how the segment is mapped
+//!
+SharedBufferManager::SharedBufferManager(const std::string& shared_mem_name, const MappingOptions& options)
 try :
     shared_mem_name_(shared_mem_name),
     remove_when_deleted_(false),
-    shared_mem_(open_only, shared_mem_name_.c_str(), read_write) {
+    options_(options),
+    page_size_(0),
+    prefault_duration_(0),
+    frame_lengths_(0),
+    ready_ring_(0),
+    release_ring_(0) {
 
     // Map the whole shared memory region into this process
-    shared_mem_region_ = mapped_region(shared_mem_, read_write);
+    map_segment(false);
+    bind_segment();
+    lock_segment();
+    prefault_segment(false);
 
     // Determine how big the region is
     shared_mem_size_ = shared_mem_region_.get_size();
 
     // Map the buffer manager header
     manager_hdr_ = reinterpret_cast<Header*>(shared_mem_region_.get_address());
+    if (manager_hdr_->variable_frames) {
+        frame_lengths_ = reinterpret_cast<uint64_t*>(manager_hdr_ + 1);
+    }
+
+    // Locate the notification rings if the trailer at the end of the segment indicates they are present.
+    // The rings are found at the offset recorded in the trailer rather than immediately before it, since
+    // the segment may have been rounded up to a whole number of huge pages when created.
+    if (shared_mem_size_ >= sizeof(Header) + sizeof(RingTrailer)) {
+        char* base = reinterpret_cast<char*>(shared_mem_region_.get_address());
+        RingTrailer* trailer = reinterpret_cast<RingTrailer*>(base + shared_mem_size_ - sizeof(RingTrailer));
+        size_t buffer_end = manager_hdr_->buffer_offset + (manager_hdr_->num_buffers * manager_hdr_->buffer_size);
+        size_t trailer_offset = shared_mem_size_ - sizeof(RingTrailer);
+        if ((trailer->magic == ring_trailer_magic) && (trailer->ring_offset >= buffer_end)
+            && (trailer->ring_offset <= trailer_offset)
+            && ((2 * trailer->ring_size) <= (trailer_offset - trailer->ring_offset))) {
+            ready_ring_ = reinterpret_cast<SharedBufferRing*>(base + trailer->ring_offset);
+            release_ring_ = reinterpret_cast<SharedBufferRing*>(base + trailer->ring_offset + trailer->ring_size);
+        }
+    }
 
 } catch (interprocess_exception& e) {
     // Catch, transform and rethrow any exceptions thrown during the member initializer list
@@ -80,10 +209,19 @@ try :
 SharedBufferManager::~SharedBufferManager()
 {
     if (remove_when_deleted_) {
-        shared_memory_object::remove(shared_mem_name_.c_str());
+        if (options_.huge_page_dir.empty()) {
+            shared_memory_object::remove(shared_mem_name_.c_str());
+        } else {
+            file_mapping::remove(huge_page_path().c_str());
+        }
     }
 }
 
+const std::string& SharedBufferManager::get_shared_mem_name(void) const
+{
+    return shared_mem_name_;
+}
+
 const size_t SharedBufferManager::get_manager_id(void) const
 {
     return manager_hdr_->manager_id;
@@ -106,8 +244,267 @@ void* SharedBufferManager::get_buffer_address(const unsigned int buffer) const
         throw SharedBufferManagerException(ss.str());
     }
     return reinterpret_cast<void*>(
-        ((char*)shared_mem_region_.get_address() + sizeof(Header)) + buffer * manager_hdr_->buffer_size
+        ((char*)shared_mem_region_.get_address() + manager_hdr_->buffer_offset) + buffer * manager_hdr_->buffer_size
+    );
+}
+
+//! Indicate if the shared memory segment holds variable-length frames.
+//!
+//! \return true if the buffers are blocks holding variable-length frames
+//!
+const bool SharedBufferManager::has_variable_frames(void) const
+{
+    return (frame_lengths_ != 0);
+}
+
+//! Set the length of a variable-length frame.
+//!
+//! This method records the length of the frame starting at a block in the frame length table of the
+//! segment. It must be called before the frame is notified as ready, so that the process receiving
+//! the notification finds the length.
+//!
+//! \param[in] buffer - ID of the first block of the frame
+//! \param[in] length - length of the frame in bytes
+//!
+void SharedBufferManager::set_frame_length(const unsigned int buffer, const size_t length)
+{
+    if (!frame_lengths_) {
+        throw SharedBufferManagerException("Frame lengths can only be set for variable-length frames");
+    }
+    if ((buffer >= manager_hdr_->num_buffers)
+        || (length > ((manager_hdr_->num_buffers - buffer) * manager_hdr_->buffer_size))) {
+        std::stringstream ss;
+        ss << "Illegal frame length " << length << " specified for buffer index " << buffer;
+        throw SharedBufferManagerException(ss.str());
+    }
+    frame_lengths_[buffer] = length;
+}
+
+//! Get the length of the frame in a buffer.
+//!
+//! This method returns the length recorded for a variable-length frame starting at a block or, if
+//! the segment is divided into fixed-size buffers, the buffer size.
+//!
+//! \param[in] buffer - ID of the buffer, or of the first block of the frame
+//! \return length of the frame in bytes
+//!
+const size_t SharedBufferManager::get_frame_length(const unsigned int buffer) const
+{
+    if (buffer >= manager_hdr_->num_buffers) {
+        std::stringstream ss;
+        ss << "Illegal buffer index specified: " << buffer;
+        throw SharedBufferManagerException(ss.str());
+    }
+    return frame_lengths_ ? static_cast<size_t>(frame_lengths_[buffer]) : manager_hdr_->buffer_size;
+}
+
+//! Get the size of the pages backing the shared memory segment.
+//!
+//! \return page size in bytes
+//!
+const size_t SharedBufferManager::get_page_size(void) const
+{
+    return page_size_;
+}
+
+//! Get the NUMA node the shared memory segment is bound to.
+//!
+//! \return NUMA node, or -1 if the segment is not bound to a node
+//!
+const int SharedBufferManager::get_numa_node(void) const
+{
+    return options_.numa_node;
+}
+
+//! Get the time taken to fault in the shared memory segment when it was mapped.
+//!
+//! \return prefault duration in microseconds, or zero if the segment was not pre-faulted
+//!
+const unsigned int SharedBufferManager::get_prefault_duration(void) const
+{
+    return prefault_duration_;
+}
+
+//! Indicate if the shared memory segment contains frame notification rings.
+//!
+//! \return true if the notification rings are present
+//!
+const bool SharedBufferManager::has_notify_rings(void) const
+{
+    return (ready_ring_ != 0);
+}
+
+//! Get the frame ready notification ring.
+//!
+//! \return pointer to the ring, or null if the segment has no notification rings
+//!
+SharedBufferRing* SharedBufferManager::get_ready_ring(void) const
+{
+    return ready_ring_;
+}
+
+//! Get the frame release notification ring.
+//!
+//! \return pointer to the ring, or null if the segment has no notification rings
+//!
+SharedBufferRing* SharedBufferManager::get_release_ring(void) const
+{
+    return release_ring_;
+}
+
+size_t SharedBufferManager::align_ring_offset(size_t offset)
+{
+    return (offset + ring_alignment - 1) & ~(ring_alignment - 1);
+}
+
+//! Map the shared memory segment into this process.
+//!
+//! The segment is either a POSIX shared memory object or, if a hugetlbfs mount is configured, a
+//! file in that mount, in which case its size is rounded up to a whole number of huge pages.
+//!
+//! \param[in] create - create the segment if it does not exist and set its size
+//! \param[in] segment_size - size of the segment to create in bytes
+//!
+void SharedBufferManager::map_segment(bool create, size_t segment_size)
+{
+    if (options_.huge_page_dir.empty()) {
+        page_size_ = sysconf(_SC_PAGESIZE);
+        if (create) {
+            shared_memory_object shared_mem(open_or_create, shared_mem_name_.c_str(), read_write);
+            shared_mem_.swap(shared_mem);
+            shared_mem_.truncate(segment_size);
+        } else {
+            shared_memory_object shared_mem(open_only, shared_mem_name_.c_str(), read_write);
+            shared_mem_.swap(shared_mem);
+        }
+        shared_mem_region_ = mapped_region(shared_mem_, read_write);
+        return;
+    }
+
+    std::string path = huge_page_path();
+#ifdef __linux__
+    struct statfs fs_stats;
+    if (statfs(options_.huge_page_dir.c_str(), &fs_stats) != 0) {
+        std::stringstream ss;
+        ss << "Unable to access huge page directory " << options_.huge_page_dir << ": " << strerror(errno);
+        throw SharedBufferManagerException(ss.str());
+    }
+    page_size_ = fs_stats.f_bsize;
+#else
+    page_size_ = sysconf(_SC_PAGESIZE);
+#endif
+
+    if (create) {
+        int fd = open(path.c_str(), O_CREAT | O_RDWR, 0666);
+        if (fd < 0) {
+            std::stringstream ss;
+            ss << "Unable to create huge page file " << path << ": " << strerror(errno);
+            throw SharedBufferManagerException(ss.str());
+        }
+        off_t file_size = ((segment_size + page_size_ - 1) / page_size_) * page_size_;
+        int rc = ftruncate(fd, file_size);
+        int truncate_errno = errno;
+        close(fd);
+        if (rc != 0) {
+            std::stringstream ss;
+            ss << "Unable to size huge page file " << path << " to " << file_size
+               << " bytes: " << strerror(truncate_errno);
+            throw SharedBufferManagerException(ss.str());
+        }
+    }
+    file_mapping huge_page_file(path.c_str(), read_write);
+    huge_page_file_.swap(huge_page_file);
+    shared_mem_region_ = mapped_region(huge_page_file_, read_write);
+}
+
+//! Bind the shared memory segment to the configured NUMA node.
+//!
+//! The binding is a policy on the shared memory object, so only affects pages not yet allocated.
+//!
+void SharedBufferManager::bind_segment(void)
+{
+    if (options_.numa_node < 0) {
+        return;
+    }
+#ifdef __linux__
+    const size_t bits_per_mask = 8 * sizeof(unsigned long);
+    std::vector<unsigned long> node_mask((options_.numa_node / bits_per_mask) + 1, 0);
+    node_mask[options_.numa_node / bits_per_mask] |= 1UL << (options_.numa_node % bits_per_mask);
+    long rc = syscall(
+        __NR_mbind, shared_mem_region_.get_address(), shared_mem_region_.get_size(), MPOL_BIND, &node_mask[0],
+        (node_mask.size() * bits_per_mask) + 1, 0
     );
+    if (rc != 0) {
+        std::stringstream ss;
+        ss << "Unable to bind shared memory to NUMA node " << options_.numa_node << ": " << strerror(errno);
+        throw SharedBufferManagerException(ss.str());
+    }
+#else
+    throw SharedBufferManagerException("Binding shared memory to a NUMA node is not supported on this platform");
+#endif
+}
+
+//! Lock the shared memory segment into memory, if configured.
+//!
+void SharedBufferManager::lock_segment(void)
+{
+    if (!options_.lock_memory) {
+        return;
+    }
+    if (mlock(shared_mem_region_.get_address(), shared_mem_region_.get_size()) != 0) {
+        std::stringstream ss;
+        ss << "Unable to lock " << shared_mem_region_.get_size() << " bytes of shared memory: " << strerror(errno);
+        throw SharedBufferManagerException(ss.str());
+    }
+}
+
+//! Fault in every page of the shared memory segment, if configured.
+//!
+//! The creating process faults the pages in for writing, allocating them. A process mapping an
+//! existing segment only reads each page, so as not to disturb frames already being received.
+//!
+//! \param[in] write - fault the pages in for writing
+//!
+void SharedBufferManager::prefault_segment(bool write)
+{
+    if (!options_.prefault) {
+        return;
+    }
+    struct timespec start_time;
+    struct timespec end_time;
+    gettime(&start_time, true);
+
+    char* base = reinterpret_cast<char*>(shared_mem_region_.get_address());
+    size_t size = shared_mem_region_.get_size();
+    bool populated = false;
+#if defined(MADV_POPULATE_WRITE) && defined(MADV_POPULATE_READ)
+    populated = (madvise(base, size, write ? MADV_POPULATE_WRITE : MADV_POPULATE_READ) == 0);
+#endif
+    if (!populated) {
+        volatile char* page = base;
+        for (size_t offset = 0; offset < size; offset += page_size_) {
+            char value = page[offset];
+            if (write) {
+                page[offset] = value;
+            }
+        }
+    }
+
+    gettime(&end_time, true);
+    prefault_duration_ = elapsed_us(start_time, end_time);
+}
+
+//! Get the path of the hugetlbfs file backing the segment.
+//!
+//! \return path of the file
+//!
+std::string SharedBufferManager::huge_page_path(void) const
+{
+    std::string path = options_.huge_page_dir;
+    if (path[path.size() - 1] != '/') {
+        path += "/";
+    }
+    return path + shared_mem_name_;
 }
 
 size_t SharedBufferManager::last_manager_id = 0;
@@ -0,0 +1,308 @@
+/*!
+ * SharedBufferNotifier.cpp
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sstream>
+
+#ifdef __linux__
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+#include "SharedBufferNotifier.h"
+
+using namespace OdinData;
+
+//! Constructor for the SharedBufferNotifier class.
+//!
+//! This constructor sets up notification via the rings in the specified shared buffer manager.
+//! The creating side, i.e. the frame receiver, creates the eventfd doorbells and a listening UNIX
+//! domain socket, named after the shared buffer, on which they are passed to the processing side.
+//! The processing side connects to that socket to obtain the doorbells.
+//!
+//! \param[in] buffer_manager - shared buffer manager containing the notification rings
+//! \param[in] create - true to create the doorbells, false to connect to existing ones
+//!
+SharedBufferNotifier::SharedBufferNotifier(SharedBufferManagerPtr buffer_manager, bool create) :
+    buffer_manager_(buffer_manager),
+    listen_fd_(-1)
+{
+    for (std::size_t ring = 0; ring < num_rings; ring++) {
+        doorbell_fds_[ring] = -1;
+    }
+
+    if (!buffer_manager_ || !buffer_manager_->has_notify_rings()) {
+        throw SharedBufferNotifierException("Shared buffer has no notification rings");
+    }
+
+#ifdef __linux__
+    try {
+        if (create) {
+            this->create_doorbells();
+        } else {
+            this->connect_doorbells();
+        }
+    } catch (SharedBufferNotifierException& e) {
+        this->close_fds();
+        throw;
+    }
+#else
+    throw SharedBufferNotifierException("Shared buffer notification rings are not supported on this platform");
+#endif
+}
+
+//! Destructor for the SharedBufferNotifier class.
+//!
+SharedBufferNotifier::~SharedBufferNotifier()
+{
+    this->close_fds();
+}
+
+//! Post a descriptor to a notification ring.
+//!
+//! This method pushes a frame descriptor onto the specified ring and signals the ring doorbell.
+//! Posting is serialised within the calling process, so that multiple threads in one process may
+//! post to the same ring while preserving the single producer property of the ring.
+//!
+//! \param[in] ring_id - ring to post to
+//! \param[in] buffer_id - shared buffer ID
+//! \param[in] frame_number - frame number contained in the buffer
+//! \param[in] flags - notification flags
+//! \return true if the descriptor was posted, false if the ring was full
+//!
+bool SharedBufferNotifier::post(RingId ring_id, uint32_t buffer_id, uint64_t frame_number, uint32_t flags)
+{
+    SharedBufferRing::Descriptor desc;
+    desc.frame_number = frame_number;
+    desc.buffer_id = buffer_id;
+    desc.flags = flags;
+
+    {
+        boost::lock_guard<boost::mutex> lock(post_mutex_[ring_id]);
+        if (!this->get_ring(ring_id)->push(desc)) {
+            return false;
+        }
+    }
+
+#ifdef __linux__
+    eventfd_write(doorbell_fds_[ring_id], 1);
+#endif
+    return true;
+}
+
+//! Take a descriptor from a notification ring.
+//!
+//! Only one thread in one process may take descriptors from each ring.
+//!
+//! \param[in] ring_id - ring to take from
+//! \param[out] desc - descriptor taken from the ring
+//! \return true if a descriptor was taken, false if the ring was empty
+//!
+bool SharedBufferNotifier::take(RingId ring_id, SharedBufferRing::Descriptor& desc)
+{
+    return this->get_ring(ring_id)->pop(desc);
+}
+
+//! Get the doorbell file descriptor for a ring.
+//!
+//! The descriptor becomes readable when descriptors have been posted to the ring, and can be
+//! registered with an IpcReactor.
+//!
+//! \param[in] ring_id - ring to get the doorbell for
+//! \return doorbell file descriptor
+//!
+int SharedBufferNotifier::get_doorbell_fd(RingId ring_id) const
+{
+    return doorbell_fds_[ring_id];
+}
+
+//! Clear the doorbell for a ring.
+//!
+//! The consumer should clear the doorbell before taking all available descriptors from the ring,
+//! so that no notification is missed.
+//!
+//! \param[in] ring_id - ring to clear the doorbell for
+//!
+void SharedBufferNotifier::clear_doorbell(RingId ring_id)
+{
+#ifdef __linux__
+    eventfd_t value;
+    eventfd_read(doorbell_fds_[ring_id], &value);
+#endif
+}
+
+//! Get the file descriptor of the socket listening for processing side connections.
+//!
+//! \return listening socket file descriptor, or -1 if not the creating side
+//!
+int SharedBufferNotifier::get_listen_fd(void) const
+{
+    return listen_fd_;
+}
+
+//! Handle a connection on the listening socket.
+//!
+//! This method accepts a connection from a processing application and passes the doorbell file
+//! descriptors to it as ancillary data.
+//!
+void SharedBufferNotifier::handle_connection(void)
+{
+#ifdef __linux__
+    int conn_fd = accept(listen_fd_, NULL, NULL);
+    if (conn_fd < 0) {
+        return;
+    }
+
+    char data = 0;
+    struct iovec iov;
+    iov.iov_base = &data;
+    iov.iov_len = sizeof(data);
+
+    char control[CMSG_SPACE(sizeof(doorbell_fds_))];
+    memset(control, 0, sizeof(control));
+
+    struct msghdr msg_hdr;
+    memset(&msg_hdr, 0, sizeof(msg_hdr));
+    msg_hdr.msg_iov = &iov;
+    msg_hdr.msg_iovlen = 1;
+    msg_hdr.msg_control = control;
+    msg_hdr.msg_controllen = sizeof(control);
+
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg_hdr);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(doorbell_fds_));
+    memcpy(CMSG_DATA(cmsg), doorbell_fds_, sizeof(doorbell_fds_));
+
+    sendmsg(conn_fd, &msg_hdr, MSG_NOSIGNAL);
+    close(conn_fd);
+#endif
+}
+
+//! Return the name of the socket used to pass doorbells, derived from the shared buffer name.
+//!
+std::string SharedBufferNotifier::socket_name(void) const
+{
+    return std::string("odin_data_notify_") + buffer_manager_->get_shared_mem_name();
+}
+
+//! Create the doorbells and the socket on which they are passed to connecting processes.
+//!
+//! The socket is bound in the Linux abstract namespace, so is removed automatically when closed.
+//!
+void SharedBufferNotifier::create_doorbells(void)
+{
+#ifdef __linux__
+    for (std::size_t ring = 0; ring < num_rings; ring++) {
+        doorbell_fds_[ring] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (doorbell_fds_[ring] < 0) {
+            std::stringstream ss;
+            ss << "Failed to create notification doorbell: " << strerror(errno);
+            throw SharedBufferNotifierException(ss.str());
+        }
+    }
+
+    std::string name = this->socket_name();
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(&addr.sun_path[1], name.c_str(), sizeof(addr.sun_path) - 2);
+    socklen_t addr_len = offsetof(struct sockaddr_un, sun_path) + 1 + strlen(&addr.sun_path[1]);
+
+    listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if ((listen_fd_ < 0) || (bind(listen_fd_, (struct sockaddr*)&addr, addr_len) < 0) || (listen(listen_fd_, 4) < 0)) {
+        std::stringstream ss;
+        ss << "Failed to create notification socket " << name << ": " << strerror(errno);
+        throw SharedBufferNotifierException(ss.str());
+    }
+#endif
+}
+
+//! Connect to the creating process to obtain the doorbells.
+//!
+void SharedBufferNotifier::connect_doorbells(void)
+{
+#ifdef __linux__
+    std::string name = this->socket_name();
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(&addr.sun_path[1], name.c_str(), sizeof(addr.sun_path) - 2);
+    socklen_t addr_len = offsetof(struct sockaddr_un, sun_path) + 1 + strlen(&addr.sun_path[1]);
+
+    int conn_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if ((conn_fd < 0) || (connect(conn_fd, (struct sockaddr*)&addr, addr_len) < 0)) {
+        std::stringstream ss;
+        ss << "Failed to connect to notification socket " << name << ": " << strerror(errno);
+        if (conn_fd >= 0) {
+            close(conn_fd);
+        }
+        throw SharedBufferNotifierException(ss.str());
+    }
+
+    // Wait a bounded time for the creating process to pass the doorbells
+    struct timeval timeout;
+    timeout.tv_sec = 1;
+    timeout.tv_usec = 0;
+    setsockopt(conn_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    char data;
+    struct iovec iov;
+    iov.iov_base = &data;
+    iov.iov_len = sizeof(data);
+
+    char control[CMSG_SPACE(sizeof(doorbell_fds_))];
+    memset(control, 0, sizeof(control));
+
+    struct msghdr msg_hdr;
+    memset(&msg_hdr, 0, sizeof(msg_hdr));
+    msg_hdr.msg_iov = &iov;
+    msg_hdr.msg_iovlen = 1;
+    msg_hdr.msg_control = control;
+    msg_hdr.msg_controllen = sizeof(control);
+
+    ssize_t bytes_received = recvmsg(conn_fd, &msg_hdr, MSG_CMSG_CLOEXEC);
+    int recv_errno = errno;
+    close(conn_fd);
+
+    struct cmsghdr* cmsg = (bytes_received > 0) ? CMSG_FIRSTHDR(&msg_hdr) : NULL;
+    if (!cmsg || (cmsg->cmsg_level != SOL_SOCKET) || (cmsg->cmsg_type != SCM_RIGHTS)
+        || (cmsg->cmsg_len != CMSG_LEN(sizeof(doorbell_fds_)))) {
+        std::stringstream ss;
+        ss << "Failed to receive notification doorbells from socket " << name;
+        if (bytes_received < 0) {
+            ss << ": " << strerror(recv_errno);
+        }
+        throw SharedBufferNotifierException(ss.str());
+    }
+    memcpy(doorbell_fds_, CMSG_DATA(cmsg), sizeof(doorbell_fds_));
+#endif
+}
+
+//! Close the doorbell and listening socket file descriptors.
+//!
+void SharedBufferNotifier::close_fds(void)
+{
+    for (std::size_t ring = 0; ring < num_rings; ring++) {
+        if (doorbell_fds_[ring] >= 0) {
+            close(doorbell_fds_[ring]);
+            doorbell_fds_[ring] = -1;
+        }
+    }
+    if (listen_fd_ >= 0) {
+        close(listen_fd_);
+        listen_fd_ = -1;
+    }
+}
+
+//! Get a pointer to the specified ring in the shared buffer manager.
+//!
+SharedBufferRing* SharedBufferNotifier::get_ring(RingId ring_id) const
+{
+    return (ring_id == ReadyRing) ? buffer_manager_->get_ready_ring() : buffer_manager_->get_release_ring();
+}
@@ -8,11 +8,13 @@
 #ifndef FRAMEPROCESSOR_SRC_ACQUISITION_H_
 #define FRAMEPROCESSOR_SRC_ACQUISITION_H_
 
+#include <deque>
 #include <map>
 #include <string>
 #include <vector>
 
 #include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
 
 #include <log4cxx/logger.h>
 using namespace log4cxx;
@@ -33,7 +35,7 @@ public:
     ProcessFrameStatus process_frame(boost::shared_ptr<Frame> frame, HDF5CallDurations_t& call_durations);
     void create_file(size_t file_number, HDF5CallDurations_t& call_durations);
     void close_file(boost::shared_ptr<HDF5File> file, HDF5CallDurations_t& call_durations);
-    void validate_dataset_definition(DatasetDefinition definition);
+    void validate_dataset_definition(DatasetDefinition definition) const;
     bool start_acquisition(
         size_t concurrent_rank,
         size_t concurrent_processes,
@@ -47,6 +49,8 @@ public:
         size_t alignment_threshold,
         size_t alignment_value,
         std::string master_frame,
+        HDF5FlushPolicy_t flush_policy,
+        bool pre_create_files,
         HDF5CallDurations_t& call_durations
     );
     void stop_acquisition(HDF5CallDurations_t& call_durations);
@@ -57,7 +61,7 @@ public:
     boost::shared_ptr<HDF5File> get_file(size_t frame_offset, HDF5CallDurations_t& call_durations);
     std::string get_create_meta_header();
     std::string get_meta_header();
-    std::string generate_filename(size_t file_number = 0);
+    std::string generate_filename(size_t file_number = 0) const;
 
     LoggerPtr logger_;
     /** Name of master frame. When a master frame is received frame numbers increment */
@@ -86,6 +90,8 @@ public:
     size_t alignment_threshold_;
     /** HDF5 file chunk alignment value */
     size_t alignment_value_;
+    /** When datasets are flushed to disk */
+    HDF5FlushPolicy_t flush_policy_;
     /** Identifier for the acquisition - value sent from a detector/control to be used to
      * identify frames, config or anything else to this acquisition. Used to name the file */
     std::string acquisition_id_;
@@ -110,6 +116,14 @@ private:
     void add_uint64_to_document(const std::string& key, size_t value, rapidjson::Document* document) const;
     void add_string_to_document(const std::string& key, const std::string& value, rapidjson::Document* document) const;
     std::string document_to_string(rapidjson::Document& document) const;
+    size_t open_file(boost::shared_ptr<HDF5File> file, size_t file_number) const;
+    void retire_file(boost::shared_ptr<HDF5File> file, HDF5CallDurations_t& call_durations);
+    void prepare_file(size_t file_number);
+    boost::shared_ptr<HDF5File> take_prepared_file(size_t file_number, size_t& create_duration);
+    void record_file_thread_events(HDF5CallDurations_t& call_durations);
+    void stop_file_thread(HDF5CallDurations_t& call_durations);
+    void discard_file(boost::shared_ptr<HDF5File> file) const;
+    void run_file_thread();
 
     /** The current file that frames are being written to */
     boost::shared_ptr<HDF5File> current_file_;
@@ -117,6 +131,30 @@ private:
     boost::shared_ptr<HDF5File> previous_file_;
     /** Most recently generated error message */
     std::string last_error_;
+    /** Whether files are created ahead of rollover and retired files closed by the file thread */
+    bool pre_create_files_;
+    /** Thread creating and closing files in the background */
+    boost::thread file_thread_;
+    /** Mutex protecting the file thread state */
+    boost::mutex file_thread_mutex_;
+    /** Condition variable notified when the file thread has work or has created a file */
+    boost::condition_variable file_thread_condition_;
+    /** Is the file thread running */
+    bool file_thread_running_;
+    /** Has the file thread been asked to create a file */
+    bool prepare_requested_;
+    /** Is the file thread creating a file */
+    bool preparing_;
+    /** Number of the file the file thread has been asked to create */
+    size_t prepare_file_number_;
+    /** File created by the file thread, waiting to be used */
+    boost::shared_ptr<HDF5File> prepared_file_;
+    /** Duration of the H5Fcreate call for the file created by the file thread */
+    size_t prepared_create_duration_;
+    /** Retired files waiting to be closed by the file thread */
+    std::deque<boost::shared_ptr<HDF5File>> files_to_close_;
+    /** Names and close durations of files closed by the file thread, waiting to be recorded */
+    std::vector<std::pair<std::string, size_t>> files_closed_;
 };
 
 } /* namespace FrameProcessor */
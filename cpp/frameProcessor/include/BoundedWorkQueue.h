@@ -0,0 +1,452 @@
+/*
+ * BoundedWorkQueue.h
+ *
+ *  Created on: 16 Oct 2026
+ *      Author: odin-data developers
+ */
+
+#ifndef TOOLS_FILEWRITER_BOUNDEDWORKQUEUE_H_
+#define TOOLS_FILEWRITER_BOUNDEDWORKQUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <list>
+#include <pthread.h>
+#include <vector>
+
+#include "WorkQueue.h"
+
+namespace FrameProcessor {
+
+/** Lock-free bounded producer consumer work queue.
+ *
+ * This is an alternative to the WorkQueue for transfer of Frame objects between plugins,
+ * implemented as a fixed size ring of slots, each carrying a sequence number, rather than a
+ * mutex protected list. Items are added and removed without taking a lock or allocating
+ * memory, and only when the queue is empty (or full) does the consumer (or producer) fall
+ * back to blocking on a condition, optionally after spinning for a number of attempts.
+ *
+ * The queue supports a single consumer thread. In single producer mode only one thread may
+ * add items to the queue at a time, which avoids an atomic read-modify-write per item; in
+ * multiple producer mode any number of threads may add items, each claiming a slot with a
+ * compare-and-swap.
+ *
+ * Items added with the maximum limit ignored are placed on a mutex protected overflow list
+ * if the ring is full, so that a producer which must not block (e.g. the shared memory
+ * controller) is never held up. Items from a given producer are always removed in the order
+ * they were added.
+ */
+template <typename T> class BoundedWorkQueue : public WorkQueue<T> {
+    typedef typename WorkQueue<T>::Entry Entry;
+
+    /** Ring slot, holding an item and its sequence number */
+    struct Slot {
+        /** Sequence number of the slot, used to determine whether it is free or occupied */
+        std::atomic<size_t> sequence;
+        /** Item stored in the slot */
+        Entry entry;
+    };
+
+public:
+    /** Constructor.
+     *
+     * The constructor allocates the ring, rounding the depth up to a power of two, and
+     * initialises the mutex and conditions used when blocking.
+     *
+     * \param[in] depth - minimum number of items the queue can hold before adding blocks.
+     * \param[in] multi_producer - true if more than one thread may add items to the queue.
+     * \param[in] spin_count - number of attempts made to add or remove an item before blocking.
+     */
+    BoundedWorkQueue(int depth = max_queue_size, bool multi_producer = true, int spin_count = 0) :
+        WorkQueue<T>(depth),
+        capacity_(capacity_for(depth)),
+        mask_(capacity_ - 1),
+        slots_(capacity_),
+        multi_producer_(multi_producer),
+        spin_count_(spin_count),
+        head_(0),
+        removed_depth_(0),
+        tail_(0),
+        overflow_size_(0),
+        consumer_waiting_(false),
+        producers_waiting_(0),
+        interrupted_(false)
+    {
+        for (size_t i = 0; i < capacity_; i++) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        pthread_mutex_init(&wait_mutex_, NULL);
+        pthread_cond_init(&not_empty_, NULL);
+        pthread_cond_init(&not_full_, NULL);
+    }
+
+    /** Destructor.
+     *
+     * The destructor frees resources (mutex and conditions).
+     */
+    virtual ~BoundedWorkQueue()
+    {
+        pthread_mutex_destroy(&wait_mutex_);
+        pthread_cond_destroy(&not_empty_);
+        pthread_cond_destroy(&not_full_);
+    }
+
+    /** Add an item to the queue.
+     *
+     * The item is placed in the next free slot of the ring. If the ring is full, the producer
+     * spins and then blocks until the consumer frees a slot, unless the maximum limit is ignored,
+     * in which case the item is placed on the overflow list.
+     *
+     * \param[in] item - the item to add to the queue.
+     * \param[in] ignore_max_limit - add the item without blocking even if the queue is full.
+     */
+    virtual void add(T item, bool ignore_max_limit = false)
+    {
+        struct timespec queued;
+        if (ignore_max_limit) {
+            // Preserve ordering with any items already on the overflow list
+            if (overflow_size_.load(std::memory_order_acquire) > 0 || !try_push(item, queued)) {
+                Entry entry;
+                entry.item = item;
+                gettime(&entry.queued, true);
+                pthread_mutex_lock(&wait_mutex_);
+                overflow_.push_back(entry);
+                overflow_size_.fetch_add(1, std::memory_order_release);
+                pthread_cond_signal(&not_empty_);
+                pthread_mutex_unlock(&wait_mutex_);
+                return;
+            }
+        } else if (!try_push(item, queued)) {
+            // The ring is full, so spin and then block, recording how long the producer is held up
+            struct timespec blocked_start;
+            gettime(&blocked_start, true);
+            bool pushed = try_push_spin(item, queued);
+            pthread_mutex_lock(&wait_mutex_);
+            if (!pushed) {
+                producers_waiting_.fetch_add(1, std::memory_order_seq_cst);
+                while (!try_push(item, queued)) {
+                    pthread_cond_wait(&not_full_, &wait_mutex_);
+                }
+                producers_waiting_.fetch_sub(1, std::memory_order_relaxed);
+            }
+            this->m_stats.blocked_.update(elapsed_us(blocked_start, queued));
+            pthread_mutex_unlock(&wait_mutex_);
+        }
+        wake_consumer();
+    }
+
+    /** Remove an item from the queue.
+     *
+     * Calling this method spins and then blocks the current thread until an item is available
+     * in the queue, or the queue is interrupted, in which case an empty item is returned.
+     *
+     * \return the first item in the queue.
+     */
+    virtual T remove()
+    {
+        Entry entry;
+        for (int spin = 0; spin <= spin_count_; spin++) {
+            if (try_pop(entry)) {
+                wake_producers();
+                return removed(entry);
+            }
+            if (interrupted_.exchange(false, std::memory_order_acq_rel)) {
+                return T();
+            }
+            cpu_relax();
+        }
+
+        pthread_mutex_lock(&wait_mutex_);
+        consumer_waiting_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool popped;
+        while (!(popped = try_pop(entry, true))) {
+            if (interrupted_.exchange(false, std::memory_order_acq_rel)) {
+                break;
+            }
+            pthread_cond_wait(&not_empty_, &wait_mutex_);
+        }
+        consumer_waiting_.store(false, std::memory_order_relaxed);
+        pthread_mutex_unlock(&wait_mutex_);
+
+        if (popped) {
+            wake_producers();
+            return removed(entry);
+        }
+        return T();
+    }
+
+    /** Return the size of the queue.
+     *
+     * \return the number of items in the queue, including any on the overflow list.
+     */
+    virtual int size()
+    {
+        size_t tail = tail_.load(std::memory_order_acquire);
+        size_t head = head_.load(std::memory_order_acquire);
+        return static_cast<int>(tail - head) + static_cast<int>(overflow_size_.load(std::memory_order_acquire));
+    }
+
+    /** Return the performance metrics of the queue.
+     *
+     * \return a copy of the queue performance metrics.
+     */
+    virtual WorkQueueStats get_stats()
+    {
+        pthread_mutex_lock(&wait_mutex_);
+        WorkQueueStats stats = this->m_stats;
+        pthread_mutex_unlock(&wait_mutex_);
+        return stats;
+    }
+
+    /** Reset the performance metrics of the queue.
+     */
+    virtual void reset_stats()
+    {
+        pthread_mutex_lock(&wait_mutex_);
+        this->m_stats.reset();
+        pthread_mutex_unlock(&wait_mutex_);
+    }
+
+    /** Return the maximum number of items in the ring before adding blocks.
+     *
+     * \return the capacity of the ring.
+     */
+    virtual int max_size() const
+    {
+        return static_cast<int>(capacity_);
+    }
+
+    /** Return whether the queue only supports a single producer thread.
+     *
+     * \return true if the queue is in single producer mode.
+     */
+    virtual bool single_producer() const
+    {
+        return !multi_producer_;
+    }
+
+    /** Wake the consumer thread if it is blocked removing an item from the queue.
+     *
+     * The blocked remove call returns an empty item. Unlike the WorkQueue, nothing is added to
+     * the queue, so this may safely be called from a thread other than the producer in single
+     * producer mode.
+     */
+    virtual void interrupt()
+    {
+        interrupted_.store(true, std::memory_order_seq_cst);
+        pthread_mutex_lock(&wait_mutex_);
+        pthread_cond_signal(&not_empty_);
+        pthread_mutex_unlock(&wait_mutex_);
+    }
+
+    /** Return the ring capacity, a power of two, required to hold at least the specified number of items.
+     *
+     * \param[in] depth - number of items.
+     * \return ring capacity.
+     */
+    static size_t capacity_for(int depth)
+    {
+        size_t capacity = 1;
+        while (capacity < static_cast<size_t>(depth)) {
+            capacity <<= 1;
+        }
+        return capacity;
+    }
+
+private:
+    /** Attempt to add an item to the ring, spinning for the configured number of attempts.
+     *
+     * \param[in] item - the item to add.
+     * \param[out] queued - the time the item was added.
+     * \return true if the item was added.
+     */
+    bool try_push_spin(const T& item, struct timespec& queued)
+    {
+        for (int spin = 0; spin < spin_count_; spin++) {
+            if (try_push(item, queued)) {
+                return true;
+            }
+            cpu_relax();
+        }
+        return false;
+    }
+
+    /** Attempt to add an item to the ring without blocking.
+     *
+     * \param[in] item - the item to add.
+     * \param[out] queued - the time the item was added.
+     * \return true if the item was added, false if the ring is full.
+     */
+    bool try_push(const T& item, struct timespec& queued)
+    {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        Slot* slot;
+        if (multi_producer_) {
+            for (;;) {
+                slot = &slots_[pos & mask_];
+                size_t sequence = slot->sequence.load(std::memory_order_acquire);
+                std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+                if (diff == 0) {
+                    if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = tail_.load(std::memory_order_relaxed);
+                }
+            }
+        } else {
+            slot = &slots_[pos & mask_];
+            if (slot->sequence.load(std::memory_order_acquire) != pos) {
+                return false;
+            }
+            tail_.store(pos + 1, std::memory_order_relaxed);
+        }
+        gettime(&queued, true);
+        slot->entry.item = item;
+        slot->entry.queued = queued;
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Attempt to remove an item from the queue without blocking.
+     *
+     * Items are taken from the ring first. The overflow list is only used once the ring is
+     * completely empty, so that items from a given producer are removed in order.
+     *
+     * \param[out] entry - the entry removed.
+     * \param[in] locked - true if the caller already holds the wait mutex.
+     * \return true if an item was removed.
+     */
+    bool try_pop(Entry& entry, bool locked = false)
+    {
+        size_t pos = head_.load(std::memory_order_relaxed);
+        Slot* slot = &slots_[pos & mask_];
+        if (slot->sequence.load(std::memory_order_acquire) == pos + 1) {
+            removed_depth_ = static_cast<int>(tail_.load(std::memory_order_acquire) - pos)
+                             + static_cast<int>(overflow_size_.load(std::memory_order_acquire));
+            entry = slot->entry;
+            slot->entry.item = T();
+            head_.store(pos + 1, std::memory_order_release);
+            slot->sequence.store(pos + capacity_, std::memory_order_release);
+            return true;
+        }
+
+        // A slot may have been claimed but not yet filled by a producer, in which case the ring
+        // is not empty and the overflow list must not be used
+        if (overflow_size_.load(std::memory_order_acquire) == 0 || tail_.load(std::memory_order_acquire) != pos) {
+            return false;
+        }
+
+        bool popped = false;
+        if (!locked) {
+            pthread_mutex_lock(&wait_mutex_);
+        }
+        if (!overflow_.empty()) {
+            removed_depth_ = static_cast<int>(overflow_.size());
+            entry = overflow_.front();
+            overflow_.pop_front();
+            overflow_size_.fetch_sub(1, std::memory_order_release);
+            popped = true;
+        }
+        if (!locked) {
+            pthread_mutex_unlock(&wait_mutex_);
+        }
+        return popped;
+    }
+
+    /** Record the performance metrics for an entry removed from the queue.
+     *
+     * The queue depth is sampled by the consumer before each item is released from the ring,
+     * which captures the maximum depth since items are only added between removals.
+     *
+     * The statistics are updated under the wait mutex, since they are read and reset from other
+     * threads by get_stats() and reset_stats().
+     *
+     * \param[in] entry - the entry removed.
+     * \return the item in the entry.
+     */
+    T removed(const Entry& entry)
+    {
+        struct timespec now;
+        gettime(&now, true);
+        pthread_mutex_lock(&wait_mutex_);
+        this->m_stats.wait_.update(elapsed_us(entry.queued, now));
+        if (removed_depth_ > this->m_stats.high_water_mark_) {
+            this->m_stats.high_water_mark_ = removed_depth_;
+        }
+        pthread_mutex_unlock(&wait_mutex_);
+        return entry.item;
+    }
+
+    /** Signal the consumer if it is blocked waiting for an item. */
+    void wake_consumer()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (consumer_waiting_.load(std::memory_order_relaxed)) {
+            pthread_mutex_lock(&wait_mutex_);
+            pthread_cond_signal(&not_empty_);
+            pthread_mutex_unlock(&wait_mutex_);
+        }
+    }
+
+    /** Signal any producers blocked waiting for a free slot. */
+    void wake_producers()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (producers_waiting_.load(std::memory_order_relaxed) > 0) {
+            pthread_mutex_lock(&wait_mutex_);
+            pthread_cond_broadcast(&not_full_);
+            pthread_mutex_unlock(&wait_mutex_);
+        }
+    }
+
+    /** Hint to the processor that the calling thread is spinning */
+    static void cpu_relax()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+
+    /** Number of slots in the ring, a power of two */
+    const size_t capacity_;
+    /** Mask applied to positions to obtain a slot index */
+    const size_t mask_;
+    /** Ring of slots */
+    std::vector<Slot> slots_;
+    /** Whether more than one thread may add items to the queue */
+    const bool multi_producer_;
+    /** Number of attempts made to add or remove an item before blocking */
+    const int spin_count_;
+    /** Position of the next item to remove, written by the consumer */
+    alignas(64) std::atomic<size_t> head_;
+    /** Depth of the queue when the last item was removed, including that item */
+    int removed_depth_;
+    /** Position of the next item to add, written by the producers */
+    alignas(64) std::atomic<size_t> tail_;
+    /** Number of items on the overflow list */
+    alignas(64) std::atomic<size_t> overflow_size_;
+    /** Whether the consumer is blocked waiting for an item */
+    std::atomic<bool> consumer_waiting_;
+    /** Number of producers blocked waiting for a free slot */
+    std::atomic<int> producers_waiting_;
+    /** Whether the consumer has been interrupted */
+    std::atomic<bool> interrupted_;
+    /** Items added with the maximum limit ignored while the ring was full */
+    std::list<Entry> overflow_;
+    /** Mutex protecting the overflow list and blocking */
+    pthread_mutex_t wait_mutex_;
+    /** Condition for waking up the consumer when an item is added */
+    pthread_cond_t not_empty_;
+    /** Condition for waking up producers when a slot is freed */
+    pthread_cond_t not_full_;
+};
+
+} /* namespace FrameProcessor */
+
+#endif /* TOOLS_FILEWRITER_BOUNDEDWORKQUEUE_H_ */
@@ -20,6 +20,7 @@ using namespace log4cxx;
 #include "ClassLoader.h"
 #include "FrameProcessorDefinitions.h"
 #include "FrameProcessorPlugin.h"
+#include "WorkQueue.h"
 
 namespace FrameProcessor {
 
@@ -46,6 +47,7 @@ public:
     virtual std::vector<std::string> requestCommands();
     void configure_process(OdinData::IpcMessage& config, OdinData::IpcMessage& reply);
     void configure_file(OdinData::IpcMessage& config, OdinData::IpcMessage& reply);
+    void configure_flush(OdinData::IpcMessage& config, OdinData::IpcMessage& reply);
     void configure_dataset(const std::string& dataset_name, OdinData::IpcMessage& config, OdinData::IpcMessage& reply);
     void create_new_dataset(const std::string& dset_name);
     void delete_datasets();
@@ -55,6 +57,9 @@ public:
     void stop_acquisition();
     void start_close_file_timeout();
     void run_close_file_timeout();
+    void configure_write_behind(size_t depth);
+    void wait_for_write_behind();
+    void run_write_behind(boost::shared_ptr<WorkQueue<boost::shared_ptr<Frame>>> queue);
     size_t calc_num_frames(size_t total_frames);
     int get_version_major();
     int get_version_minor();
@@ -85,10 +90,17 @@ public:
     static constexpr char STATUS_LAST_FLUSH[11] = "last_flush";
     static constexpr char STATUS_MAX_FLUSH[10] = "max_flush";
     static constexpr char STATUS_MEAN_FLUSH[11] = "mean_flush";
+    static constexpr char STATUS_FLUSHES[8] = "flushes";
     static constexpr char STATUS_LAST_CLOSE[11] = "last_close";
     static constexpr char STATUS_MAX_CLOSE[10] = "max_close";
     static constexpr char STATUS_MEAN_CLOSE[11] = "mean_close";
 
+    /** Configuration constant for status-write behind related items */
+    static constexpr char STATUS_WRITE_BEHIND[13] = "write_behind";
+    static constexpr char STATUS_QUEUED_FRAMES[14] = "queued_frames";
+    static constexpr char STATUS_QUEUED_BYTES[13] = "queued_bytes";
+    static constexpr char STATUS_MAX_QUEUED_BYTES[17] = "max_queued_bytes";
+
     /** Configuration constant for process related items */
     static const std::string CONFIG_PROCESS;
     /** Configuration constant for number of processes */
@@ -120,6 +132,19 @@ public:
     static const std::string CONFIG_FILE_PATH;
     /** Configuration constant for file extension */
     static const std::string CONFIG_FILE_EXTENSION;
+    /** Configuration constant for creating files ahead of rollover in the background */
+    static const std::string CONFIG_FILE_PRE_CREATE;
+
+    /** Configuration constant for flush related items */
+    static const std::string CONFIG_FLUSH;
+    /** Configuration constant for number of writes to a dataset between flushes */
+    static const std::string CONFIG_FLUSH_FRAMES;
+    /** Configuration constant for period in milliseconds between flushes of a dataset */
+    static const std::string CONFIG_FLUSH_PERIOD;
+    /** Configuration constant for number of writes to a parameter dataset between flushes */
+    static const std::string CONFIG_FLUSH_PARAM_FRAMES;
+    /** Configuration constant for period in milliseconds between flushes of a parameter dataset */
+    static const std::string CONFIG_FLUSH_PARAM_PERIOD;
 
     /** Configuration constant for dataset related items */
     static const std::string CONFIG_DATASET;
@@ -158,6 +183,8 @@ public:
     static const std::string WRITE_ERROR_DURATION;
     static const std::string FLUSH_ERROR_DURATION;
     static const std::string CLOSE_ERROR_DURATION;
+    /** Configuration constant for the depth of the write behind queue (0 writes frames synchronously) */
+    static const std::string CONFIG_WRITE_BEHIND;
 
     static const std::string START_WRITING;
     static const std::string STOP_WRITING;
@@ -171,6 +198,8 @@ private:
     FileWriterPlugin(const FileWriterPlugin& src); // prevent copying one of these
 
     void process_frame(boost::shared_ptr<Frame> frame);
+    void write_frame(boost::shared_ptr<Frame> frame);
+    void stop_write_behind();
     void process_end_of_acquisition();
     bool frame_in_acquisition(boost::shared_ptr<Frame> frame);
 
@@ -224,12 +253,34 @@ private:
     std::string file_postfix_;
     /** The file extension to use */
     std::string file_extension_;
+    /** Create files ahead of rollover and close retired files in the background */
+    bool pre_create_files_;
     /** Name of master frame. When a master frame is received frame numbers increment */
     std::string master_frame_;
     /** HDF5 call warning and error durations */
     HDF5ErrorDefinition_t hdf5_error_definition_;
+    /** When datasets are flushed to disk */
+    HDF5FlushPolicy_t flush_policy_;
     /** HDF5 File IO performance stats */
     HDF5CallDurations_t hdf5_call_durations_;
+    /** Number of frames the write behind queue holds, 0 if frames are written synchronously */
+    size_t write_behind_depth_;
+    /** Queue of frames waiting to be written by the write behind thread */
+    boost::shared_ptr<WorkQueue<boost::shared_ptr<Frame>>> write_behind_queue_;
+    /** The write behind thread */
+    boost::thread write_behind_thread_;
+    /** Mutex protecting the write behind queue and counters */
+    boost::mutex write_behind_mutex_;
+    /** Condition variable notified when the write behind thread has written a frame */
+    boost::condition_variable write_behind_condition_;
+    /** Total number of frames added to the write behind queue */
+    uint64_t write_behind_frames_queued_;
+    /** Total number of frames written by the write behind thread */
+    uint64_t write_behind_frames_written_;
+    /** Number of bytes of frame data waiting to be written */
+    size_t write_behind_queued_bytes_;
+    /** Highest number of bytes of frame data waiting to be written */
+    size_t write_behind_max_queued_bytes_;
 };
 
 } /* namespace FrameProcessor */
@@ -11,6 +11,7 @@
 #include <boost/shared_ptr.hpp>
 #include <log4cxx/logger.h>
 
+#include "BoundedWorkQueue.h"
 #include "ClassLoader.h"
 #include "FrameProcessorPlugin.h"
 #include "IpcChannel.h"
@@ -48,6 +49,7 @@ public:
     void resetStatistics(OdinData::IpcMessage& reply);
     void configurePlugin(OdinData::IpcMessage& config, OdinData::IpcMessage& reply);
     void loadPlugin(const std::string& index, const std::string& name, const std::string& library);
+    void configurePluginQueue(const std::string& index, const std::string& type, int depth, int spin);
     void connectPlugin(const std::string& index, const std::string& connectTo);
     void disconnectPlugin(const std::string& index, const std::string& disconnectFrom);
     void disconnectAllPlugins();
@@ -104,6 +106,18 @@ private:
     static const std::string CONFIG_PLUGIN_LIBRARY;
     /** Configuration constant for setting up a plugin connection **/
     static const std::string CONFIG_PLUGIN_CONNECTION;
+    /** Configuration constant for the type of work queue used by a plugin connection **/
+    static const std::string CONFIG_PLUGIN_QUEUE;
+    /** Configuration constant for the depth of the work queue used by a plugin connection **/
+    static const std::string CONFIG_PLUGIN_QUEUE_DEPTH;
+    /** Configuration constant for the spin count of the work queue used by a plugin connection **/
+    static const std::string CONFIG_PLUGIN_QUEUE_SPIN;
+    /** Work queue type using a mutex protected list **/
+    static const std::string QUEUE_TYPE_LIST;
+    /** Work queue type using a lock-free ring with a single producer **/
+    static const std::string QUEUE_TYPE_SPSC;
+    /** Work queue type using a lock-free ring with multiple producers **/
+    static const std::string QUEUE_TYPE_MPSC;
 
     /** Configuration constant for storing a named configuration object **/
     static const std::string CONFIG_STORE;
@@ -40,6 +40,26 @@ struct HDF5CallDurations_t {
     CallDuration write;
     CallDuration flush;
     CallDuration close;
+    /** Number of dataset flushes **/
+    uint64_t flushes = 0;
+};
+
+/**
+ * When datasets written to are flushed to disk
+ *
+ * - frames: Number of writes to a frame dataset after which it is flushed, 0 to not flush on a number of writes
+ * - period: Time (milliseconds) since a frame dataset was last flushed after which a write flushes it, 0 to not
+ *           flush on a period
+ * - param_frames, param_period: The same for parameter datasets
+ *
+ * With both set to 0 datasets are only flushed when the file is closed. By default frame datasets are
+ * flushed after every write and parameter datasets at most once a second.
+ */
+struct HDF5FlushPolicy_t {
+    size_t frames = 1;
+    size_t period = 0;
+    size_t param_frames = 0;
+    size_t param_period = 1000;
 };
 
 /**
@@ -70,6 +90,20 @@ public:
         /** Extent of the (outermost dimension of the) dataset that has had frames written to, including any gaps
          * i.e. the highest offset that has been written to + 1 */
         size_t actual_dataset_size_;
+        /** Number of writes to the dataset since it was last flushed */
+        size_t unflushed_writes_;
+        /** Time the dataset was last flushed */
+        boost::posix_time::ptime last_flushed_;
+        /** Extent of the outermost dimension of a chunk of the dataset */
+        hsize_t outer_chunk_size_;
+        /** Parameter values waiting to be written to the dataset */
+        std::vector<char> param_buffer_;
+        /** Number of parameter values waiting to be written */
+        hsize_t param_buffer_count_;
+        /** Offset in the dataset of the first parameter value waiting to be written */
+        hsize_t param_buffer_offset_;
+        /** Data type of the parameter values waiting to be written */
+        DataType param_buffer_type_;
     };
 
     HDF5File(const HDF5ErrorDefinition_t& hdf5_error_definition);
@@ -86,6 +120,7 @@ public:
         size_t alignment_value
     );
     size_t close_file();
+    void flush_datasets(HDF5CallDurations_t& call_durations);
     void create_dataset(const DatasetDefinition& definition, int low_index, int high_index);
     void write_frame(
         const Frame& frame,
@@ -93,13 +128,19 @@ public:
         uint64_t outer_chunk_dimension,
         HDF5CallDurations_t& call_durations
     );
-    void write_parameter(const Frame& frame, DatasetDefinition dataset_definition, hsize_t frame_offset);
+    void write_parameter(
+        const Frame& frame,
+        DatasetDefinition dataset_definition,
+        hsize_t frame_offset,
+        HDF5CallDurations_t& call_durations
+    );
     size_t get_dataset_frames(const std::string& dset_name);
     size_t get_dataset_max_size(const std::string& dset_name);
     void start_swmr();
     size_t get_file_index();
     std::string get_filename();
     void set_unlimited();
+    void set_flush_policy(const HDF5FlushPolicy_t& flush_policy);
 
 private:
     /** Filter definition to write datasets with LZ4 compressed data */
@@ -109,12 +150,17 @@ private:
     /** Filter definition to write datasets with Blosc processed data */
     static const H5Z_filter_t BLOSC_FILTER = (H5Z_filter_t)32001;
 
-    /** Flush rate for parameter datasets in miliseconds */
-    static const int PARAM_FLUSH_RATE = 1000;
-
     HDF5Dataset_t& get_hdf5_dataset(const std::string& dset_name);
     void extend_dataset(HDF5File::HDF5Dataset_t& dset, size_t frame_no);
     hid_t datatype_to_hdf_type(DataType data_type) const;
+    void written(
+        HDF5Dataset_t& dset,
+        const std::string& dset_name,
+        bool parameter,
+        HDF5CallDurations_t& call_durations
+    );
+    void flush_dataset(HDF5Dataset_t& dset, HDF5CallDurations_t& call_durations);
+    void write_parameter_buffer(HDF5Dataset_t& dset);
 
     LoggerPtr logger_;
     /** Internal ID of the file being written to */
@@ -135,10 +181,8 @@ private:
     bool unlimited_;
     /** Mutex used to make this class thread safe */
     std::mutex mutex_;
-    /* Parameters memspace */
-    hid_t param_memspace_;
-    /* Map containing time each dataset was last flushed*/
-    std::map<std::string, boost::posix_time::ptime> last_flushed;
+    /** When datasets are flushed to disk */
+    HDF5FlushPolicy_t flush_policy_;
     /* Watchdog timer for monitoring function call durations */
     WatchdogTimer watchdog_timer_;
     /** HDF5 call error definitions */
@@ -18,6 +18,7 @@
 using namespace log4cxx;
 using namespace log4cxx::helpers;
 
+#include "CallDuration.h"
 #include "Frame.h"
 #include "WorkQueue.h"
 
@@ -34,11 +35,13 @@ public:
     IFrameCallback();
     virtual ~IFrameCallback();
     boost::shared_ptr<WorkQueue<boost::shared_ptr<Frame>>> getWorkQueue();
+    void setWorkQueue(boost::shared_ptr<WorkQueue<boost::shared_ptr<Frame>>> queue);
     void start();
     void stop();
     bool isWorking() const;
     void confirmRegistration(const std::string& name);
     void confirmRemoval(const std::string& name);
+    size_t registrationCount() const;
 
     /** Callback for when ever a new Frame is available.
      *
@@ -49,6 +52,10 @@ public:
      */
     virtual void callback(boost::shared_ptr<Frame> frame) = 0;
 
+protected:
+    /** Time the worker thread spends idle waiting for a Frame **/
+    CallDuration idle_duration_;
+
 private:
     /** Pointer to logger */
     LoggerPtr logger_;
@@ -3,7 +3,9 @@
 
 #include "Frame.h"
 
+#include "FrameNotifyBatch.h"
 #include "IpcChannel.h"
+#include "SharedBufferNotifier.h"
 #include <stdint.h>
 
 namespace FrameProcessor {
@@ -11,14 +13,17 @@ namespace FrameProcessor {
 class SharedBufferFrame : public Frame {
 
 public:
-    /** Construct a SharedBufferFrame */
+    /** Construct a SharedBufferFrame mapping nbytes of a shared buffer, which for variable-length
+     * frames may span several blocks starting at the buffer */
     SharedBufferFrame(
         const FrameMetaData& meta_data,
         void* data_src,
         size_t nbytes,
         uint64_t bufferID,
         OdinData::IpcChannel* relCh,
-        const int& image_offset = 0
+        const int& image_offset = 0,
+        OdinData::SharedBufferNotifierPtr notifier = OdinData::SharedBufferNotifierPtr(),
+        OdinData::FrameNotifyBatchPtr release_batch = OdinData::FrameNotifyBatchPtr()
     );
 
     /** Shallow-copy copy */
@@ -39,6 +44,12 @@ private:
 
     /** ZMQ release channel for the shared buffer **/
     OdinData::IpcChannel* shared_channel_;
+
+    /** Shared memory ring notifier for the release of the shared buffer, if enabled **/
+    OdinData::SharedBufferNotifierPtr notifier_;
+
+    /** Batch of frame release notifications sent on the release channel, if batching is enabled **/
+    OdinData::FrameNotifyBatchPtr release_batch_;
 };
 
 }
@@ -17,11 +17,13 @@ using namespace log4cxx::helpers;
 
 #include "boost/date_time/posix_time/posix_time.hpp"
 
+#include "FrameNotifyBatch.h"
 #include "IFrameCallback.h"
 #include "IpcChannel.h"
 #include "IpcMessage.h"
 #include "IpcReactor.h"
 #include "SharedBufferManager.h"
+#include "SharedBufferNotifier.h"
 
 namespace FrameProcessor {
 
@@ -43,19 +45,31 @@ public:
         const std::string& txEndPoint
     );
     virtual ~SharedMemoryController();
-    void setSharedBufferManager(const std::string& shared_buffer_name);
+    void setSharedBufferManager(
+        const std::string& shared_buffer_name,
+        const bool notify_ring = false,
+        const OdinData::SharedBufferManager::MappingOptions& options = OdinData::SharedBufferManager::MappingOptions()
+    );
     void requestSharedBufferConfig(const bool deferred = false);
     void registerCallback(const std::string& name, boost::shared_ptr<IFrameCallback> cb);
     void removeCallback(const std::string& name);
     void handleRxChannel();
+    void handleReadyRing();
     void status(OdinData::IpcMessage& status);
     void injectEOA();
 
 private:
+    void dispatchFrame(int bufferID, int frame_number);
+    void removeNotifier();
+    void configureReleaseBatch(unsigned int max_frames, unsigned int max_latency_ms);
+    void flushReleaseBatch();
+
     /** Pointer to logger */
     LoggerPtr logger_;
     /** Pointer to SharedBufferManager object */
     boost::shared_ptr<OdinData::SharedBufferManager> sbm_;
+    /** Pointer to SharedBufferNotifier object, if frame notification is through shared memory rings */
+    OdinData::SharedBufferNotifierPtr notifier_;
     /** Map of IFrameCallback pointers, indexed by name */
     std::map<std::string, boost::shared_ptr<IFrameCallback>> callbacks_;
     /** IpcReactor pointer, for managing IpcMessage objects */
@@ -64,6 +78,10 @@ private:
     OdinData::IpcChannel rxChannel_;
     /** IpcChannel for sending notifications of frame release */
     OdinData::IpcChannel txChannel_;
+    /** Batch of frame release notifications, shared with the frames released through it */
+    OdinData::FrameNotifyBatchPtr releaseBatch_;
+    /** ID of the reactor timer flushing the frame release batch, -1 if not registered */
+    int releaseBatchTimerId_;
     /** Shared buffer configured status flag */
     bool sharedBufferConfigured_;
     /** Shared buffer config request deferred flag */
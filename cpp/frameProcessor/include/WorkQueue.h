@@ -10,12 +10,44 @@
 
 #include <cstddef>
 #include <list>
+#include <pthread.h>
+
+#include "CallDuration.h"
+#include "gettime.h"
 
 namespace FrameProcessor {
 
 /** Maximum queue size - to prevent unlimited use of memory **/
 const int max_queue_size = 8;
 
+/**
+ * A simple store for work queue performance metrics.
+ *
+ * Durations in microseconds.
+ */
+class WorkQueueStats {
+public:
+    WorkQueueStats() :
+        high_water_mark_(0)
+    {
+    }
+
+    /** Reset all values to 0 */
+    void reset()
+    {
+        wait_.reset();
+        blocked_.reset();
+        high_water_mark_ = 0;
+    }
+
+    /** Time items spend in the queue before being removed **/
+    CallDuration wait_;
+    /** Time producers spend blocked adding items to a full queue **/
+    CallDuration blocked_;
+    /** Maximum number of items in the queue **/
+    int high_water_mark_;
+};
+
 /** Thread safe producer consumer work queue.
  *
  * This is a thread safe producer consumer queue for use across multiple threads
@@ -23,21 +55,42 @@ const int max_queue_size = 8;
  * arrival of new items. This WorkQueue is used for transfer of Frame objects
  * between plugins. Note that the queue is used for transferring pointers to the
  * Frame objects, and not the Frame objects themselves.
+ *
+ * The methods are virtual so that alternative queue implementations, such as the
+ * BoundedWorkQueue, can be substituted for individual plugins.
  */
 template <typename T> class WorkQueue {
+protected:
+    /** Worker item queued for processing, with the time it was added to the queue */
+    struct Entry {
+        /** Worker item */
+        T item;
+        /** Time the item was added to the queue */
+        struct timespec queued;
+    };
+
+    /** Performance metrics of the queue */
+    WorkQueueStats m_stats;
+
+private:
     /** Queue (list) of worker items queued for processing */
-    std::list<T> m_queue;
+    std::list<Entry> m_queue;
     /** Mutex for locking the queue */
     pthread_mutex_t m_mutex;
     /** Condition for waking up blocked threads when a new item is added to the queue */
     pthread_cond_t m_condv;
+    /** Maximum number of items in the queue before adding blocks */
+    size_t m_max_size;
 
 public:
     /** Constructor.
      *
      * The constructor initialises the mutex and condition required for the class.
+     *
+     * \param[in] max_size - maximum number of items in the queue before adding blocks, at least one.
      */
-    WorkQueue()
+    WorkQueue(int max_size = max_queue_size) :
+        m_max_size(max_size > 0 ? static_cast<size_t>(max_size) : 1)
     {
         pthread_mutex_init(&m_mutex, NULL);
         pthread_cond_init(&m_condv, NULL);
@@ -60,15 +113,31 @@ public:
      *
      * \param[in] item - the item to add to the queue.
      */
-    void add(T item, bool ignore_max_limit = false)
+    virtual void add(T item, bool ignore_max_limit = false)
     {
+        struct timespec blocked_start;
+        bool blocked = false;
+
         pthread_mutex_lock(&m_mutex);
         if (!ignore_max_limit) {
-            while (m_queue.size() >= max_queue_size) {
+            while (m_queue.size() >= m_max_size) {
+                if (!blocked) {
+                    gettime(&blocked_start, true);
+                    blocked = true;
+                }
                 pthread_cond_wait(&m_condv, &m_mutex);
             }
         }
-        m_queue.push_back(item);
+        Entry entry;
+        entry.item = item;
+        gettime(&entry.queued, true);
+        if (blocked) {
+            m_stats.blocked_.update(elapsed_us(blocked_start, entry.queued));
+        }
+        m_queue.push_back(entry);
+        if (static_cast<int>(m_queue.size()) > m_stats.high_water_mark_) {
+            m_stats.high_water_mark_ = m_queue.size();
+        }
         pthread_cond_signal(&m_condv);
         pthread_mutex_unlock(&m_mutex);
     }
@@ -81,30 +150,82 @@ public:
      *
      * \return the first item in the queue.
      */
-    T remove()
+    virtual T remove()
     {
         pthread_mutex_lock(&m_mutex);
         while (m_queue.size() == 0) {
             pthread_cond_wait(&m_condv, &m_mutex);
         }
-        T item = m_queue.front();
+        Entry entry = m_queue.front();
         m_queue.pop_front();
+        struct timespec now;
+        gettime(&now, true);
+        m_stats.wait_.update(elapsed_us(entry.queued, now));
         pthread_cond_signal(&m_condv);
         pthread_mutex_unlock(&m_mutex);
-        return item;
+        return entry.item;
     }
 
     /** Return the size of the queue.
      *
      * \return the size of the queue.
      */
-    int size()
+    virtual int size()
     {
         pthread_mutex_lock(&m_mutex);
         int size = m_queue.size();
         pthread_mutex_unlock(&m_mutex);
         return size;
     }
+
+    /** Return the performance metrics of the queue.
+     *
+     * \return a copy of the queue performance metrics.
+     */
+    virtual WorkQueueStats get_stats()
+    {
+        pthread_mutex_lock(&m_mutex);
+        WorkQueueStats stats = m_stats;
+        pthread_mutex_unlock(&m_mutex);
+        return stats;
+    }
+
+    /** Reset the performance metrics of the queue.
+     */
+    virtual void reset_stats()
+    {
+        pthread_mutex_lock(&m_mutex);
+        m_stats.reset();
+        pthread_mutex_unlock(&m_mutex);
+    }
+
+    /** Return the maximum number of items in the queue before adding blocks.
+     *
+     * \return the maximum size of the queue.
+     */
+    virtual int max_size() const
+    {
+        return static_cast<int>(m_max_size);
+    }
+
+    /** Return whether the queue only supports a single producer thread.
+     *
+     * \return false, as any number of threads may add items to this queue.
+     */
+    virtual bool single_producer() const
+    {
+        return false;
+    }
+
+    /** Wake a thread blocked removing an item from the queue.
+     *
+     * A default constructed (empty) item is added to the queue, which is returned to
+     * the consumer once any items already in the queue have been removed.
+     */
+    virtual void interrupt()
+    {
+        this->add(T());
+    }
 };
 
 } /* namespace FrameProcessor */
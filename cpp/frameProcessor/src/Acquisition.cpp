@@ -12,6 +12,7 @@
 #include "DebugLevelLogger.h"
 #include "Frame.h"
 #include "Json.h"
+#include "logging.h"
 
 namespace FrameProcessor {
 
@@ -52,7 +53,13 @@ Acquisition::Acquisition(const HDF5ErrorDefinition_t& hdf5_error_definition) :
     alignment_value_(1),
     last_error_(""),
     file_postfix_(""),
-    hdf5_error_definition_(hdf5_error_definition)
+    hdf5_error_definition_(hdf5_error_definition),
+    pre_create_files_(false),
+    file_thread_running_(false),
+    prepare_requested_(false),
+    preparing_(false),
+    prepare_file_number_(0),
+    prepared_create_duration_(0)
 {
     this->logger_ = Logger::getLogger("FP.Acquisition");
     LOG4CXX_TRACE(logger_, "Acquisition constructor.");
@@ -61,6 +68,8 @@ Acquisition::Acquisition(const HDF5ErrorDefinition_t& hdf5_error_definition) :
 
 Acquisition::~Acquisition()
 {
+    HDF5CallDurations_t call_durations;
+    stop_file_thread(call_durations);
 }
 
 /**
@@ -132,7 +141,7 @@ ProcessFrameStatus Acquisition::process_frame(boost::shared_ptr<Frame> frame, HD
                 std::map<std::string, DatasetDefinition>::iterator dset_iter;
                 dset_iter = dataset_defs_.find(param_iter->first);
                 if (dset_iter != dataset_defs_.end()) {
-                    file->write_parameter(*frame, dset_iter->second, frame_offset_in_file);
+                    file->write_parameter(*frame, dset_iter->second, frame_offset_in_file, call_durations);
                 }
             }
 
@@ -204,40 +213,66 @@ ProcessFrameStatus Acquisition::process_frame(boost::shared_ptr<Frame> frame, HD
 /**
  * Creates a file
  *
- * This method creates a new HDF5File object with the given file_number.
- * The file will be created, the datasets populated within the file, and a meta message sent
+ * This method makes a new HDF5File object with the given file_number the current file, retiring
+ * the file before the previous one. If the file thread has already created the file it is used,
+ * otherwise the file will be created and the datasets populated within the file. A meta message
+ * is then sent, and if pre-creating files the file thread is asked to create the following file.
  *
  * \param[in] file_number - The file_number to create a file for
  */
 void Acquisition::create_file(size_t file_number, HDF5CallDurations_t& call_durations)
 {
     // Set previous file to current file, closing off the file for the previous file first
-    close_file(previous_file_, call_durations);
+    retire_file(previous_file_, call_durations);
     previous_file_ = current_file_;
 
-    current_file_ = boost::shared_ptr<HDF5File>(new HDF5File(hdf5_error_definition_));
-
-    // Create the file
-    boost::filesystem::path full_path = boost::filesystem::path(file_path_) / boost::filesystem::path(filename_);
-    size_t create_duration = current_file_->create_file(
-        full_path.string(), file_number, use_earliest_hdf5_, alignment_threshold_, alignment_value_
-    );
+    size_t create_duration = 0;
+    current_file_ = take_prepared_file(file_number, create_duration);
+    if (!current_file_) {
+        current_file_ = boost::shared_ptr<HDF5File>(new HDF5File(hdf5_error_definition_));
+        create_duration = open_file(current_file_, file_number);
+    }
     call_durations.create.update(create_duration);
 
     // Send meta data message to notify of file creation
     OdinData::JsonDict json;
-    json.add(META_FILE_PATH_KEY, full_path.string());
+    json.add(META_FILE_PATH_KEY, current_file_->get_filename());
     json.add(META_CREATE_DURATION_KEY, create_duration);
     publish_meta(META_NAME, META_CREATE_ITEM, json.str(), get_create_meta_header());
 
+    if (pre_create_files_) {
+        prepare_file(file_number + concurrent_processes_);
+    }
+}
+
+/**
+ * Opens a file
+ *
+ * This method creates the file for the given file_number and populates the datasets within it,
+ * ready for frames to be written.
+ *
+ * \param[in] file - The HDF5File to create the file with
+ * \param[in] file_number - The file_number to create a file for
+ * \return - The duration of the H5Fcreate call
+ */
+size_t Acquisition::open_file(boost::shared_ptr<HDF5File> file, size_t file_number) const
+{
+    // Create the file
+    boost::filesystem::path full_path
+        = boost::filesystem::path(file_path_) / boost::filesystem::path(generate_filename(file_number));
+    size_t create_duration = file->create_file(
+        full_path.string(), file_number, use_earliest_hdf5_, alignment_threshold_, alignment_value_
+    );
+
     if (total_frames_ == 0) {
         // Running in continuous mode, so we could receive any number of frames
         // Make the HDF5 datasets unlimited
-        current_file_->set_unlimited();
+        file->set_unlimited();
     }
+    file->set_flush_policy(flush_policy_);
 
     // Create the datasets from the definitions
-    std::map<std::string, DatasetDefinition>::iterator iter;
+    std::map<std::string, DatasetDefinition>::const_iterator iter;
     for (iter = dataset_defs_.begin(); iter != dataset_defs_.end(); ++iter) {
         DatasetDefinition dset_def = iter->second;
 
@@ -270,10 +305,209 @@ void Acquisition::create_file(size_t file_number, HDF5CallDurations_t& call_dura
             dset_def.num_frames = frames_to_write_;
         }
         validate_dataset_definition(dset_def);
-        current_file_->create_dataset(dset_def, low_index, high_index);
+        file->create_dataset(dset_def, low_index, high_index);
     }
 
-    current_file_->start_swmr();
+    file->start_swmr();
+
+    return create_duration;
+}
+
+/**
+ * Retires a file that frames are no longer written to
+ *
+ * If pre-creating files the file is handed to the file thread to be closed, otherwise it is
+ * closed immediately.
+ *
+ * \param[in] file - The HDF5File to retire
+ */
+void Acquisition::retire_file(boost::shared_ptr<HDF5File> file, HDF5CallDurations_t& call_durations)
+{
+    if (file == 0) {
+        return;
+    }
+    if (pre_create_files_) {
+        {
+            boost::mutex::scoped_lock lock(file_thread_mutex_);
+            files_to_close_.push_back(file);
+        }
+        file_thread_condition_.notify_all();
+        record_file_thread_events(call_durations);
+    } else {
+        close_file(file, call_durations);
+    }
+}
+
+/**
+ * Asks the file thread to create the file for the given file_number
+ *
+ * No file is created if the acquisition has a known number of frames that will all be written
+ * to files before it.
+ *
+ * \param[in] file_number - The file_number to create a file for
+ */
+void Acquisition::prepare_file(size_t file_number)
+{
+    if (blocks_per_file_ == 0) {
+        return;
+    }
+    size_t frames_before_file = (file_number / concurrent_processes_) * frames_per_block_ * blocks_per_file_;
+    if (frames_to_write_ > 0 && frames_before_file >= frames_to_write_) {
+        return;
+    }
+    {
+        boost::mutex::scoped_lock lock(file_thread_mutex_);
+        prepare_file_number_ = file_number;
+        prepare_requested_ = true;
+    }
+    file_thread_condition_.notify_all();
+}
+
+/**
+ * Takes the file created by the file thread if it is for the given file_number
+ *
+ * Waits for the file thread if it is still creating the file.
+ *
+ * \param[in] file_number - The file_number of the file required
+ * \param[out] create_duration - The duration of the H5Fcreate call for the file
+ * \return - The file, or an empty pointer if the file thread has not created it
+ */
+boost::shared_ptr<HDF5File> Acquisition::take_prepared_file(size_t file_number, size_t& create_duration)
+{
+    boost::shared_ptr<HDF5File> file;
+    if (!pre_create_files_) {
+        return file;
+    }
+    boost::mutex::scoped_lock lock(file_thread_mutex_);
+    while ((prepare_requested_ || preparing_) && prepare_file_number_ == file_number) {
+        file_thread_condition_.wait(lock);
+    }
+    if (prepared_file_ && prepared_file_->get_file_index() == file_number) {
+        file.swap(prepared_file_);
+        create_duration = prepared_create_duration_;
+        LOG4CXX_DEBUG_LEVEL(1, logger_, "Using pre-created file " << file->get_filename());
+    }
+    return file;
+}
+
+/**
+ * Records the files closed by the file thread
+ *
+ * The close durations are recorded and a meta message sent for each file.
+ */
+void Acquisition::record_file_thread_events(HDF5CallDurations_t& call_durations)
+{
+    std::vector<std::pair<std::string, size_t>> files_closed;
+    {
+        boost::mutex::scoped_lock lock(file_thread_mutex_);
+        files_closed.swap(files_closed_);
+    }
+    std::vector<std::pair<std::string, size_t>>::iterator iter;
+    for (iter = files_closed.begin(); iter != files_closed.end(); ++iter) {
+        call_durations.close.update(iter->second);
+        OdinData::JsonDict json;
+        json.add(META_FILE_PATH_KEY, iter->first);
+        json.add(META_CLOSE_DURATION_KEY, iter->second);
+        publish_meta(META_NAME, META_CLOSE_ITEM, json.str(), get_meta_header());
+    }
+}
+
+/**
+ * Stops the file thread once it has closed any retired files
+ *
+ * A file created ahead of a rollover that did not happen is closed and removed.
+ */
+void Acquisition::stop_file_thread(HDF5CallDurations_t& call_durations)
+{
+    if (!file_thread_.joinable()) {
+        return;
+    }
+    {
+        boost::mutex::scoped_lock lock(file_thread_mutex_);
+        file_thread_running_ = false;
+        prepare_requested_ = false;
+    }
+    file_thread_condition_.notify_all();
+    file_thread_.join();
+    record_file_thread_events(call_durations);
+
+    discard_file(prepared_file_);
+    prepared_file_.reset();
+}
+
+/**
+ * Closes and removes a file created by the file thread that was never used
+ *
+ * \param[in] file - The HDF5File to discard
+ */
+void Acquisition::discard_file(boost::shared_ptr<HDF5File> file) const
+{
+    if (file == 0) {
+        return;
+    }
+    std::string filename = file->get_filename();
+    LOG4CXX_INFO(logger_, "Removing unused pre-created file " << filename);
+    try {
+        file->close_file();
+        boost::filesystem::remove(filename);
+    } catch (const std::exception& e) {
+        LOG4CXX_ERROR(logger_, "Failed to remove unused pre-created file " << filename << ": " << e.what());
+    }
+}
+
+/**
+ * Function that is run by the file thread
+ *
+ * Creates the file requested by prepare_file ahead of it being needed, and closes the files
+ * handed over by retire_file, so that neither happens in the frame path. Creating the next file
+ * takes priority over closing retired files. The HDF5 library serialises the calls made from
+ * this thread with those made by the frame path.
+ */
+void Acquisition::run_file_thread()
+{
+    OdinData::configure_logging_mdc(OdinData::app_path.c_str());
+    boost::mutex::scoped_lock lock(file_thread_mutex_);
+    while (file_thread_running_ || !files_to_close_.empty()) {
+        if (prepare_requested_) {
+            size_t file_number = prepare_file_number_;
+            prepare_requested_ = false;
+            preparing_ = true;
+            boost::shared_ptr<HDF5File> unused_file;
+            unused_file.swap(prepared_file_);
+            lock.unlock();
+            discard_file(unused_file);
+            boost::shared_ptr<HDF5File> file(new HDF5File(hdf5_error_definition_));
+            size_t create_duration = 0;
+            try {
+                create_duration = open_file(file, file_number);
+            } catch (const std::exception& e) {
+                LOG4CXX_ERROR(logger_, "Failed to pre-create file " << file_number << ": " << e.what());
+                file.reset();
+            }
+            lock.lock();
+            prepared_file_ = file;
+            prepared_create_duration_ = create_duration;
+            preparing_ = false;
+            file_thread_condition_.notify_all();
+        } else if (!files_to_close_.empty()) {
+            boost::shared_ptr<HDF5File> file = files_to_close_.front();
+            files_to_close_.pop_front();
+            lock.unlock();
+            std::string filename = file->get_filename();
+            LOG4CXX_INFO(logger_, "Closing file " << filename);
+            size_t close_duration = 0;
+            try {
+                close_duration = file->close_file();
+            } catch (const std::exception& e) {
+                LOG4CXX_ERROR(logger_, "Failed to close file " << filename << ": " << e.what());
+            }
+            file.reset();
+            lock.lock();
+            files_closed_.push_back(std::make_pair(filename, close_duration));
+        } else {
+            file_thread_condition_.wait(lock);
+        }
+    }
 }
 
 /**
@@ -288,6 +522,7 @@ void Acquisition::close_file(boost::shared_ptr<HDF5File> file, HDF5CallDurations
 {
     if (file != 0) {
         LOG4CXX_INFO(logger_, "Closing file " << file->get_filename());
+        file->flush_datasets(call_durations);
         size_t close_duration = file->close_file();
         call_durations.close.update(close_duration);
 
@@ -306,7 +541,7 @@ void Acquisition::close_file(boost::shared_ptr<HDF5File> file, HDF5CallDurations
  *
  * \param[in] definition - The DatasetDefinition to validate
  */
-void Acquisition::validate_dataset_definition(DatasetDefinition definition)
+void Acquisition::validate_dataset_definition(DatasetDefinition definition) const
 {
     // Check image dimensions
     std::vector<long long unsigned int>::iterator iter;
@@ -338,6 +573,8 @@ void Acquisition::validate_dataset_definition(DatasetDefinition definition)
  * \param[in] alignment_threshold - Alignment threshold for hdf5 chunking
  * \param[in] alignment_value - Alignment value for hdf5 chunking
  * \param[in] master_frame - The master frame dataset name
+ * \param[in] flush_policy - When datasets are flushed to disk
+ * \param[in] pre_create_files - Whether to create files ahead of rollover in a background thread
  * \return - true if the acquisition was started successfully
  */
 bool Acquisition::start_acquisition(
@@ -353,6 +590,8 @@ bool Acquisition::start_acquisition(
     size_t alignment_threshold,
     size_t alignment_value,
     std::string master_frame,
+    HDF5FlushPolicy_t flush_policy,
+    bool pre_create_files,
     HDF5CallDurations_t& call_durations
 )
 {
@@ -369,6 +608,8 @@ bool Acquisition::start_acquisition(
     file_postfix_ = file_postfix;
     file_extension_ = file_extension;
     master_frame_ = master_frame;
+    flush_policy_ = flush_policy;
+    pre_create_files_ = pre_create_files;
 
     // Sanitise the file extension, ensuring there is a . at the start if the extension is not empty
     if (!file_extension_.empty()) {
@@ -388,6 +629,11 @@ bool Acquisition::start_acquisition(
 
     publish_meta(META_NAME, META_START_ITEM, "", get_create_meta_header());
 
+    if (pre_create_files_) {
+        file_thread_running_ = true;
+        file_thread_ = boost::thread(boost::bind(&Acquisition::run_file_thread, this));
+    }
+
     create_file(concurrent_rank_, call_durations);
 
     return true;
@@ -398,6 +644,7 @@ bool Acquisition::start_acquisition(
  */
 void Acquisition::stop_acquisition(HDF5CallDurations_t& call_durations)
 {
+    stop_file_thread(call_durations);
     close_file(previous_file_, call_durations);
     close_file(current_file_, call_durations);
     publish_meta(META_NAME, META_STOP_ITEM, "", get_meta_header());
@@ -546,6 +793,10 @@ boost::shared_ptr<HDF5File> Acquisition::get_file(size_t frame_offset, HDF5CallD
         return this->current_file_;
     }
 
+    if (pre_create_files_) {
+        record_file_thread_events(call_durations);
+    }
+
     // Get the file index this frame should go into
     size_t file_index = get_file_index(frame_offset);
 
@@ -658,7 +909,7 @@ std::string Acquisition::get_meta_header()
  * \param[in] file_number - The file number to generate the filename for
  * \return - The name of the file including extension
  */
-std::string Acquisition::generate_filename(size_t file_number)
+std::string Acquisition::generate_filename(size_t file_number) const
 {
 
     std::stringstream generated_filename;
@@ -6,6 +6,7 @@
  */
 
 #include "DummyUDPProcessPlugin.h"
+#include "PacketBitmap.h"
 #include "version.h"
 
 namespace FrameProcessor {
@@ -287,18 +288,20 @@ void DummyUDPProcessPlugin::process_lost_packets(boost::shared_ptr<Frame>& frame
             logger_, "Processing " << hdr_packets_lost << " lost packets for frame " << hdr_ptr->frame_number
         );
 
-        int packets_lost = 0;
         char* payload_ptr = static_cast<char*>(frame->get_data_ptr()) + sizeof(DummyUDP::FrameHeader);
 
-        // Loop over all packets in frame
-        for (int packet_idx = 0; packet_idx < hdr_ptr->total_packets_expected; packet_idx++) {
-            // If header reports packet missing, zero out the packet
-            if (hdr_ptr->packet_state[packet_idx] == 0) {
-                LOG4CXX_DEBUG(logger_, "Missing packet number " << packet_idx);
-                char* packet_ptr = payload_ptr + (hdr_ptr->packet_size * packet_idx);
-                memset(packet_ptr, 0, hdr_ptr->packet_size);
-                packets_lost++;
-            }
+        // Enumerate the packets reported missing in the packet state bitmap and zero them out
+        std::vector<size_t> missing_packets;
+        OdinData::PacketBitmap packet_state(
+            const_cast<uint64_t*>(hdr_ptr->packet_state), hdr_ptr->total_packets_expected
+        );
+        int packets_lost = static_cast<int>(packet_state.missing(missing_packets));
+
+        for (std::vector<size_t>::iterator packet_iter = missing_packets.begin(); packet_iter != missing_packets.end();
+             ++packet_iter) {
+            LOG4CXX_DEBUG(logger_, "Missing packet number " << *packet_iter);
+            char* packet_ptr = payload_ptr + (hdr_ptr->packet_size * (*packet_iter));
+            memset(packet_ptr, 0, hdr_ptr->packet_size);
         }
         // Check if there's a mismatch between packets reported lost by the header and found
         // by scanning the packet state information.
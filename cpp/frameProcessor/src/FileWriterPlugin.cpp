@@ -38,6 +38,13 @@ const std::string FileWriterPlugin::CONFIG_FILE_NUMBER_START = "first_number";
 const std::string FileWriterPlugin::CONFIG_FILE_POSTFIX = "postfix";
 const std::string FileWriterPlugin::CONFIG_FILE_PATH = "path";
 const std::string FileWriterPlugin::CONFIG_FILE_EXTENSION = "extension";
+const std::string FileWriterPlugin::CONFIG_FILE_PRE_CREATE = "pre_create";
+
+const std::string FileWriterPlugin::CONFIG_FLUSH = "flush";
+const std::string FileWriterPlugin::CONFIG_FLUSH_FRAMES = "frames";
+const std::string FileWriterPlugin::CONFIG_FLUSH_PERIOD = "period";
+const std::string FileWriterPlugin::CONFIG_FLUSH_PARAM_FRAMES = "param_frames";
+const std::string FileWriterPlugin::CONFIG_FLUSH_PARAM_PERIOD = "param_period";
 
 const std::string FileWriterPlugin::CONFIG_DATASET = "dataset";
 const std::string FileWriterPlugin::CONFIG_DATASET_TYPE = "datatype";
@@ -62,6 +69,7 @@ const std::string FileWriterPlugin::CREATE_ERROR_DURATION = "create_error_durati
 const std::string FileWriterPlugin::WRITE_ERROR_DURATION = "write_error_duration";
 const std::string FileWriterPlugin::FLUSH_ERROR_DURATION = "flush_error_duration";
 const std::string FileWriterPlugin::CLOSE_ERROR_DURATION = "close_error_duration";
+const std::string FileWriterPlugin::CONFIG_WRITE_BEHIND = "write_behind";
 
 const std::string FileWriterPlugin::START_WRITING = "start_writing";
 const std::string FileWriterPlugin::STOP_WRITING = "stop_writing";
@@ -84,12 +92,18 @@ FileWriterPlugin::FileWriterPlugin() :
     use_file_numbering_(true),
     file_postfix_(""),
     file_extension_("h5"),
+    pre_create_files_(false),
     use_earliest_hdf5_(false),
     alignment_threshold_(1),
     alignment_value_(1),
     timeout_period_(0),
     timeout_thread_running_(true),
-    timeout_thread_(boost::bind(&FileWriterPlugin::run_close_file_timeout, this))
+    timeout_thread_(boost::bind(&FileWriterPlugin::run_close_file_timeout, this)),
+    write_behind_depth_(0),
+    write_behind_frames_queued_(0),
+    write_behind_frames_written_(0),
+    write_behind_queued_bytes_(0),
+    write_behind_max_queued_bytes_(0)
 {
     std::string prefix = FileWriterPlugin::CONFIG_PROCESS + '/';
     add_config_param_metadata(
@@ -123,6 +137,7 @@ FileWriterPlugin::FileWriterPlugin() :
     add_config_param_metadata(prefix + FileWriterPlugin::CONFIG_FILE_POSTFIX, PMDD::STRING_T, PMDA::READ_WRITE);
     add_config_param_metadata(prefix + FileWriterPlugin::CONFIG_FILE_PATH, PMDD::STRING_T, PMDA::READ_ONLY);
     add_config_param_metadata(prefix + FileWriterPlugin::CONFIG_FILE_EXTENSION, PMDD::STRING_T, PMDA::READ_WRITE);
+    add_config_param_metadata(prefix + FileWriterPlugin::CONFIG_FILE_PRE_CREATE, PMDD::BOOL_T, PMDA::READ_WRITE);
     add_config_param_metadata(
         prefix + FileWriterPlugin::CREATE_ERROR_DURATION, PMDD::UINT_T, PMDA::READ_WRITE, 0, PMD::MAX_UNSET
     );
@@ -136,6 +151,20 @@ FileWriterPlugin::FileWriterPlugin() :
         prefix + FileWriterPlugin::CLOSE_ERROR_DURATION, PMDD::UINT_T, PMDA::READ_WRITE, 0, PMD::MAX_UNSET
     );
 
+    (prefix = FileWriterPlugin::CONFIG_FLUSH).append("/");
+    add_config_param_metadata(
+        prefix + FileWriterPlugin::CONFIG_FLUSH_FRAMES, PMDD::UINT_T, PMDA::READ_WRITE, 0, PMD::MAX_UNSET
+    );
+    add_config_param_metadata(
+        prefix + FileWriterPlugin::CONFIG_FLUSH_PERIOD, PMDD::UINT_T, PMDA::READ_WRITE, 0, PMD::MAX_UNSET
+    );
+    add_config_param_metadata(
+        prefix + FileWriterPlugin::CONFIG_FLUSH_PARAM_FRAMES, PMDD::UINT_T, PMDA::READ_WRITE, 0, PMD::MAX_UNSET
+    );
+    add_config_param_metadata(
+        prefix + FileWriterPlugin::CONFIG_FLUSH_PARAM_PERIOD, PMDD::UINT_T, PMDA::READ_WRITE, 0, PMD::MAX_UNSET
+    );
+
     add_config_param_metadata(FileWriterPlugin::CONFIG_FRAMES, PMDD::UINT_T, PMDA::READ_WRITE, 0, PMD::MAX_UNSET);
     add_config_param_metadata(FileWriterPlugin::CONFIG_MASTER_DATASET, PMDD::STRING_T, PMDA::READ_WRITE);
     add_config_param_metadata(FileWriterPlugin::ACQUISITION_ID, PMDD::STRING_T, PMDA::READ_WRITE);
@@ -143,6 +172,7 @@ FileWriterPlugin::FileWriterPlugin() :
         FileWriterPlugin::CLOSE_TIMEOUT_PERIOD, PMDD::UINT_T, PMDA::READ_WRITE, 0, PMD::MAX_UNSET
     );
     add_config_param_metadata(FileWriterPlugin::START_CLOSE_TIMEOUT, PMDD::BOOL_T, PMDA::READ_WRITE);
+    add_config_param_metadata(FileWriterPlugin::CONFIG_WRITE_BEHIND, PMDD::UINT_T, PMDA::READ_WRITE, 0, PMD::MAX_UNSET);
 
     add_status_param_metadata(STATUS_WRITING, PMDD::BOOL_T, PMDA::READ_ONLY);
     add_status_param_metadata(STATUS_FRAMES_MAX, PMDD::UINT_T, PMDA::READ_ONLY, 0, PMD::MAX_UNSET);
@@ -165,10 +195,16 @@ FileWriterPlugin::FileWriterPlugin() :
     add_status_param_metadata(prefix + STATUS_LAST_FLUSH, PMDD::UINT_T, PMDA::READ_ONLY, 0, PMD::MAX_UNSET);
     add_status_param_metadata(prefix + STATUS_MAX_FLUSH, PMDD::UINT_T, PMDA::READ_ONLY, 0, PMD::MAX_UNSET);
     add_status_param_metadata(prefix + STATUS_MEAN_FLUSH, PMDD::UINT_T, PMDA::READ_ONLY, 0, PMD::MAX_UNSET);
+    add_status_param_metadata(prefix + STATUS_FLUSHES, PMDD::UINT_T, PMDA::READ_ONLY, 0, PMD::MAX_UNSET);
     add_status_param_metadata(prefix + STATUS_LAST_CLOSE, PMDD::UINT_T, PMDA::READ_ONLY, 0, PMD::MAX_UNSET);
     add_status_param_metadata(prefix + STATUS_MAX_CLOSE, PMDD::UINT_T, PMDA::READ_ONLY, 0, PMD::MAX_UNSET);
     add_status_param_metadata(prefix + STATUS_MEAN_CLOSE, PMDD::UINT_T, PMDA::READ_ONLY, 0, PMD::MAX_UNSET);
 
+    (prefix = STATUS_WRITE_BEHIND).append("/");
+    add_status_param_metadata(prefix + STATUS_QUEUED_FRAMES, PMDD::UINT_T, PMDA::READ_ONLY, 0, PMD::MAX_UNSET);
+    add_status_param_metadata(prefix + STATUS_QUEUED_BYTES, PMDD::UINT_T, PMDA::READ_ONLY, 0, PMD::MAX_UNSET);
+    add_status_param_metadata(prefix + STATUS_MAX_QUEUED_BYTES, PMDD::UINT_T, PMDA::READ_ONLY, 0, PMD::MAX_UNSET);
+
     this->logger_ = Logger::getLogger("FP.FileWriterPlugin");
     LOG4CXX_INFO(logger_, "FileWriterPlugin version " << this->get_version_long() << " loaded");
     this->current_acquisition_ = boost::shared_ptr<Acquisition>(new Acquisition(hdf5_error_definition_));
@@ -185,6 +221,8 @@ FileWriterPlugin::FileWriterPlugin() :
  */
 FileWriterPlugin::~FileWriterPlugin()
 {
+    // Write out any queued frames before shutting down the close timeout
+    stop_write_behind();
     timeout_thread_running_ = false;
     timeout_active_ = false;
     // Notify the close timeout thread to clean up resources
@@ -203,6 +241,33 @@ FileWriterPlugin::~FileWriterPlugin()
 }
 
 /** Process an incoming frame.
+ *
+ * If a write behind queue is configured the frame is added to it, to be written by the
+ * write behind thread, otherwise it is written immediately.
+ *
+ * \param[in] frame - Pointer to the Frame object.
+ */
+void FileWriterPlugin::process_frame(boost::shared_ptr<Frame> frame)
+{
+    boost::shared_ptr<WorkQueue<boost::shared_ptr<Frame>>> queue;
+    {
+        boost::mutex::scoped_lock lock(write_behind_mutex_);
+        queue = write_behind_queue_;
+        if (queue) {
+            write_behind_frames_queued_++;
+            write_behind_queued_bytes_ += frame->get_data_size();
+            write_behind_max_queued_bytes_ = std::max(write_behind_max_queued_bytes_, write_behind_queued_bytes_);
+        }
+    }
+    if (queue) {
+        // Blocks if the queue is full, holding back upstream plugins until the writer catches up
+        queue->add(frame);
+    } else {
+        write_frame(frame);
+    }
+}
+
+/** Write a frame to file.
  *
  * Checks we have been asked to write frames. If we are in writing mode
  * then the frame is checked for subframes. If subframes are found then
@@ -213,7 +278,7 @@ FileWriterPlugin::~FileWriterPlugin()
  *
  * \param[in] frame - Pointer to the Frame object.
  */
-void FileWriterPlugin::process_frame(boost::shared_ptr<Frame> frame)
+void FileWriterPlugin::write_frame(boost::shared_ptr<Frame> frame)
 {
     // Protect this method
     boost::mutex::scoped_lock cflock(close_file_mutex_);
@@ -254,6 +319,8 @@ void FileWriterPlugin::process_frame(boost::shared_ptr<Frame> frame)
  */
 void FileWriterPlugin::process_end_of_acquisition()
 {
+    // Frames queued ahead of the end of acquisition belong in the current file
+    wait_for_write_behind();
     if (writing_) {
         LOG4CXX_INFO(logger_, "End of acquisition frame received, stopping writer");
         stop_acquisition();
@@ -286,7 +353,7 @@ void FileWriterPlugin::start_writing()
         writing_ = this->current_acquisition_->start_acquisition(
             concurrent_rank_, concurrent_processes_, frames_per_block_, blocks_per_file_, first_file_index_,
             use_file_numbering_, file_postfix_, file_extension_, use_earliest_hdf5_, alignment_threshold_,
-            alignment_value_, master_frame_, hdf5_call_durations_
+            alignment_value_, master_frame_, flush_policy_, pre_create_files_, hdf5_call_durations_
         );
     }
 }
@@ -321,6 +388,12 @@ void FileWriterPlugin::stop_writing()
  */
 void FileWriterPlugin::configure(OdinData::IpcMessage& config, OdinData::IpcMessage& reply)
 {
+    // The write behind thread takes the mutex for each frame it writes, so the queue is
+    // reconfigured before the mutex is taken
+    if (config.has_param(FileWriterPlugin::CONFIG_WRITE_BEHIND)) {
+        this->configure_write_behind(config.get_param<size_t>(FileWriterPlugin::CONFIG_WRITE_BEHIND));
+    }
+
     // Protect this method
     std::lock_guard<std::mutex> lock(mutex_);
 
@@ -341,6 +414,12 @@ void FileWriterPlugin::configure(OdinData::IpcMessage& config, OdinData::IpcMess
             this->configure_file(fileConfig, reply);
         }
 
+        // Check to see if we are configuring when datasets are flushed
+        if (config.has_param(FileWriterPlugin::CONFIG_FLUSH)) {
+            OdinData::IpcMessage flushConfig(config.get_param<const rapidjson::Value&>(FileWriterPlugin::CONFIG_FLUSH));
+            this->configure_flush(flushConfig, reply);
+        }
+
         // Check to see if we are configuring a dataset
         if (config.has_param(FileWriterPlugin::CONFIG_DATASET)) {
             // Attempt to retrieve the value as a string parameter
@@ -441,16 +520,24 @@ void FileWriterPlugin::requestConfiguration(OdinData::IpcMessage& reply)
     reply.set_param(file_str + FileWriterPlugin::CONFIG_FILE_NUMBER_START, first_file_index_);
     reply.set_param(file_str + FileWriterPlugin::CONFIG_FILE_POSTFIX, file_postfix_);
     reply.set_param(file_str + FileWriterPlugin::CONFIG_FILE_EXTENSION, file_extension_);
+    reply.set_param(file_str + FileWriterPlugin::CONFIG_FILE_PRE_CREATE, pre_create_files_);
     // Configure HDF5 call error durations
     reply.set_param(file_str + FileWriterPlugin::CREATE_ERROR_DURATION, hdf5_error_definition_.create_duration);
     reply.set_param(file_str + FileWriterPlugin::WRITE_ERROR_DURATION, hdf5_error_definition_.write_duration);
     reply.set_param(file_str + FileWriterPlugin::FLUSH_ERROR_DURATION, hdf5_error_definition_.flush_duration);
     reply.set_param(file_str + FileWriterPlugin::CLOSE_ERROR_DURATION, hdf5_error_definition_.close_duration);
 
+    std::string flush_str = get_name() + '/' + FileWriterPlugin::CONFIG_FLUSH + '/';
+    reply.set_param(flush_str + FileWriterPlugin::CONFIG_FLUSH_FRAMES, flush_policy_.frames);
+    reply.set_param(flush_str + FileWriterPlugin::CONFIG_FLUSH_PERIOD, flush_policy_.period);
+    reply.set_param(flush_str + FileWriterPlugin::CONFIG_FLUSH_PARAM_FRAMES, flush_policy_.param_frames);
+    reply.set_param(flush_str + FileWriterPlugin::CONFIG_FLUSH_PARAM_PERIOD, flush_policy_.param_period);
+
     reply.set_param(get_name() + '/' + FileWriterPlugin::CONFIG_FRAMES, next_acquisition_->total_frames_);
     reply.set_param(get_name() + '/' + FileWriterPlugin::CONFIG_MASTER_DATASET, master_frame_);
     reply.set_param(get_name() + '/' + FileWriterPlugin::ACQUISITION_ID, next_acquisition_->acquisition_id_);
     reply.set_param(get_name() + '/' + FileWriterPlugin::CLOSE_TIMEOUT_PERIOD, timeout_period_);
+    reply.set_param(get_name() + '/' + FileWriterPlugin::CONFIG_WRITE_BEHIND, write_behind_depth_);
 
     // Check for datasets
     std::map<std::string, DatasetDefinition>::iterator iter;
@@ -678,6 +765,17 @@ void FileWriterPlugin::configure_file(OdinData::IpcMessage& config, OdinData::Ip
         this->file_extension_ = config.get_param<std::string>(FileWriterPlugin::CONFIG_FILE_EXTENSION);
         LOG4CXX_DEBUG_LEVEL(1, logger_, "File extension changed to " << this->file_extension_);
     }
+    if (config.has_param(FileWriterPlugin::CONFIG_FILE_PRE_CREATE)) {
+        bool pre_create_files = config.get_param<bool>(FileWriterPlugin::CONFIG_FILE_PRE_CREATE);
+#ifdef H5_HAVE_THREADSAFE
+        this->pre_create_files_ = pre_create_files;
+        LOG4CXX_DEBUG_LEVEL(1, logger_, "File pre-creation changed to " << this->pre_create_files_);
+#else
+        if (pre_create_files) {
+            LOG4CXX_WARN(logger_, "Files cannot be pre-created as the HDF5 library is not threadsafe");
+        }
+#endif
+    }
     // Check for HDF5 call error durations
     if (config.has_param(FileWriterPlugin::CREATE_ERROR_DURATION)) {
         this->hdf5_error_definition_.create_duration
@@ -709,6 +807,48 @@ void FileWriterPlugin::configure_file(OdinData::IpcMessage& config, OdinData::Ip
     }
 }
 
+/**
+ * Set flush configuration options for the file writer.
+ *
+ * This sets up when datasets are flushed to disk after being written to. The options are:
+ * CONFIG_FLUSH_FRAMES - Number of writes to a frame dataset after which it is flushed (0 = no flush on a count)
+ * CONFIG_FLUSH_PERIOD - Time (ms) since a frame dataset was last flushed after which a write flushes it (0 = no
+ *                       flush on a period)
+ * CONFIG_FLUSH_PARAM_FRAMES - As CONFIG_FLUSH_FRAMES, for parameter datasets
+ * CONFIG_FLUSH_PARAM_PERIOD - As CONFIG_FLUSH_PERIOD, for parameter datasets
+ *
+ * With both set to 0 datasets are only flushed when the file is closed. By default frame datasets are
+ * flushed after every write and parameter datasets at most once a second. The configuration is applied
+ * when the next acquisition is started.
+ *
+ * \param[in] config - IpcMessage containing configuration data.
+ * \param[out] reply - Response IpcMessage.
+ */
+void FileWriterPlugin::configure_flush(OdinData::IpcMessage& config, OdinData::IpcMessage& reply)
+{
+    if (config.has_param(FileWriterPlugin::CONFIG_FLUSH_FRAMES)) {
+        flush_policy_.frames = config.get_param<size_t>(FileWriterPlugin::CONFIG_FLUSH_FRAMES);
+        LOG4CXX_DEBUG_LEVEL(1, logger_, "Flushing datasets every " << flush_policy_.frames << " writes");
+    }
+    if (config.has_param(FileWriterPlugin::CONFIG_FLUSH_PERIOD)) {
+        flush_policy_.period = config.get_param<size_t>(FileWriterPlugin::CONFIG_FLUSH_PERIOD);
+        LOG4CXX_DEBUG_LEVEL(1, logger_, "Flushing datasets every " << flush_policy_.period << "ms");
+    }
+    if (config.has_param(FileWriterPlugin::CONFIG_FLUSH_PARAM_FRAMES)) {
+        flush_policy_.param_frames = config.get_param<size_t>(FileWriterPlugin::CONFIG_FLUSH_PARAM_FRAMES);
+        LOG4CXX_DEBUG_LEVEL(
+            1, logger_, "Flushing parameter datasets every " << flush_policy_.param_frames << " writes"
+        );
+    }
+    if (config.has_param(FileWriterPlugin::CONFIG_FLUSH_PARAM_PERIOD)) {
+        flush_policy_.param_period = config.get_param<size_t>(FileWriterPlugin::CONFIG_FLUSH_PARAM_PERIOD);
+        LOG4CXX_DEBUG_LEVEL(1, logger_, "Flushing parameter datasets every " << flush_policy_.param_period << "ms");
+    }
+    if (writing_) {
+        LOG4CXX_INFO(logger_, "Flush configuration will be applied to the next acquisition");
+    }
+}
+
 /**
  * Set dataset configuration options for the file writer.
  *
@@ -913,9 +1053,16 @@ void FileWriterPlugin::add_file_writing_stats(OdinData::IpcMessage& status)
     status.set_param(prefix + STATUS_LAST_FLUSH, (int)hdf5_call_durations_.flush.last_);
     status.set_param(prefix + STATUS_MAX_FLUSH, (int)hdf5_call_durations_.flush.max_);
     status.set_param(prefix + STATUS_MEAN_FLUSH, (int)hdf5_call_durations_.flush.mean_);
+    status.set_param(prefix + STATUS_FLUSHES, hdf5_call_durations_.flushes);
     status.set_param(prefix + STATUS_LAST_CLOSE, (int)hdf5_call_durations_.close.last_);
     status.set_param(prefix + STATUS_MAX_CLOSE, (int)hdf5_call_durations_.close.max_);
     status.set_param(prefix + STATUS_MEAN_CLOSE, (int)hdf5_call_durations_.close.mean_);
+
+    prefix = get_name() + '/' + STATUS_WRITE_BEHIND + '/';
+    boost::mutex::scoped_lock lock(write_behind_mutex_);
+    status.set_param(prefix + STATUS_QUEUED_FRAMES, write_behind_frames_queued_ - write_behind_frames_written_);
+    status.set_param(prefix + STATUS_QUEUED_BYTES, write_behind_queued_bytes_);
+    status.set_param(prefix + STATUS_MAX_QUEUED_BYTES, write_behind_max_queued_bytes_);
 }
 
 /**
@@ -926,7 +1073,10 @@ bool FileWriterPlugin::reset_statistics()
     hdf5_call_durations_.create.reset();
     hdf5_call_durations_.write.reset();
     hdf5_call_durations_.flush.reset();
+    hdf5_call_durations_.flushes = 0;
     hdf5_call_durations_.close.reset();
+    boost::mutex::scoped_lock lock(write_behind_mutex_);
+    write_behind_max_queued_bytes_ = write_behind_queued_bytes_;
     return true;
 }
 
@@ -1087,6 +1237,106 @@ void FileWriterPlugin::run_close_file_timeout()
     }
 }
 
+/**
+ * Configures the write behind queue
+ *
+ * A non-zero depth starts a write behind thread which writes frames to file from a queue
+ * holding up to that many frames, so that a slow write does not hold up the plugin worker
+ * thread. Each frame is held by the queue until it has been written, so its shared buffer
+ * is not released early. A depth of zero writes frames synchronously from process_frame.
+ *
+ * \param[in] depth - Number of frames the write behind queue holds.
+ */
+void FileWriterPlugin::configure_write_behind(size_t depth)
+{
+    if (depth == write_behind_depth_) {
+        return;
+    }
+    if (writing_) {
+        std::string message = "Cannot change write behind depth whilst writing";
+        set_error(message);
+        throw std::runtime_error(message);
+    }
+    stop_write_behind();
+    write_behind_depth_ = depth;
+    if (depth > 0) {
+        boost::shared_ptr<WorkQueue<boost::shared_ptr<Frame>>> queue(
+            new WorkQueue<boost::shared_ptr<Frame>>(static_cast<int>(depth))
+        );
+        write_behind_thread_ = boost::thread(boost::bind(&FileWriterPlugin::run_write_behind, this, queue));
+        boost::mutex::scoped_lock lock(write_behind_mutex_);
+        write_behind_queue_ = queue;
+        LOG4CXX_INFO(logger_, "Writing frames through a write behind queue of depth " << depth);
+    } else {
+        LOG4CXX_INFO(logger_, "Writing frames synchronously");
+    }
+}
+
+/**
+ * Waits until all frames queued so far have been written by the write behind thread
+ *
+ * Returns immediately if there is no write behind queue.
+ */
+void FileWriterPlugin::wait_for_write_behind()
+{
+    boost::mutex::scoped_lock lock(write_behind_mutex_);
+    uint64_t frames_queued = write_behind_frames_queued_;
+    while (write_behind_frames_written_ < frames_queued) {
+        write_behind_condition_.wait(lock);
+    }
+}
+
+/**
+ * Stops the write behind thread once all queued frames have been written
+ *
+ * Frames processed after this call are written synchronously.
+ */
+void FileWriterPlugin::stop_write_behind()
+{
+    boost::shared_ptr<WorkQueue<boost::shared_ptr<Frame>>> queue;
+    {
+        boost::mutex::scoped_lock lock(write_behind_mutex_);
+        queue.swap(write_behind_queue_);
+    }
+    if (queue) {
+        wait_for_write_behind();
+        queue->interrupt();
+        write_behind_thread_.join();
+    }
+}
+
+/**
+ * Function that is run by the write behind thread
+ *
+ * Frames are removed from the queue and written until the queue is interrupted. The
+ * reference to each frame is only dropped once it has been written and pushed on to any
+ * registered callbacks.
+ *
+ * \param[in] queue - Queue of frames to write.
+ */
+void FileWriterPlugin::run_write_behind(boost::shared_ptr<WorkQueue<boost::shared_ptr<Frame>>> queue)
+{
+    OdinData::configure_logging_mdc(OdinData::app_path.c_str());
+    boost::shared_ptr<Frame> frame = queue->remove();
+    while (frame) {
+        size_t frame_bytes = frame->get_data_size();
+        try {
+            write_frame(frame);
+        } catch (std::exception& e) {
+            LOG4CXX_ERROR(logger_, "Write behind failed for frame " << frame->get_frame_number() << ": " << e.what());
+            set_error(e.what());
+        }
+        frame.reset();
+        {
+            boost::mutex::scoped_lock lock(write_behind_mutex_);
+            write_behind_frames_written_++;
+            write_behind_queued_bytes_ -= frame_bytes;
+        }
+        write_behind_condition_.notify_all();
+        frame = queue->remove();
+    }
+}
+
 /**
  * Calculates the number of frames that this FileWriter can expect to write based on the total number of frames
  *
@@ -1137,6 +1387,7 @@ void FileWriterPlugin::execute(const std::string& command, OdinData::IpcMessage&
             this->start_writing();
         }
     } else if (command == FileWriterPlugin::STOP_WRITING) {
+        this->wait_for_write_behind();
         this->stop_writing();
     } else {
         std::stringstream ss;
@@ -35,6 +35,12 @@ const std::string FrameProcessorController::CONFIG_PLUGIN_NAME = "name";
 const std::string FrameProcessorController::CONFIG_PLUGIN_INDEX = "index";
 const std::string FrameProcessorController::CONFIG_PLUGIN_LIBRARY = "library";
 const std::string FrameProcessorController::CONFIG_PLUGIN_CONNECTION = "connection";
+const std::string FrameProcessorController::CONFIG_PLUGIN_QUEUE = "queue";
+const std::string FrameProcessorController::CONFIG_PLUGIN_QUEUE_DEPTH = "queue_depth";
+const std::string FrameProcessorController::CONFIG_PLUGIN_QUEUE_SPIN = "queue_spin";
+const std::string FrameProcessorController::QUEUE_TYPE_LIST = "list";
+const std::string FrameProcessorController::QUEUE_TYPE_SPSC = "spsc";
+const std::string FrameProcessorController::QUEUE_TYPE_MPSC = "mpsc";
 
 const std::string FrameProcessorController::CONFIG_STORE = "store";
 const std::string FrameProcessorController::CONFIG_EXECUTE = "execute";
@@ -655,7 +661,8 @@ void FrameProcessorController::resetStatistics(OdinData::IpcMessage& reply)
  * CONFIG_PLUGIN_LOAD - Uses NAME, INDEX and LIBRARY to load a plugin
  * into the controller.
  * CONFIG_PLUGIN_CONNECT - Uses CONNECTION and INDEX to connect one
- * plugin input to another plugin output.
+ * plugin input to another plugin output. The optional QUEUE, QUEUE_DEPTH and
+ * QUEUE_SPIN parameters select the work queue used by the connecting plugin.
  * CONFIG_PLUGIN_DISCONNECT - Uses CONNECTION and INDEX to disconnect
  * one plugin from another.
  *
@@ -688,6 +695,13 @@ void FrameProcessorController::configurePlugin(OdinData::IpcMessage& config, Odi
             && pluginConfig.has_param(FrameProcessorController::CONFIG_PLUGIN_INDEX)) {
             std::string index = pluginConfig.get_param<std::string>(FrameProcessorController::CONFIG_PLUGIN_INDEX);
             std::string cnxn = pluginConfig.get_param<std::string>(FrameProcessorController::CONFIG_PLUGIN_CONNECTION);
+            if (pluginConfig.has_param(FrameProcessorController::CONFIG_PLUGIN_QUEUE)) {
+                std::string type = pluginConfig.get_param<std::string>(FrameProcessorController::CONFIG_PLUGIN_QUEUE);
+                int depth
+                    = pluginConfig.get_param<int>(FrameProcessorController::CONFIG_PLUGIN_QUEUE_DEPTH, max_queue_size);
+                int spin = pluginConfig.get_param<int>(FrameProcessorController::CONFIG_PLUGIN_QUEUE_SPIN, 0);
+                this->configurePluginQueue(index, type, depth, spin);
+            }
             this->connectPlugin(index, cnxn);
         }
     }
@@ -765,6 +779,61 @@ void FrameProcessorController::loadPlugin(const std::string& index, const std::s
     }
 }
 
+/** Configure the work queue of a plugin.
+ *
+ * Replaces the work queue through which the plugin receives frames. The queue can only be
+ * replaced before the plugin is connected to any frame source. The list queue is the default
+ * mutex protected queue; the spsc and mpsc queues are lock-free bounded rings, for a plugin
+ * fed by a single or by multiple upstream connections respectively, which spin for the given
+ * number of attempts before blocking when empty or full.
+ *
+ * \param[in] index - Index of the plugin.
+ * \param[in] type - Type of the work queue (list, spsc or mpsc).
+ * \param[in] depth - Number of frames the queue can hold before blocking upstream plugins.
+ * \param[in] spin - Number of attempts to add or remove a frame before blocking.
+ */
+void FrameProcessorController::configurePluginQueue(
+    const std::string& index,
+    const std::string& type,
+    int depth,
+    int spin
+)
+{
+    if (plugins_.count(index) == 0) {
+        std::stringstream is;
+        is << "Cannot configure work queue for plugin with index = " << index << ", plugin isn't loaded";
+        LOG4CXX_ERROR(logger_, is.str());
+        throw std::runtime_error(is.str().c_str());
+    }
+    if (depth <= 0) {
+        std::stringstream is;
+        is << "Cannot configure work queue for plugin with index = " << index << ", invalid depth " << depth;
+        LOG4CXX_ERROR(logger_, is.str());
+        throw std::runtime_error(is.str().c_str());
+    }
+
+    boost::shared_ptr<WorkQueue<boost::shared_ptr<Frame>>> queue;
+    if (type == FrameProcessorController::QUEUE_TYPE_LIST) {
+        queue.reset(new WorkQueue<boost::shared_ptr<Frame>>(depth));
+    } else if (type == FrameProcessorController::QUEUE_TYPE_SPSC) {
+        queue.reset(new BoundedWorkQueue<boost::shared_ptr<Frame>>(depth, false, spin));
+    } else if (type == FrameProcessorController::QUEUE_TYPE_MPSC) {
+        queue.reset(new BoundedWorkQueue<boost::shared_ptr<Frame>>(depth, true, spin));
+    } else {
+        std::stringstream is;
+        is << "Cannot configure work queue for plugin with index = " << index << ", unknown queue type " << type;
+        LOG4CXX_ERROR(logger_, is.str());
+        throw std::runtime_error(is.str().c_str());
+    }
+
+    plugins_[index]->setWorkQueue(queue);
+    LOG4CXX_INFO(
+        logger_,
+        "Plugin with index = " << index << " using " << type << " work queue of depth " << queue->max_size()
+                               << " with spin count " << spin
+    );
+}
+
 /** Connects two plugins together.
  *
  * When plugins have been connected they can pass frame objects between them.
@@ -776,6 +845,15 @@ void FrameProcessorController::connectPlugin(const std::string& index, const std
 {
     // Check that the plugin is loaded
     if (plugins_.count(index) > 0) {
+        // A single producer work queue cannot be fed by more than one connection
+        if (plugins_[index]->getWorkQueue()->single_producer() && plugins_[index]->registrationCount() > 0) {
+            std::stringstream is;
+            is << "Cannot connect plugin with index = " << index << " to " << connectTo
+               << ", plugin has a single producer work queue and is already connected";
+            LOG4CXX_ERROR(logger_, is.str());
+            throw std::runtime_error(is.str().c_str());
+        }
+
         // Check for the shared memory connection
         if (connectTo == "frame_receiver") {
             if (sharedMemController_) {
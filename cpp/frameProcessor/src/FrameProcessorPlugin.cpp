@@ -218,7 +218,11 @@ void FrameProcessorPlugin::status(OdinData::IpcMessage& status)
 /**
  * Collate performance statistics for the plugin.
  *
- * The performance metrics are added to the status IpcMessage object.
+ * The performance metrics are added to the status IpcMessage object. Along with the
+ * frame processing time, the metrics of the plugin work queue are reported: the current
+ * and maximum number of frames queued, the time frames wait in the queue, the time
+ * upstream plugins are blocked adding frames to the full queue and the time the
+ * plugin worker thread is idle waiting for frames.
  *
  * \param[out] status - Reference to an IpcMessage value to store the performance stats.
  */
@@ -227,6 +231,21 @@ void FrameProcessorPlugin::add_performance_stats(OdinData::IpcMessage& status)
     status.set_param(get_name() + "/timing/last_process", process_duration_.last_);
     status.set_param(get_name() + "/timing/max_process", process_duration_.max_);
     status.set_param(get_name() + "/timing/mean_process", process_duration_.mean_);
+
+    boost::shared_ptr<WorkQueue<boost::shared_ptr<Frame>>> queue = this->getWorkQueue();
+    WorkQueueStats queue_stats = queue->get_stats();
+    status.set_param(get_name() + "/timing/queue_depth", queue->size());
+    status.set_param(get_name() + "/timing/queue_size", queue->max_size());
+    status.set_param(get_name() + "/timing/queue_high_water_mark", queue_stats.high_water_mark_);
+    status.set_param(get_name() + "/timing/last_queue_wait", queue_stats.wait_.last_);
+    status.set_param(get_name() + "/timing/max_queue_wait", queue_stats.wait_.max_);
+    status.set_param(get_name() + "/timing/mean_queue_wait", queue_stats.wait_.mean_);
+    status.set_param(get_name() + "/timing/last_queue_blocked", queue_stats.blocked_.last_);
+    status.set_param(get_name() + "/timing/max_queue_blocked", queue_stats.blocked_.max_);
+    status.set_param(get_name() + "/timing/mean_queue_blocked", queue_stats.blocked_.mean_);
+    status.set_param(get_name() + "/timing/last_idle", idle_duration_.last_);
+    status.set_param(get_name() + "/timing/max_idle", idle_duration_.max_);
+    status.set_param(get_name() + "/timing/mean_idle", idle_duration_.mean_);
 }
 
 /**
@@ -237,6 +256,8 @@ void FrameProcessorPlugin::add_performance_stats(OdinData::IpcMessage& status)
 void FrameProcessorPlugin::reset_performance_stats()
 {
     process_duration_.reset();
+    idle_duration_.reset();
+    this->getWorkQueue()->reset_stats();
 }
 
 /**
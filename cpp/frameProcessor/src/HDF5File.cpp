@@ -28,7 +28,6 @@ herr_t hdf5_error_cb(unsigned n, const H5E_error2_t* err_desc, void* client_data
 
 HDF5File::HDF5File(const HDF5ErrorDefinition_t& hdf5_error_definition) :
     hdf5_file_id_(-1),
-    param_memspace_(-1),
     hdf5_error_flag_(false),
     file_index_(0),
     use_earliest_version_(false),
@@ -50,9 +49,6 @@ HDF5File::~HDF5File()
 {
     // Call to close file in case it hasn't been closed
     close_file();
-    if (this->param_memspace_ >= 0) {
-        ensure_h5_result(H5Sclose(this->param_memspace_), "H5Sclose failed");
-    }
 }
 
 /**
@@ -68,6 +64,16 @@ void HDF5File::set_unlimited()
     }
 }
 
+/**
+ * Set when datasets are flushed to disk after being written to
+ *
+ * \param[in] flush_policy - The flush policy to apply to all datasets in the file
+ */
+void HDF5File::set_flush_policy(const HDF5FlushPolicy_t& flush_policy)
+{
+    flush_policy_ = flush_policy;
+}
+
 /**
  * Handles an HDF5 error. Logs the error and throws a runtime exception
  *
@@ -189,11 +195,6 @@ size_t HDF5File::create_file(
     ensure_h5_result(H5Pclose(fapl), "H5Pclose failed to close the file access property list");
     ensure_h5_result(H5Pclose(fcpl), "H5Pclose failed to close the file creation property list");
 
-    // Create the memspace for writing parameter datasets
-    hsize_t elementSize[1] = { 1 };
-    param_memspace_ = H5Screate_simple(1, elementSize, NULL);
-    ensure_h5_result(param_memspace_, "Failed to create parameter dataspace");
-
     file_index_ = file_index;
 
     return create_duration;
@@ -211,9 +212,12 @@ size_t HDF5File::close_file()
 
     size_t close_duration = 0;
     if (this->hdf5_file_id_ >= 0) {
-        // Close dataset handles
+        // Write out any buffered parameter values and close dataset handles
         std::map<std::string, HDF5Dataset_t>::iterator it;
         for (it = this->hdf5_datasets_.begin(); it != this->hdf5_datasets_.end(); ++it) {
+            if (it->second.param_buffer_count_ > 0) {
+                write_parameter_buffer(it->second);
+            }
             ensure_h5_result(H5Dclose(it->second.dataset_id), "H5Dclose failed");
         }
         this->hdf5_datasets_.clear();
@@ -229,6 +233,28 @@ size_t HDF5File::close_file()
     return close_duration;
 }
 
+/**
+ * Flush any datasets that have been written to since they were last flushed.
+ *
+ * Called before the file is closed so that the flushes that would otherwise be made by
+ * H5Fclose are recorded.
+ *
+ * \param[in] call_durations - Struct containing hdf5 call durations - flush will be updated
+ *                             with the durations of the H5Dflush calls
+ */
+void HDF5File::flush_datasets(HDF5CallDurations_t& call_durations)
+{
+    // Protect this method
+    std::lock_guard<std::mutex> lock { mutex_ };
+
+    std::map<std::string, HDF5Dataset_t>::iterator it;
+    for (it = this->hdf5_datasets_.begin(); it != this->hdf5_datasets_.end(); ++it) {
+        if (it->second.unflushed_writes_ > 0) {
+            flush_dataset(it->second, call_durations);
+        }
+    }
+}
+
 /**
  * Write a frame to the file.
  *
@@ -285,15 +311,7 @@ void HDF5File::write_frame(
     call_durations.write.update(write_duration);
     ensure_h5_result(status, "H5DOwrite_chunk failed");
 
-#if H5_VERSION_GE(1, 9, 178)
-    if (!use_earliest_version_) {
-        watchdog_timer_.start_timer("H5Dflush", hdf5_error_definition_.flush_duration);
-        hid_t status = H5Dflush(dset.dataset_id);
-        unsigned int flush_duration = watchdog_timer_.finish_timer();
-        call_durations.flush.update(flush_duration);
-        ensure_h5_result(status, "Failed to flush data to disk");
-    }
-#endif
+    written(dset, frame.get_meta_data().get_dataset_name(), false, call_durations);
 
     // Check if the latest written frame has extended the dataset, and if it has then
     // adjust the actual_dataset_size_ member of the dset structure to match the real size
@@ -305,11 +323,23 @@ void HDF5File::write_frame(
 /**
  * Write a parameter to the file.
  *
+ * Parameter values are buffered and written in blocks of consecutive values, which are
+ * written out when they reach the end of a chunk of the dataset, when a value does not
+ * follow on from the buffered values and before the dataset is flushed or closed. The
+ * flush policy therefore bounds how long values are held in the buffer.
+ *
  * \param[in] frame - Reference to the frame.
  * \param[in] dataset_definition - The dataset definition for this parameter.
  * \param[in] frame_offset - The offset to write the value to
+ * \param[in] call_durations - Struct containing hdf5 call durations - flush will be updated
+ *                             with the durations of any H5Dflush call
  */
-void HDF5File::write_parameter(const Frame& frame, DatasetDefinition dataset_definition, hsize_t frame_offset)
+void HDF5File::write_parameter(
+    const Frame& frame,
+    DatasetDefinition dataset_definition,
+    hsize_t frame_offset,
+    HDF5CallDurations_t& call_durations
+)
 {
     // Protect this method
     std::lock_guard<std::mutex> lock { mutex_ };
@@ -358,60 +388,72 @@ void HDF5File::write_parameter(const Frame& frame, DatasetDefinition dataset_def
 
     HDF5Dataset_t& dset = this->get_hdf5_dataset(dataset_definition.name);
 
-    if (unlimited_) {
-        this->extend_dataset(dset, frame_offset + 1);
+    LOG4CXX_TRACE(logger_, "Writing parameter [" << dataset_definition.name << "] at offset = " << frame_offset);
+
+    // Write out the buffered values if this one does not follow on from them
+    if (dset.param_buffer_count_ > 0
+        && (frame_offset != dset.param_buffer_offset_ + dset.param_buffer_count_
+            || dataset_definition.data_type != dset.param_buffer_type_)) {
+        write_parameter_buffer(dset);
+    }
+    if (dset.param_buffer_count_ == 0) {
+        dset.param_buffer_offset_ = frame_offset;
+        dset.param_buffer_type_ = dataset_definition.data_type;
     }
+    dset.param_buffer_.insert(dset.param_buffer_.end(), (char*)data_ptr, (char*)data_ptr + size);
+    dset.param_buffer_count_++;
 
-    LOG4CXX_TRACE(logger_, "Writing parameter [" << dataset_definition.name << "] at offset = " << frame_offset);
+    // Write out the buffered values once they fill up to the end of a chunk
+    if ((frame_offset + 1) % dset.outer_chunk_size_ == 0) {
+        write_parameter_buffer(dset);
+    }
+
+    written(dset, dataset_definition.name, true, call_durations);
+}
+
+/**
+ * Write the buffered parameter values of a dataset to the file as a single block.
+ *
+ * Use this method ONLY while holding the mutex_
+ *
+ * \param[in] dset - The dataset to write the buffered values to
+ */
+void HDF5File::write_parameter_buffer(HDF5Dataset_t& dset)
+{
+    // Take the buffered values, so that they are not written again if the write fails
+    std::vector<char> values;
+    values.swap(dset.param_buffer_);
+    hsize_t count[1] = { dset.param_buffer_count_ };
+    dset.param_buffer_count_ = 0;
+
+    if (unlimited_) {
+        this->extend_dataset(dset, dset.param_buffer_offset_ + count[0]);
+    }
 
     // Set the offset
     std::vector<hsize_t> offset(dset.dataset_dimensions.size());
-    offset[0] = frame_offset;
+    offset[0] = dset.param_buffer_offset_;
 
     // Create the hdf5 variables for writing
-    hid_t dtype = datatype_to_hdf_type(dataset_definition.data_type);
-    hsize_t elementSize[1] = { 1 };
+    hid_t dtype = datatype_to_hdf_type(dset.param_buffer_type_);
+    hid_t memspace = H5Screate_simple(1, count, NULL);
+    ensure_h5_result(memspace, "Failed to create parameter dataspace");
     hid_t fspace = H5Dget_space(dset.dataset_id);
     ensure_h5_result(fspace, "Failed to get parameter dataset dataspace");
 
     // Select the hyperslab
     ensure_h5_result(
-        H5Sselect_hyperslab(fspace, H5S_SELECT_SET, &offset.front(), NULL, elementSize, NULL),
-        "H5Sselect_hyperslab failed"
+        H5Sselect_hyperslab(fspace, H5S_SELECT_SET, &offset.front(), NULL, count, NULL), "H5Sselect_hyperslab failed"
     );
 
-    // Write the value to the dataset
+    // Write the values to the dataset
     watchdog_timer_.start_timer("H5Dwrite", hdf5_error_definition_.write_duration);
-    hid_t status = H5Dwrite(dset.dataset_id, dtype, param_memspace_, fspace, H5P_DEFAULT, data_ptr);
+    hid_t status = H5Dwrite(dset.dataset_id, dtype, memspace, fspace, H5P_DEFAULT, &values.front());
     watchdog_timer_.finish_timer();
     ensure_h5_result(status, "H5Dwrite failed");
 
     ensure_h5_result(H5Sclose(fspace), "H5Sclose failed");
-
-    // Flush if necessary and update the time it was last flushed
-#if H5_VERSION_GE(1, 9, 178)
-    bool flush = false;
-    boost::posix_time::ptime now = boost::posix_time::microsec_clock::local_time();
-    std::map<std::string, boost::posix_time::ptime>::iterator flushed_iter;
-    flushed_iter = last_flushed.find(dataset_definition.name);
-    if (flushed_iter != last_flushed.end()) {
-        if ((now - flushed_iter->second).total_milliseconds() > PARAM_FLUSH_RATE) {
-            flush = true;
-            flushed_iter->second = boost::posix_time::microsec_clock::local_time();
-        }
-    } else {
-        flush = true;
-        last_flushed[dataset_definition.name] = now;
-    }
-
-    if (flush && !use_earliest_version_) {
-        LOG4CXX_TRACE(logger_, "Flushing parameter [" << dataset_definition.name << "]");
-        watchdog_timer_.start_timer("H5Dflush", hdf5_error_definition_.flush_duration);
-        hid_t status = H5Dflush(dset.dataset_id);
-        watchdog_timer_.finish_timer();
-        ensure_h5_result(status, "Failed to flush data to disk");
-    }
-#endif
+    ensure_h5_result(H5Sclose(memspace), "H5Sclose failed");
 }
 
 /**
@@ -563,6 +605,12 @@ void HDF5File::create_dataset(const DatasetDefinition& definition, int low_index
     dset.dataset_dimensions = dset_dims;
     dset.dataset_offsets = std::vector<hsize_t>(3);
     dset.actual_dataset_size_ = 0;
+    dset.unflushed_writes_ = 0;
+    dset.last_flushed_ = boost::posix_time::microsec_clock::local_time();
+    dset.outer_chunk_size_ = chunk_dims[0];
+    dset.param_buffer_count_ = 0;
+    dset.param_buffer_offset_ = 0;
+    dset.param_buffer_type_ = definition.data_type;
     this->hdf5_datasets_[definition.name] = dset;
 
     LOG4CXX_DEBUG_LEVEL(1, logger_, "Closing intermediate open HDF objects");
@@ -593,6 +641,73 @@ HDF5File::HDF5Dataset_t& HDF5File::get_hdf5_dataset(const std::string& dset_name
     return this->hdf5_datasets_.at(dset_name);
 }
 
+/**
+ * Record a write to a dataset, flushing it if required by the flush policy.
+ *
+ * Frame and parameter datasets have separate flush policies, so that parameter datasets are not
+ * flushed on every frame by default.
+ *
+ * Use this method ONLY while holding the mutex_
+ *
+ * \param[in] dset - The dataset that has been written to
+ * \param[in] dset_name - Name of the dataset
+ * \param[in] parameter - Whether the dataset is a parameter dataset
+ * \param[in] call_durations - Struct containing hdf5 call durations - flush will be updated
+ *                             with the duration of any H5Dflush call
+ */
+void HDF5File::written(
+    HDF5Dataset_t& dset,
+    const std::string& dset_name,
+    bool parameter,
+    HDF5CallDurations_t& call_durations
+)
+{
+    size_t flush_frames = parameter ? flush_policy_.param_frames : flush_policy_.frames;
+    size_t flush_period = parameter ? flush_policy_.param_period : flush_policy_.period;
+
+    dset.unflushed_writes_++;
+    bool flush = flush_frames > 0 && dset.unflushed_writes_ >= flush_frames;
+    if (!flush && flush_period > 0) {
+        boost::posix_time::ptime now = boost::posix_time::microsec_clock::local_time();
+        flush = (now - dset.last_flushed_) >= boost::posix_time::milliseconds(static_cast<long>(flush_period));
+    }
+    if (flush) {
+        LOG4CXX_TRACE(logger_, "Flushing dataset [" << dset_name << "]");
+        flush_dataset(dset, call_durations);
+    }
+}
+
+/**
+ * Flush a dataset to disk, first writing out any buffered parameter values.
+ *
+ * Datasets are only flushed when the latest version of the HDF5 library is in use, as the
+ * file is then open for SWMR readers.
+ *
+ * Use this method ONLY while holding the mutex_
+ *
+ * \param[in] dset - The dataset to flush
+ * \param[in] call_durations - Struct containing hdf5 call durations - flush will be updated
+ *                             with the duration of the H5Dflush call
+ */
+void HDF5File::flush_dataset(HDF5Dataset_t& dset, HDF5CallDurations_t& call_durations)
+{
+    if (dset.param_buffer_count_ > 0) {
+        write_parameter_buffer(dset);
+    }
+    dset.unflushed_writes_ = 0;
+    dset.last_flushed_ = boost::posix_time::microsec_clock::local_time();
+#if H5_VERSION_GE(1, 9, 178)
+    if (!use_earliest_version_) {
+        watchdog_timer_.start_timer("H5Dflush", hdf5_error_definition_.flush_duration);
+        hid_t status = H5Dflush(dset.dataset_id);
+        unsigned int flush_duration = watchdog_timer_.finish_timer();
+        call_durations.flush.update(flush_duration);
+        call_durations.flushes++;
+        ensure_h5_result(status, "Failed to flush data to disk");
+    }
+#endif
+}
+
 /** Extend the HDF5 dataset ready for new data
  *
  * Checks the frame_no is larger than the current dataset dimensions and then
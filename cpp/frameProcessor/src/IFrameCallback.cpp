@@ -5,6 +5,9 @@
  *      Author: gnx91527
  */
 
+#include <stdexcept>
+
+#include "gettime.h"
 #include "logging.h"
 #include <IFrameCallback.h>
 
@@ -39,6 +42,43 @@ boost::shared_ptr<WorkQueue<boost::shared_ptr<Frame>>> IFrameCallback::getWorkQu
     return queue_;
 }
 
+/** Replace the WorkQueue.
+ *
+ * The WorkQueue can only be replaced while this IFrameCallback is not registered with any
+ * frame source, as there must be no producers adding to the queue while it is replaced. If
+ * the worker thread is running it is stopped and joined, any items remaining on the current
+ * queue are moved to the new queue and the worker thread is then restarted.
+ *
+ * \param[in] queue - pointer to the new WorkQueue.
+ */
+void IFrameCallback::setWorkQueue(boost::shared_ptr<WorkQueue<boost::shared_ptr<Frame>>> queue)
+{
+    if (!registrations_.empty()) {
+        throw std::runtime_error("Cannot replace the work queue while connected to a frame source");
+    }
+
+    bool restart = thread_ && run_;
+    if (thread_) {
+        run_ = false;
+        queue_->interrupt();
+        thread_->join();
+        delete thread_;
+        thread_ = 0;
+    }
+
+    while (queue_->size() > 0) {
+        boost::shared_ptr<Frame> frame = queue_->remove();
+        if (frame) {
+            queue->add(frame, true);
+        }
+    }
+    queue_ = queue;
+
+    if (restart) {
+        this->start();
+    }
+}
+
 /** Start the worker thread.
  *
  * Check to ensure this object is not already working. If it isn't then
@@ -65,9 +105,8 @@ void IFrameCallback::stop()
     if (working_) {
         // Set the run condition flag to false
         run_ = false;
-        // Now notify the work queue we have finished by adding a null ptr
-        boost::shared_ptr<Frame> nullMsg;
-        queue_->add(nullMsg);
+        // Now notify the work queue we have finished, waking the worker thread
+        queue_->interrupt();
     }
 }
 
@@ -103,6 +142,15 @@ void IFrameCallback::confirmRemoval(const std::string& name)
     registrations_.erase(name);
 }
 
+/** Return the number of objects that this IFrameCallback is registered with.
+ *
+ * \return number of confirmed registrations.
+ */
+size_t IFrameCallback::registrationCount() const
+{
+    return registrations_.size();
+}
+
 /** Main thread of execution for this class.
  *
  * The thread executes in a continuous loop until the working_ flag is set to false.
@@ -121,9 +169,14 @@ void IFrameCallback::workerTask()
     // Set the working flag to true
     working_ = true;
 
-    // Check the queue for messages
+    // Check the queue for messages, recording the time spent idle waiting for each one
+    struct timespec idle_start;
+    struct timespec idle_end;
     while (run_) {
+        gettime(&idle_start, true);
         boost::shared_ptr<Frame> msg = queue_->remove();
+        gettime(&idle_end, true);
+        idle_duration_.update(elapsed_us(idle_start, idle_end));
         if (msg) {
             // Once we have a message, call the callback
             this->callback(msg);
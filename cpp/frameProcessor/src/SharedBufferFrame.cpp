@@ -10,13 +10,17 @@ SharedBufferFrame::SharedBufferFrame(
     size_t nbytes,
     uint64_t bufferID,
     OdinData::IpcChannel* relCh,
-    const int& image_offset
+    const int& image_offset,
+    OdinData::SharedBufferNotifierPtr notifier,
+    OdinData::FrameNotifyBatchPtr release_batch
 ) :
     Frame(meta_data, nbytes, image_offset)
 {
     data_ptr_ = data_src;
     shared_id_ = bufferID;
     shared_channel_ = relCh;
+    notifier_ = notifier;
+    release_batch_ = release_batch;
 }
 
 /** Copy constructor;
@@ -29,6 +33,9 @@ SharedBufferFrame::SharedBufferFrame(const SharedBufferFrame& frame) :
     data_ptr_ = frame.data_ptr_;
     data_size_ = frame.data_size_;
     shared_id_ = frame.shared_id_;
+    shared_channel_ = frame.shared_channel_;
+    notifier_ = frame.notifier_;
+    release_batch_ = frame.release_batch_;
 }
 
 /** Destroy frame
@@ -36,6 +43,24 @@ SharedBufferFrame::SharedBufferFrame(const SharedBufferFrame& frame) :
  */
 SharedBufferFrame::~SharedBufferFrame()
 {
+    // If the frame receiver is using the shared memory rings, post the release to the release ring,
+    // falling back to a release message if the ring is full
+    if (notifier_
+        && notifier_->post(
+            OdinData::SharedBufferNotifier::ReleaseRing, shared_id_, meta_data_.get_frame_number()
+        )) {
+        return;
+    }
+
+    // If release notifications are batched, add the release to the batch, which is published once
+    // full or when its latency bound is reached
+    if (release_batch_ && release_batch_->enabled()) {
+        release_batch_->add(
+            static_cast<int>(meta_data_.get_frame_number()), static_cast<int>(shared_id_), *shared_channel_
+        );
+        return;
+    }
+
     OdinData::IpcMessage txMsg(OdinData::IpcMessage::MsgTypeNotify, OdinData::IpcMessage::MsgValNotifyFrameRelease);
     txMsg.set_param("frame", static_cast<uint64_t>(meta_data_.get_frame_number()));
     txMsg.set_param("buffer_id", shared_id_);
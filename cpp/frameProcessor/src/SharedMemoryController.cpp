@@ -5,6 +5,8 @@
  *      Author: gnx91527
  */
 
+#include <algorithm>
+
 #include "DebugLevelLogger.h"
 #include "EndOfAcquisitionFrame.h"
 #include "SharedBufferFrame.h"
@@ -35,6 +37,8 @@ SharedMemoryController::SharedMemoryController(
     reactor_(reactor),
     rxChannel_(ZMQ_SUB),
     txChannel_(ZMQ_PUB),
+    releaseBatch_(new OdinData::FrameNotifyBatch(OdinData::IpcMessage::MsgValNotifyFrameReleaseBatch)),
+    releaseBatchTimerId_(-1),
     sharedBufferConfigured_(false),
     sharedBufferConfigRequestDeferred_(false)
 {
@@ -54,8 +58,11 @@ SharedMemoryController::SharedMemoryController(
         throw std::runtime_error(e.what());
     }
 
-    // Add the Frame Ready channel to the reactor
-    reactor_->register_channel(rxChannel_, boost::bind(&SharedMemoryController::handleRxChannel, this));
+    // Add the Frame Ready channel to the reactor, draining pending notifications on each wakeup
+    reactor_->register_channel(
+        rxChannel_, boost::bind(&SharedMemoryController::handleRxChannel, this),
+        OdinData::IpcReactor::default_drain_budget
+    );
 
     // Now connect the frame release response channel
     try {
@@ -87,6 +94,12 @@ SharedMemoryController::~SharedMemoryController()
         it = callbacks_.erase(it);
     }
 
+    // Remove the frame ready ring doorbell from the reactor if present
+    this->removeNotifier();
+
+    // Publish any frame releases remaining in a partial batch and remove the batch flush timer
+    this->configureReleaseBatch(1, 0);
+
     // Close the IPC Channels
     reactor_->remove_channel(txChannel_);
     reactor_->remove_channel(rxChannel_);
@@ -95,23 +108,53 @@ SharedMemoryController::~SharedMemoryController()
 }
 
 /** setSharedBufferManager
- * Takes a name of shared buffer manager and initialises a SharedBufferManager object
+ * Takes a name of shared buffer manager and initialises a SharedBufferManager object. If the frame
+ * receiver has enabled frame notification through the shared memory rings, a SharedBufferNotifier is
+ * also created and the frame ready ring doorbell registered with the reactor. Should that fail, frame
+ * notifications continue to be exchanged over the IPC channels.
+ *
+ * The shared buffer is mapped with the same options as the frame receiver used to create it, so
+ * that a buffer backed by huge pages is found and locked and pre-faulted in this process too.
  *
  * \param[in] shared_buffer_name - name of the shared buffer manager
+ * \param[in] notify_ring - true if frame notifications are passed through the shared memory rings
+ * \param[in] options - options controlling how the shared buffer is mapped
  */
-void SharedMemoryController::setSharedBufferManager(const std::string& shared_buffer_name)
+void SharedMemoryController::setSharedBufferManager(
+    const std::string& shared_buffer_name,
+    const bool notify_ring,
+    const OdinData::SharedBufferManager::MappingOptions& options
+)
 {
 
     // Set configured status to false until the new shared buffer manager is initialised
     sharedBufferConfigured_ = false;
 
-    // Reset the shared buffer manager if already existing
+    // Remove any existing notifier and reset the shared buffer manager if already existing
+    this->removeNotifier();
     if (sbm_) {
         sbm_.reset();
     }
 
     // Create a new shared buffer manager
-    sbm_ = boost::shared_ptr<OdinData::SharedBufferManager>(new OdinData::SharedBufferManager(shared_buffer_name));
+    sbm_ = boost::shared_ptr<OdinData::SharedBufferManager>(
+        new OdinData::SharedBufferManager(shared_buffer_name, options)
+    );
+
+    // Connect to the frame notification rings if enabled
+    if (notify_ring) {
+        try {
+            notifier_.reset(new OdinData::SharedBufferNotifier(sbm_, false));
+            reactor_->register_socket(
+                notifier_->get_doorbell_fd(OdinData::SharedBufferNotifier::ReadyRing),
+                boost::bind(&SharedMemoryController::handleReadyRing, this)
+            );
+            LOG4CXX_DEBUG_LEVEL(1, logger_, "Frame notifications enabled through shared buffer rings");
+        } catch (OdinData::OdinDataException& e) {
+            LOG4CXX_ERROR(logger_, "Failed to connect to shared buffer frame notification rings: " << e.what());
+            notifier_.reset();
+        }
+    }
 
     // Set configured status to true
     sharedBufferConfigured_ = true;
@@ -177,38 +220,20 @@ void SharedMemoryController::handleRxChannel()
 
             int bufferID = rxMsg.get_param<int>("buffer_id", -1);
             if (bufferID != -1) {
-
-                if (sbm_) {
-
-                    // Create a frame object and copy in the raw frame data
-                    int frame_number = rxMsg.get_param<int>("frame", 0);
-
-                    FrameProcessor::FrameMetaData frame_meta(
-                        frame_number, "raw", FrameProcessor::raw_64bit, "", std::vector<unsigned long long>()
-                    );
-
-                    boost::shared_ptr<SharedBufferFrame> frame;
-                    frame = boost::shared_ptr<SharedBufferFrame>(new SharedBufferFrame(
-                        frame_meta, sbm_->get_buffer_address(bufferID), sbm_->get_buffer_size(), bufferID, &txChannel_
-                    ));
-
-                    // Loop over registered callbacks, placing the frame onto each queue
-                    std::map<std::string, boost::shared_ptr<IFrameCallback>>::iterator cbIter;
-                    for (cbIter = callbacks_.begin(); cbIter != callbacks_.end(); ++cbIter) {
-                        cbIter->second->getWorkQueue()->add(frame, true);
-                    }
-
-                } else {
-                    LOG4CXX_WARN(
-                        logger_,
-                        "RX thread got notification for buffer " << bufferID
-                                                                 << " with no shared buffer config - ignoring"
-                    );
-                }
-
+                this->dispatchFrame(bufferID, rxMsg.get_param<int>("frame", 0));
             } else {
                 LOG4CXX_ERROR(logger_, "RX thread received empty frame notification with buffer ID");
             }
+        } else if ((rxMsg.get_msg_type() == OdinData::IpcMessage::MsgTypeNotify)
+                   && (rxMsg.get_msg_val() == OdinData::IpcMessage::MsgValNotifyFrameReadyBatch)) {
+            OdinData::FrameNotifyBatch::FrameList frames;
+            if (OdinData::FrameNotifyBatch::decode(rxMsg, frames) == 0) {
+                LOG4CXX_ERROR(logger_, "RX thread received batched frame notification with no frames");
+            }
+            for (OdinData::FrameNotifyBatch::FrameList::iterator frame_iter = frames.begin();
+                 frame_iter != frames.end(); ++frame_iter) {
+                this->dispatchFrame(frame_iter->second, frame_iter->first);
+            }
         } else if ((rxMsg.get_msg_type() == OdinData::IpcMessage::MsgTypeNotify)
                    && (rxMsg.get_msg_val() == OdinData::IpcMessage::MsgValNotifyBufferConfig)) {
             try {
@@ -216,9 +241,21 @@ void SharedMemoryController::handleRxChannel()
                 LOG4CXX_DEBUG_LEVEL(
                     1, logger_, "Shared buffer config notification received for " << shared_buffer_name
                 );
-                this->setSharedBufferManager(shared_buffer_name);
+                bool notify_ring = rxMsg.get_param<bool>("frame_notify_ring", false);
+                OdinData::SharedBufferManager::MappingOptions options;
+                options.huge_page_dir = rxMsg.get_param<std::string>("huge_page_dir", "");
+                options.numa_node = rxMsg.get_param<int>("numa_node", -1);
+                options.lock_memory = rxMsg.get_param<bool>("lock_memory", false);
+                options.prefault = rxMsg.get_param<bool>("prefault", false);
+                this->setSharedBufferManager(shared_buffer_name, notify_ring, options);
+                this->configureReleaseBatch(
+                    rxMsg.get_param<unsigned int>("frame_release_batch", 1),
+                    rxMsg.get_param<unsigned int>("frame_release_batch_ms", 1)
+                );
             } catch (OdinData::IpcMessageException& e) {
                 LOG4CXX_ERROR(logger_, "Received shared buffer config notification with no name parameter");
+            } catch (OdinData::SharedBufferManagerException& e) {
+                LOG4CXX_ERROR(logger_, "Failed to map shared buffer: " << e.what());
             }
         } else {
             LOG4CXX_ERROR(logger_, "RX thread got unexpected message: " << rxMsgEncoded);
@@ -236,6 +273,108 @@ void SharedMemoryController::handleRxChannel()
     }
 }
 
+/** Called whenever the frame ready ring doorbell is signalled.
+ *
+ * Clears the doorbell and then takes all frame descriptors posted to the frame ready ring by the
+ * frame receiver, passing each frame to the registered callbacks.
+ */
+void SharedMemoryController::handleReadyRing()
+{
+    notifier_->clear_doorbell(OdinData::SharedBufferNotifier::ReadyRing);
+
+    OdinData::SharedBufferRing::Descriptor desc;
+    while (notifier_->take(OdinData::SharedBufferNotifier::ReadyRing, desc)) {
+        LOG4CXX_DEBUG_LEVEL(
+            1, logger_,
+            "Frame ready ring notification for frame " << desc.frame_number << " in buffer " << desc.buffer_id
+        );
+        this->dispatchFrame(desc.buffer_id, desc.frame_number);
+    }
+}
+
+/** Construct a frame for a ready shared buffer and pass it to the registered callbacks.
+ *
+ * The frame spans the length recorded for it in the shared buffer, which is the buffer size unless
+ * the frame receiver allocates variable-length frames as runs of blocks starting at the buffer.
+ * The frame is released back to the frame receiver when the last reference to it is destroyed.
+ *
+ * \param[in] bufferID - ID of the shared buffer containing the frame.
+ * \param[in] frame_number - frame number.
+ */
+void SharedMemoryController::dispatchFrame(int bufferID, int frame_number)
+{
+    if (sbm_) {
+
+        // Create a frame object referencing the raw frame data
+        FrameProcessor::FrameMetaData frame_meta(
+            frame_number, "raw", FrameProcessor::raw_64bit, "", std::vector<unsigned long long>()
+        );
+
+        boost::shared_ptr<SharedBufferFrame> frame;
+        frame = boost::shared_ptr<SharedBufferFrame>(new SharedBufferFrame(
+            frame_meta, sbm_->get_buffer_address(bufferID), sbm_->get_frame_length(bufferID), bufferID, &txChannel_,
+            0, notifier_, releaseBatch_
+        ));
+
+        // Loop over registered callbacks, placing the frame onto each queue
+        std::map<std::string, boost::shared_ptr<IFrameCallback>>::iterator cbIter;
+        for (cbIter = callbacks_.begin(); cbIter != callbacks_.end(); ++cbIter) {
+            cbIter->second->getWorkQueue()->add(frame, true);
+        }
+
+    } else {
+        LOG4CXX_WARN(
+            logger_, "RX thread got notification for buffer " << bufferID << " with no shared buffer config - ignoring"
+        );
+    }
+}
+
+/** Remove the frame ready ring doorbell from the reactor and release the notifier.
+ */
+void SharedMemoryController::removeNotifier()
+{
+    if (notifier_) {
+        reactor_->remove_socket(notifier_->get_doorbell_fd(OdinData::SharedBufferNotifier::ReadyRing));
+        notifier_.reset();
+    }
+}
+
+/** Configure batching of frame release notifications.
+ *
+ * Any releases pending in the current batch are published before the batch is reconfigured. When
+ * batching is enabled, a reactor timer is registered to publish partial batches within the latency
+ * bound, so that releases are not held when frames stop arriving.
+ *
+ * \param[in] max_frames - maximum number of frames per release notification, 1 to disable batching
+ * \param[in] max_latency_ms - maximum time in ms a release is held in a batch
+ */
+void SharedMemoryController::configureReleaseBatch(unsigned int max_frames, unsigned int max_latency_ms)
+{
+    if (releaseBatchTimerId_ != -1) {
+        reactor_->remove_timer(releaseBatchTimerId_);
+        releaseBatchTimerId_ = -1;
+    }
+    releaseBatch_->flush(txChannel_);
+    releaseBatch_->configure(max_frames, max_latency_ms);
+
+    if (releaseBatch_->enabled()) {
+        releaseBatchTimerId_ = reactor_->register_timer(
+            std::max(max_latency_ms, 1U), 0, boost::bind(&SharedMemoryController::flushReleaseBatch, this)
+        );
+        LOG4CXX_DEBUG_LEVEL(
+            1, logger_,
+            "Frame release notifications batched up to " << max_frames << " frames within " << max_latency_ms << "ms"
+        );
+    }
+}
+
+/** Publish any frame release notifications pending in the current batch.
+ */
+void SharedMemoryController::flushReleaseBatch()
+{
+    releaseBatch_->flush(txChannel_);
+}
+
 /** Register a callback for Frame updates with this class.
  *
  * The callback (IFrameCallback subclass) is added to the map of callbacks, indexed
@@ -284,6 +423,12 @@ void SharedMemoryController::status(OdinData::IpcMessage& status)
 {
     // Set status parameters in the status message
     status.set_param(SharedMemoryController::SHARED_MEMORY_CONTROLLER_NAME + "/configured", sharedBufferConfigured_);
+
+    // Add the frame ready channel batching statistics
+    OdinData::IpcReactorChannelStats stats = reactor_->get_channel_stats(rxChannel_);
+    status.set_param(SharedMemoryController::SHARED_MEMORY_CONTROLLER_NAME + "/frame_ready/wakeups", stats.wakeups);
+    status.set_param(SharedMemoryController::SHARED_MEMORY_CONTROLLER_NAME + "/frame_ready/messages", stats.messages);
+    status.set_param(SharedMemoryController::SHARED_MEMORY_CONTROLLER_NAME + "/frame_ready/max_batch", stats.max_batch);
 }
 
 /**
@@ -16,7 +16,6 @@ namespace FrameProcessor {
 
 WatchdogTimer::WatchdogTimer(const boost::function<void(const std::string&)>& timeout_callback) :
     worker_thread_running_(false),
-    worker_thread_(boost::bind(&WatchdogTimer::run, this)),
     timeout_callback_(timeout_callback),
     timer_id_(0),
     is_valid_id_(false),
@@ -24,6 +23,9 @@ WatchdogTimer::WatchdogTimer(const boost::function<void(const std::string&)>& ti
 {
     this->logger_ = Logger::getLogger("FP.WatchdogTimer");
 
+    // Start the worker thread only once all members, including the reactor it runs, are constructed
+    worker_thread_ = boost::thread(boost::bind(&WatchdogTimer::run, this));
+
     // Wait until worker thread is ready before returning
     while (!worker_thread_running_) { }
 
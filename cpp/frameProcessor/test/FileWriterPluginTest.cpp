@@ -1,6 +1,8 @@
 #define BOOST_TEST_MODULE "FileWriterPluginTests"
 #define BOOST_TEST_MAIN
 
+#include <boost/filesystem.hpp>
+
 #include "Fixtures.h"
 
 BOOST_GLOBAL_FIXTURE(GlobalConfig);
@@ -164,4 +166,121 @@ BOOST_AUTO_TEST_CASE(FileWriterPluginMetadataTimestampUpdate)
     BOOST_CHECK(second_ts > first_ts);
 }
 
+BOOST_AUTO_TEST_CASE(FileWriterPluginWriteBehind)
+{
+    OdinData::IpcMessage reply;
+    FrameProcessor::FileWriterPlugin fwp;
+    fwp.set_name("hdf");
+
+    rapidjson::Document config_doc;
+    config_doc.Parse(
+        "{\"file\": {\"path\": \"/tmp/\", \"prefix\": \"write_behind_test\"}, \"frames\": 10, \"write_behind\": 4,"
+        " \"dataset\": {\"data\": {\"datatype\": \"uint16\", \"dims\": [3, 4], \"chunks\": [1, 3, 4]}}}"
+    );
+    OdinData::IpcMessage cfg(config_doc);
+    BOOST_REQUIRE_NO_THROW(fwp.configure(cfg, reply));
+    OdinData::IpcMessage config_reply;
+    fwp.requestConfiguration(config_reply);
+    BOOST_CHECK_EQUAL(4, config_reply.get_param<int>("hdf/write_behind"));
+
+    fwp.execute(FrameProcessor::FileWriterPlugin::START_WRITING, reply);
+    fwp.start();
+
+    // Keep only weak references, so that the frames are released once written
+    std::vector<boost::weak_ptr<FrameProcessor::Frame>> written;
+    unsigned short img[12] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 };
+    dimensions_t img_dims(2);
+    img_dims[0] = 3;
+    img_dims[1] = 4;
+    for (int i = 0; i < 10; i++) {
+        FrameProcessor::FrameMetaData frame_meta(
+            i, "data", FrameProcessor::raw_16bit, "", img_dims, FrameProcessor::no_compression
+        );
+        boost::shared_ptr<FrameProcessor::Frame> frame(
+            new FrameProcessor::DataBlockFrame(frame_meta, static_cast<void*>(img), 24)
+        );
+        written.push_back(frame);
+        fwp.getWorkQueue()->add(frame);
+    }
+
+    // The acquisition stops once the last frame has been written
+    OdinData::IpcMessage status;
+    for (int i = 0; i < 500; i++) {
+        status = OdinData::IpcMessage();
+        fwp.status(status);
+        if (!status.get_param<bool>("hdf/writing")) {
+            break;
+        }
+        usleep(10000);
+    }
+    fwp.stop();
+    BOOST_CHECK(!status.get_param<bool>("hdf/writing"));
+    BOOST_CHECK_EQUAL(10, status.get_param<int>("hdf/frames_written"));
+    BOOST_CHECK_EQUAL(0, status.get_param<int>("hdf/write_behind/queued_frames"));
+    BOOST_CHECK_EQUAL(0, status.get_param<int>("hdf/write_behind/queued_bytes"));
+    BOOST_CHECK_GE(status.get_param<int>("hdf/write_behind/max_queued_bytes"), 24);
+    for (int i = 0; i < 10; i++) {
+        BOOST_CHECK(written[i].expired());
+    }
+
+    // The depth cannot be changed whilst writing, but can be returned to synchronous writing when stopped
+    cfg = OdinData::IpcMessage();
+    cfg.set_param(FrameProcessor::FileWriterPlugin::CONFIG_WRITE_BEHIND, 0);
+    BOOST_REQUIRE_NO_THROW(fwp.configure(cfg, reply));
+}
+
+#ifdef H5_HAVE_THREADSAFE
+BOOST_AUTO_TEST_CASE(FileWriterPluginPreCreateFiles)
+{
+    OdinData::IpcMessage reply;
+    FrameProcessor::FileWriterPlugin fwp;
+    fwp.set_name("hdf");
+
+    const char* filenames[] = { "/tmp/pre_create_test_000000.h5", "/tmp/pre_create_test_000001.h5",
+                                "/tmp/pre_create_test_000002.h5", "/tmp/pre_create_test_000003.h5" };
+    for (int i = 0; i < 4; i++) {
+        boost::filesystem::remove(filenames[i]);
+    }
+
+    rapidjson::Document config_doc;
+    config_doc.Parse(
+        "{\"file\": {\"path\": \"/tmp/\", \"prefix\": \"pre_create_test\", \"pre_create\": true},"
+        " \"process\": {\"frames_per_block\": 2, \"blocks_per_file\": 1}, \"frames\": 6, \"acquisition_id\": \"test\","
+        " \"dataset\": {\"data\": {\"datatype\": \"uint16\", \"dims\": [3, 4], \"chunks\": [1, 3, 4]}}}"
+    );
+    OdinData::IpcMessage cfg(config_doc);
+    BOOST_REQUIRE_NO_THROW(fwp.configure(cfg, reply));
+    OdinData::IpcMessage config_reply;
+    fwp.requestConfiguration(config_reply);
+    BOOST_CHECK(config_reply.get_param<bool>("hdf/file/pre_create"));
+
+    fwp.execute(FrameProcessor::FileWriterPlugin::START_WRITING, reply);
+    fwp.start();
+
+    // Each file rollover should find the file already created by the file thread
+    for (int i = 0; i < 6; i++) {
+        fwp.getWorkQueue()->add(frames[i]);
+    }
+
+    OdinData::IpcMessage status;
+    for (int i = 0; i < 500; i++) {
+        status = OdinData::IpcMessage();
+        fwp.status(status);
+        if (!status.get_param<bool>("hdf/writing")) {
+            break;
+        }
+        usleep(10000);
+    }
+    fwp.stop();
+    BOOST_CHECK(!status.get_param<bool>("hdf/writing"));
+    BOOST_CHECK_EQUAL(6, status.get_param<int>("hdf/frames_written"));
+
+    // Only the files that frames were written to remain
+    for (int i = 0; i < 3; i++) {
+        BOOST_CHECK(boost::filesystem::exists(filenames[i]));
+    }
+    BOOST_CHECK(!boost::filesystem::exists(filenames[3]));
+}
+#endif
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -65,6 +65,83 @@ BOOST_AUTO_TEST_CASE(HDF5FileMultiDatasetTest)
     BOOST_REQUIRE_NO_THROW(hdf5f.close_file());
 }
 
+BOOST_AUTO_TEST_CASE(HDF5FileFlushPolicyTest)
+{
+    FrameProcessor::HDF5FlushPolicy_t flush_policy;
+    std::stringstream ss;
+
+    // Flush every 4 frames, with the remaining frames flushed before the file is closed
+    FrameProcessor::HDF5File hdf5f(hdf5_error_definition);
+    ss << "/tmp/blah_flush_frames_pid" << getpid() << ".h5";
+    BOOST_REQUIRE_NO_THROW(hdf5f.create_file(ss.str(), 0, false, 1, 1));
+    BOOST_REQUIRE_NO_THROW(hdf5f.create_dataset(dset_def, -1, -1));
+    flush_policy.frames = 4;
+    flush_policy.period = 0;
+    hdf5f.set_flush_policy(flush_policy);
+    for (int i = 0; i < 10; i++) {
+        BOOST_REQUIRE_NO_THROW(hdf5f.write_frame(*frames[i], i, 1, durations));
+    }
+    BOOST_CHECK_EQUAL(durations.flushes, 2);
+    BOOST_REQUIRE_NO_THROW(hdf5f.flush_datasets(durations));
+    BOOST_CHECK_EQUAL(durations.flushes, 3);
+    BOOST_REQUIRE_NO_THROW(hdf5f.flush_datasets(durations));
+    BOOST_CHECK_EQUAL(durations.flushes, 3);
+    BOOST_REQUIRE_NO_THROW(hdf5f.close_file());
+
+    // Only flush when the file is closed
+    FrameProcessor::HDF5File hdf5f_close(hdf5_error_definition);
+    ss.str("");
+    ss << "/tmp/blah_flush_close_pid" << getpid() << ".h5";
+    BOOST_REQUIRE_NO_THROW(hdf5f_close.create_file(ss.str(), 0, false, 1, 1));
+    BOOST_REQUIRE_NO_THROW(hdf5f_close.create_dataset(dset_def, -1, -1));
+    flush_policy.frames = 0;
+    hdf5f_close.set_flush_policy(flush_policy);
+    for (int i = 0; i < 10; i++) {
+        BOOST_REQUIRE_NO_THROW(hdf5f_close.write_frame(*frames[i], i, 1, durations));
+    }
+    BOOST_CHECK_EQUAL(durations.flushes, 3);
+    BOOST_REQUIRE_NO_THROW(hdf5f_close.flush_datasets(durations));
+    BOOST_CHECK_EQUAL(durations.flushes, 4);
+    BOOST_REQUIRE_NO_THROW(hdf5f_close.close_file());
+}
+
+BOOST_AUTO_TEST_CASE(HDF5FileDefaultFlushPolicyTest)
+{
+    FrameProcessor::HDF5File hdf5f(hdf5_error_definition);
+    FrameProcessor::HDF5CallDurations_t call_durations;
+    std::stringstream ss;
+    ss << "/tmp/blah_flush_default_pid" << getpid() << ".h5";
+    BOOST_REQUIRE_NO_THROW(hdf5f.create_file(ss.str(), 0, false, 1, 1));
+    BOOST_REQUIRE_NO_THROW(hdf5f.create_dataset(dset_def, -1, -1));
+
+    FrameProcessor::DatasetDefinition param_dset_def;
+    param_dset_def.name = "p1";
+    param_dset_def.data_type = FrameProcessor::raw_64bit;
+    param_dset_def.num_frames = 10;
+    dimensions_t chunk_dims(1);
+    chunk_dims[0] = 10;
+    param_dset_def.chunks = chunk_dims;
+    param_dset_def.compression = FrameProcessor::no_compression;
+    BOOST_REQUIRE_NO_THROW(hdf5f.create_dataset(param_dset_def, -1, -1));
+
+    // Frame datasets are flushed after every write, parameter datasets at most once a second
+    for (int i = 0; i < 10; i++) {
+        BOOST_REQUIRE_NO_THROW(hdf5f.write_frame(*frames[i], i, 1, call_durations));
+    }
+    BOOST_CHECK_EQUAL(call_durations.flushes, 10);
+    for (int i = 0; i < 10; i++) {
+        uint64_t val = i;
+        frames[i]->meta_data().set_parameter("p1", val);
+        BOOST_REQUIRE_NO_THROW(hdf5f.write_parameter(*frames[i], param_dset_def, i, call_durations));
+    }
+    BOOST_CHECK_EQUAL(call_durations.flushes, 10);
+
+    // The parameter dataset is flushed before the file is closed
+    BOOST_REQUIRE_NO_THROW(hdf5f.flush_datasets(call_durations));
+    BOOST_CHECK_EQUAL(call_durations.flushes, 11);
+    BOOST_REQUIRE_NO_THROW(hdf5f.close_file());
+}
+
 BOOST_AUTO_TEST_CASE(HDF5FileBadFileTest)
 {
     FrameProcessor::HDF5File hdf5f(hdf5_error_definition);
@@ -209,12 +286,57 @@ BOOST_AUTO_TEST_CASE(FileWriterPluginWriteParamTest)
     for (it = frames.begin(); it != frames.end(); ++it) {
         (*it)->meta_data().set_parameter("p1", val);
         BOOST_TEST_MESSAGE("Writing frame: " << (*it)->get_frame_number());
-        BOOST_REQUIRE_NO_THROW(hdf5f.write_parameter(*(*it), param_dset_def, (*it)->get_frame_number()));
+        BOOST_REQUIRE_NO_THROW(hdf5f.write_parameter(*(*it), param_dset_def, (*it)->get_frame_number(), durations));
         val++;
     }
     BOOST_REQUIRE_NO_THROW(hdf5f.close_file());
 }
 
+BOOST_AUTO_TEST_CASE(FileWriterPluginWriteParamBufferTest)
+{
+    FrameProcessor::HDF5File hdf5f(hdf5_error_definition);
+
+    // Use the PID to ensure file created has a unique name
+    std::stringstream ss;
+    ss << "/tmp/test_write_param_buffer_pid" << getpid() << ".h5";
+    BOOST_REQUIRE_NO_THROW(hdf5f.create_file(ss.str(), 0, false, 1, 1));
+
+    FrameProcessor::DatasetDefinition param_dset_def;
+    param_dset_def.name = "p1";
+    param_dset_def.data_type = FrameProcessor::raw_64bit;
+    param_dset_def.num_frames = 10;
+    dimensions_t chunk_dims(1);
+    chunk_dims[0] = 4;
+    param_dset_def.chunks = chunk_dims;
+    param_dset_def.compression = FrameProcessor::no_compression;
+    BOOST_REQUIRE_NO_THROW(hdf5f.create_dataset(param_dset_def, -1, -1));
+
+    // With the default flush policy values are buffered and written when they fill a chunk or are
+    // out of sequence, rather than for every frame
+    FrameProcessor::HDF5CallDurations_t call_durations;
+    int offsets[10] = { 0, 1, 2, 3, 4, 7, 5, 6, 8, 9 };
+    for (int i = 0; i < 10; i++) {
+        uint64_t val = offsets[i] * 10;
+        frames[i]->meta_data().set_parameter("p1", val);
+        BOOST_REQUIRE_NO_THROW(hdf5f.write_parameter(*frames[i], param_dset_def, offsets[i], call_durations));
+    }
+    BOOST_CHECK_EQUAL(call_durations.flushes, 0);
+    BOOST_REQUIRE_NO_THROW(hdf5f.close_file());
+
+    // Read back the values to check every buffered value was written to its offset
+    uint64_t values[10];
+    hid_t file_id = H5Fopen(ss.str().c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+    BOOST_REQUIRE(file_id >= 0);
+    hid_t dataset_id = H5Dopen2(file_id, "p1", H5P_DEFAULT);
+    BOOST_REQUIRE(dataset_id >= 0);
+    BOOST_REQUIRE(H5Dread(dataset_id, H5T_NATIVE_UINT64, H5S_ALL, H5S_ALL, H5P_DEFAULT, values) >= 0);
+    H5Dclose(dataset_id);
+    H5Fclose(file_id);
+    for (int i = 0; i < 10; i++) {
+        BOOST_CHECK_EQUAL(values[i], i * 10);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(FileWriterPluginWriteParamWrongTypeTest)
 {
     FrameProcessor::HDF5File hdf5f(hdf5_error_definition);
@@ -240,7 +362,9 @@ BOOST_AUTO_TEST_CASE(FileWriterPluginWriteParamWrongTypeTest)
         uint64_t val = 123;
         (*it)->meta_data().set_parameter("p1", val);
         BOOST_TEST_MESSAGE("Writing frame: " << (*it)->get_frame_number());
-        BOOST_CHECK_THROW(hdf5f.write_parameter(*(*it), param_dset_def, (*it)->get_frame_number()), std::runtime_error);
+        BOOST_CHECK_THROW(
+            hdf5f.write_parameter(*(*it), param_dset_def, (*it)->get_frame_number(), durations), std::runtime_error
+        );
     }
     BOOST_REQUIRE_NO_THROW(hdf5f.close_file());
 }
@@ -270,7 +394,9 @@ BOOST_AUTO_TEST_CASE(FileWriterPluginWriteParamNoParamTest)
         uint64_t val = 123;
         (*it)->meta_data().set_parameter("p2", val);
         BOOST_TEST_MESSAGE("Writing frame: " << (*it)->get_frame_number());
-        BOOST_CHECK_THROW(hdf5f.write_parameter(*(*it), param_dset_def, (*it)->get_frame_number()), std::runtime_error);
+        BOOST_CHECK_THROW(
+            hdf5f.write_parameter(*(*it), param_dset_def, (*it)->get_frame_number(), durations), std::runtime_error
+        );
     }
     BOOST_REQUIRE_NO_THROW(hdf5f.close_file());
 }
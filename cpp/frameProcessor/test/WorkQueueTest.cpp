@@ -0,0 +1,148 @@
+#define BOOST_TEST_MODULE "WorkQueueTests"
+#define BOOST_TEST_MAIN
+
+#include <boost/thread.hpp>
+
+#include "Fixtures.h"
+
+#include "BoundedWorkQueue.h"
+
+BOOST_GLOBAL_FIXTURE(GlobalConfig);
+
+typedef boost::shared_ptr<int> Item;
+
+void produce_items(boost::shared_ptr<FrameProcessor::WorkQueue<Item>> queue, int producer, int num_items)
+{
+    for (int i = 0; i < num_items; i++) {
+        queue->add(Item(new int(producer * num_items + i)));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(WorkQueueUnitTest);
+
+BOOST_AUTO_TEST_CASE(ListQueueDepthTest)
+{
+    FrameProcessor::WorkQueue<Item> queue(4);
+    BOOST_CHECK_EQUAL(queue.max_size(), 4);
+    BOOST_CHECK(!queue.single_producer());
+    for (int i = 0; i < 4; i++) {
+        queue.add(Item(new int(i)));
+    }
+    BOOST_CHECK_EQUAL(queue.size(), 4);
+    for (int i = 0; i < 4; i++) {
+        BOOST_CHECK_EQUAL(*queue.remove(), i);
+    }
+    BOOST_CHECK_EQUAL(queue.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(BoundedQueueSingleProducerTest)
+{
+    FrameProcessor::BoundedWorkQueue<Item> queue(6, false);
+    BOOST_CHECK_EQUAL(queue.max_size(), 8);
+    BOOST_CHECK(queue.single_producer());
+
+    // Wrap around the ring several times, checking items are removed in order
+    int next_item = 0;
+    for (int pass = 0; pass < 5; pass++) {
+        for (int i = 0; i < 8; i++) {
+            queue.add(Item(new int(pass * 8 + i)));
+        }
+        BOOST_CHECK_EQUAL(queue.size(), 8);
+        for (int i = 0; i < 8; i++) {
+            BOOST_CHECK_EQUAL(*queue.remove(), next_item++);
+        }
+        BOOST_CHECK_EQUAL(queue.size(), 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(BoundedQueueOverflowTest)
+{
+    FrameProcessor::BoundedWorkQueue<Item> queue(4, false);
+
+    // Adding beyond the depth with the limit ignored must not block, and order must be preserved
+    for (int i = 0; i < 10; i++) {
+        queue.add(Item(new int(i)), true);
+    }
+    BOOST_CHECK_EQUAL(queue.size(), 10);
+    for (int i = 0; i < 3; i++) {
+        BOOST_CHECK_EQUAL(*queue.remove(), i);
+    }
+    queue.add(Item(new int(10)), true);
+    for (int i = 3; i < 11; i++) {
+        BOOST_CHECK_EQUAL(*queue.remove(), i);
+    }
+    BOOST_CHECK_EQUAL(queue.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(BoundedQueueInterruptTest)
+{
+    FrameProcessor::BoundedWorkQueue<Item> queue(4, false, 100);
+    boost::thread interrupter(boost::bind(&FrameProcessor::WorkQueue<Item>::interrupt, &queue));
+    BOOST_CHECK(!queue.remove());
+    interrupter.join();
+    BOOST_CHECK_EQUAL(queue.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(BoundedQueueMultipleProducerTest)
+{
+    const int num_producers = 4;
+    const int num_items = 10000;
+    boost::shared_ptr<FrameProcessor::WorkQueue<Item>> queue(new FrameProcessor::BoundedWorkQueue<Item>(8, true, 50));
+
+    boost::thread_group producers;
+    for (int producer = 0; producer < num_producers; producer++) {
+        producers.create_thread(boost::bind(produce_items, queue, producer, num_items));
+    }
+
+    // Every item must be received exactly once, in order for each producer
+    std::vector<int> next_item(num_producers, 0);
+    for (int i = 0; i < num_producers * num_items; i++) {
+        Item item = queue->remove();
+        BOOST_REQUIRE(item);
+        int producer = *item / num_items;
+        BOOST_CHECK_EQUAL(*item % num_items, next_item[producer]);
+        next_item[producer]++;
+    }
+    producers.join_all();
+
+    for (int producer = 0; producer < num_producers; producer++) {
+        BOOST_CHECK_EQUAL(next_item[producer], num_items);
+    }
+    BOOST_CHECK_EQUAL(queue->size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(QueueStatsTest)
+{
+    boost::shared_ptr<FrameProcessor::WorkQueue<Item>> queues[]
+        = { boost::shared_ptr<FrameProcessor::WorkQueue<Item>>(new FrameProcessor::WorkQueue<Item>(2)),
+            boost::shared_ptr<FrameProcessor::WorkQueue<Item>>(new FrameProcessor::BoundedWorkQueue<Item>(2, false)) };
+
+    for (int q = 0; q < 2; q++) {
+        boost::shared_ptr<FrameProcessor::WorkQueue<Item>> queue = queues[q];
+
+        // Fill the queue and then add a further item from another thread, which blocks until
+        // an item is removed
+        queue->add(Item(new int(0)));
+        queue->add(Item(new int(1)));
+        boost::thread producer(boost::bind(produce_items, queue, 2, 1));
+        boost::this_thread::sleep(boost::posix_time::milliseconds(20));
+        for (int i = 0; i < 3; i++) {
+            BOOST_CHECK(queue->remove());
+        }
+        producer.join();
+
+        FrameProcessor::WorkQueueStats stats = queue->get_stats();
+        BOOST_CHECK_EQUAL(stats.high_water_mark_, 2);
+        BOOST_CHECK_GE(stats.wait_.max_, 10000);
+        BOOST_CHECK_GE(stats.blocked_.max_, 10000);
+        BOOST_CHECK_GT(stats.blocked_.last_, 0);
+
+        queue->reset_stats();
+        stats = queue->get_stats();
+        BOOST_CHECK_EQUAL(stats.high_water_mark_, 0);
+        BOOST_CHECK_EQUAL(stats.wait_.max_, 0);
+        BOOST_CHECK_EQUAL(stats.blocked_.max_, 0);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END(); // WorkQueueUnitTest
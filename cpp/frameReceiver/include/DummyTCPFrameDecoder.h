@@ -37,6 +37,7 @@ public:
 
     void* get_next_message_buffer(void);
     const size_t get_next_message_size(void) const;
+    size_t get_next_message_iov(struct iovec* iov, size_t max_iov);
     FrameDecoder::FrameReceiveState process_message(size_t bytes_received);
 
     const size_t get_frame_buffer_size(void) const;
@@ -14,7 +14,7 @@
 #include <time.h>
 
 #include "DummyUDPDefinitions.h"
-#include "FrameDecoderUDP.h"
+#include "FrameDecoderUDPSpecialised.h"
 
 namespace FrameReceiver {
 
@@ -26,7 +26,7 @@ namespace DummyUdpFrameDecoderDefaults {
     const unsigned int default_udp_packet_size = DummyUDP::default_packet_size;
 }
 
-class DummyUDPFrameDecoder : public FrameDecoderUDP {
+class DummyUDPFrameDecoder final : public FrameDecoderUDPSpecialised<DummyUDPFrameDecoder> {
 public:
     DummyUDPFrameDecoder();
     ~DummyUDPFrameDecoder();
@@ -59,6 +59,9 @@ public:
     size_t get_next_payload_size(void) const;
     FrameDecoder::FrameReceiveState process_packet(size_t bytes_received, int port, struct sockaddr_in* from_addr);
 
+    const size_t get_max_payload_size(void) const;
+    void* get_predicted_payload_buffer(std::size_t packets_ahead) const;
+
     void monitor_buffers(void);
     void get_status(const std::string param_prefix, OdinData::IpcMessage& status_msg);
     void reset_statistics(void);
@@ -68,9 +71,11 @@ public:
     uint32_t get_frame_number(void) const;
     uint32_t get_packet_number(void) const;
 
+protected:
+    void frame_timedout(int frame, int buffer_id);
+
 private:
     void initialise_frame_header(DummyUDP::FrameHeader* header_ptr);
-    unsigned int elapsed_ms(struct timespec& start, struct timespec& end);
 
     unsigned int udp_packets_per_frame_;
     std::size_t udp_packet_size_;
@@ -86,10 +91,14 @@ private:
     std::size_t num_active_fems_;
 
     bool dropping_frame_data_;
+    bool current_packet_is_new_;
     uint32_t packets_received_;
     uint32_t packets_lost_;
     uint32_t packets_dropped_;
 };
 
+// The receive loop is instantiated with the packet handling methods, so that they can be inlined
+extern template class FrameDecoderUDPReceiveLoop<DummyUDPFrameDecoder>;
+
 } // namespace FrameReceiver
 #endif /* INCLUDE_DUMMYFRAMEDECODERUDP_H_ */
@@ -8,6 +8,7 @@
 #ifndef INCLUDE_FRAMEDECODER_H_
 #define INCLUDE_FRAMEDECODER_H_
 
+#include <deque>
 #include <map>
 #include <queue>
 
@@ -23,15 +24,20 @@ using namespace log4cxx;
 using namespace log4cxx::helpers;
 #include <DebugLevelLogger.h>
 
+#include "FrameSlotTable.h"
+#include "FrameSpillPool.h"
+#include "FrameTimeoutQueue.h"
 #include "IVersionedObject.h"
 #include "IpcMessage.h"
 #include "OdinDataException.h"
+#include "SharedBufferAllocator.h"
 #include "SharedBufferManager.h"
 
 namespace FrameReceiver {
 
 const std::string CONFIG_DECODER_ENABLE_PACKET_LOGGING = "enable_packet_logging";
 const std::string CONFIG_DECODER_FRAME_TIMEOUT_MS = "frame_timeout_ms";
+const std::string CONFIG_DECODER_SPILL_POOL_FRAMES = "spill_pool_frames";
 
 class FrameDecoderException : public OdinData::OdinDataException {
 public:
@@ -42,6 +48,7 @@ public:
 typedef boost::function<void(int, int)> FrameReadyCallback;
 typedef std::queue<int> EmptyBufferQueue;
 typedef std::map<int, int> FrameBufferMap;
+typedef std::deque<std::pair<int, int>> PendingFrameQueue;
 
 class FrameDecoder : public OdinData::IVersionedObject {
 public:
@@ -72,14 +79,31 @@ public:
     const size_t get_num_mapped_buffers(void) const;
     void drop_all_buffers(void);
     const unsigned int get_frame_timeout_ms(void) const;
+    const unsigned int get_frame_expiry_period_ms(void) const;
     const unsigned int get_num_frames_timedout(void) const;
     const unsigned int get_num_frames_dropped(void) const;
+    const size_t get_spill_pool_size(void) const;
+    const size_t get_num_spilled_buffers(void) const;
+    const size_t get_spill_pool_peak(void) const;
+    const unsigned int get_num_frames_spilled(void) const;
+    const unsigned int get_num_frames_unspilled(void) const;
     virtual void monitor_buffers(void) = 0;
+    void expire_frames(void);
     virtual void get_status(const std::string param_prefix, OdinData::IpcMessage& status_msg) = 0;
     void version(const std::string param_prefix, OdinData::IpcMessage& status);
     virtual void reset_statistics(void);
 
+    //! Number of expiry checks per frame timeout period, setting the timeout granularity
+    static const unsigned int frame_expiry_divisions = 10;
+
 protected:
+    bool get_empty_buffer(int& buffer_id);
+    void* get_frame_buffer_address(int buffer_id) const;
+    void set_frame_length(int buffer_id, size_t length);
+    void start_frame_timeout(int frame, int buffer_id);
+    void cancel_frame_timeout(int buffer_id);
+    virtual void frame_timedout(int frame, int buffer_id);
+
     LoggerPtr logger_; //!< Pointer to the logging facility
 
     bool enable_packet_logging_; //!< Flag to enable packet logging by decoder
@@ -87,13 +111,35 @@ protected:
 
     OdinData::SharedBufferManagerPtr buffer_manager_; //!< Pointer to the shared buffer manager
     FrameReadyCallback ready_callback_; //!< Callback for frames ready to be processed
+    FrameReadyCallback notify_callback_; //!< Callback notifying ready frames in shared buffers downstream
 
     EmptyBufferQueue empty_buffer_queue_; //!< Queue of empty buffers ready for use
     FrameBufferMap frame_buffer_map_; //!< Map of buffers currently receiving frame data
+    FrameSlotTable frame_slot_table_; //!< Table of buffers currently receiving frame data, sized from the buffer count
+    FrameTimeoutQueue frame_timeout_queue_; //!< Deadline queue of frames registered for timeout
+
+    bool variable_frames_; //!< Frames are allocated as runs of blocks in the shared buffer
+    OdinData::SharedBufferAllocator block_allocator_; //!< Allocator of shared buffer blocks for variable-length frames
+    size_t frame_blocks_; //!< Number of shared buffer blocks allocated to receive a frame into
+
+    FrameSpillPool spill_pool_; //!< Pool of buffers to receive frames into when shared buffers are exhausted
+    unsigned int spill_pool_frames_; //!< Number of frames the spill pool is configured to hold
+    int spill_buffer_base_; //!< Buffer ID of the first spill pool buffer, following the shared buffer IDs
+    PendingFrameQueue pending_frames_; //!< Ready frames held back until spilled frames ahead can be notified
+    unsigned int frames_spilled_; //!< Number of frames received into the spill pool
+    unsigned int frames_unspilled_; //!< Number of spilled frames copied back into shared buffers
+    std::vector<size_t> spill_frame_lengths_; //!< Length of the frame held in each spill pool buffer
 
     unsigned int frame_timeout_ms_; //!< Incomplete frame timeout in ms
     unsigned int frames_timedout_; //!< Number of frames timed out in decoder
     unsigned int frames_dropped_; //!< Number of frames dropped due to lack of buffers
+
+private:
+    void frame_ready(int buffer_id, int frame);
+    void release_pending_frames(void);
+    bool take_shared_buffer(size_t length, int& buffer_id);
+    void reset_spill_pool(void);
+    bool is_spill_buffer(int buffer_id) const;
 };
 
 inline FrameDecoder::~FrameDecoder() { };
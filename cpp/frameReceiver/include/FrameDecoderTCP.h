@@ -14,6 +14,7 @@
 #include <netinet/in.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <sys/uio.h>
 
 #include <boost/function.hpp>
 #include <boost/shared_ptr.hpp>
@@ -38,6 +39,34 @@ public:
 
     virtual FrameReceiveState process_message(size_t bytes_received) = 0;
 
+    //! Get the buffer locations the next message should be received into.
+    //!
+    //! The default returns the single buffer given by get_next_message_buffer(). Decoders which
+    //! place a message header and its payload in different locations, e.g. the payload directly in
+    //! the frame buffer after the frame header, override this to return one vector per location so
+    //! that the RX thread receives the message into them with readv().
+    //!
+    //! \param[out] iov - array of I/O vectors to fill
+    //! \param[in] max_iov - number of vectors in the array
+    //! \return - number of vectors filled
+    //!
+    virtual size_t get_next_message_iov(struct iovec* iov, size_t max_iov)
+    {
+        iov[0].iov_base = get_next_message_buffer();
+        iov[0].iov_len = get_next_message_size();
+        return 1;
+    }
+
+    //! Select the connection that following calls to the decoder relate to.
+    //!
+    //! The TCP RX thread calls this before requesting buffers for, or processing, each message
+    //! when it is receiving on more than one connection. Decoders assembling frames from several
+    //! concurrent connections override this to keep their message state per connection.
+    //!
+    //! \param[in] connection_id - identifier of the connection
+    //!
+    virtual void select_connection(int connection_id) { };
+
     void* current_raw_buffer_;
 };
 
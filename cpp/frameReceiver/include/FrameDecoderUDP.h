@@ -14,6 +14,9 @@
 #include <netinet/in.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <vector>
 
 #include <boost/function.hpp>
 #include <boost/shared_ptr.hpp>
@@ -26,10 +29,38 @@ using namespace log4cxx::helpers;
 #include "FrameDecoder.h"
 
 namespace FrameReceiver {
+
+//! Function signature of the callback made for each packet received by a packet receiver, before
+//! the packet is processed by the decoder, with the message header, bytes received and port
+typedef boost::function<void(const struct msghdr&, std::size_t, int)> PacketReceivedCallback;
+
+//! UDPPacketReceiver - receive loop for UDP packets specialised on a concrete frame decoder type
+class UDPPacketReceiver {
+public:
+    virtual ~UDPPacketReceiver() { };
+
+    //! Receives and processes up to a maximum number of packets queued on a socket without blocking
+    virtual std::size_t receive(
+        int recv_socket,
+        int recv_port,
+        std::size_t max_packets,
+        void* control_buffer,
+        std::size_t control_size,
+        const PacketReceivedCallback& callback
+    ) = 0;
+};
+
+typedef boost::shared_ptr<UDPPacketReceiver> UDPPacketReceiverPtr;
+
 class FrameDecoderUDP : public FrameDecoder {
 public:
+    static const std::size_t max_batch_iovecs = 2; //!< Maximum number of iovecs per packet in batch mode
+
     FrameDecoderUDP() :
-        FrameDecoder() { };
+        FrameDecoder(),
+        batch_size_(0),
+        batch_slot_size_(0),
+        batch_direct_placement_(false) { };
 
     virtual ~FrameDecoderUDP() = 0;
 
@@ -42,6 +73,28 @@ public:
     virtual void* get_next_payload_buffer(void) const = 0;
     virtual size_t get_next_payload_size(void) const = 0;
     virtual FrameReceiveState process_packet(size_t bytes_received, int port, struct sockaddr_in* from_addr) = 0;
+
+    virtual UDPPacketReceiverPtr create_packet_receiver(void);
+
+    virtual const size_t get_max_payload_size(void) const;
+    virtual void* get_predicted_payload_buffer(std::size_t packets_ahead) const;
+    const bool supports_batch_receive(void) const;
+    virtual void init_batch_receive(std::size_t batch_size, bool direct_placement);
+    virtual std::size_t get_batch_iovecs(std::size_t slot, struct iovec* iov);
+    virtual void process_packet_batch(
+        std::size_t first_slot,
+        std::size_t num_packets,
+        const std::size_t* bytes_received,
+        int port,
+        struct sockaddr_in* from_addrs
+    );
+
+protected:
+    std::size_t batch_size_; //!< Number of packet slots in the batch receive staging buffer
+    std::size_t batch_slot_size_; //!< Size of each packet slot in the batch receive staging buffer
+    std::vector<uint8_t> batch_buffer_; //!< Staging buffer for batched packet reception
+    std::vector<uint8_t*> batch_payloads_; //!< Location each packet slot payload is received into
+    bool batch_direct_placement_; //!< Receive payloads directly into predicted frame buffer locations
 };
 
 inline FrameDecoderUDP::~FrameDecoderUDP() { };
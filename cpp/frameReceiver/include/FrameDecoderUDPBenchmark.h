@@ -0,0 +1,98 @@
+/*!
+ * FrameDecoderUDPBenchmark.h - socket-free microbenchmark harness for UDP frame decoders
+ *
+ * This class measures the per-packet cost of a UDP frame decoder in isolation from the network
+ * stack. A stream of packets, either synthesised by the caller or loaded from a pcap capture, is
+ * held in memory and replayed through the decoder using the same header peek, scatter receive
+ * and process sequence as FrameReceiverUDPRxThread, with the kernel copy into the decoder
+ * buffers replaced by a memcpy. Frames released by the decoder are returned to its empty buffer
+ * queue immediately, so that the benchmark measures the decoder rather than downstream
+ * processing. Where the platform allows, hardware performance counters are read around the timed
+ * region to report cycles, instructions and cache behaviour per packet.
+ */
+
+#ifndef INCLUDE_FRAMEDECODERUDPBENCHMARK_H_
+#define INCLUDE_FRAMEDECODERUDPBENCHMARK_H_
+
+#include <netinet/in.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "FrameDecoderUDP.h"
+#include "SharedBufferManager.h"
+
+namespace FrameReceiver {
+
+class FrameDecoderUDPBenchmark {
+public:
+    static const int default_port = 61649; //!< Default port number passed to the decoder with each packet
+
+    //! Results of a benchmark run
+    struct Result {
+        uint64_t packets; //!< Number of packets processed in the timed region
+        uint64_t bytes; //!< Number of packet bytes processed in the timed region
+        uint64_t frames_ready; //!< Number of frames released by the decoder in the timed region
+        uint64_t frames_timedout; //!< Number of incomplete frames timed out by the decoder
+        uint64_t frames_dropped; //!< Number of frames dropped by the decoder for lack of buffers
+        double elapsed_s; //!< Elapsed time of the timed region in seconds
+        double ns_per_packet; //!< Mean time to process a packet in ns
+        double packets_per_s; //!< Packet rate
+        double frames_per_s; //!< Rate of frames released by the decoder
+        double gbits_per_s; //!< Packet data rate in Gbit/s
+        std::map<std::string, uint64_t> counters; //!< Hardware counter totals by name, if available
+    };
+
+    FrameDecoderUDPBenchmark(
+        FrameDecoderUDPPtr decoder,
+        OdinData::SharedBufferManagerPtr buffer_manager,
+        std::size_t batch_size = 0,
+        int port = default_port
+    );
+
+    void clear_packets(void);
+    void add_packet(const void* data, std::size_t size);
+    std::size_t load_pcap(const std::string& file_name, int port = -1);
+    std::size_t get_num_packets(void) const;
+
+    Result run(unsigned int passes = 1);
+
+private:
+    void deliver_packet(const uint8_t* data, std::size_t size);
+    void deliver_batch(std::size_t first_packet, std::size_t num_packets);
+    void frame_ready(int buffer_id, int frame);
+    void release_frames(void);
+    void check_expiry(void);
+    void drain(void);
+
+    FrameDecoderUDPPtr decoder_; //!< Decoder under test
+    OdinData::SharedBufferManagerPtr buffer_manager_; //!< Buffer manager the decoder receives frames into
+    std::size_t batch_size_; //!< Number of packets per batch, or zero for single packet receive
+    int port_; //!< Port number passed to the decoder with each packet
+    struct sockaddr_in from_addr_; //!< Sender address passed to the decoder with each packet
+
+    std::vector<uint8_t> stream_data_; //!< Contiguous storage of the packets in the stream
+    std::vector<std::pair<std::size_t, std::size_t>> packets_; //!< Offset and size of each packet in the stream
+    std::size_t stream_bytes_; //!< Total size of the packets in the stream
+
+    std::vector<int> ready_buffers_; //!< Buffers released by the decoder, awaiting return to its queue
+    uint64_t frames_ready_; //!< Number of frames released by the decoder
+    uint64_t next_expiry_ns_; //!< Time at which frames are next expired
+
+    std::vector<std::size_t> batch_bytes_; //!< Bytes received per packet in the current batch
+    std::vector<struct sockaddr_in> batch_addrs_; //!< Sender address per packet in the current batch
+
+    LoggerPtr logger_; //!< Pointer to the logging facility
+};
+
+typedef boost::shared_ptr<FrameDecoderUDPBenchmark> FrameDecoderUDPBenchmarkPtr;
+
+} // namespace FrameReceiver
+
+#endif /* INCLUDE_FRAMEDECODERUDPBENCHMARK_H_ */
@@ -0,0 +1,142 @@
+/*!
+ * FrameDecoderUDPSpecialised.h - UDP frame decoder base class with a compile-time specialised receive loop
+ *
+ * A UDP decoder normally has its packet handling methods called through the FrameDecoderUDP
+ * interface, costing several virtual calls for each packet received. A decoder can instead derive
+ * from FrameDecoderUDPSpecialised, passing its own type as the template parameter. The receiver
+ * thread then receives packets through a FrameDecoderUDPReceiveLoop instantiated on the concrete
+ * decoder type, in which the packet handling methods are called directly, so that constant header
+ * sizes and payload layouts are folded into the loop and the methods can be inlined. Decoders are
+ * still loaded at run time through the ClassLoader, since the loop is created by the decoder.
+ *
+ * The receive loop calls the implementations of the packet handling methods in the decoder type
+ * itself, so that type should be declared final. To inline them, the decoder should explicitly
+ * instantiate the receive loop in the source file implementing those methods, declaring it as an
+ * extern template in its header so that it is not instantiated elsewhere.
+ */
+
+#ifndef INCLUDE_FRAMEDECODERUDPSPECIALISED_H_
+#define INCLUDE_FRAMEDECODERUDPSPECIALISED_H_
+
+#include <netinet/in.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include "FrameDecoderUDP.h"
+
+namespace FrameReceiver {
+
+//! FrameDecoderUDPReceiveLoop - UDP packet receive loop specialised on a concrete decoder type
+template <class Decoder> class FrameDecoderUDPReceiveLoop : public UDPPacketReceiver {
+public:
+    //! Constructor
+    //!
+    //! \param[in] decoder - pointer to the decoder to pass received packets to
+    //!
+    explicit FrameDecoderUDPReceiveLoop(Decoder* decoder) :
+        decoder_(decoder) { };
+
+    //! Receives and processes up to a maximum number of packets queued on a socket without blocking
+    //!
+    //! This method performs the same sequence for each packet as the receiver thread does through
+    //! the FrameDecoderUDP interface: the packet header is peeked and processed if the decoder
+    //! requires it, the packet is received into the header and payload buffers specified by the
+    //! decoder and then processed. The loop ends when the maximum number of packets have been
+    //! received or a receive fails, leaving errno set by the failed call, which is EAGAIN or
+    //! EWOULDBLOCK if no more packets are queued on the socket.
+    //!
+    //! \param[in] recv_socket - file descriptor of the receive socket
+    //! \param[in] recv_port - port number the socket is bound to
+    //! \param[in] max_packets - maximum number of packets to receive
+    //! \param[in] control_buffer - buffer for ancillary data received with each packet, or NULL
+    //! \param[in] control_size - size of the ancillary data buffer
+    //! \param[in] callback - callback made for each packet before it is processed, or empty
+    //! \return number of packets received
+    //!
+    std::size_t receive(
+        int recv_socket,
+        int recv_port,
+        std::size_t max_packets,
+        void* control_buffer,
+        std::size_t control_size,
+        const PacketReceivedCallback& callback
+    )
+    {
+        std::size_t packets_received = 0;
+
+        while (packets_received < max_packets) {
+            struct iovec io_vec[2];
+            std::size_t iovec_entry = 0;
+            struct sockaddr_in from_addr;
+
+            if (decoder_->Decoder::requires_header_peek()) {
+                socklen_t from_len = sizeof(from_addr);
+                ssize_t header_bytes = recvfrom(
+                    recv_socket, decoder_->Decoder::get_packet_header_buffer(),
+                    decoder_->Decoder::get_packet_header_size(), MSG_PEEK | MSG_DONTWAIT,
+                    (struct sockaddr*)&from_addr, &from_len
+                );
+                if (header_bytes < 0) {
+                    break;
+                }
+                decoder_->Decoder::process_packet_header(header_bytes, recv_port, &from_addr);
+
+                io_vec[iovec_entry].iov_base = decoder_->Decoder::get_packet_header_buffer();
+                io_vec[iovec_entry].iov_len = decoder_->Decoder::get_packet_header_size();
+                iovec_entry++;
+            }
+
+            io_vec[iovec_entry].iov_base = decoder_->Decoder::get_next_payload_buffer();
+            io_vec[iovec_entry].iov_len = decoder_->Decoder::get_next_payload_size();
+            iovec_entry++;
+
+            struct msghdr msg_hdr;
+            memset((void*)&msg_hdr, 0, sizeof(struct msghdr));
+            msg_hdr.msg_name = (void*)&from_addr;
+            msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+            msg_hdr.msg_iov = io_vec;
+            msg_hdr.msg_iovlen = iovec_entry;
+            msg_hdr.msg_control = control_buffer;
+            msg_hdr.msg_controllen = control_size;
+
+            ssize_t bytes_received = recvmsg(recv_socket, &msg_hdr, MSG_DONTWAIT);
+            if (bytes_received < 0) {
+                break;
+            }
+
+            if (callback) {
+                callback(msg_hdr, bytes_received, recv_port);
+            }
+
+            decoder_->Decoder::process_packet(bytes_received, recv_port, &from_addr);
+            packets_received++;
+        }
+
+        return packets_received;
+    }
+
+private:
+    Decoder* decoder_; //!< Pointer to the decoder to pass received packets to
+};
+
+//! FrameDecoderUDPSpecialised - UDP frame decoder base class providing a specialised receive loop
+template <class Decoder> class FrameDecoderUDPSpecialised : public FrameDecoderUDP {
+public:
+    FrameDecoderUDPSpecialised() :
+        FrameDecoderUDP() { };
+
+    virtual ~FrameDecoderUDPSpecialised() { };
+
+    //! Creates a receive loop specialised on the concrete decoder type
+    //!
+    //! \return pointer to the receive loop
+    //!
+    UDPPacketReceiverPtr create_packet_receiver(void)
+    {
+        return UDPPacketReceiverPtr(new FrameDecoderUDPReceiveLoop<Decoder>(static_cast<Decoder*>(this)));
+    }
+};
+
+} // namespace FrameReceiver
+#endif /* INCLUDE_FRAMEDECODERUDPSPECIALISED_H_ */
@@ -0,0 +1,87 @@
+/*!
+ * FrameReceiverAFPacketRxThread.h
+ *
+ */
+
+#ifndef FRAMERECEIVERAFPACKETRXTHREAD_H_
+#define FRAMERECEIVERAFPACKETRXTHREAD_H_
+
+#include <stdint.h>
+#include <string>
+
+#include <boost/asio.hpp>
+#include <boost/thread.hpp>
+
+#include <log4cxx/logger.h>
+using namespace log4cxx;
+using namespace log4cxx::helpers;
+#include "DebugLevelLogger.h"
+
+#include "FrameDecoderUDP.h"
+#include "FrameReceiverConfig.h"
+#include "FrameReceiverRxThread.h"
+#include "IpcChannel.h"
+#include "IpcMessage.h"
+#include "IpcReactor.h"
+#include "OdinDataException.h"
+#include "SharedBufferManager.h"
+
+using namespace OdinData;
+
+namespace FrameReceiver {
+
+//! FrameReceiverAFPacketRxThread - receive UDP frame data through an AF_PACKET memory-mapped ring
+//!
+//! This RX thread receives the UDP packets addressed to the configured ports through a TPACKET_V3
+//! receive ring shared with the kernel, rather than through UDP sockets. A BPF filter attached to
+//! the packet socket passes only UDP packets for the configured address and ports into the ring.
+//! The kernel fills the ring a block of packets at a time, and each block is handed to the UDP
+//! frame decoder packet by packet without any further system calls.
+class FrameReceiverAFPacketRxThread : public FrameReceiverRxThread {
+public:
+    FrameReceiverAFPacketRxThread(
+        FrameReceiverConfig& config,
+        SharedBufferManagerPtr buffer_manager,
+        FrameDecoderPtr frame_decoder,
+        unsigned int tick_period_ms = 100
+    );
+    virtual ~FrameReceiverAFPacketRxThread();
+
+private:
+    static const std::size_t ring_block_size = 1 << 20; //!< Size of each block in the receive ring
+    static const std::size_t ring_frame_size = 2048; //!< Nominal packet slot size used to size the ring
+    static const std::size_t min_ring_blocks = 4; //!< Minimum number of blocks in the receive ring
+    static const unsigned int ring_block_timeout_ms = 1; //!< Time after which a partly filled block is retired
+    static const std::size_t max_filter_length = 256; //!< Maximum BPF program length reachable by a jump
+
+    void run_specific_service(void);
+    void cleanup_specific_service(void);
+    void fill_specific_status_params(IpcMessage& status_msg);
+
+    bool create_packet_socket(void);
+    bool attach_port_filter(void);
+    bool map_receive_ring(void);
+    void close_packet_socket(void);
+    void handle_receive_ring(void);
+    void process_ring_block(void* block);
+    void process_udp_packet(const uint8_t* packet, std::size_t length);
+    void update_ring_stats(void);
+
+    LoggerPtr logger_;
+    FrameDecoderUDPPtr frame_decoder_;
+
+    int packet_socket_; //!< AF_PACKET socket the receive ring is attached to
+    std::string interface_name_; //!< Name of the interface packets are received on, empty for all
+    uint8_t* ring_; //!< Address of the memory-mapped receive ring
+    std::size_t ring_blocks_; //!< Number of blocks in the receive ring
+    std::size_t next_block_; //!< Index of the next block to be returned by the kernel
+
+    uint64_t ring_packets_; //!< Number of packets passed into the ring by the kernel
+    uint64_t ring_drops_; //!< Number of packets dropped by the kernel because the ring was full
+    uint64_t ring_freezes_; //!< Number of times the ring was full when a block was retired
+    uint64_t packets_received_; //!< Number of packets handed to the frame decoder
+    uint64_t packets_discarded_; //!< Number of packets in the ring that could not be decoded
+};
+
+} // namespace FrameReceiver
+#endif /* FRAMERECEIVERAFPACKETRXTHREAD_H_ */
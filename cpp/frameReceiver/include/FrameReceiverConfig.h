@@ -38,7 +38,29 @@ const std::string CONFIG_FRAME_RELEASE_ENDPOINT = "frame_release_endpoint";
 const std::string CONFIG_RX_PORTS = "rx_ports";
 const std::string CONFIG_RX_ADDRESS = "rx_address";
 const std::string CONFIG_RX_RECV_BUFFER_SIZE = "rx_recv_buffer_size";
+const std::string CONFIG_RX_BATCH_SIZE = "rx_batch_size";
+const std::string CONFIG_RX_SOCKET_STATS = "rx_socket_stats";
+const std::string CONFIG_RX_THREADS = "rx_threads";
+const std::string CONFIG_RX_THREAD_CORES = "rx_thread_cores";
+const std::string CONFIG_RX_THREAD_PRIORITY = "rx_thread_priority";
+const std::string CONFIG_RX_REUSEPORT = "rx_reuseport";
+const std::string CONFIG_RX_TCP_LISTEN = "rx_tcp_listen";
+const std::string CONFIG_RX_EPOLL = "rx_epoll";
+const std::string CONFIG_RX_BUSY_POLL = "rx_busy_poll";
+const std::string CONFIG_RX_BUSY_POLL_US = "rx_busy_poll_us";
+const std::string CONFIG_RX_PCAP_FILE = "rx_pcap_file";
+const std::string CONFIG_RX_PCAP_SNAPLEN = "rx_pcap_snaplen";
+const std::string CONFIG_RX_PCAP_BUFFER_SIZE = "rx_pcap_buffer_size";
 const std::string CONFIG_SHARED_BUFFER_NAME = "shared_buffer_name";
+const std::string CONFIG_FRAME_NOTIFY_RING = "frame_notify_ring";
+const std::string CONFIG_FRAME_NOTIFY_BATCH = "frame_notify_batch";
+const std::string CONFIG_FRAME_NOTIFY_BATCH_MS = "frame_notify_batch_ms";
+const std::string CONFIG_FRAME_NOTIFY_DIRECT = "frame_notify_direct";
+const std::string CONFIG_SHARED_BUFFER_HUGE_PAGE_DIR = "shared_buffer_huge_page_dir";
+const std::string CONFIG_SHARED_BUFFER_NUMA_NODE = "shared_buffer_numa_node";
+const std::string CONFIG_SHARED_BUFFER_LOCK = "shared_buffer_lock";
+const std::string CONFIG_SHARED_BUFFER_PREFAULT = "shared_buffer_prefault";
+const std::string CONFIG_SHARED_BUFFER_BLOCK_SIZE = "shared_buffer_block_size";
 const std::string CONFIG_FRAME_TIMEOUT_MS = "frame_timeout_ms";
 const std::string CONFIG_FRAME_COUNT = "frame_count";
 const std::string CONFIG_ENABLE_PACKET_LOGGING = "enable_packet_logging";
@@ -57,11 +79,33 @@ public:
         rx_type_(Defaults::default_rx_type),
         rx_address_(Defaults::default_rx_address),
         rx_recv_buffer_size_(Defaults::default_rx_recv_buffer_size),
+        rx_batch_size_(Defaults::default_rx_batch_size),
+        rx_socket_stats_(Defaults::default_rx_socket_stats),
+        rx_threads_(Defaults::default_rx_threads),
+        rx_thread_cores_(Defaults::default_rx_thread_cores),
+        rx_thread_priority_(Defaults::default_rx_thread_priority),
+        rx_reuseport_(Defaults::default_rx_reuseport),
+        rx_tcp_listen_(Defaults::default_rx_tcp_listen),
+        rx_epoll_(Defaults::default_rx_epoll),
+        rx_busy_poll_(Defaults::default_rx_busy_poll),
+        rx_busy_poll_us_(Defaults::default_rx_busy_poll_us),
+        rx_pcap_file_(Defaults::default_rx_pcap_file),
+        rx_pcap_snaplen_(Defaults::default_rx_pcap_snaplen),
+        rx_pcap_buffer_size_(Defaults::default_rx_pcap_buffer_size),
         rx_channel_endpoint_(""),
         ctrl_channel_endpoint_(""),
         frame_ready_endpoint_(""),
         frame_release_endpoint_(""),
         shared_buffer_name_(OdinData::Defaults::default_shared_buffer_name),
+        frame_notify_ring_(Defaults::default_frame_notify_ring),
+        frame_notify_batch_(Defaults::default_frame_notify_batch),
+        frame_notify_batch_ms_(Defaults::default_frame_notify_batch_ms),
+        frame_notify_direct_(Defaults::default_frame_notify_direct),
+        shared_buffer_huge_page_dir_(Defaults::default_shared_buffer_huge_page_dir),
+        shared_buffer_numa_node_(Defaults::default_shared_buffer_numa_node),
+        shared_buffer_lock_(Defaults::default_shared_buffer_lock),
+        shared_buffer_prefault_(Defaults::default_shared_buffer_prefault),
+        shared_buffer_block_size_(Defaults::default_shared_buffer_block_size),
         frame_timeout_ms_(Defaults::default_frame_timeout_ms),
         enable_packet_logging_(Defaults::default_enable_packet_logging),
         force_reconfig_(Defaults::default_force_reconfig)
@@ -102,6 +146,8 @@ public:
             rx_name_map["ZMQ"] = Defaults::RxTypeZMQ;
             rx_name_map["tcp"] = Defaults::RxTypeTCP;
             rx_name_map["TCP"] = Defaults::RxTypeTCP;
+            rx_name_map["afpacket"] = Defaults::RxTypeAFPacket;
+            rx_name_map["AFPACKET"] = Defaults::RxTypeAFPacket;
         }
 
         if (rx_name_map.count(rx_name)) {
@@ -121,6 +167,7 @@ public:
             rx_type_map[Defaults::RxTypeUDP] = "udp";
             rx_type_map[Defaults::RxTypeZMQ] = "zmq";
             rx_type_map[Defaults::RxTypeTCP] = "tcp";
+            rx_type_map[Defaults::RxTypeAFPacket] = "afpacket";
             rx_type_map[Defaults::RxTypeIllegal] = "unknown";
         }
 
@@ -158,11 +205,33 @@ public:
 
         config_msg.set_param<std::string>(CONFIG_RX_ADDRESS, rx_address_);
         config_msg.set_param<int>(CONFIG_RX_RECV_BUFFER_SIZE, rx_recv_buffer_size_);
+        config_msg.set_param<unsigned int>(CONFIG_RX_BATCH_SIZE, rx_batch_size_);
+        config_msg.set_param<bool>(CONFIG_RX_SOCKET_STATS, rx_socket_stats_);
+        config_msg.set_param<unsigned int>(CONFIG_RX_THREADS, rx_threads_);
+        config_msg.set_param<std::string>(CONFIG_RX_THREAD_CORES, rx_thread_cores_);
+        config_msg.set_param<int>(CONFIG_RX_THREAD_PRIORITY, rx_thread_priority_);
+        config_msg.set_param<bool>(CONFIG_RX_REUSEPORT, rx_reuseport_);
+        config_msg.set_param<bool>(CONFIG_RX_TCP_LISTEN, rx_tcp_listen_);
+        config_msg.set_param<bool>(CONFIG_RX_EPOLL, rx_epoll_);
+        config_msg.set_param<bool>(CONFIG_RX_BUSY_POLL, rx_busy_poll_);
+        config_msg.set_param<unsigned int>(CONFIG_RX_BUSY_POLL_US, rx_busy_poll_us_);
+        config_msg.set_param<std::string>(CONFIG_RX_PCAP_FILE, rx_pcap_file_);
+        config_msg.set_param<unsigned int>(CONFIG_RX_PCAP_SNAPLEN, rx_pcap_snaplen_);
+        config_msg.set_param<unsigned int>(CONFIG_RX_PCAP_BUFFER_SIZE, rx_pcap_buffer_size_);
         config_msg.set_param<std::string>(CONFIG_RX_ENDPOINT, rx_channel_endpoint_);
         config_msg.set_param<std::string>(CONFIG_CTRL_ENDPOINT, ctrl_channel_endpoint_);
         config_msg.set_param<std::string>(CONFIG_FRAME_READY_ENDPOINT, frame_ready_endpoint_);
         config_msg.set_param<std::string>(CONFIG_FRAME_RELEASE_ENDPOINT, frame_release_endpoint_);
         config_msg.set_param<std::string>(CONFIG_SHARED_BUFFER_NAME, shared_buffer_name_);
+        config_msg.set_param<bool>(CONFIG_FRAME_NOTIFY_RING, frame_notify_ring_);
+        config_msg.set_param<unsigned int>(CONFIG_FRAME_NOTIFY_BATCH, frame_notify_batch_);
+        config_msg.set_param<unsigned int>(CONFIG_FRAME_NOTIFY_BATCH_MS, frame_notify_batch_ms_);
+        config_msg.set_param<bool>(CONFIG_FRAME_NOTIFY_DIRECT, frame_notify_direct_);
+        config_msg.set_param<std::string>(CONFIG_SHARED_BUFFER_HUGE_PAGE_DIR, shared_buffer_huge_page_dir_);
+        config_msg.set_param<int>(CONFIG_SHARED_BUFFER_NUMA_NODE, shared_buffer_numa_node_);
+        config_msg.set_param<bool>(CONFIG_SHARED_BUFFER_LOCK, shared_buffer_lock_);
+        config_msg.set_param<bool>(CONFIG_SHARED_BUFFER_PREFAULT, shared_buffer_prefault_);
+        config_msg.set_param<unsigned int>(CONFIG_SHARED_BUFFER_BLOCK_SIZE, shared_buffer_block_size_);
         config_msg.set_param<int>(CONFIG_FRAME_COUNT, frame_count_);
 
         std::string decoder_config_path("decoder_config/");
@@ -177,10 +246,23 @@ private:
     std::string decoder_path_; //!< Path to decoder library
     std::string decoder_type_; //!< Decoder type receiving data for - drives frame size
     boost::scoped_ptr<IpcMessage> decoder_config_; //!< Decoder configuration data as IpcMessage
-    Defaults::RxType rx_type_; //!< Type of receiver interface (UDP or ZMQ)
+    Defaults::RxType rx_type_; //!< Type of receiver interface (UDP, ZMQ, TCP or AF_PACKET)
     std::vector<uint16_t> rx_ports_; //!< Port(s) to receive frame data on
     std::string rx_address_; //!< IP address to receive frame data on
     int rx_recv_buffer_size_; //!< Receive socket buffer size
+    unsigned int rx_batch_size_; //!< Maximum number of packets received per system call
+    bool rx_socket_stats_; //!< Enable kernel drop and timestamp statistics on receive sockets
+    unsigned int rx_threads_; //!< Number of receive worker threads
+    std::string rx_thread_cores_; //!< Comma-separated list of CPU cores to pin receiving threads to
+    int rx_thread_priority_; //!< SCHED_FIFO priority of receiving threads, 0 for normal scheduling
+    bool rx_reuseport_; //!< Use a SO_REUSEPORT socket group per port across receive worker threads
+    bool rx_tcp_listen_; //!< Listen for TCP connections on the receive ports rather than connecting to them
+    bool rx_epoll_; //!< Use the epoll reactor backend in the receive threads
+    bool rx_busy_poll_; //!< Busy-poll the receive sockets with non-blocking receives rather than sleeping in a poll
+    unsigned int rx_busy_poll_us_; //!< SO_BUSY_POLL time in microseconds set on busy-polled sockets, 0 to leave unset
+    std::string rx_pcap_file_; //!< pcap file to capture received UDP packets into, empty if not capturing
+    unsigned int rx_pcap_snaplen_; //!< Maximum UDP payload bytes captured per packet, 0 for full packets
+    unsigned int rx_pcap_buffer_size_; //!< Size in bytes of the packet capture ring
     unsigned int io_threads_; //!< Number of IO threads for IPC channels
     std::string rx_channel_endpoint_; //!< IPC channel endpoint for RX thread communication
     std::string ctrl_channel_endpoint_; //!< IPC channel endpoint for control communication with other processes
@@ -189,6 +271,15 @@ private:
     std::string frame_release_endpoint_; //!< IPC channel endpoint for receiving frame release notifications from other
                                          //!< processes
     std::string shared_buffer_name_; //!< Shared memory frame buffer name
+    bool frame_notify_ring_; //!< Pass frame ready and release notifications through shared memory rings
+    unsigned int frame_notify_batch_; //!< Maximum frames per batched frame ready or release notification
+    unsigned int frame_notify_batch_ms_; //!< Maximum time in ms a frame notification is held in a batch
+    bool frame_notify_direct_; //!< Pass frame notifications directly between the RX thread and other processes
+    std::string shared_buffer_huge_page_dir_; //!< hugetlbfs mount backing the shared buffer, empty if not used
+    int shared_buffer_numa_node_; //!< NUMA node to bind the shared buffer to, -1 for no binding
+    bool shared_buffer_lock_; //!< Lock the shared buffer into memory
+    bool shared_buffer_prefault_; //!< Fault in the shared buffer pages when it is configured
+    unsigned int shared_buffer_block_size_; //!< Block size for variable-length frames, zero for fixed-size buffers
     unsigned int frame_timeout_ms_; //!< Incomplete frame timeout in milliseconds
     unsigned int frame_count_; //!< Number of frames to receive before terminating
     bool enable_packet_logging_; //!< Enable packet diagnostic logging
@@ -200,7 +291,9 @@ private:
     friend class FrameReceiverUDPRxThread;
     friend class FrameReceiverZMQRxThread;
     friend class FrameReceiverTCPRxThread;
+    friend class FrameReceiverAFPacketRxThread;
     friend class FrameReceiverConfigTestProxy;
+    friend class FrameReceiverControllerTestProxy;
     friend class FrameReceiverRxThreadTestProxy;
 };
 
@@ -21,8 +21,10 @@
 
 #include "ClassLoader.h"
 #include "FrameDecoder.h"
+#include "FrameNotifyBatch.h"
 #include "FrameReceiverConfig.h"
 #include "FrameReceiverException.h"
+#include "FrameReceiverAFPacketRxThread.h"
 #include "FrameReceiverRxThread.h"
 #include "FrameReceiverTCPRxThread.h"
 #include "FrameReceiverUDPRxThread.h"
@@ -31,6 +33,7 @@
 #include "IpcMessage.h"
 #include "IpcReactor.h"
 #include "OdinDataException.h"
+#include "SharedBufferNotifier.h"
 
 // Uncomment this to compile a diagnostic tick timer into the controller
 // #define FR_CONTROLLER_TICK_TIMER
@@ -73,11 +76,21 @@ private:
     void handle_ctrl_channel(void);
     void handle_rx_channel(void);
     void handle_frame_release_channel(void);
+    void handle_frame_release_ring(void);
+    void frame_released(const unsigned int num_frames = 1);
+
+    void setup_frame_notifier(void);
+    void cleanup_frame_notifier(void);
 
     void precharge_buffers(void);
     void notify_buffer_config(const bool deferred = false);
     void store_rx_thread_status(OdinData::IpcMessage& rx_status_msg);
     void get_status(OdinData::IpcMessage& status_reply);
+    void get_channel_stats(
+        OdinData::IpcMessage& status_reply,
+        const std::string& param_prefix,
+        OdinData::IpcChannel& channel
+    );
     void get_version(OdinData::IpcMessage& version_reply);
     void reset_statistics(OdinData::IpcMessage& reset_reply);
     void request_configuration(OdinData::IpcMessage& config_reply);
@@ -92,6 +105,7 @@ private:
     boost::scoped_ptr<FrameReceiverRxThread> rx_thread_; //!< Receiver thread object
     FrameDecoderPtr frame_decoder_; //!< Frame decoder object
     SharedBufferManagerPtr buffer_manager_; //!< Buffer manager object
+    SharedBufferNotifierPtr frame_notifier_; //!< Shared memory ring frame notifier object
 
     FrameReceiverConfig config_; //!< Configuration storage object
     bool terminate_controller_; //!< Flag to signal termination of the controller
@@ -111,6 +125,7 @@ private:
     IpcChannel rx_channel_; //!< Channel for communication with receiver thread
     IpcChannel ctrl_channel_; //!< Channel for communication with  control clients
     IpcChannel frame_ready_channel_; //!< Channel for signalling to downstream processes
+    boost::mutex frame_ready_mutex_; //!< Mutex serialising frame ready channel access with the RX thread
     IpcChannel frame_release_channel_; //!< Channel for receiving notification of released frames
 
     IpcReactor reactor_; //!< Reactor for multiplexing all communications
@@ -118,10 +133,15 @@ private:
     unsigned int total_buffers_; //!< Record the total number of buffers in the system
     unsigned int frames_received_; //!< Counter for frames received
     unsigned int frames_released_; //!< Counter for frames released
+    bool frame_notify_direct_active_; //!< Indicates that the RX thread is notifying frames directly
+    uint64_t rx_frames_ready_; //!< Frames ready last reported in the RX thread status
+    uint64_t rx_frames_released_; //!< Frames released last reported in the RX thread status
 
     std::string rx_thread_identity_; //!< Identity of the RX thread dealer channel
 
     boost::scoped_ptr<OdinData::IpcMessage> rx_thread_status_; //!< Status of the receiver thread
+
+    friend class FrameReceiverControllerTestProxy;
 };
 
 const std::size_t deferred_action_delay_ms = 1000; //!< Default delay in ms for deferred actions
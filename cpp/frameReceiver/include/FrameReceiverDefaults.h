@@ -22,7 +22,8 @@ namespace Defaults {
         RxTypeIllegal = -1,
         RxTypeUDP,
         RxTypeZMQ,
-        RxTypeTCP
+        RxTypeTCP,
+        RxTypeAFPacket
     };
 
     const std::size_t default_max_buffer_mem = 1048576;
@@ -36,10 +37,33 @@ namespace Defaults {
 #else
     const int default_rx_recv_buffer_size = 30000000;
 #endif
+    const unsigned int default_rx_batch_size = 1;
+    const bool default_rx_socket_stats = false;
+    const unsigned int default_rx_threads = 1;
+    const std::string default_rx_thread_cores = "";
+    const int default_rx_thread_priority = 0;
+    const bool default_rx_reuseport = false;
+    const bool default_rx_tcp_listen = false;
+    const bool default_rx_epoll = false;
+    const bool default_rx_busy_poll = false;
+    const unsigned int default_rx_busy_poll_us = 50;
+    const std::string default_rx_pcap_file = "";
+    const unsigned int default_rx_pcap_snaplen = 0;
+    const unsigned int default_rx_pcap_buffer_size = 64 * 1024 * 1024;
+    const bool default_frame_notify_ring = false;
+    const unsigned int default_frame_notify_batch = 1;
+    const unsigned int default_frame_notify_batch_ms = 1;
+    const bool default_frame_notify_direct = false;
+    const std::string default_shared_buffer_huge_page_dir = "";
+    const int default_shared_buffer_numa_node = -1;
+    const bool default_shared_buffer_lock = false;
+    const bool default_shared_buffer_prefault = false;
+    const unsigned int default_shared_buffer_block_size = 0;
     const std::string default_rx_chan_endpoint = "inproc://rx_channel";
     const std::string default_ctrl_chan_endpoint = "tcp://127.0.0.1:5000";
     const unsigned int default_frame_timeout_ms = 1000;
     const bool default_enable_packet_logging = false;
+    const unsigned int default_spill_pool_frames = 0;
     const bool default_force_reconfig = false;
 
 }
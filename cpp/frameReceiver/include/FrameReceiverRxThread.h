@@ -18,12 +18,14 @@ using namespace log4cxx::helpers;
 #include "logging.h"
 
 #include "FrameDecoder.h"
+#include "FrameNotifyBatch.h"
 #include "FrameReceiverConfig.h"
 #include "IpcChannel.h"
 #include "IpcMessage.h"
 #include "IpcReactor.h"
 #include "OdinDataException.h"
 #include "SharedBufferManager.h"
+#include "SharedBufferNotifier.h"
 
 using namespace OdinData;
 
@@ -50,11 +52,23 @@ public:
     bool start();
     void stop();
 
+    void set_direct_notification(
+        IpcChannel* frame_ready_channel,
+        boost::mutex* frame_ready_mutex,
+        IpcChannel* frame_release_channel,
+        SharedBufferNotifierPtr frame_notifier
+    );
+
     void frame_ready(int buffer_id, int frame_number);
 
 protected:
     virtual void run_specific_service(void) = 0;
     virtual void cleanup_specific_service(void) = 0;
+    virtual void fill_specific_status_params(IpcMessage& status_msg);
+    virtual void run_event_loop(void);
+    virtual IpcChannel& get_frame_ready_channel(void);
+    virtual FrameNotifyBatch& get_frame_ready_batch(void);
+    void flush_frame_ready_batch(void);
 
     void set_thread_init_error(const std::string& msg);
 
@@ -62,6 +76,7 @@ protected:
 
     FrameReceiverConfig& config_;
     IpcReactor reactor_;
+    boost::mutex decoder_mutex_; //!< Mutex serialising frame decoder access from multiple threads
 
 private:
     void run_service(void);
@@ -69,8 +84,13 @@ private:
     void advertise_identity(void);
     void request_buffer_precharge(void);
     void handle_rx_channel(void);
+    void handle_frame_release_channel(void);
+    void handle_frame_release_ring(void);
+    void release_frames(const FrameNotifyBatch::FrameList& frames);
     void tick_timer(void);
     void buffer_monitor_timer(void);
+    void frame_expiry_timer(void);
+    void frame_ready_flush_timer(void);
     void fill_status_params(IpcMessage& status_msg);
 
     LoggerPtr logger_; //!< Pointer to the logging facility
@@ -80,8 +100,16 @@ private:
 
     boost::shared_ptr<boost::thread> rx_thread_; //!< Pointer to RX thread
     IpcChannel rx_channel_; //!< Channel for communication with the main thread
+    FrameNotifyBatch frame_ready_batch_; //!< Batch of frame ready notifications to the main thread
     std::vector<int> recv_sockets_; //!< List of receive socket file descriptors
 
+    IpcChannel* frame_ready_channel_; //!< Frame ready channel to downstream processes, NULL unless notifying directly
+    boost::mutex* frame_ready_mutex_; //!< Mutex serialising frame ready channel access with the main thread
+    IpcChannel* frame_release_channel_; //!< Frame release channel from downstream processes when notifying directly
+    SharedBufferNotifierPtr frame_notifier_; //!< Shared memory ring frame notifier when notifying directly
+    uint64_t frames_ready_; //!< Frames notified ready directly, serialised by frame decoder access
+    uint64_t frames_released_; //!< Frames released directly to the RX thread
+
     bool run_thread_; //!< Flag signalling thread should run
     volatile bool thread_running_; //!< Flag singalling if thread is running
     volatile bool thread_init_error_; //!< Flag singalling thread initialisation error
@@ -6,7 +6,13 @@
 #ifndef FRAMERECEIVERTCPRXTHREAD_H_
 #define FRAMERECEIVERTCPRXTHREAD_H_
 
+#include <map>
+#include <string>
+
+#include <sys/uio.h>
+
 #include <boost/asio.hpp>
+#include <boost/shared_ptr.hpp>
 #include <boost/thread.hpp>
 
 #include <log4cxx/logger.h>
@@ -26,6 +32,13 @@ using namespace log4cxx::helpers;
 using namespace OdinData;
 
 namespace FrameReceiver {
+
+//! FrameReceiverTCPRxThread - receive frame data over TCP connections
+//!
+//! This RX thread either connects to a sender on each configured port, or listens on each port and
+//! accepts any number of sender connections. All connections are non-blocking and each keeps its own
+//! receive state, so that a message partly received on one connection is resumed when more data
+//! arrives without holding up the other connections or the RX thread reactor.
 class FrameReceiverTCPRxThread : public FrameReceiverRxThread {
 public:
     FrameReceiverTCPRxThread(
@@ -37,14 +50,41 @@ public:
     virtual ~FrameReceiverTCPRxThread();
 
 private:
+    static const std::size_t max_message_iov = 8; //!< Maximum number of buffer locations per message
+    static const unsigned int max_messages_per_wakeup = 16; //!< Messages received per connection per wakeup
+
+    //! Receive state of a single TCP connection
+    struct TCPConnection {
+        int socket_fd; //!< Socket file descriptor of the connection
+        int port; //!< Local port the connection was made to
+        std::string peer; //!< Address and port of the remote end of the connection
+        struct iovec iov[max_message_iov]; //!< Buffer locations of the message being received
+        std::size_t iov_count; //!< Number of buffer locations of the message, zero between messages
+        std::size_t iov_index; //!< Index of the first buffer location not yet filled
+        std::size_t message_bytes; //!< Number of bytes of the message received so far
+    };
+    typedef boost::shared_ptr<TCPConnection> TCPConnectionPtr;
+
     void run_specific_service(void);
     void cleanup_specific_service(void);
+    void fill_specific_status_params(IpcMessage& status_msg);
+
+    int create_socket(uint16_t rx_port, struct sockaddr_in& addr);
+    void add_connection(int socket_fd, int port, const struct sockaddr_in& peer_addr);
+    void close_connection(int socket_fd);
 
-    void handle_receive_socket(int socket_fd, int recv_port);
+    void handle_accept(int listen_socket, int recv_port);
+    void handle_receive_socket(int socket_fd);
+    bool start_message(TCPConnection& connection);
 
     LoggerPtr logger_;
     FrameDecoderTCPPtr frame_decoder_;
-    int recv_socket_;
+    std::map<int, TCPConnectionPtr> connections_; //!< Receive state of open connections by socket
+
+    uint64_t connections_accepted_; //!< Number of connections accepted or made
+    uint64_t connections_closed_; //!< Number of connections closed
+    uint64_t messages_received_; //!< Number of complete messages received across all connections
+    uint64_t bytes_received_; //!< Number of bytes received across all connections
 };
 
 } // namespace FrameReceiver
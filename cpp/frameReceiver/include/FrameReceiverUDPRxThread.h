@@ -8,6 +8,14 @@
 #ifndef FRAMERECEIVERUDPRXTHREAD_H_
 #define FRAMERECEIVERUDPRXTHREAD_H_
 
+#include <sys/socket.h>
+#include <time.h>
+#include <atomic>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include <boost/asio.hpp>
 #include <boost/thread.hpp>
 
@@ -23,6 +31,7 @@ using namespace log4cxx::helpers;
 #include "IpcMessage.h"
 #include "IpcReactor.h"
 #include "OdinDataException.h"
+#include "PacketCaptureTap.h"
 #include "SharedBufferManager.h"
 
 using namespace OdinData;
@@ -39,13 +48,109 @@ public:
     virtual ~FrameReceiverUDPRxThread();
 
 private:
+    static const std::size_t num_hist_bins = 16; //!< Number of bins in socket timing histograms
+    static const unsigned int worker_tick_period_ms = 100; //!< Receive worker thread tick timer period
+    static const std::size_t max_receive_loop_packets = 64; //!< Maximum packets per specialised receive loop call
+    static const uint64_t busy_poll_service_ns = 100000; //!< Interval between reactor servicing when busy-polling
+
+    //! Per-socket receive statistics derived from kernel ancillary data
+    struct SocketStats {
+        SocketStats();
+        void update(const struct msghdr& msg_hdr, const struct timespec& recv_time);
+        static std::size_t hist_bin(uint64_t interval_ns);
+
+        uint64_t packets; //!< Number of packets received on the socket
+        uint64_t kernel_drops; //!< Number of packets dropped by the kernel socket buffer
+        uint64_t max_latency_ns; //!< Maximum socket-to-decoder latency in nanoseconds
+        struct timespec last_arrival; //!< Kernel arrival time of the last packet
+        bool have_last_arrival; //!< Indicates that last_arrival holds a valid time
+        uint64_t inter_arrival_hist[num_hist_bins]; //!< Histogram of packet inter-arrival times
+        uint64_t latency_hist[num_hist_bins]; //!< Histogram of socket-to-decoder latencies
+    };
+
+    //! Statistics of a busy-poll receive loop, updated by the loop and read by the RX thread status
+    struct BusyPollStats {
+        BusyPollStats();
+
+        void reset(void);
+        static void add(std::atomic<uint64_t>& counter, uint64_t value);
+
+        std::atomic<uint64_t> iterations; //!< Number of loop iterations
+        std::atomic<uint64_t> empty_polls; //!< Number of iterations in which no packets were received
+        std::atomic<uint64_t> receive_ns; //!< Time in nanoseconds spent in iterations which received packets
+        std::atomic<uint64_t> idle_ns; //!< Time in nanoseconds spent in iterations which received no packets
+        std::atomic<uint64_t> service_ns; //!< Time in nanoseconds spent servicing the reactor
+    };
+
+    //! Receive worker thread servicing a subset of the receive sockets with its own reactor
+    struct RxWorker {
+        RxWorker(unsigned int index, std::size_t first_slot, IpcReactor::ReactorBackend backend);
+
+        unsigned int index; //!< Index of the worker
+        std::size_t first_slot; //!< First batch receive slot used by the worker
+        int core; //!< CPU core the worker is pinned to, or -1 if not pinned
+        IpcChannel channel; //!< Channel for frame ready notifications to the main thread
+        FrameNotifyBatch ready_batch; //!< Batch of frame ready notifications sent on the worker channel
+        IpcReactor reactor; //!< Reactor servicing the worker receive sockets
+        std::vector<std::pair<int, uint16_t> > sockets; //!< Receive sockets and their ports
+        BusyPollStats busy_poll_stats; //!< Statistics of the worker busy-poll loop
+        boost::shared_ptr<boost::thread> thread; //!< Pointer to the worker thread
+    };
+    typedef boost::shared_ptr<RxWorker> RxWorkerPtr;
+
     void run_specific_service(void);
     void cleanup_specific_service(void);
+    void fill_specific_status_params(IpcMessage& status_msg);
+    IpcChannel& get_frame_ready_channel(void);
+    FrameNotifyBatch& get_frame_ready_batch(void);
+    void run_event_loop(void);
 
-    void handle_receive_socket(int socket_fd, int recv_port);
+    void init_batch_receive(std::size_t num_slot_sets);
+    int create_receive_socket(uint16_t rx_port, bool reuse_port);
+    bool enable_socket_stats(int recv_socket, uint16_t rx_port);
+    void register_receive_socket(IpcReactor& reactor, int recv_socket, uint16_t rx_port, std::size_t first_slot);
+    void configure_receive_thread(const std::string& thread_name, int core);
+    bool start_workers(void);
+    void stop_workers(void);
+    void run_worker(RxWorker* worker);
+    void worker_tick_timer(RxWorker* worker);
+    void worker_flush_timer(RxWorker* worker);
+    void run_busy_poll(
+        IpcReactor& reactor,
+        const std::vector<std::pair<int, uint16_t> >& sockets,
+        std::size_t first_slot,
+        BusyPollStats& stats
+    );
+    std::size_t handle_receive_socket(int socket_fd, int recv_port);
+    void packet_received(const struct msghdr& msg_hdr, std::size_t bytes_received, int recv_port);
+    std::size_t handle_receive_socket_batch(int socket_fd, int recv_port, std::size_t first_slot);
 
     LoggerPtr logger_;
     FrameDecoderUDPPtr frame_decoder_;
+
+    bool socket_stats_enabled_; //!< Indicates that kernel socket statistics are enabled
+    std::size_t control_size_; //!< Size of the ancillary data buffer for each packet
+    std::vector<uint8_t> control_buffer_; //!< Ancillary data buffer for single packet receive
+    std::map<int, SocketStats> socket_stats_; //!< Receive statistics indexed by port
+
+    UDPPacketReceiverPtr packet_receiver_; //!< Receive loop specialised on the decoder type, empty if none
+    PacketReceivedCallback packet_received_callback_; //!< Callback made by the receive loop for each packet
+
+    std::size_t batch_size_; //!< Maximum number of packets received per recvmmsg call
+    std::vector<struct mmsghdr> batch_msgs_; //!< Message headers for batched receive
+    std::vector<struct iovec> batch_iovecs_; //!< Scatter/gather vectors for batched receive
+    std::vector<struct sockaddr_in> batch_addrs_; //!< Source addresses of packets in a batch
+    std::vector<std::size_t> batch_bytes_; //!< Number of bytes received for each packet in a batch
+    std::vector<uint8_t> batch_control_; //!< Ancillary data buffers for packets in a batch
+
+    std::vector<RxWorkerPtr> workers_; //!< Receive worker threads, empty if receiving in the RX thread
+
+    bool busy_poll_; //!< Indicates that receiving threads busy-poll their sockets
+    std::vector<std::pair<int, uint16_t> > busy_poll_sockets_; //!< Sockets busy-polled by the RX thread and their ports
+    BusyPollStats busy_poll_stats_; //!< Statistics of the RX thread busy-poll loop
+
+    PacketCaptureTapPtr packet_tap_; //!< pcap capture of received packets, empty if not capturing
+    bool run_workers_; //!< Flag signalling that receive worker threads should run
 };
 
 } // namespace FrameReceiver
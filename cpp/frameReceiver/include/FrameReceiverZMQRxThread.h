@@ -41,6 +41,7 @@ public:
 private:
     void run_specific_service(void);
     void cleanup_specific_service(void);
+    void fill_specific_status_params(IpcMessage& status_msg);
 
     void handle_receive_socket();
 
@@ -0,0 +1,173 @@
+/*!
+ * FrameSlotTable.h - fixed-capacity frame number to buffer ID table for frame decoders
+ *
+ * This class maps the numbers of frames currently being received to the shared buffers they are
+ * being received into. It is an open-addressed hash table with linear probing, sized from the
+ * number of shared buffers so that it never needs to grow, and uses backward-shift deletion so
+ * that lookups stay short as frames are inserted and released out of order. Frame numbers are
+ * hashed by masking, which places consecutive frames in consecutive slots.
+ */
+
+#ifndef INCLUDE_FRAMESLOTTABLE_H_
+#define INCLUDE_FRAMESLOTTABLE_H_
+
+#include <stddef.h>
+
+#include <utility>
+#include <vector>
+
+namespace FrameReceiver {
+
+class FrameSlotTable {
+public:
+    //! Construct an empty table with no capacity
+    FrameSlotTable() :
+        mask_(0),
+        size_(0)
+    {
+    }
+
+    //! Reset the table to hold up to the specified number of frames, discarding any current entries
+    void reset(size_t max_frames)
+    {
+        size_t capacity = 1;
+        while (capacity < (2 * max_frames)) {
+            capacity <<= 1;
+        }
+        slots_.assign(capacity, Slot());
+        mask_ = capacity - 1;
+        size_ = 0;
+    }
+
+    //! Discard all entries in the table
+    void clear(void)
+    {
+        slots_.assign(slots_.size(), Slot());
+        size_ = 0;
+    }
+
+    //! Return the buffer ID mapped to a frame, or -1 if the frame is not in the table
+    int find(int frame) const
+    {
+        if (slots_.empty()) {
+            return -1;
+        }
+        for (size_t idx = home_slot(frame);; idx = (idx + 1) & mask_) {
+            const Slot& slot = slots_[idx];
+            if (!slot.occupied) {
+                return -1;
+            }
+            if (slot.frame == frame) {
+                return slot.buffer_id;
+            }
+        }
+    }
+
+    //! Map a frame to a buffer ID, returning false if the table is full
+    bool insert(int frame, int buffer_id)
+    {
+        if (slots_.empty()) {
+            return false;
+        }
+        for (size_t idx = home_slot(frame);; idx = (idx + 1) & mask_) {
+            Slot& slot = slots_[idx];
+            if (slot.occupied && (slot.frame == frame)) {
+                slot.buffer_id = buffer_id;
+                return true;
+            }
+            if (!slot.occupied) {
+                if (size_ == slots_.size() - 1) {
+                    return false;
+                }
+                slot.occupied = true;
+                slot.frame = frame;
+                slot.buffer_id = buffer_id;
+                size_++;
+                return true;
+            }
+        }
+    }
+
+    //! Remove a frame from the table, returning false if the frame was not in the table
+    bool erase(int frame)
+    {
+        if (slots_.empty()) {
+            return false;
+        }
+
+        size_t idx = home_slot(frame);
+        while (true) {
+            if (!slots_[idx].occupied) {
+                return false;
+            }
+            if (slots_[idx].frame == frame) {
+                break;
+            }
+            idx = (idx + 1) & mask_;
+        }
+
+        // Shift following entries of the probe run back into the freed slot, so that no
+        // tombstones are left to lengthen later lookups
+        size_t hole = idx;
+        for (size_t next = (hole + 1) & mask_; slots_[next].occupied; next = (next + 1) & mask_) {
+            size_t home = home_slot(slots_[next].frame);
+            if (((next - home) & mask_) >= ((next - hole) & mask_)) {
+                slots_[hole] = slots_[next];
+                hole = next;
+            }
+        }
+        slots_[hole] = Slot();
+        size_--;
+        return true;
+    }
+
+    //! Return the number of frames in the table
+    size_t size(void) const
+    {
+        return size_;
+    }
+
+    //! Indicate if the table is empty
+    bool empty(void) const
+    {
+        return size_ == 0;
+    }
+
+    //! Append the frame numbers and buffer IDs of all entries to a vector
+    void entries(std::vector<std::pair<int, int>>& frame_buffers) const
+    {
+        for (size_t idx = 0; idx < slots_.size(); idx++) {
+            if (slots_[idx].occupied) {
+                frame_buffers.push_back(std::make_pair(slots_[idx].frame, slots_[idx].buffer_id));
+            }
+        }
+    }
+
+private:
+    //! Table slot holding a frame number and its buffer ID
+    struct Slot {
+        Slot() :
+            occupied(false),
+            frame(0),
+            buffer_id(-1)
+        {
+        }
+
+        bool occupied; //!< Indicates the slot holds an entry
+        int frame; //!< Frame number
+        int buffer_id; //!< Shared buffer ID the frame is being received into
+    };
+
+    //! Return the slot a frame number hashes to
+    size_t home_slot(int frame) const
+    {
+        return static_cast<size_t>(static_cast<unsigned int>(frame)) & mask_;
+    }
+
+    std::vector<Slot> slots_; //!< Table slots, a power of two in number
+    size_t mask_; //!< Mask of slot index bits
+    size_t size_; //!< Number of entries in the table
+};
+
+} // namespace FrameReceiver
+#endif /* INCLUDE_FRAMESLOTTABLE_H_ */
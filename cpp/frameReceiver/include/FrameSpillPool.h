@@ -0,0 +1,153 @@
+/*!
+ * FrameSpillPool.h - bounded pool of anonymous memory frame buffers for frame decoders
+ *
+ * This class provides a secondary tier of frame buffers for decoders to assemble frames into when
+ * the shared buffers are exhausted, e.g. when the frame processor briefly falls behind. The pool is
+ * a single private anonymous mapping divided into fixed-size slots; pages are only committed as they
+ * are written, so a large pool costs no memory until it is used. Frames assembled in the pool are
+ * copied into shared buffers as they are released, before being notified to the processor.
+ */
+
+#ifndef INCLUDE_FRAMESPILLPOOL_H_
+#define INCLUDE_FRAMESPILLPOOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/mman.h>
+
+#include <vector>
+
+namespace FrameReceiver {
+
+class FrameSpillPool {
+public:
+    //! Construct an empty pool with no capacity
+    FrameSpillPool() :
+        pool_(0),
+        pool_size_(0),
+        frame_size_(0),
+        capacity_(0),
+        peak_in_use_(0)
+    {
+    }
+
+    //! Destructor, releasing the pool memory
+    ~FrameSpillPool()
+    {
+        unmap();
+    }
+
+    //! Reset the pool to hold the specified number of frames of the given size, discarding any
+    //! frames currently held. Returns false if the pool memory could not be mapped, leaving the
+    //! pool empty.
+    bool reset(size_t num_frames, size_t frame_size)
+    {
+        unmap();
+        free_slots_.clear();
+        peak_in_use_ = 0;
+
+        if ((num_frames == 0) || (frame_size == 0)) {
+            return true;
+        }
+
+        size_t pool_size = num_frames * frame_size;
+        void* pool = mmap(NULL, pool_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (pool == MAP_FAILED) {
+            return false;
+        }
+
+        pool_ = static_cast<uint8_t*>(pool);
+        pool_size_ = pool_size;
+        frame_size_ = frame_size;
+        capacity_ = num_frames;
+
+        // Hand out the lowest slots first so that the pages in use stay compact
+        free_slots_.reserve(num_frames);
+        for (size_t slot = num_frames; slot > 0; slot--) {
+            free_slots_.push_back(slot - 1);
+        }
+        return true;
+    }
+
+    //! Acquire a free slot, returning false if the pool is full
+    bool acquire(size_t& slot)
+    {
+        if (free_slots_.empty()) {
+            return false;
+        }
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+        if (in_use() > peak_in_use_) {
+            peak_in_use_ = in_use();
+        }
+        return true;
+    }
+
+    //! Return a slot to the pool
+    void release(size_t slot)
+    {
+        free_slots_.push_back(slot);
+    }
+
+    //! Return the address of a slot
+    void* address(size_t slot) const
+    {
+        return pool_ + (slot * frame_size_);
+    }
+
+    //! Return the size of each slot in bytes
+    size_t frame_size(void) const
+    {
+        return frame_size_;
+    }
+
+    //! Return the number of slots in the pool
+    size_t capacity(void) const
+    {
+        return capacity_;
+    }
+
+    //! Return the number of slots currently in use
+    size_t in_use(void) const
+    {
+        return capacity_ - free_slots_.size();
+    }
+
+    //! Return the largest number of slots in use at once since the pool or peak was last reset
+    size_t peak_in_use(void) const
+    {
+        return peak_in_use_;
+    }
+
+    //! Reset the peak number of slots in use to the current number
+    void reset_peak(void)
+    {
+        peak_in_use_ = in_use();
+    }
+
+private:
+    //! Release the pool memory
+    void unmap(void)
+    {
+        if (pool_) {
+            munmap(pool_, pool_size_);
+        }
+        pool_ = 0;
+        pool_size_ = 0;
+        frame_size_ = 0;
+        capacity_ = 0;
+    }
+
+    FrameSpillPool(const FrameSpillPool&);
+    FrameSpillPool& operator=(const FrameSpillPool&);
+
+    uint8_t* pool_; //!< Base address of the pool mapping
+    size_t pool_size_; //!< Size of the pool mapping in bytes
+    size_t frame_size_; //!< Size of each slot in bytes
+    size_t capacity_; //!< Number of slots in the pool
+    size_t peak_in_use_; //!< Largest number of slots in use at once
+    std::vector<size_t> free_slots_; //!< Stack of free slot indices
+};
+
+} // namespace FrameReceiver
+#endif /* INCLUDE_FRAMESPILLPOOL_H_ */
@@ -0,0 +1,151 @@
+/*!
+ * FrameTimeoutQueue.h - deadline-ordered incomplete frame timeout queue for frame decoders
+ *
+ * This class tracks the deadlines by which frames being received into shared buffers must
+ * complete. Deadlines are held in a min-heap so that the frames which are due can be expired
+ * without scanning all mapped buffers. Frames which complete before their deadline are cancelled
+ * by buffer ID in constant time; the stale heap entry is discarded lazily, either when it reaches
+ * the top of the heap or when it would otherwise be expired.
+ */
+
+#ifndef INCLUDE_FRAMETIMEOUTQUEUE_H_
+#define INCLUDE_FRAMETIMEOUTQUEUE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+#include <queue>
+#include <vector>
+
+namespace FrameReceiver {
+
+class FrameTimeoutQueue {
+public:
+    //! Construct an empty queue
+    FrameTimeoutQueue() :
+        next_sequence_(1),
+        size_(0)
+    {
+    }
+
+    //! Reset the queue for the specified number of buffers, discarding any current deadlines
+    void reset(size_t num_buffers)
+    {
+        heap_ = DeadlineHeap();
+        buffer_sequence_.assign(num_buffers, 0);
+        size_ = 0;
+    }
+
+    //! Discard all deadlines in the queue
+    void clear(void)
+    {
+        reset(buffer_sequence_.size());
+    }
+
+    //! Add a deadline for a frame being received into a buffer, replacing any existing deadline
+    //! for that buffer
+    void add(int frame, int buffer_id, uint64_t deadline_ns)
+    {
+        if (buffer_id < 0) {
+            return;
+        }
+        if (static_cast<size_t>(buffer_id) >= buffer_sequence_.size()) {
+            buffer_sequence_.resize(buffer_id + 1, 0);
+        }
+        if (buffer_sequence_[buffer_id] == 0) {
+            size_++;
+        }
+        Deadline deadline = {deadline_ns, next_sequence_++, frame, buffer_id};
+        buffer_sequence_[buffer_id] = deadline.sequence;
+        heap_.push(deadline);
+        discard_stale();
+    }
+
+    //! Cancel the deadline for a buffer, returning false if the buffer had no deadline
+    bool cancel(int buffer_id)
+    {
+        if ((buffer_id < 0) || (static_cast<size_t>(buffer_id) >= buffer_sequence_.size())
+            || (buffer_sequence_[buffer_id] == 0)) {
+            return false;
+        }
+        buffer_sequence_[buffer_id] = 0;
+        size_--;
+        discard_stale();
+        return true;
+    }
+
+    //! Remove the earliest frame whose deadline has passed, returning false if no frame is due
+    bool pop_expired(uint64_t now_ns, int& frame, int& buffer_id)
+    {
+        discard_stale();
+        if (heap_.empty() || (heap_.top().deadline_ns > now_ns)) {
+            return false;
+        }
+        const Deadline& deadline = heap_.top();
+        frame = deadline.frame;
+        buffer_id = deadline.buffer_id;
+        buffer_sequence_[buffer_id] = 0;
+        size_--;
+        heap_.pop();
+        discard_stale();
+        return true;
+    }
+
+    //! Get the earliest pending deadline, returning false if the queue is empty
+    bool next_deadline(uint64_t& deadline_ns)
+    {
+        discard_stale();
+        if (heap_.empty()) {
+            return false;
+        }
+        deadline_ns = heap_.top().deadline_ns;
+        return true;
+    }
+
+    //! Return the number of frames with pending deadlines
+    size_t size(void) const
+    {
+        return size_;
+    }
+
+    //! Indicate if the queue has no pending deadlines
+    bool empty(void) const
+    {
+        return size_ == 0;
+    }
+
+private:
+    //! Frame deadline entry
+    struct Deadline {
+        uint64_t deadline_ns; //!< Deadline in nanoseconds
+        uint64_t sequence; //!< Sequence number identifying this deadline for its buffer
+        int frame; //!< Frame number
+        int buffer_id; //!< Shared buffer ID the frame is being received into
+
+        //! Order deadlines so that the earliest is at the top of the heap
+        bool operator>(const Deadline& other) const
+        {
+            return (deadline_ns > other.deadline_ns)
+                || ((deadline_ns == other.deadline_ns) && (sequence > other.sequence));
+        }
+    };
+
+    typedef std::priority_queue<Deadline, std::vector<Deadline>, std::greater<Deadline>> DeadlineHeap;
+
+    //! Pop cancelled or superseded deadlines from the top of the heap
+    void discard_stale(void)
+    {
+        while (!heap_.empty() && (buffer_sequence_[heap_.top().buffer_id] != heap_.top().sequence)) {
+            heap_.pop();
+        }
+    }
+
+    DeadlineHeap heap_; //!< Min-heap of frame deadlines, including stale entries not yet discarded
+    std::vector<uint64_t> buffer_sequence_; //!< Sequence number of the live deadline for each buffer, 0 if none
+    uint64_t next_sequence_; //!< Sequence number to assign to the next deadline
+    size_t size_; //!< Number of live deadlines
+};
+
+} // namespace FrameReceiver
+#endif /* INCLUDE_FRAMETIMEOUTQUEUE_H_ */
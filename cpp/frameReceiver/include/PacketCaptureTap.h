@@ -0,0 +1,359 @@
+/*!
+ * PacketCaptureTap.h - asynchronous pcap capture of received UDP packets
+ *
+ * This class captures packets received by the UDP RX thread into a pcap file which can be replayed
+ * by the frame simulator. The receive path copies each packet, truncated to the configured snap
+ * length, with its timestamp and addressing into a lock-free single-producer/single-consumer byte
+ * ring. A background writer thread drains the ring, synthesises the Ethernet, IPv4 and UDP headers
+ * of each packet and writes them to the file. When the writer cannot keep up and the ring is full,
+ * packets are not captured and are counted as dropped, so the receive path overhead is bounded by
+ * the copy into the ring. Calls to capture() must be serialised by the caller.
+ */
+
+#ifndef INCLUDE_PACKETCAPTURETAP_H_
+#define INCLUDE_PACKETCAPTURETAP_H_
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+namespace FrameReceiver {
+
+class PacketCaptureTap {
+public:
+    static const size_t max_packet_size = 65507; //!< Maximum UDP payload size over IPv4
+    static const size_t header_size = 42; //!< Size of the Ethernet, IPv4 and UDP headers written per packet
+    static const unsigned int writer_idle_us = 1000; //!< Writer thread sleep when the ring is empty
+
+    //! Construct a tap capturing up to snaplen bytes of each UDP payload, or the full payload if
+    //! zero, into a ring of the specified size in bytes. The destination address written into
+    //! captured packets is the receive address.
+    PacketCaptureTap(const std::string& dst_address, size_t snaplen, size_t ring_size) :
+        dst_addr_(inet_addr(dst_address.c_str())),
+        snaplen_(((snaplen == 0) || (snaplen > max_packet_size)) ? max_packet_size : snaplen),
+        ring_(record_size(std::max(ring_size, 2 * record_size(max_packet_size)))),
+        file_(NULL),
+        run_writer_(false),
+        tail_(0),
+        head_(0),
+        packets_captured_(0),
+        packets_dropped_(0),
+        packets_written_(0),
+        bytes_written_(0),
+        write_errors_(0)
+    {
+        if (dst_addr_ == INADDR_NONE) {
+            dst_addr_ = INADDR_ANY;
+        }
+    }
+
+    //! Destroy the tap, stopping the writer thread and closing the file
+    ~PacketCaptureTap()
+    {
+        stop();
+    }
+
+    //! Open the pcap file, writing the file header, and start the writer thread, returning false
+    //! if the file cannot be written
+    bool start(const std::string& file_name)
+    {
+        stop();
+
+        file_ = fopen(file_name.c_str(), "wb");
+        if (file_ == NULL) {
+            return false;
+        }
+        file_buffer_.resize(1 << 20);
+        setvbuf(file_, &file_buffer_[0], _IOFBF, file_buffer_.size());
+
+        PcapFileHeader file_header = {
+            0xa1b2c3d4, 2, 4, 0, 0, static_cast<uint32_t>(header_size + snaplen_), link_type_ethernet
+        };
+        if (fwrite(&file_header, sizeof(file_header), 1, file_) != 1) {
+            fclose(file_);
+            file_ = NULL;
+            return false;
+        }
+
+        run_writer_ = true;
+        writer_thread_.reset(new boost::thread(boost::bind(&PacketCaptureTap::run_writer, this)));
+        return true;
+    }
+
+    //! Stop the writer thread, writing any packets remaining in the ring, and close the file
+    void stop(void)
+    {
+        if (writer_thread_) {
+            run_writer_ = false;
+            writer_thread_->join();
+            writer_thread_.reset();
+        }
+        if (file_ != NULL) {
+            fclose(file_);
+            file_ = NULL;
+        }
+    }
+
+    //! Capture a received packet held in the specified vectors, returning false if it was dropped
+    //! because the ring is full
+    bool capture(
+        const struct iovec* iov,
+        size_t iov_count,
+        size_t bytes_received,
+        const struct sockaddr_in* from_addr,
+        uint16_t recv_port
+    )
+    {
+        size_t cap_len = std::min(bytes_received, snaplen_);
+        size_t rec_size = record_size(cap_len);
+
+        // Find space for the record, which must be contiguous, padding to the start of the ring if
+        // it does not fit before the end
+        uint64_t tail = tail_.load(std::memory_order_relaxed);
+        size_t offset = static_cast<size_t>(tail % ring_.size());
+        size_t space_to_end = ring_.size() - offset;
+        size_t padding = (rec_size > space_to_end) ? space_to_end : 0;
+        if ((tail + padding + rec_size - head_.load(std::memory_order_acquire)) > ring_.size()) {
+            packets_dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (padding) {
+            if (padding >= sizeof(Record)) {
+                reinterpret_cast<Record*>(&ring_[offset])->rec_size = 0;
+            }
+            offset = 0;
+        }
+
+        Record* record = reinterpret_cast<Record*>(&ring_[offset]);
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        record->rec_size = static_cast<uint32_t>(rec_size);
+        record->ts_sec = static_cast<uint32_t>(now.tv_sec);
+        record->ts_usec = static_cast<uint32_t>(now.tv_nsec / 1000);
+        record->len = static_cast<uint32_t>(bytes_received);
+        record->cap_len = static_cast<uint32_t>(cap_len);
+        record->src_addr = (from_addr != NULL) ? from_addr->sin_addr.s_addr : INADDR_ANY;
+        record->src_port = (from_addr != NULL) ? from_addr->sin_port : 0;
+        record->dst_port = htons(recv_port);
+
+        uint8_t* data = &ring_[offset + sizeof(Record)];
+        size_t remaining = cap_len;
+        for (size_t idx = 0; (idx < iov_count) && (remaining > 0); idx++) {
+            size_t copy_len = std::min(remaining, static_cast<size_t>(iov[idx].iov_len));
+            memcpy(data, iov[idx].iov_base, copy_len);
+            data += copy_len;
+            remaining -= copy_len;
+        }
+
+        tail_.store(tail + padding + rec_size, std::memory_order_release);
+        packets_captured_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    //! Return the snap length applied to UDP payloads
+    size_t get_snaplen(void) const
+    {
+        return snaplen_;
+    }
+
+    //! Return the number of packets captured into the ring
+    uint64_t get_packets_captured(void) const
+    {
+        return packets_captured_.load(std::memory_order_relaxed);
+    }
+
+    //! Return the number of packets dropped because the ring was full
+    uint64_t get_packets_dropped(void) const
+    {
+        return packets_dropped_.load(std::memory_order_relaxed);
+    }
+
+    //! Return the number of packets written to the file
+    uint64_t get_packets_written(void) const
+    {
+        return packets_written_.load(std::memory_order_relaxed);
+    }
+
+    //! Return the number of bytes written to the file
+    uint64_t get_bytes_written(void) const
+    {
+        return bytes_written_.load(std::memory_order_relaxed);
+    }
+
+    //! Return the number of packets which could not be written to the file
+    uint64_t get_write_errors(void) const
+    {
+        return write_errors_.load(std::memory_order_relaxed);
+    }
+
+private:
+    static const uint32_t link_type_ethernet = 1; //!< pcap link type of captured packets
+
+    //! pcap file header
+    struct PcapFileHeader {
+        uint32_t magic; //!< Magic number indicating byte order and microsecond timestamps
+        uint16_t version_major; //!< Major version of the file format
+        uint16_t version_minor; //!< Minor version of the file format
+        int32_t this_zone; //!< Timezone offset of timestamps, always zero
+        uint32_t sig_figs; //!< Timestamp accuracy, always zero
+        uint32_t snaplen; //!< Maximum captured length of packets
+        uint32_t link_type; //!< Link layer type of packets
+    };
+
+    //! pcap packet record header
+    struct PcapRecordHeader {
+        uint32_t ts_sec; //!< Capture timestamp seconds
+        uint32_t ts_usec; //!< Capture timestamp microseconds
+        uint32_t incl_len; //!< Number of bytes of the packet in the file
+        uint32_t orig_len; //!< Original length of the packet
+    };
+
+    //! Ring record header, followed by the captured payload bytes. A record size of zero marks
+    //! padding to the end of the ring.
+    struct Record {
+        uint32_t rec_size; //!< Size of the record in the ring including this header
+        uint32_t ts_sec; //!< Capture timestamp seconds
+        uint32_t ts_usec; //!< Capture timestamp microseconds
+        uint32_t len; //!< UDP payload length received
+        uint32_t cap_len; //!< UDP payload length captured
+        uint32_t src_addr; //!< Source address, network byte order
+        uint16_t src_port; //!< Source port, network byte order
+        uint16_t dst_port; //!< Destination port, network byte order
+        uint32_t reserved; //!< Reserved, pads the header to a multiple of 8 bytes
+    };
+
+    //! Return the size in the ring of a record with the specified captured length, rounded up so
+    //! that records remain aligned. Also used to round up the size of the ring itself.
+    static size_t record_size(size_t cap_len)
+    {
+        return (sizeof(Record) + cap_len + 7) & ~static_cast<size_t>(7);
+    }
+
+    //! Run the writer thread, draining the ring to the file until stopped
+    void run_writer(void)
+    {
+        while (run_writer_) {
+            if (drain() == 0) {
+                fflush(file_);
+                usleep(writer_idle_us);
+            }
+        }
+        drain();
+        fflush(file_);
+    }
+
+    //! Write all records currently in the ring to the file, returning the number written
+    size_t drain(void)
+    {
+        size_t num_written = 0;
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        uint64_t tail = tail_.load(std::memory_order_acquire);
+        while (head != tail) {
+            size_t offset = static_cast<size_t>(head % ring_.size());
+            size_t space_to_end = ring_.size() - offset;
+            const Record* record = reinterpret_cast<const Record*>(&ring_[offset]);
+            if ((space_to_end < sizeof(Record)) || (record->rec_size == 0)) {
+                head += space_to_end;
+                continue;
+            }
+            write_record(*record, &ring_[offset + sizeof(Record)]);
+            head += record->rec_size;
+            head_.store(head, std::memory_order_release);
+            num_written++;
+        }
+        head_.store(head, std::memory_order_release);
+        return num_written;
+    }
+
+    //! Write a captured packet to the file with synthesised Ethernet, IPv4 and UDP headers
+    void write_record(const Record& record, const uint8_t* payload)
+    {
+        uint8_t headers[header_size];
+        memset(headers, 0, sizeof(headers));
+
+        // Ethernet header, with null addresses and the IPv4 ethertype
+        headers[12] = 0x08;
+        headers[13] = 0x00;
+
+        // IPv4 header without options, flagged as not fragmented
+        uint8_t* ip_hdr = &headers[14];
+        uint16_t ip_len = htons(static_cast<uint16_t>(20 + 8 + record.len));
+        ip_hdr[0] = 0x45;
+        memcpy(&ip_hdr[2], &ip_len, sizeof(ip_len));
+        ip_hdr[6] = 0x40;
+        ip_hdr[8] = 64;
+        ip_hdr[9] = IPPROTO_UDP;
+        memcpy(&ip_hdr[12], &record.src_addr, sizeof(record.src_addr));
+        memcpy(&ip_hdr[16], &dst_addr_, sizeof(dst_addr_));
+        uint16_t ip_check = htons(ip_checksum(ip_hdr, 20));
+        memcpy(&ip_hdr[10], &ip_check, sizeof(ip_check));
+
+        // UDP header, without a checksum
+        uint8_t* udp_hdr = &headers[34];
+        uint16_t udp_len = htons(static_cast<uint16_t>(8 + record.len));
+        memcpy(&udp_hdr[0], &record.src_port, sizeof(record.src_port));
+        memcpy(&udp_hdr[2], &record.dst_port, sizeof(record.dst_port));
+        memcpy(&udp_hdr[4], &udp_len, sizeof(udp_len));
+
+        PcapRecordHeader record_header
+            = {record.ts_sec, record.ts_usec, static_cast<uint32_t>(header_size + record.cap_len),
+               static_cast<uint32_t>(header_size + record.len)};
+
+        if ((fwrite(&record_header, sizeof(record_header), 1, file_) != 1)
+            || (fwrite(headers, sizeof(headers), 1, file_) != 1)
+            || ((record.cap_len > 0) && (fwrite(payload, record.cap_len, 1, file_) != 1))) {
+            write_errors_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        packets_written_.fetch_add(1, std::memory_order_relaxed);
+        bytes_written_.fetch_add(sizeof(record_header) + header_size + record.cap_len, std::memory_order_relaxed);
+    }
+
+    //! Calculate the ones' complement checksum of an IPv4 header in host byte order
+    static uint16_t ip_checksum(const uint8_t* hdr, size_t len)
+    {
+        uint32_t sum = 0;
+        for (size_t idx = 0; idx < len; idx += 2) {
+            sum += (static_cast<uint32_t>(hdr[idx]) << 8) | hdr[idx + 1];
+        }
+        while (sum >> 16) {
+            sum = (sum & 0xffff) + (sum >> 16);
+        }
+        return static_cast<uint16_t>(~sum);
+    }
+
+    uint32_t dst_addr_; //!< Destination address of captured packets, network byte order
+    size_t snaplen_; //!< Maximum number of UDP payload bytes captured per packet
+    std::vector<uint8_t> ring_; //!< Ring of captured packet records
+    FILE* file_; //!< pcap file being written
+    std::vector<char> file_buffer_; //!< Buffer for writes to the pcap file
+    boost::shared_ptr<boost::thread> writer_thread_; //!< Writer thread draining the ring
+    volatile bool run_writer_; //!< Flag signalling the writer thread should run
+
+    std::atomic<uint64_t> tail_; //!< Ring offset at which the next record is captured, written by the producer
+    std::atomic<uint64_t> head_; //!< Ring offset of the next record to write, written by the writer thread
+    std::atomic<uint64_t> packets_captured_; //!< Number of packets captured into the ring
+    std::atomic<uint64_t> packets_dropped_; //!< Number of packets dropped because the ring was full
+    std::atomic<uint64_t> packets_written_; //!< Number of packets written to the file
+    std::atomic<uint64_t> bytes_written_; //!< Number of bytes of packet records written to the file
+    std::atomic<uint64_t> write_errors_; //!< Number of packets which could not be written to the file
+};
+
+typedef boost::shared_ptr<PacketCaptureTap> PacketCaptureTapPtr;
+
+} // namespace FrameReceiver
+#endif /* INCLUDE_PACKETCAPTURETAP_H_ */
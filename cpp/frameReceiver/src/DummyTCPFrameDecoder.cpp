@@ -143,6 +143,37 @@ const size_t DummyTCPFrameDecoder::get_next_message_size(void) const
     return frame_size_ - read_so_far_;
 }
 
+/**
+ * Gets the buffer locations to receive the next message into
+ *
+ * While the frame header is outstanding, the header and the payload following it are returned
+ * as separate locations within the frame buffer.
+ *
+ * \param[out] iov Array of I/O vectors to fill
+ * \param[in] max_iov Number of vectors in the array
+ * \return Number of vectors filled
+ */
+size_t DummyTCPFrameDecoder::get_next_message_iov(struct iovec* iov, size_t max_iov)
+{
+    char* message_buffer = static_cast<char*>(get_next_message_buffer());
+    size_t message_size = get_next_message_size();
+
+    size_t num_iov = 0;
+    if ((max_iov > 1) && (read_so_far_ < header_size_)) {
+        size_t header_bytes = header_size_ - read_so_far_;
+        iov[num_iov].iov_base = message_buffer;
+        iov[num_iov].iov_len = header_bytes;
+        num_iov++;
+        message_buffer += header_bytes;
+        message_size -= header_bytes;
+    }
+    iov[num_iov].iov_base = message_buffer;
+    iov[num_iov].iov_len = message_size;
+    num_iov++;
+
+    return num_iov;
+}
+
 void DummyTCPFrameDecoder::monitor_buffers(void)
 {
 }
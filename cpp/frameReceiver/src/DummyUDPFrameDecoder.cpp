@@ -10,6 +10,7 @@
 #include <sstream>
 
 #include "DummyUDPFrameDecoder.h"
+#include "PacketBitmap.h"
 #include "gettime.h"
 #include "version.h"
 
@@ -22,7 +23,7 @@ using namespace FrameReceiver;
 //! ignored packets.
 //!
 DummyUDPFrameDecoder::DummyUDPFrameDecoder() :
-    FrameDecoderUDP(),
+    FrameDecoderUDPSpecialised<DummyUDPFrameDecoder>(),
     udp_packets_per_frame_(DummyUdpFrameDecoderDefaults::default_udp_packets_per_frame),
     udp_packet_size_(DummyUdpFrameDecoderDefaults::default_udp_packet_size),
     status_get_count_(0),
@@ -32,6 +33,7 @@ DummyUDPFrameDecoder::DummyUDPFrameDecoder() :
     current_frame_header_(0),
     num_active_fems_(0),
     dropping_frame_data_(false),
+    current_packet_is_new_(false),
     packets_received_(0),
     packets_lost_(0),
     packets_dropped_(0)
@@ -200,8 +202,9 @@ void* DummyUDPFrameDecoder::get_packet_header_buffer(void)
 //! This method is called to process the header of an incoming packet. The content of that header is
 //! used to determine where the route the payload of the packet on the next receive. Header
 //! information is used to determine which frame buffer the current packet should be routed to,
-//! and to request a new frame buffer when the first packet of a given frame is recevied. Buffer
-//! exhaustion is also handled by directing all packets for the current frame to a scratch buffer.
+//! and to request a new frame buffer when the first packet of a given frame is recevied. When the
+//! shared buffers are exhausted the frame is received into the spill pool if configured; if that is
+//! also full, all packets for the current frame are directed to a scratch buffer.
 //!
 //! \param[in] bytes_recevied - number of bytes received
 //! \param[in] port - UDP port packet header was received on
@@ -217,8 +220,9 @@ void DummyUDPFrameDecoder::process_packet_header(size_t bytes_received, int port
     if (frame_number != current_frame_seen_) {
         current_frame_seen_ = frame_number;
 
-        if (frame_buffer_map_.count(current_frame_seen_) == 0) {
-            if (empty_buffer_queue_.empty()) {
+        int mapped_buffer_id = frame_slot_table_.find(current_frame_seen_);
+        if (mapped_buffer_id < 0) {
+            if (!get_empty_buffer(current_frame_buffer_id_)) {
                 current_frame_buffer_ = dropped_frame_buffer_.get();
 
                 if (!dropping_frame_data_) {
@@ -232,10 +236,9 @@ void DummyUDPFrameDecoder::process_packet_header(size_t bytes_received, int port
                     dropping_frame_data_ = true;
                 }
             } else {
-                current_frame_buffer_id_ = empty_buffer_queue_.front();
-                empty_buffer_queue_.pop();
-                frame_buffer_map_[current_frame_seen_] = current_frame_buffer_id_;
-                current_frame_buffer_ = buffer_manager_->get_buffer_address(current_frame_buffer_id_);
+                frame_slot_table_.insert(current_frame_seen_, current_frame_buffer_id_);
+                start_frame_timeout(current_frame_seen_, current_frame_buffer_id_);
+                current_frame_buffer_ = get_frame_buffer_address(current_frame_buffer_id_);
 
                 if (!dropping_frame_data_) {
                     LOG4CXX_DEBUG_LEVEL(
@@ -258,14 +261,16 @@ void DummyUDPFrameDecoder::process_packet_header(size_t bytes_received, int port
             initialise_frame_header(current_frame_header_);
 
         } else {
-            current_frame_buffer_id_ = frame_buffer_map_[current_frame_seen_];
-            current_frame_buffer_ = buffer_manager_->get_buffer_address(current_frame_buffer_id_);
+            current_frame_buffer_id_ = mapped_buffer_id;
+            current_frame_buffer_ = get_frame_buffer_address(current_frame_buffer_id_);
             current_frame_header_ = reinterpret_cast<DummyUDP::FrameHeader*>(current_frame_buffer_);
         }
     }
 
-    // Update packet state in frame header
-    current_frame_header_->packet_state[packet_number] = 1;
+    // Update packet state bitmap in frame header, noting if this is a duplicate of a packet
+    // already received for the frame
+    current_packet_is_new_
+        = OdinData::PacketBitmap(current_frame_header_->packet_state, udp_packets_per_frame_).set(packet_number);
 
     // Increment packet counters
     if (dropping_frame_data_) {
@@ -291,7 +296,7 @@ void DummyUDPFrameDecoder::initialise_frame_header(DummyUDP::FrameHeader* header
     header_ptr->total_packets_received = 0;
     header_ptr->packet_size = udp_packet_size_;
 
-    memset(header_ptr->packet_state, 0, sizeof(uint8_t) * DummyUDP::max_packets);
+    OdinData::PacketBitmap(header_ptr->packet_state, udp_packets_per_frame_).clear();
 
     gettime(reinterpret_cast<struct timespec*>(&(header_ptr->frame_start_time)));
 }
@@ -325,6 +330,45 @@ size_t DummyUDPFrameDecoder::get_next_payload_size(void) const
     return udp_packet_size_;
 };
 
+//! Get the maximum packet payload size for batched receive.
+//!
+//! This method returns the maximum payload size of a packet, allowing the decoder to be used
+//! with batched receive in the UDP receiver thread. For this decoder all packets have the
+//! configured UDP packet size.
+//!
+//! \return maximum packet payload size in bytes
+//!
+const size_t DummyUDPFrameDecoder::get_max_payload_size(void) const
+{
+    return udp_packet_size_;
+}
+
+//! Get the predicted location of the payload of a packet yet to be received.
+//!
+//! This method returns the location in the current frame buffer of the payload of the packet the
+//! specified number of packets after the last one processed, assuming that packets continue to
+//! arrive in order. No location is predicted if there is no frame being received into a frame
+//! buffer, if the packet would be beyond the end of the frame or if it has already been received.
+//!
+//! \param[in] packets_ahead - number of packets after the last one processed
+//! \return pointer to the predicted payload buffer, or a null pointer if it cannot be predicted
+//!
+void* DummyUDPFrameDecoder::get_predicted_payload_buffer(std::size_t packets_ahead) const
+{
+    if ((current_frame_seen_ == DummyUDP::default_frame_number) || dropping_frame_data_) {
+        return NULL;
+    }
+
+    std::size_t packet_number = get_packet_number() + packets_ahead;
+    if ((packet_number >= udp_packets_per_frame_)
+        || OdinData::PacketBitmap(current_frame_header_->packet_state, udp_packets_per_frame_).test(packet_number)) {
+        return NULL;
+    }
+
+    return reinterpret_cast<uint8_t*>(current_frame_buffer_) + get_frame_header_size()
+        + (udp_packet_size_ * packet_number);
+}
+
 //! Process a received packet payload.
 //!
 //! This method is called once the payload of a packet has been recevied. In this dummy decoder
@@ -343,8 +387,10 @@ DummyUDPFrameDecoder::process_packet(size_t bytes_received, int port, struct soc
 {
     FrameDecoder::FrameReceiveState frame_state = FrameDecoder::FrameReceiveStateIncomplete;
 
-    // Increment the packet received counter in the frame header
-    current_frame_header_->total_packets_received++;
+    // Increment the packet received counter in the frame header, ignoring duplicate packets
+    if (current_packet_is_new_) {
+        current_frame_header_->total_packets_received++;
+    }
 
     // If we have recevied the expected number of packets, mark the frame as complete and hand off
     // the frame for downstream processing
@@ -353,8 +399,9 @@ DummyUDPFrameDecoder::process_packet(size_t bytes_received, int port, struct soc
         current_frame_header_->frame_state = frame_state;
 
         if (!dropping_frame_data_) {
-            // Erase frame from buffer map
-            frame_buffer_map_.erase(current_frame_seen_);
+            // Erase frame from slot table and cancel its timeout
+            frame_slot_table_.erase(current_frame_seen_);
+            cancel_frame_timeout(current_frame_buffer_id_);
 
             // Notify main thread that frame is ready
             ready_callback_(current_frame_buffer_id_, current_frame_header_->frame_number);
@@ -369,63 +416,56 @@ DummyUDPFrameDecoder::process_packet(size_t bytes_received, int port, struct soc
 
 //! Monitor the state of currently mapped frame buffers.
 //!
-//! This method, called periodically by a timer in the receive thread reactor, monitors the state
-//! of currently mapped frame buffers. In any frame buffers have been mapped for a sufficiently
-//! long time that indicates packets have been lost and the frame is incomplete, the frame is
-//! flagged as such and notified to the main thread via the ready callback.
+//! This method, called periodically by a timer in the receive thread reactor, reports the state
+//! of currently mapped frame buffers. Incomplete frames are released when their timeout passes by
+//! the frame expiry mechanism in the base class, which calls frame_timedout() for each frame due.
 //!
 void DummyUDPFrameDecoder::monitor_buffers(void)
 {
-    int frames_timedout = 0;
-
-    struct timespec current_time;
-    gettime(&current_time);
-
-    // Loop over frame buffers currently in map and check their state
-    std::map<int, int>::iterator buffer_map_iter = frame_buffer_map_.begin();
-    while (buffer_map_iter != frame_buffer_map_.end()) {
-        int frame_num = buffer_map_iter->first;
-        int buffer_id = buffer_map_iter->second;
-
-        void* buffer_addr = buffer_manager_->get_buffer_address(buffer_id);
-
-        DummyUDP::FrameHeader* frame_header = reinterpret_cast<DummyUDP::FrameHeader*>(buffer_addr);
+    LOG4CXX_DEBUG_LEVEL(
+        4, logger_,
+        get_num_mapped_buffers() << " frame buffers in use, " << get_num_empty_buffers() << " empty buffers available, "
+                                 << frames_timedout_ << " incomplete frames timed out, " << packets_lost_
+                                 << " packets lost"
+    );
+}
 
-        // If the time since the frame starting being filled with packets exceeds a timeout, mark
-        // the frame as incomplete and call the ready callback.
-        if (elapsed_ms(frame_header->frame_start_time, current_time) > frame_timeout_ms_) {
-            // Calculated packets lost on this frame and add to total
-            uint32_t packets_lost = udp_packets_per_frame_ - frame_header->total_packets_received;
-            packets_lost_ += packets_lost;
+//! Handle a timed out frame.
+//!
+//! This method is called by the base class frame expiry mechanism when a frame has been mapped
+//! for longer than the frame timeout, indicating that packets have been lost and the frame is
+//! incomplete. The frame is flagged as such and notified to the main thread via the ready callback.
+//!
+//! \param[in] frame - frame number
+//! \param[in] buffer_id - ID of the buffer the frame was being received into
+//!
+void DummyUDPFrameDecoder::frame_timedout(int frame, int buffer_id)
+{
+    void* buffer_addr = get_frame_buffer_address(buffer_id);
+    DummyUDP::FrameHeader* frame_header = reinterpret_cast<DummyUDP::FrameHeader*>(buffer_addr);
 
-            LOG4CXX_DEBUG_LEVEL(
-                1, logger_,
-                "Frame " << frame_num << " in buffer " << buffer_id << " addr 0x" << std::hex << buffer_addr << std::dec
-                         << " timed out with " << frame_header->total_packets_received << " packets received, "
-                         << packets_lost << " packets lost"
-            );
+    // Calculate packets lost on this frame from the packet state bitmap and add to total
+    uint32_t packets_lost
+        = udp_packets_per_frame_ - OdinData::PacketBitmap(frame_header->packet_state, udp_packets_per_frame_).count();
+    packets_lost_ += packets_lost;
 
-            frame_header->frame_state = FrameReceiveStateTimedout;
-            ready_callback_(buffer_id, frame_num);
-            frames_timedout++;
+    LOG4CXX_DEBUG_LEVEL(
+        1, logger_,
+        "Frame " << frame << " in buffer " << buffer_id << " addr 0x" << std::hex << buffer_addr << std::dec
+                 << " timed out with " << frame_header->total_packets_received << " packets received, "
+                 << packets_lost << " packets lost"
+    );
 
-            frame_buffer_map_.erase(buffer_map_iter++);
-        } else {
-            buffer_map_iter++;
-        }
-    }
+    frame_header->frame_state = FrameReceiveStateTimedout;
+    frame_slot_table_.erase(frame);
 
-    if (frames_timedout) {
-        LOG4CXX_WARN(logger_, "Released " << frames_timedout << " timed out incomplete frames");
+    // If packets for the timed out frame are still arriving, make sure they are not written into
+    // the buffer once it has been released
+    if (frame == current_frame_seen_) {
+        current_frame_seen_ = -1;
     }
-    frames_timedout_ += frames_timedout;
 
-    LOG4CXX_DEBUG_LEVEL(
-        4, logger_,
-        get_num_mapped_buffers() << " frame buffers in use, " << get_num_empty_buffers() << " empty buffers available, "
-                                 << frames_timedout_ << " incomplete frames timed out, " << packets_lost_
-                                 << " packets lost"
-    );
+    ready_callback_(buffer_id, frame);
 }
 
 //! Get the current status of the frame decoder.
@@ -483,20 +523,7 @@ uint32_t DummyUDPFrameDecoder::get_packet_number(void) const
         & DummyUDP::packet_number_mask;
 }
 
-//! Calculate and return an elapsed time in milliseconds.
-//!
-//! This method calculates and returns an elapsed time in milliseconds based on the start and
-//! end timespec structs passed as arguments.
-//!
-//! \param[in] start - start time in timespec struct format
-//! \param[in] end - end time in timespec struct format
-//! \return elapsed time between start and end in milliseconds
-//!
-unsigned int DummyUDPFrameDecoder::elapsed_ms(struct timespec& start, struct timespec& end)
-{
-
-    double start_ns = ((double)start.tv_sec * 1000000000) + start.tv_nsec;
-    double end_ns = ((double)end.tv_sec * 1000000000) + end.tv_nsec;
-
-    return (unsigned int)((end_ns - start_ns) / 1000000);
+// Instantiate the specialised receive loop here, where the packet handling methods it calls are defined
+namespace FrameReceiver {
+template class FrameDecoderUDPReceiveLoop<DummyUDPFrameDecoder>;
 }
@@ -5,11 +5,30 @@
  *      Author: Tim Nicholls, STFC Application Engineering Group
  */
 
+#include <string.h>
+
+#include <algorithm>
+
+#include <boost/bind/bind.hpp>
+
 #include "FrameDecoder.h"
 #include "FrameReceiverDefaults.h"
+#include "gettime.h"
+
+#ifdef BOOST_HAS_PLACEHOLDERS
+using namespace boost::placeholders;
+#endif
 
 using namespace FrameReceiver;
 
+//! Get the current monotonic time in nanoseconds, used for frame timeout deadlines
+static inline uint64_t monotonic_time_ns(void)
+{
+    struct timespec now;
+    gettime(&now, true);
+    return (static_cast<uint64_t>(now.tv_sec) * 1000000000) + now.tv_nsec;
+}
+
 //! Constructor for the FrameDecoder class.
 //!
 //! This method initialises the base class of each frame decoder, storing default values
@@ -18,6 +37,12 @@ using namespace FrameReceiver;
 FrameDecoder::FrameDecoder() :
     logger_(Logger::getLogger("FR.FrameDecoder")),
     enable_packet_logging_(FrameReceiver::Defaults::default_enable_packet_logging),
+    variable_frames_(false),
+    frame_blocks_(0),
+    spill_pool_frames_(FrameReceiver::Defaults::default_spill_pool_frames),
+    spill_buffer_base_(0),
+    frames_spilled_(0),
+    frames_unspilled_(0),
     frame_timeout_ms_(FrameReceiver::Defaults::default_frame_timeout_ms),
     frames_timedout_(0),
     frames_dropped_(0) { };
@@ -40,6 +65,10 @@ void FrameDecoder::init(OdinData::IpcMessage& config_msg)
     enable_packet_logging_ = config_msg.get_param<bool>(CONFIG_DECODER_ENABLE_PACKET_LOGGING, enable_packet_logging_);
     frame_timeout_ms_ = config_msg.get_param<unsigned int>(CONFIG_DECODER_FRAME_TIMEOUT_MS, frame_timeout_ms_);
 
+    // The spill pool is sized when the buffer manager is next registered, since its buffers match
+    // the shared buffer size
+    spill_pool_frames_ = config_msg.get_param<unsigned int>(CONFIG_DECODER_SPILL_POOL_FRAMES, spill_pool_frames_);
+
     // Retrieve the packet logger instance
     packet_logger_ = Logger::getLogger("FR.PacketLogger");
 }
@@ -59,6 +88,7 @@ void FrameDecoder::request_configuration(const std::string param_prefix, OdinDat
 {
     config_reply.set_param(param_prefix + CONFIG_DECODER_ENABLE_PACKET_LOGGING, enable_packet_logging_);
     config_reply.set_param(param_prefix + CONFIG_DECODER_FRAME_TIMEOUT_MS, frame_timeout_ms_);
+    config_reply.set_param(param_prefix + CONFIG_DECODER_SPILL_POOL_FRAMES, spill_pool_frames_);
 }
 
 /** Request the decoder's supported commands.
@@ -96,13 +126,38 @@ void FrameDecoder::execute(const std::string& command, OdinData::IpcMessage& rep
 //! Register a buffer manager with the decoder.
 //!
 //! This method registers a SharedBufferManager instance with the decoder, to be used when
-//! receiving, decoding and storing incoming data.
+//! receiving, decoding and storing incoming data. The spill pool is allocated with the configured
+//! number of buffers of the same size as the shared buffers, and the frame slot table is sized to
+//! hold a frame for every buffer in the buffer manager and the spill pool.
+//!
+//! If the buffer manager holds variable-length frames, its buffers are blocks from which each frame
+//! is allocated as a run long enough for the frame buffer size, identified by its first block.
 //!
 //! \param[in] buffer_manager - pointer to a SharedBufferManager instance
 //!
 void FrameDecoder::register_buffer_manager(OdinData::SharedBufferManagerPtr buffer_manager)
 {
     buffer_manager_ = buffer_manager;
+    variable_frames_ = buffer_manager_ && buffer_manager_->has_variable_frames();
+    if (variable_frames_) {
+        size_t block_size = buffer_manager_->get_buffer_size();
+        block_allocator_.reset(buffer_manager_->get_num_buffers());
+        frame_blocks_ = (this->get_frame_buffer_size() + block_size - 1) / block_size;
+        if (frame_blocks_ > block_allocator_.num_blocks()) {
+            LOG4CXX_ERROR(
+                logger_, "Frame buffer size " << this->get_frame_buffer_size()
+                                              << " exceeds size of shared buffer, no frames can be received"
+            );
+        }
+    } else {
+        block_allocator_.reset(0);
+        frame_blocks_ = 0;
+    }
+    this->reset_spill_pool();
+
+    size_t num_buffers = buffer_manager_ ? (buffer_manager_->get_num_buffers() + spill_pool_.capacity()) : 0;
+    frame_slot_table_.reset(num_buffers);
+    frame_timeout_queue_.reset(num_buffers);
 }
 
 //! Register a frame ready callback with the decoder.
@@ -115,43 +170,57 @@ void FrameDecoder::register_buffer_manager(OdinData::SharedBufferManagerPtr buff
 //!
 void FrameDecoder::register_frame_ready_callback(FrameReadyCallback callback)
 {
-    ready_callback_ = callback;
+    // Decoders call the ready callback for frames in either shared or spill pool buffers, so route
+    // it through the decoder to copy spilled frames into shared buffers before notifying them
+    notify_callback_ = callback;
+    ready_callback_ = boost::bind(&FrameDecoder::frame_ready, this, _1, _2);
 }
 
 //! Push an buffer onto the empty buffer queue.
 //!
 //! This method is used to add an empty buffer to the tail of the internal empty buffer
-//! queue for subsequent use receiving frame data
+//! queue for subsequent use receiving frame data. If ready frames are being held back behind
+//! frames in the spill pool, the buffer is first used to release them. For variable-length
+//! frames, the run of blocks starting at the buffer is instead returned to the block allocator.
 //!
 //! \param[in] buffer_id - SharedBufferManager buffer ID
 //!
 void FrameDecoder::push_empty_buffer(int buffer_id)
 {
-    empty_buffer_queue_.push(buffer_id);
+    if (!variable_frames_) {
+        empty_buffer_queue_.push(buffer_id);
+    } else if (!block_allocator_.release(buffer_id)) {
+        LOG4CXX_WARN(logger_, "Ignoring release of buffer ID " << buffer_id << " which does not start a frame");
+        return;
+    }
+    if (!pending_frames_.empty()) {
+        this->release_pending_frames();
+    }
 }
 
 //! Get the number of empty buffers queued.
 //!
 //! This method returns the number of buffers currently queued by the decoder in the empty
-//! buffer queue
+//! buffer queue or, for variable-length frames, the number of free shared buffer blocks.
 //!
 //! \return number of empty buffers queued
 //!
 const size_t FrameDecoder::get_num_empty_buffers(void) const
 {
-    return empty_buffer_queue_.size();
+    return variable_frames_ ? block_allocator_.free_blocks() : empty_buffer_queue_.size();
 }
 
 //! Get the number of mapped buffers currently held.
 //!
 //! This method returns the number of buffers currently mapped to incoming frames by the
-//! decoder, i.e. frames which are being filled but are not yet ready for processing.
+//! decoder, i.e. frames which are being filled but are not yet ready for processing. Decoders
+//! may track these frames in either the frame buffer map or the frame slot table.
 //!
 //! \return - number of buffers currently mapped for incoming frames
 //!
 const size_t FrameDecoder::get_num_mapped_buffers(void) const
 {
-    return frame_buffer_map_.size();
+    return frame_buffer_map_.size() + frame_slot_table_.size();
 }
 
 //! Get the current frame timeout value.
@@ -165,6 +234,21 @@ const unsigned int FrameDecoder::get_frame_timeout_ms(void) const
     return frame_timeout_ms_;
 }
 
+//! Get the frame expiry period.
+//!
+//! This method returns the period in milliseconds at which the receive thread should call
+//! expire_frames() to release frames whose timeout has passed. The period is a fraction of
+//! the frame timeout so that incomplete frames are released close to their deadline rather than
+//! holding a buffer for up to twice the timeout.
+//!
+//! \return - frame expiry period in milliseconds
+//!
+const unsigned int FrameDecoder::get_frame_expiry_period_ms(void) const
+{
+    unsigned int period_ms = frame_timeout_ms_ / frame_expiry_divisions;
+    return (period_ms > 0) ? period_ms : 1;
+}
+
 //! Get the number of frames timed out in the decoder
 //!
 //! This method returns the number of frames that have timed out during reception
@@ -190,6 +274,67 @@ const unsigned int FrameDecoder::get_num_frames_dropped(void) const
     return frames_dropped_;
 }
 
+//! Get the number of buffers in the spill pool.
+//!
+//! This method returns the number of frame buffers in the spill pool, which frames are received
+//! into when the shared buffers are exhausted.
+//!
+//! \return - number of spill pool buffers
+//!
+const size_t FrameDecoder::get_spill_pool_size(void) const
+{
+    return spill_pool_.capacity();
+}
+
+//! Get the number of spill pool buffers currently in use.
+//!
+//! This method returns the number of spill pool buffers holding frames which are either being
+//! received or waiting for a shared buffer to be copied into.
+//!
+//! \return - number of spill pool buffers in use
+//!
+const size_t FrameDecoder::get_num_spilled_buffers(void) const
+{
+    return spill_pool_.in_use();
+}
+
+//! Get the peak number of spill pool buffers in use.
+//!
+//! This method returns the largest number of spill pool buffers in use at once since the
+//! statistics were last reset. The shared buffer pool would need to be larger by this many
+//! buffers to have received the same frames without spilling.
+//!
+//! \return - peak number of spill pool buffers in use
+//!
+const size_t FrameDecoder::get_spill_pool_peak(void) const
+{
+    return spill_pool_.peak_in_use();
+}
+
+//! Get the number of frames spilled by the decoder.
+//!
+//! This method returns the number of frames received into spill pool buffers because no shared
+//! buffers were available.
+//!
+//! \return - number of frames spilled
+//!
+const unsigned int FrameDecoder::get_num_frames_spilled(void) const
+{
+    return frames_spilled_;
+}
+
+//! Get the number of frames unspilled by the decoder.
+//!
+//! This method returns the number of spilled frames which have been copied into shared buffers
+//! and notified as ready.
+//!
+//! \return - number of frames unspilled
+//!
+const unsigned int FrameDecoder::get_num_frames_unspilled(void) const
+{
+    return frames_unspilled_;
+}
+
 //! Drop all buffers currently held by the decoder.
 //!
 //! This method forces the decoder to drop all buffers currently held either in the empty
@@ -205,6 +350,11 @@ void FrameDecoder::drop_all_buffers(void)
         std::swap(empty_buffer_queue_, new_queue);
     }
 
+    if (block_allocator_.free_blocks()) {
+        LOG4CXX_INFO(logger_, "Dropping " << block_allocator_.free_blocks() << " free blocks from block allocator");
+    }
+    block_allocator_.reset(block_allocator_.num_blocks());
+
     if (!frame_buffer_map_.empty()) {
         LOG4CXX_WARN(
             logger_, "Dropping " << frame_buffer_map_.size() << " unreleased buffers from decoder - possible data loss"
@@ -212,6 +362,170 @@ void FrameDecoder::drop_all_buffers(void)
         FrameBufferMap new_map;
         std::swap(frame_buffer_map_, new_map);
     }
+
+    if (!frame_slot_table_.empty()) {
+        LOG4CXX_WARN(
+            logger_, "Dropping " << frame_slot_table_.size() << " unreleased buffers from decoder - possible data loss"
+        );
+        frame_slot_table_.clear();
+    }
+
+    if (!pending_frames_.empty() || spill_pool_.in_use()) {
+        LOG4CXX_WARN(
+            logger_, "Dropping " << spill_pool_.in_use() << " spilled frames and " << pending_frames_.size()
+                                 << " pending ready frames from decoder - possible data loss"
+        );
+        pending_frames_.clear();
+        this->reset_spill_pool();
+    }
+
+    frame_timeout_queue_.clear();
+}
+
+//! Expire frames whose timeout has passed.
+//!
+//! This method, called periodically by the receive thread, releases every frame registered with
+//! start_frame_timeout() whose deadline has passed, in deadline order. Only the frames that are
+//! due are visited, so the cost is independent of the number of mapped buffers. Each expired
+//! frame is passed to frame_timedout() for handling by the decoder.
+//!
+void FrameDecoder::expire_frames(void)
+{
+    if (frame_timeout_queue_.empty()) {
+        return;
+    }
+
+    uint64_t now_ns = monotonic_time_ns();
+    unsigned int frames_expired = 0;
+    int frame;
+    int buffer_id;
+
+    while (frame_timeout_queue_.pop_expired(now_ns, frame, buffer_id)) {
+        frame_timedout(frame, buffer_id);
+        frames_expired++;
+    }
+
+    if (frames_expired) {
+        LOG4CXX_WARN(logger_, "Released " << frames_expired << " timed out incomplete frames");
+        frames_timedout_ += frames_expired;
+    }
+}
+
+//! Start the timeout for a frame.
+//!
+//! This method is called by decoders when the first packet of a frame is received into a buffer,
+//! registering a deadline of the current time plus the frame timeout. If the frame has not
+//! completed by then, it will be passed to frame_timedout() by expire_frames().
+//!
+//! \param[in] frame - frame number
+//! \param[in] buffer_id - ID of the buffer the frame is being received into
+//!
+void FrameDecoder::start_frame_timeout(int frame, int buffer_id)
+{
+    uint64_t deadline_ns = monotonic_time_ns() + (static_cast<uint64_t>(frame_timeout_ms_) * 1000000);
+    frame_timeout_queue_.add(frame, buffer_id, deadline_ns);
+}
+
+//! Cancel the timeout for a frame.
+//!
+//! This method is called by decoders when a frame completes and its buffer is released, so that
+//! the frame is not subsequently timed out.
+//!
+//! \param[in] buffer_id - ID of the buffer the frame was received into
+//!
+void FrameDecoder::cancel_frame_timeout(int buffer_id)
+{
+    frame_timeout_queue_.cancel(buffer_id);
+}
+
+//! Get an empty buffer to receive a frame into.
+//!
+//! This method is called by decoders when the first packet of a frame is received, to obtain a
+//! buffer for it. Buffers are taken from the empty buffer queue in preference; if it is empty,
+//! a buffer is taken from the spill pool instead. Decoders must use get_frame_buffer_address()
+//! to find the address of the buffer, since spill pool buffers are not in the buffer manager.
+//!
+//! For variable-length frames, a run of blocks of the frame buffer size is allocated from the
+//! shared buffer instead of taking a buffer from the queue. Decoders can call set_frame_length()
+//! once the frame is complete to return the blocks it did not use.
+//!
+//! \param[out] buffer_id - ID of the buffer obtained
+//! \return - true if a buffer was obtained, false if both the queue and spill pool are empty
+//!
+bool FrameDecoder::get_empty_buffer(int& buffer_id)
+{
+    if (this->take_shared_buffer(this->get_frame_buffer_size(), buffer_id)) {
+        return true;
+    }
+
+    size_t slot;
+    if (spill_pool_.acquire(slot)) {
+        buffer_id = spill_buffer_base_ + static_cast<int>(slot);
+        spill_frame_lengths_[slot] = this->get_frame_buffer_size();
+        frames_spilled_++;
+        LOG4CXX_DEBUG_LEVEL(
+            2, logger_, "No empty shared buffers available, spilling frame into buffer ID " << buffer_id
+        );
+        return true;
+    }
+
+    return false;
+}
+
+//! Get the address of a frame buffer.
+//!
+//! This method returns the address of a buffer obtained with get_empty_buffer(), which may be
+//! either a shared buffer or a spill pool buffer.
+//!
+//! \param[in] buffer_id - ID of the buffer
+//! \return - address of the buffer
+//!
+void* FrameDecoder::get_frame_buffer_address(int buffer_id) const
+{
+    if (is_spill_buffer(buffer_id)) {
+        return spill_pool_.address(buffer_id - spill_buffer_base_);
+    }
+    return buffer_manager_->get_buffer_address(buffer_id);
+}
+
+//! Set the length of the frame in a buffer.
+//!
+//! This method is called by decoders once the length of a frame is known, before it is notified as
+//! ready, for frames which do not fill the frame buffer size, e.g. compressed or sparse data. For
+//! variable-length frames the length is recorded in the shared buffer for downstream processes and
+//! the blocks beyond it are returned to the block allocator. For fixed-size buffers the frame
+//! occupies the whole buffer, and the length is only used when copying a spilled frame.
+//!
+//! \param[in] buffer_id - ID of the buffer obtained with get_empty_buffer()
+//! \param[in] length - length of the frame in bytes, including the frame header
+//!
+void FrameDecoder::set_frame_length(int buffer_id, size_t length)
+{
+    length = std::min(length, this->get_frame_buffer_size());
+
+    if (is_spill_buffer(buffer_id)) {
+        spill_frame_lengths_[buffer_id - spill_buffer_base_] = length;
+    } else if (variable_frames_) {
+        size_t block_size = buffer_manager_->get_buffer_size();
+        size_t num_blocks = std::max<size_t>((length + block_size - 1) / block_size, 1);
+        block_allocator_.shrink(buffer_id, num_blocks);
+        buffer_manager_->set_frame_length(buffer_id, length);
+    }
+}
+
+//! Handle a frame timeout.
+//!
+//! This method is called by expire_frames() for each frame whose timeout has passed. This
+//! default implementation simply releases the frame via the ready callback; decoders should
+//! override it to mark the frame header as timed out and update their own statistics before
+//! releasing the frame.
+//!
+//! \param[in] frame - frame number
+//! \param[in] buffer_id - ID of the buffer the frame was being received into
+//!
+void FrameDecoder::frame_timedout(int frame, int buffer_id)
+{
+    ready_callback_(buffer_id, frame);
 }
 
 //! Collate version information for the decoder.
@@ -240,4 +554,129 @@ void FrameDecoder::reset_statistics(void)
     LOG4CXX_DEBUG_LEVEL(1, logger_, "Resetting frame decoder statistics");
     frames_timedout_ = 0;
     frames_dropped_ = 0;
+    frames_spilled_ = 0;
+    frames_unspilled_ = 0;
+    spill_pool_.reset_peak();
+}
+
+//! Handle a frame ready to be processed.
+//!
+//! This method is registered as the ready callback called by decoders. Frames in shared buffers
+//! are notified downstream immediately unless earlier frames are held in the spill pool, in which
+//! case they are queued behind them so that frames are notified in the order they became ready.
+//!
+//! \param[in] buffer_id - ID of the buffer the frame was received into
+//! \param[in] frame - frame number
+//!
+void FrameDecoder::frame_ready(int buffer_id, int frame)
+{
+    if (pending_frames_.empty() && !is_spill_buffer(buffer_id)) {
+        notify_callback_(buffer_id, frame);
+        return;
+    }
+
+    pending_frames_.push_back(std::make_pair(buffer_id, frame));
+    this->release_pending_frames();
+}
+
+//! Release ready frames held back behind spilled frames.
+//!
+//! This method notifies pending ready frames downstream in order, copying each spilled frame
+//! into an empty shared buffer and returning its spill pool buffer. It stops at the first
+//! spilled frame for which no empty shared buffer is available.
+//!
+void FrameDecoder::release_pending_frames(void)
+{
+    while (!pending_frames_.empty()) {
+        int buffer_id = pending_frames_.front().first;
+        int frame = pending_frames_.front().second;
+
+        if (is_spill_buffer(buffer_id)) {
+            size_t slot = buffer_id - spill_buffer_base_;
+            size_t copy_size = std::min(spill_frame_lengths_[slot], spill_pool_.frame_size());
+            int shared_buffer_id;
+            if (!this->take_shared_buffer(copy_size, shared_buffer_id)) {
+                break;
+            }
+
+            memcpy(buffer_manager_->get_buffer_address(shared_buffer_id), spill_pool_.address(slot), copy_size);
+            spill_pool_.release(slot);
+            frames_unspilled_++;
+
+            LOG4CXX_DEBUG_LEVEL(
+                2, logger_, "Copied spilled frame " << frame << " from buffer ID " << buffer_id << " to buffer ID "
+                                                    << shared_buffer_id
+            );
+            buffer_id = shared_buffer_id;
+        }
+
+        // Remove the frame from the queue before notifying it, in case the notification releases
+        // a buffer back to the decoder
+        pending_frames_.pop_front();
+        notify_callback_(buffer_id, frame);
+    }
+}
+
+//! Take a shared buffer to hold a frame.
+//!
+//! This method takes an empty buffer from the empty buffer queue or, for variable-length frames,
+//! allocates a run of blocks long enough for the specified frame length and records the length in
+//! the shared buffer.
+//!
+//! \param[in] length - length of the frame in bytes
+//! \param[out] buffer_id - ID of the buffer taken
+//! \return - true if a buffer was taken, false if none is available
+//!
+bool FrameDecoder::take_shared_buffer(size_t length, int& buffer_id)
+{
+    if (variable_frames_) {
+        size_t block_size = buffer_manager_->get_buffer_size();
+        size_t num_blocks = std::max<size_t>((length + block_size - 1) / block_size, 1);
+        size_t first_block;
+        if (!block_allocator_.allocate(num_blocks, first_block)) {
+            return false;
+        }
+        buffer_manager_->set_frame_length(first_block, length);
+        buffer_id = static_cast<int>(first_block);
+        return true;
+    }
+
+    if (empty_buffer_queue_.empty()) {
+        return false;
+    }
+    buffer_id = empty_buffer_queue_.front();
+    empty_buffer_queue_.pop();
+    return true;
+}
+
+//! Reset the spill pool.
+//!
+//! This method reallocates the spill pool with the configured number of buffers, each the size
+//! of a shared buffer or, for variable-length frames, the frame buffer size, discarding any frames
+//! it holds. Spill pool buffer IDs follow on from the shared buffer IDs. The pool is left empty if
+//! no buffer manager is registered.
+//!
+void FrameDecoder::reset_spill_pool(void)
+{
+    size_t num_frames = buffer_manager_ ? spill_pool_frames_ : 0;
+    size_t frame_size = 0;
+    if (buffer_manager_) {
+        frame_size = variable_frames_ ? this->get_frame_buffer_size() : buffer_manager_->get_buffer_size();
+    }
+
+    if (!spill_pool_.reset(num_frames, frame_size)) {
+        LOG4CXX_ERROR(logger_, "Failed to allocate spill pool of " << num_frames << " frames, spilling disabled");
+    }
+    spill_frame_lengths_.assign(spill_pool_.capacity(), frame_size);
+    spill_buffer_base_ = buffer_manager_ ? static_cast<int>(buffer_manager_->get_num_buffers()) : 0;
+}
+
+//! Indicate if a buffer ID refers to a spill pool buffer.
+//!
+//! \param[in] buffer_id - ID of the buffer
+//! \return - true if the buffer is in the spill pool
+//!
+bool FrameDecoder::is_spill_buffer(int buffer_id) const
+{
+    return (spill_pool_.capacity() > 0) && (buffer_id >= spill_buffer_base_);
 }
@@ -0,0 +1,315 @@
+/*
+ * FrameDecoderBenchmarkApp.cpp - microbenchmark of UDP frame decoders without sockets
+ *
+ * This application loads a UDP frame decoder plugin, as the frameReceiver does, and drives it
+ * with a packet stream through the FrameDecoderUDPBenchmark harness, reporting the per-packet
+ * cost of decoding. Synthetic in-order, reordered, interleaved and lossy streams are generated
+ * for the DummyUDP decoder; other decoders are driven by a stream loaded from a pcap capture of
+ * their detector traffic.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <log4cxx/basicconfigurator.h>
+#include <log4cxx/logger.h>
+#include <log4cxx/propertyconfigurator.h>
+#include <log4cxx/xml/domconfigurator.h>
+using namespace log4cxx;
+using namespace log4cxx::helpers;
+
+#include <boost/program_options.hpp>
+namespace po = boost::program_options;
+
+#include "ClassLoader.h"
+#include "DummyUDPFrameDecoder.h"
+#include "FrameDecoderUDPBenchmark.h"
+#include "FrameReceiverDefaults.h"
+#include "stringparse.h"
+#include "version.h"
+
+#ifdef __APPLE__
+#define SHARED_LIBRARY_SUFFIX ".dylib"
+#else
+#define SHARED_LIBRARY_SUFFIX ".so"
+#endif
+
+using namespace FrameReceiver;
+
+namespace {
+
+bool has_suffix(const std::string& str, const std::string& suffix)
+{
+    return str.size() >= suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+//! Parameters of a synthetic DummyUDP packet stream
+struct DummyUDPStream {
+    std::string ordering; //!< Packet ordering: inorder, reordered, interleaved or lossy
+    unsigned int frames; //!< Number of frames in the stream
+    unsigned int packets_per_frame; //!< Number of packets per frame
+    std::size_t packet_size; //!< Size of the packet payload, excluding the packet header
+    unsigned int reorder_window; //!< Number of packets within which a reordered stream is shuffled
+    unsigned int interleave; //!< Number of frames whose packets are interleaved
+    double loss; //!< Fraction of packets lost in a lossy stream
+};
+
+//! Shuffle a range of packet numbers in place
+void shuffle_packets(std::vector<uint32_t>& packets, std::size_t first, std::size_t last)
+{
+    for (std::size_t idx = last; idx > first + 1; idx--) {
+        std::size_t swap_idx = first + (random() % (idx - first));
+        std::swap(packets[idx - 1], packets[swap_idx]);
+    }
+}
+
+//! Generate a synthetic DummyUDP packet stream into the benchmark, returning the number of packets
+std::size_t generate_dummy_udp_stream(FrameDecoderUDPBenchmark& benchmark, const DummyUDPStream& stream)
+{
+    std::vector<uint8_t> packet(sizeof(DummyUDP::PacketHeader) + stream.packet_size);
+    for (std::size_t idx = sizeof(DummyUDP::PacketHeader); idx < packet.size(); idx++) {
+        packet[idx] = static_cast<uint8_t>(idx);
+    }
+    DummyUDP::PacketHeader* header = reinterpret_cast<DummyUDP::PacketHeader*>(&packet[0]);
+
+    // Frames are generated in groups, with the packets of the frames in a group interleaved
+    unsigned int group_size = (stream.ordering == "interleaved") ? std::max(stream.interleave, 1U) : 1;
+    std::vector<uint32_t> packet_order(stream.packets_per_frame);
+
+    for (unsigned int first_frame = 0; first_frame < stream.frames; first_frame += group_size) {
+        unsigned int frames_in_group = std::min(group_size, stream.frames - first_frame);
+
+        for (uint32_t idx = 0; idx < stream.packets_per_frame; idx++) {
+            packet_order[idx] = idx;
+        }
+        if (stream.ordering == "reordered") {
+            std::size_t window = std::max(stream.reorder_window, 2U);
+            for (std::size_t first = 0; first < packet_order.size(); first += window) {
+                shuffle_packets(packet_order, first, std::min(first + window, packet_order.size()));
+            }
+        }
+
+        for (uint32_t idx = 0; idx < stream.packets_per_frame; idx++) {
+            for (unsigned int frame = first_frame; frame < first_frame + frames_in_group; frame++) {
+                if ((stream.ordering == "lossy") && ((random() / (RAND_MAX + 1.0)) < stream.loss)) {
+                    continue;
+                }
+                uint32_t packet_number = packet_order[idx];
+                header->frame_number = frame;
+                header->packet_number_flags = packet_number;
+                if (packet_number == 0) {
+                    header->packet_number_flags |= DummyUDP::start_of_frame_mask;
+                }
+                if (packet_number == stream.packets_per_frame - 1) {
+                    header->packet_number_flags |= DummyUDP::end_of_frame_mask;
+                }
+                benchmark.add_packet(&packet[0], packet.size());
+            }
+        }
+    }
+    return benchmark.get_num_packets();
+}
+
+//! Print the benchmark results
+void print_results(const FrameDecoderUDPBenchmark::Result& result)
+{
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Packets processed:     " << result.packets << std::endl;
+    std::cout << "Elapsed time (s):      " << result.elapsed_s << std::endl;
+    std::cout << "Time per packet (ns):  " << result.ns_per_packet << std::endl;
+    std::cout << "Packet rate (pkt/s):   " << result.packets_per_s << std::endl;
+    std::cout << "Data rate (Gbit/s):    " << result.gbits_per_s << std::endl;
+    std::cout << "Frames released:       " << result.frames_ready << std::endl;
+    std::cout << "Frame rate (frames/s): " << result.frames_per_s << std::endl;
+    std::cout << "Frames timed out:      " << result.frames_timedout << std::endl;
+    std::cout << "Frames dropped:        " << result.frames_dropped << std::endl;
+
+    if (result.counters.empty()) {
+        std::cout << "Hardware counters:     unavailable" << std::endl;
+        return;
+    }
+    for (std::map<std::string, uint64_t>::const_iterator counter = result.counters.begin();
+         counter != result.counters.end(); ++counter) {
+        std::string label = counter->first + " per packet:";
+        std::cout << std::left << std::setw(23) << label << std::right
+                  << (result.packets ? static_cast<double>(counter->second) / result.packets : 0.0) << std::endl;
+    }
+    std::map<std::string, uint64_t>::const_iterator cycles = result.counters.find("cycles");
+    std::map<std::string, uint64_t>::const_iterator instructions = result.counters.find("instructions");
+    if ((cycles != result.counters.end()) && (instructions != result.counters.end()) && (cycles->second > 0)) {
+        std::cout << "Instructions per cycle: " << static_cast<double>(instructions->second) / cycles->second
+                  << std::endl;
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    BasicConfigurator::configure();
+    Logger::getRootLogger()->setLevel(Level::getWarn());
+    LoggerPtr logger = Logger::getLogger("FR.DecoderBenchmark");
+
+    DummyUDPStream stream;
+    std::string decoder_type;
+    std::string decoder_path;
+    std::string decoder_config_json;
+    std::string pcap_file;
+    int pcap_port;
+    unsigned int frame_timeout_ms;
+    std::size_t num_buffers;
+    std::size_t batch_size;
+    unsigned int passes;
+    unsigned int seed;
+
+    try {
+        po::options_description options("Options");
+        options.add_options()
+        ("help,h", "Print this help message")
+        ("version,v", "Print program version string")
+        ("debug-level,d", po::value<unsigned int>(), "Set the debug level")
+        ("log-config,l", po::value<std::string>(), "Set the log4cxx logging configuration file")
+        ("decoder", po::value<std::string>(&decoder_type)->default_value("DummyUDP"),
+         "Decoder type to load, e.g. DummyUDP")
+        ("decoder-path", po::value<std::string>(&decoder_path)->default_value(Defaults::default_decoder_path),
+         "Path to the decoder library")
+        ("decoder-config", po::value<std::string>(&decoder_config_json)->default_value("{}"),
+         "JSON object of decoder configuration parameters")
+        ("frame-timeout", po::value<unsigned int>(&frame_timeout_ms)->default_value(0),
+         "Decoder frame timeout in ms, or 0 for the decoder default")
+        ("stream", po::value<std::string>(&stream.ordering)->default_value("inorder"),
+         "Packet stream: inorder, reordered, interleaved, lossy (DummyUDP only) or pcap")
+        ("pcap-file", po::value<std::string>(&pcap_file), "Capture file to load a pcap stream from")
+        ("pcap-port", po::value<int>(&pcap_port)->default_value(-1),
+         "Destination port of packets to load from a pcap stream, or -1 for all ports")
+        ("frames", po::value<unsigned int>(&stream.frames)->default_value(1000),
+         "Number of frames in a synthetic stream")
+        ("packets-per-frame", po::value<unsigned int>(&stream.packets_per_frame)->default_value(100),
+         "Number of packets per frame in a synthetic stream")
+        ("packet-size", po::value<std::size_t>(&stream.packet_size)->default_value(DummyUDP::default_packet_size),
+         "Packet payload size in a synthetic stream")
+        ("reorder-window", po::value<unsigned int>(&stream.reorder_window)->default_value(16),
+         "Number of packets within which a reordered stream is shuffled")
+        ("interleave", po::value<unsigned int>(&stream.interleave)->default_value(4),
+         "Number of frames whose packets are interleaved in an interleaved stream")
+        ("loss", po::value<double>(&stream.loss)->default_value(0.01), "Fraction of packets lost in a lossy stream")
+        ("seed", po::value<unsigned int>(&seed)->default_value(1), "Random seed for reordered and lossy streams")
+        ("buffers", po::value<std::size_t>(&num_buffers)->default_value(64), "Number of shared frame buffers")
+        ("batch-size", po::value<std::size_t>(&batch_size)->default_value(0),
+         "Number of packets per batched receive, or 0 for single packet receive")
+        ("passes", po::value<unsigned int>(&passes)->default_value(10), "Number of times to replay the stream")
+        ;
+
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, options), vm);
+        po::notify(vm);
+
+        if (vm.count("help")) {
+            std::cout << "usage: frameDecoderBenchmark [options]" << std::endl << std::endl;
+            std::cout << options << std::endl;
+            return 0;
+        }
+        if (vm.count("version")) {
+            std::cout << "frameDecoderBenchmark version " ODIN_DATA_VERSION_STR << std::endl;
+            return 0;
+        }
+        if (vm.count("log-config")) {
+            std::string log_config = vm["log-config"].as<std::string>();
+            if (has_suffix(log_config, ".xml")) {
+                log4cxx::xml::DOMConfigurator::configure(log_config);
+            } else {
+                PropertyConfigurator::configure(log_config);
+            }
+        }
+        if (vm.count("debug-level")) {
+            set_debug_level(vm["debug-level"].as<unsigned int>());
+            Logger::getRootLogger()->setLevel(Level::getDebug());
+        }
+
+        bool synthetic_stream = (stream.ordering != "pcap");
+        if (synthetic_stream) {
+            if (decoder_type != "DummyUDP") {
+                throw std::runtime_error("Synthetic streams are only generated for the DummyUDP decoder");
+            }
+            if ((stream.ordering != "inorder") && (stream.ordering != "reordered") && (stream.ordering != "interleaved")
+                && (stream.ordering != "lossy")) {
+                throw std::runtime_error("Unknown stream type " + stream.ordering);
+            }
+        } else if (pcap_file.empty()) {
+            throw std::runtime_error("A pcap stream requires a capture file to be specified");
+        }
+
+        // Build the decoder configuration, setting the frame geometry of a synthetic stream
+        rapidjson::Document decoder_config_doc;
+        decoder_config_doc.Parse(decoder_config_json.c_str());
+        if (decoder_config_doc.HasParseError() || !decoder_config_doc.IsObject()) {
+            throw std::runtime_error("Decoder configuration is not a valid JSON object");
+        }
+        OdinData::IpcMessage decoder_config(decoder_config_doc);
+        if (synthetic_stream) {
+            decoder_config.set_param<unsigned int>(CONFIG_DECODER_UDP_PACKETS_PER_FRAME, stream.packets_per_frame);
+            decoder_config.set_param<unsigned int>(CONFIG_DECODER_UDP_PACKET_SIZE, stream.packet_size);
+        }
+        if (frame_timeout_ms > 0) {
+            decoder_config.set_param<unsigned int>(CONFIG_DECODER_FRAME_TIMEOUT_MS, frame_timeout_ms);
+        }
+
+        // Load and initialise the decoder as the frameReceiver controller does
+        if (!decoder_path.empty() && (decoder_path[decoder_path.length() - 1] != '/')) {
+            decoder_path += '/';
+        }
+        std::string lib_name = "lib" + decoder_type + "FrameDecoder" + SHARED_LIBRARY_SUFFIX;
+        std::string cls_name = decoder_type + "FrameDecoder";
+        FrameDecoderUDPPtr decoder = boost::dynamic_pointer_cast<FrameDecoderUDP>(
+            OdinData::ClassLoader<FrameDecoder>::load_class(cls_name, decoder_path + lib_name)
+        );
+        if (!decoder) {
+            throw std::runtime_error(
+                "Cannot load " + cls_name + " from " + decoder_path + lib_name + " as a UDP decoder"
+            );
+        }
+        decoder->init(logger, decoder_config);
+
+        std::stringstream shared_buffer_name;
+        shared_buffer_name << "FrameDecoderBenchmark_" << getpid();
+        OdinData::SharedBufferManagerPtr buffer_manager(new OdinData::SharedBufferManager(
+            shared_buffer_name.str(), num_buffers * decoder->get_frame_buffer_size(), decoder->get_frame_buffer_size()
+        ));
+
+        FrameDecoderUDPBenchmark benchmark(decoder, buffer_manager, batch_size);
+        std::size_t num_packets;
+        if (synthetic_stream) {
+            srandom(seed);
+            num_packets = generate_dummy_udp_stream(benchmark, stream);
+        } else {
+            num_packets = benchmark.load_pcap(pcap_file, pcap_port);
+            if (num_packets == 0) {
+                throw std::runtime_error("No packets loaded from " + pcap_file);
+            }
+        }
+
+        std::cout << "Decoder:               " << cls_name << std::endl;
+        std::cout << "Stream:                " << stream.ordering << ", " << num_packets << " packets x " << passes
+                  << " passes" << std::endl;
+        std::cout << "Receive mode:          "
+                  << (((batch_size > 0) && decoder->supports_batch_receive()) ? "batched" : "single packet")
+                  << std::endl;
+        print_results(benchmark.run(passes));
+
+    } catch (po::error& e) {
+        std::cerr << "Error parsing command line arguments: " << e.what() << std::endl;
+        return 1;
+    } catch (std::exception& e) {
+        std::cerr << "Benchmark failed: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
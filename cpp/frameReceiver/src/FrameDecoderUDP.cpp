@@ -0,0 +1,195 @@
+/*
+ * FrameDecoderUDP.cpp - abstract base class for UDP frameReceiver decoder plugins
+ */
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "FrameDecoderUDP.h"
+
+using namespace FrameReceiver;
+
+//! Create a packet receiver specialised on the concrete decoder type.
+//!
+//! This method returns a packet receiver which the UDP receiver thread uses in place of calling
+//! the decoder packet handling methods individually for each packet. The default implementation
+//! returns an empty pointer, in which case the receiver thread uses those methods. Decoders derived
+//! from FrameDecoderUDPSpecialised return a receive loop in which the calls are resolved at compile
+//! time.
+//!
+//! \return pointer to the packet receiver, or an empty pointer if the decoder has none
+//!
+UDPPacketReceiverPtr FrameDecoderUDP::create_packet_receiver(void)
+{
+    return UDPPacketReceiverPtr();
+}
+
+//! Get the maximum packet payload size for batched receive.
+//!
+//! This method returns the maximum payload size of a single packet received by the decoder. It
+//! is used to size the staging slots for batched receive. The default implementation returns zero,
+//! indicating that the decoder does not support batched receive. Decoders opting in to batched
+//! receive should override this method.
+//!
+//! \return maximum packet payload size in bytes, or zero if batching is unsupported
+//!
+const size_t FrameDecoderUDP::get_max_payload_size(void) const
+{
+    return 0;
+}
+
+//! Get the predicted location of the payload of a packet yet to be received.
+//!
+//! This method returns the buffer that the payload of a packet will be placed in, if packets
+//! continue to arrive in order, allowing batched receive to scatter payloads directly into frame
+//! buffers. The packets_ahead argument counts packets after the last one processed, starting at
+//! one. A location must be able to hold a maximum size payload and must only be returned if no
+//! data for the frame has yet been received into it, since a mispredicted packet is received there
+//! before being moved to its actual location. The
+//! default implementation returns a null pointer, in which case payloads are received into the
+//! batch staging slots and copied into the frame buffers as each packet is processed.
+//!
+//! \param[in] packets_ahead - number of packets after the last one processed
+//! \return pointer to the predicted payload buffer, or a null pointer if it cannot be predicted
+//!
+void* FrameDecoderUDP::get_predicted_payload_buffer(std::size_t packets_ahead) const
+{
+    return NULL;
+}
+
+//! Indicate if the decoder supports batched packet receive.
+//!
+//! \return true if the decoder supports batched receive
+//!
+const bool FrameDecoderUDP::supports_batch_receive(void) const
+{
+    return (get_max_payload_size() > 0);
+}
+
+//! Initialise the decoder for batched packet receive.
+//!
+//! This method is called by the UDP receiver thread before entering batched receive mode. The
+//! default implementation allocates a staging buffer with one slot per packet in the batch, each
+//! slot being large enough to hold a packet header (if the decoder requires a header peek) and a
+//! maximum size payload. Payloads are only received directly into predicted frame buffer locations
+//! if direct placement is enabled, which requires that batches are received and processed by a
+//! single thread, with the slots of each batch starting at zero.
+//!
+//! \param[in] batch_size - maximum number of packets received in a single batch
+//! \param[in] direct_placement - receive payloads directly into predicted frame buffer locations
+//!
+void FrameDecoderUDP::init_batch_receive(std::size_t batch_size, bool direct_placement)
+{
+    batch_size_ = batch_size;
+    batch_slot_size_ = get_max_payload_size();
+    if (requires_header_peek()) {
+        batch_slot_size_ += get_packet_header_size();
+    }
+    batch_buffer_.assign(batch_size_ * batch_slot_size_, 0);
+    batch_payloads_.assign(batch_size_, NULL);
+    batch_direct_placement_ = direct_placement;
+
+    LOG4CXX_DEBUG_LEVEL(
+        1, logger_,
+        "Initialised batched receive with " << batch_size_ << " slots of " << batch_slot_size_ << " bytes"
+    );
+}
+
+//! Get the receive iovecs for a packet slot in a batch.
+//!
+//! This method populates the iovec array passed as an argument with the buffers that a packet
+//! received into the specified batch slot should be scattered into. The default implementation
+//! points the header (if required) into the staging buffer slot, since the headers of all packets
+//! in a batch are needed to process them. The payload is pointed at its predicted location in a
+//! frame buffer if direct placement is enabled and the decoder can predict it, otherwise into the
+//! staging buffer slot.
+//!
+//! \param[in] slot - index of the packet slot within the batch
+//! \param[out] iov - array of at least max_batch_iovecs iovec structures to populate
+//! \return number of iovecs populated
+//!
+std::size_t FrameDecoderUDP::get_batch_iovecs(std::size_t slot, struct iovec* iov)
+{
+    std::size_t num_iovecs = 0;
+    uint8_t* slot_ptr = &batch_buffer_[slot * batch_slot_size_];
+
+    if (requires_header_peek()) {
+        iov[num_iovecs].iov_base = slot_ptr;
+        iov[num_iovecs].iov_len = get_packet_header_size();
+        slot_ptr += get_packet_header_size();
+        num_iovecs++;
+    }
+
+    uint8_t* payload_ptr = NULL;
+    if (batch_direct_placement_) {
+        payload_ptr = static_cast<uint8_t*>(get_predicted_payload_buffer(slot + 1));
+    }
+    batch_payloads_[slot] = (payload_ptr != NULL) ? payload_ptr : slot_ptr;
+
+    iov[num_iovecs].iov_base = batch_payloads_[slot];
+    iov[num_iovecs].iov_len = get_max_payload_size();
+    num_iovecs++;
+
+    return num_iovecs;
+}
+
+//! Process a batch of received packets.
+//!
+//! This method is called by the UDP receiver thread once a batch of packets has been received
+//! into the slots described by get_batch_iovecs. The default implementation replays each packet
+//! through the same header/payload sequence used for single packet receive, copying the header
+//! from the staging slot into the decoder header buffer. A payload received at the location
+//! specified by the decoder is processed in place, otherwise it is copied there. Before such a
+//! copy, the payloads of that and any later packets received directly into frame buffers are
+//! moved to their staging slots, since the copy could otherwise overwrite them. Receive worker
+//! threads each use their own contiguous range of slots, starting at first_slot.
+//!
+//! \param[in] first_slot - index of the slot the first packet of the batch was received into
+//! \param[in] num_packets - number of packets received in the batch
+//! \param[in] bytes_received - array of the number of bytes received for each packet
+//! \param[in] port - UDP port the packets were received on
+//! \param[in] from_addrs - array of socket address structures of the packet senders
+//!
+void FrameDecoderUDP::process_packet_batch(
+    std::size_t first_slot,
+    std::size_t num_packets,
+    const std::size_t* bytes_received,
+    int port,
+    struct sockaddr_in* from_addrs
+)
+{
+    std::size_t header_size = requires_header_peek() ? get_packet_header_size() : 0;
+
+    for (std::size_t packet = 0; packet < num_packets; packet++) {
+        std::size_t slot = first_slot + packet;
+        uint8_t* slot_ptr = &batch_buffer_[slot * batch_slot_size_];
+        std::size_t packet_bytes = bytes_received[packet];
+        std::size_t header_bytes = 0;
+
+        if (header_size > 0) {
+            header_bytes = std::min(packet_bytes, header_size);
+            memcpy(get_packet_header_buffer(), slot_ptr, header_bytes);
+            process_packet_header(header_bytes, port, &from_addrs[packet]);
+        }
+
+        uint8_t* next_payload = static_cast<uint8_t*>(get_next_payload_buffer());
+        std::size_t payload_bytes = std::min(packet_bytes - header_bytes, get_next_payload_size());
+
+        if (batch_payloads_[slot] != next_payload) {
+            // Move any payloads received directly into frame buffers out of the way of the copy
+            for (std::size_t later = packet; later < num_packets; later++) {
+                std::size_t later_slot = first_slot + later;
+                uint8_t* later_staging = &batch_buffer_[later_slot * batch_slot_size_] + header_size;
+                if (batch_payloads_[later_slot] != later_staging) {
+                    std::size_t later_bytes = bytes_received[later] - std::min(bytes_received[later], header_size);
+                    memcpy(later_staging, batch_payloads_[later_slot], later_bytes);
+                    batch_payloads_[later_slot] = later_staging;
+                }
+            }
+            memcpy(next_payload, batch_payloads_[slot], payload_bytes);
+        }
+
+        process_packet(header_bytes + payload_bytes, port, &from_addrs[packet]);
+    }
+}
@@ -0,0 +1,549 @@
+/*
+ * FrameDecoderUDPBenchmark.cpp - socket-free microbenchmark harness for UDP frame decoders
+ */
+
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#include <boost/bind/bind.hpp>
+
+#include "FrameDecoderUDPBenchmark.h"
+#include "gettime.h"
+
+#ifdef BOOST_HAS_PLACEHOLDERS
+using namespace boost::placeholders;
+#endif
+
+using namespace FrameReceiver;
+
+namespace {
+
+const uint32_t pcap_magic_usec = 0xa1b2c3d4; //!< Magic number of a pcap file with microsecond timestamps
+const uint32_t pcap_magic_nsec = 0xa1b23c4d; //!< Magic number of a pcap file with nanosecond timestamps
+const uint32_t pcap_linktype_ethernet = 1; //!< Link type of a pcap file of Ethernet frames
+const uint16_t ether_type_ipv4 = 0x0800; //!< Ethernet type of an IPv4 packet
+const uint16_t ether_type_vlan = 0x8100; //!< Ethernet type of an 802.1Q VLAN tagged frame
+const std::size_t ether_type_offset = 12; //!< Offset of the Ethernet type in an Ethernet frame
+const std::size_t vlan_tag_size = 4; //!< Size of an 802.1Q VLAN tag
+const std::size_t ipv4_min_header_size = 20; //!< Minimum size of an IPv4 header
+const std::size_t udp_header_size = 8; //!< Size of a UDP header
+
+const std::size_t expiry_check_mask = 63; //!< Mask of the packet count at which the expiry time is checked
+
+//! Swap the byte order of a 32-bit value
+uint32_t swap32(uint32_t value)
+{
+    return ((value & 0xff) << 24) | ((value & 0xff00) << 8) | ((value >> 8) & 0xff00) | (value >> 24);
+}
+
+//! Read a big-endian 16-bit value
+uint16_t read_be16(const uint8_t* data)
+{
+    return static_cast<uint16_t>((data[0] << 8) | data[1]);
+}
+
+//! Get the current monotonic time in nanoseconds
+uint64_t monotonic_ns(void)
+{
+    struct timespec now;
+    gettime(&now, true);
+    return (static_cast<uint64_t>(now.tv_sec) * 1000000000) + now.tv_nsec;
+}
+
+//! Copy a packet into a set of iovecs as recvmsg would, truncating it if the iovecs are too small,
+//! and return the number of bytes copied
+std::size_t scatter_packet(const uint8_t* data, std::size_t size, const struct iovec* iov, std::size_t iov_count)
+{
+    std::size_t bytes_copied = 0;
+    for (std::size_t idx = 0; (idx < iov_count) && (bytes_copied < size); idx++) {
+        std::size_t copy_len = std::min(iov[idx].iov_len, size - bytes_copied);
+        memcpy(iov[idx].iov_base, data + bytes_copied, copy_len);
+        bytes_copied += copy_len;
+    }
+    return bytes_copied;
+}
+
+//! Locate the UDP payload of an Ethernet frame captured in a pcap record, optionally filtering
+//! by destination port. Returns false if the record does not hold a complete, unfragmented IPv4
+//! UDP packet to the port.
+bool extract_udp_payload(const std::vector<uint8_t>& record, int port, const uint8_t*& payload, std::size_t& size)
+{
+    std::size_t offset = ether_type_offset;
+    if (record.size() < offset + 2) {
+        return false;
+    }
+    uint16_t ether_type = read_be16(&record[offset]);
+    if (ether_type == ether_type_vlan) {
+        offset += vlan_tag_size;
+        if (record.size() < offset + 2) {
+            return false;
+        }
+        ether_type = read_be16(&record[offset]);
+    }
+    offset += 2;
+    if ((ether_type != ether_type_ipv4) || (record.size() < offset + ipv4_min_header_size)) {
+        return false;
+    }
+
+    // Skip anything other than unfragmented UDP packets, i.e. with neither the more fragments
+    // flag nor a fragment offset set
+    const uint8_t* ip_header = &record[offset];
+    std::size_t ip_header_size = (ip_header[0] & 0x0f) * 4;
+    if (((ip_header[0] >> 4) != 4) || (ip_header_size < ipv4_min_header_size) || (ip_header[9] != IPPROTO_UDP)
+        || ((read_be16(ip_header + 6) & 0x3fff) != 0)) {
+        return false;
+    }
+    offset += ip_header_size;
+    if (record.size() < offset + udp_header_size) {
+        return false;
+    }
+
+    const uint8_t* udp_header = &record[offset];
+    std::size_t udp_length = read_be16(udp_header + 4);
+    if (((port >= 0) && (read_be16(udp_header + 2) != port)) || (udp_length < udp_header_size)
+        || (record.size() < offset + udp_length)) {
+        return false;
+    }
+    payload = udp_header + udp_header_size;
+    size = udp_length - udp_header_size;
+    return true;
+}
+
+#ifdef __linux__
+
+//! Group of hardware performance counters for the calling thread, read around the timed region
+//! of a benchmark. Counters not supported by the platform, or not permitted by the system perf
+//! event settings, are omitted; if none can be opened the group is invalid and reads nothing.
+class PerfCounterGroup {
+public:
+    PerfCounterGroup() :
+        leader_fd_(-1)
+    {
+        add("cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        add("instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        add("cache_references", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES);
+        add("cache_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+        add("l1d_read_misses", PERF_TYPE_HW_CACHE,
+            PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+        add("dtlb_read_misses", PERF_TYPE_HW_CACHE,
+            PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+    }
+
+    ~PerfCounterGroup()
+    {
+        for (std::size_t idx = 0; idx < fds_.size(); idx++) {
+            close(fds_[idx]);
+        }
+    }
+
+    //! Reset and enable the counters
+    void start(void)
+    {
+        if (leader_fd_ >= 0) {
+            ioctl(leader_fd_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(leader_fd_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+    }
+
+    //! Disable the counters and add their values to the totals, scaling them if the group was
+    //! multiplexed with other events
+    void stop(std::map<std::string, uint64_t>& totals)
+    {
+        if (leader_fd_ < 0) {
+            return;
+        }
+        ioctl(leader_fd_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+        // The group read format is the number of counters, the times enabled and running, then
+        // the counter values in the order they were opened
+        std::vector<uint64_t> values(3 + fds_.size());
+        ssize_t bytes_read = read(leader_fd_, &values[0], values.size() * sizeof(uint64_t));
+        if ((bytes_read != static_cast<ssize_t>(values.size() * sizeof(uint64_t))) || (values[0] != fds_.size())
+            || (values[2] == 0)) {
+            return;
+        }
+        double scale = static_cast<double>(values[1]) / values[2];
+        for (std::size_t idx = 0; idx < names_.size(); idx++) {
+            totals[names_[idx]] += static_cast<uint64_t>(values[3 + idx] * scale);
+        }
+    }
+
+private:
+    //! Open a counter, making the first counter opened the group leader
+    void add(const std::string& name, uint32_t type, uint64_t config)
+    {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = (leader_fd_ < 0) ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        int fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, leader_fd_, 0));
+        if (fd < 0) {
+            return;
+        }
+        if (leader_fd_ < 0) {
+            leader_fd_ = fd;
+        }
+        fds_.push_back(fd);
+        names_.push_back(name);
+    }
+
+    int leader_fd_; //!< File descriptor of the group leader counter
+    std::vector<int> fds_; //!< File descriptors of the counters opened
+    std::vector<std::string> names_; //!< Names of the counters opened
+};
+
+#else
+
+//! Placeholder counter group for platforms without perf events, reading no counters
+class PerfCounterGroup {
+public:
+    void start(void) { }
+    void stop(std::map<std::string, uint64_t>& totals) { }
+};
+
+#endif
+
+} // namespace
+
+//! Constructor for the FrameDecoderUDPBenchmark class.
+//!
+//! This constructor registers the buffer manager and a frame ready callback with the decoder and
+//! queues all buffers as empty, as the receiver controller and RX thread do at startup. The decoder
+//! must already have been initialised. If a batch size is specified and the decoder supports
+//! batched receive, packets are delivered in batches through the batched receive interface.
+//!
+//! \param[in] decoder - initialised decoder to benchmark
+//! \param[in] buffer_manager - shared buffer manager for the decoder to receive frames into
+//! \param[in] batch_size - number of packets per batch, or zero for single packet receive
+//! \param[in] port - port number passed to the decoder with each packet
+//!
+FrameDecoderUDPBenchmark::FrameDecoderUDPBenchmark(
+    FrameDecoderUDPPtr decoder,
+    OdinData::SharedBufferManagerPtr buffer_manager,
+    std::size_t batch_size,
+    int port
+) :
+    decoder_(decoder),
+    buffer_manager_(buffer_manager),
+    batch_size_(0),
+    port_(port),
+    stream_bytes_(0),
+    frames_ready_(0),
+    next_expiry_ns_(0),
+    logger_(Logger::getLogger("FR.DecoderBenchmark"))
+{
+    memset(&from_addr_, 0, sizeof(from_addr_));
+    from_addr_.sin_family = AF_INET;
+    from_addr_.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    from_addr_.sin_port = htons(port_);
+
+    decoder_->register_buffer_manager(buffer_manager_);
+    decoder_->register_frame_ready_callback(boost::bind(&FrameDecoderUDPBenchmark::frame_ready, this, _1, _2));
+    for (std::size_t buffer_id = 0; buffer_id < buffer_manager_->get_num_buffers(); buffer_id++) {
+        decoder_->push_empty_buffer(static_cast<int>(buffer_id));
+    }
+
+    if ((batch_size > 0) && decoder_->supports_batch_receive()) {
+        batch_size_ = batch_size;
+        decoder_->init_batch_receive(batch_size_, true);
+        batch_bytes_.resize(batch_size_);
+        batch_addrs_.assign(batch_size_, from_addr_);
+    }
+}
+
+//! Remove all packets from the stream.
+//!
+void FrameDecoderUDPBenchmark::clear_packets(void)
+{
+    stream_data_.clear();
+    packets_.clear();
+    stream_bytes_ = 0;
+}
+
+//! Append a packet to the stream.
+//!
+//! The packet is the UDP payload as it would be received from the socket, i.e. including any
+//! detector packet header.
+//!
+//! \param[in] data - pointer to the packet data
+//! \param[in] size - size of the packet in bytes
+//!
+void FrameDecoderUDPBenchmark::add_packet(const void* data, std::size_t size)
+{
+    std::size_t offset = stream_data_.size();
+    const uint8_t* packet_data = static_cast<const uint8_t*>(data);
+    stream_data_.insert(stream_data_.end(), packet_data, packet_data + size);
+    packets_.push_back(std::make_pair(offset, size));
+    stream_bytes_ += size;
+}
+
+//! Append the UDP packets in a pcap capture file to the stream.
+//!
+//! This method loads the payloads of the IPv4 UDP packets in a pcap file of Ethernet frames, such
+//! as one written by the receiver packet capture tap, allowing a decoder to be benchmarked with
+//! real detector traffic. Packets which are fragmented, truncated by the capture snap length or not
+//! sent to the specified port are skipped.
+//!
+//! \param[in] file_name - name of the pcap file to load
+//! \param[in] port - destination port of packets to load, or -1 to load packets to any port
+//! \return number of packets added to the stream
+//!
+std::size_t FrameDecoderUDPBenchmark::load_pcap(const std::string& file_name, int port)
+{
+    std::ifstream pcap_file(file_name.c_str(), std::ios::binary);
+    if (!pcap_file) {
+        throw FrameDecoderException("Failed to open pcap file " + file_name);
+    }
+
+    uint32_t global_header[6];
+    if (!pcap_file.read(reinterpret_cast<char*>(global_header), sizeof(global_header))) {
+        throw FrameDecoderException("Failed to read pcap file header from " + file_name);
+    }
+
+    // The magic number indicates the byte order the file was written in
+    bool swapped;
+    if ((global_header[0] == pcap_magic_usec) || (global_header[0] == pcap_magic_nsec)) {
+        swapped = false;
+    } else if ((swap32(global_header[0]) == pcap_magic_usec) || (swap32(global_header[0]) == pcap_magic_nsec)) {
+        swapped = true;
+    } else {
+        throw FrameDecoderException(file_name + " is not a pcap file");
+    }
+    uint32_t link_type = swapped ? swap32(global_header[5]) : global_header[5];
+    if (link_type != pcap_linktype_ethernet) {
+        throw FrameDecoderException(file_name + " does not contain Ethernet frames");
+    }
+
+    std::size_t packets_loaded = 0;
+    uint32_t record_header[4];
+    std::vector<uint8_t> record;
+    while (pcap_file.read(reinterpret_cast<char*>(record_header), sizeof(record_header))) {
+        uint32_t captured_len = swapped ? swap32(record_header[2]) : record_header[2];
+        record.resize(captured_len);
+        if ((captured_len > 0) && !pcap_file.read(reinterpret_cast<char*>(&record[0]), captured_len)) {
+            break;
+        }
+
+        const uint8_t* payload;
+        std::size_t payload_size;
+        if (extract_udp_payload(record, port, payload, payload_size)) {
+            add_packet(payload, payload_size);
+            packets_loaded++;
+        }
+    }
+
+    LOG4CXX_DEBUG_LEVEL(1, logger_, "Loaded " << packets_loaded << " packets from pcap file " << file_name);
+    return packets_loaded;
+}
+
+//! Get the number of packets in the stream.
+//!
+//! \return number of packets
+//!
+std::size_t FrameDecoderUDPBenchmark::get_num_packets(void) const
+{
+    return packets_.size();
+}
+
+//! Run the benchmark.
+//!
+//! This method replays the packet stream through the decoder the specified number of times,
+//! timing the delivery of the packets. Frames are expired at the decoder expiry period during
+//! the timed region, as they are by the RX thread timer. Frames left incomplete at the end of
+//! each pass are expired outside the timed region, so that a pass replaying the same frame
+//! numbers starts from a clean decoder state; this waits for the decoder frame timeout, so lossy
+//! streams should be run with a short timeout.
+//!
+//! \param[in] passes - number of times to replay the stream
+//! \return benchmark results
+//!
+FrameDecoderUDPBenchmark::Result FrameDecoderUDPBenchmark::run(unsigned int passes)
+{
+    Result result = Result();
+    PerfCounterGroup counters;
+
+    unsigned int frames_timedout = decoder_->get_num_frames_timedout();
+    unsigned int frames_dropped = decoder_->get_num_frames_dropped();
+    uint64_t elapsed_ns = 0;
+
+    for (unsigned int pass = 0; pass < passes; pass++) {
+        frames_ready_ = 0;
+        next_expiry_ns_ = monotonic_ns() + (decoder_->get_frame_expiry_period_ms() * 1000000ULL);
+
+        counters.start();
+        uint64_t start_ns = monotonic_ns();
+        if (batch_size_ > 0) {
+            for (std::size_t packet = 0; packet < packets_.size(); packet += batch_size_) {
+                deliver_batch(packet, std::min(batch_size_, packets_.size() - packet));
+                check_expiry();
+            }
+        } else {
+            for (std::size_t packet = 0; packet < packets_.size(); packet++) {
+                deliver_packet(&stream_data_[packets_[packet].first], packets_[packet].second);
+                if ((packet & expiry_check_mask) == 0) {
+                    check_expiry();
+                }
+            }
+        }
+        elapsed_ns += monotonic_ns() - start_ns;
+        counters.stop(result.counters);
+
+        result.frames_ready += frames_ready_;
+        drain();
+    }
+
+    result.packets = static_cast<uint64_t>(packets_.size()) * passes;
+    result.bytes = static_cast<uint64_t>(stream_bytes_) * passes;
+    result.frames_timedout = decoder_->get_num_frames_timedout() - frames_timedout;
+    result.frames_dropped = decoder_->get_num_frames_dropped() - frames_dropped;
+    result.elapsed_s = elapsed_ns / 1.0e9;
+    if (result.packets > 0) {
+        result.ns_per_packet = static_cast<double>(elapsed_ns) / result.packets;
+    }
+    if (elapsed_ns > 0) {
+        result.packets_per_s = result.packets / result.elapsed_s;
+        result.frames_per_s = result.frames_ready / result.elapsed_s;
+        result.gbits_per_s = (result.bytes * 8.0) / elapsed_ns;
+    }
+    return result;
+}
+
+//! Deliver a single packet to the decoder.
+//!
+//! This method follows the sequence of FrameReceiverUDPRxThread::handle_receive_socket: the
+//! header is peeked into the decoder header buffer and processed, the header and payload are
+//! scattered into the buffers specified by the decoder and the packet is then processed.
+//!
+//! \param[in] data - pointer to the packet data
+//! \param[in] size - size of the packet in bytes
+//!
+void FrameDecoderUDPBenchmark::deliver_packet(const uint8_t* data, std::size_t size)
+{
+    struct iovec io_vec[2];
+    std::size_t iovec_entry = 0;
+
+    if (decoder_->requires_header_peek()) {
+        std::size_t header_size = decoder_->get_packet_header_size();
+        std::size_t peek_bytes = std::min(size, header_size);
+        memcpy(decoder_->get_packet_header_buffer(), data, peek_bytes);
+        decoder_->process_packet_header(peek_bytes, port_, &from_addr_);
+
+        io_vec[iovec_entry].iov_base = decoder_->get_packet_header_buffer();
+        io_vec[iovec_entry].iov_len = header_size;
+        iovec_entry++;
+    }
+
+    io_vec[iovec_entry].iov_base = decoder_->get_next_payload_buffer();
+    io_vec[iovec_entry].iov_len = decoder_->get_next_payload_size();
+    iovec_entry++;
+
+    std::size_t bytes_received = scatter_packet(data, size, io_vec, iovec_entry);
+    decoder_->process_packet(bytes_received, port_, &from_addr_);
+
+    if (!ready_buffers_.empty()) {
+        release_frames();
+    }
+}
+
+//! Deliver a batch of packets to the decoder.
+//!
+//! This method follows the sequence of FrameReceiverUDPRxThread::handle_receive_socket_batch:
+//! each packet is scattered into the iovecs specified by the decoder for its batch slot and the
+//! batch is then processed.
+//!
+//! \param[in] first_packet - index of the first packet of the batch in the stream
+//! \param[in] num_packets - number of packets in the batch
+//!
+void FrameDecoderUDPBenchmark::deliver_batch(std::size_t first_packet, std::size_t num_packets)
+{
+    struct iovec slot_iovecs[FrameDecoderUDP::max_batch_iovecs];
+
+    for (std::size_t slot = 0; slot < num_packets; slot++) {
+        const std::pair<std::size_t, std::size_t>& packet = packets_[first_packet + slot];
+        std::size_t num_iovecs = decoder_->get_batch_iovecs(slot, slot_iovecs);
+        batch_bytes_[slot] = scatter_packet(&stream_data_[packet.first], packet.second, slot_iovecs, num_iovecs);
+    }
+
+    decoder_->process_packet_batch(0, num_packets, &batch_bytes_[0], port_, &batch_addrs_[0]);
+
+    if (!ready_buffers_.empty()) {
+        release_frames();
+    }
+}
+
+//! Handle a frame released by the decoder.
+//!
+//! The buffer is held until the decoder returns from processing the current packet, then
+//! returned to the decoder empty buffer queue as if released immediately by a downstream
+//! processor.
+//!
+//! \param[in] buffer_id - ID of the buffer containing the frame
+//! \param[in] frame - frame number
+//!
+void FrameDecoderUDPBenchmark::frame_ready(int buffer_id, int frame)
+{
+    ready_buffers_.push_back(buffer_id);
+    frames_ready_++;
+}
+
+//! Return the buffers of released frames to the decoder empty buffer queue.
+//!
+void FrameDecoderUDPBenchmark::release_frames(void)
+{
+    for (std::size_t idx = 0; idx < ready_buffers_.size(); idx++) {
+        decoder_->push_empty_buffer(ready_buffers_[idx]);
+    }
+    ready_buffers_.clear();
+}
+
+//! Expire timed out frames in the decoder if the expiry period has elapsed.
+//!
+void FrameDecoderUDPBenchmark::check_expiry(void)
+{
+    uint64_t now_ns = monotonic_ns();
+    if (now_ns >= next_expiry_ns_) {
+        decoder_->expire_frames();
+        release_frames();
+        next_expiry_ns_ = now_ns + (decoder_->get_frame_expiry_period_ms() * 1000000ULL);
+    }
+}
+
+//! Wait for frames left incomplete in the decoder to time out and be released.
+//!
+//! The wait is bounded at twice the frame timeout, after which a warning is logged, in case the
+//! decoder does not register its frames for timeout.
+//!
+void FrameDecoderUDPBenchmark::drain(void)
+{
+    unsigned int period_ms = decoder_->get_frame_expiry_period_ms();
+    uint64_t deadline_ns = monotonic_ns() + (decoder_->get_frame_timeout_ms() * 2000000ULL);
+
+    while (decoder_->get_num_mapped_buffers() > 0) {
+        if (monotonic_ns() > deadline_ns) {
+            LOG4CXX_WARN(
+                logger_,
+                decoder_->get_num_mapped_buffers() << " frames still mapped in decoder at end of benchmark pass"
+            );
+            break;
+        }
+        usleep(period_ms * 1000);
+        decoder_->expire_frames();
+        decoder_->monitor_buffers();
+        release_frames();
+    }
+}
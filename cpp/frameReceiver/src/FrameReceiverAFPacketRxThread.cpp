@@ -0,0 +1,458 @@
+/*!
+ * FrameReceiverAFPacketRxThread.cpp
+ *
+ */
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <ifaddrs.h>
+#include <linux/filter.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <net/if.h>
+#include <netinet/ip.h>
+#include <netinet/udp.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#endif
+
+#include <sstream>
+#include <vector>
+
+#include "FrameReceiverAFPacketRxThread.h"
+
+using namespace FrameReceiver;
+
+FrameReceiverAFPacketRxThread::FrameReceiverAFPacketRxThread(
+    FrameReceiverConfig& config,
+    SharedBufferManagerPtr buffer_manager,
+    FrameDecoderPtr frame_decoder,
+    unsigned int tick_period_ms
+) :
+    FrameReceiverRxThread(config, buffer_manager, frame_decoder, tick_period_ms),
+    logger_(log4cxx::Logger::getLogger("FR.AFPacketRxThread")),
+    packet_socket_(-1),
+    ring_(NULL),
+    ring_blocks_(0),
+    next_block_(0),
+    ring_packets_(0),
+    ring_drops_(0),
+    ring_freezes_(0),
+    packets_received_(0),
+    packets_discarded_(0)
+{
+    LOG4CXX_DEBUG_LEVEL(1, logger_, "FrameReceiverAFPacketRxThread constructor entered....");
+
+    // Store the frame decoder as a UDP type frame decoder
+    frame_decoder_ = boost::dynamic_pointer_cast<FrameDecoderUDP>(frame_decoder);
+}
+
+FrameReceiverAFPacketRxThread::~FrameReceiverAFPacketRxThread()
+{
+    LOG4CXX_DEBUG_LEVEL(1, logger_, "Destroying FrameReceiverAFPacketRxThread....");
+    this->close_packet_socket();
+}
+
+void FrameReceiverAFPacketRxThread::run_specific_service(void)
+{
+    LOG4CXX_DEBUG_LEVEL(1, logger_, "Running AF_PACKET RX thread service");
+
+#ifdef __linux__
+    if (config_.rx_threads_ > 1) {
+        LOG4CXX_WARN(
+            logger_, "AF_PACKET RX thread receives on a single ring, ignoring " << config_.rx_threads_ << " RX threads"
+        );
+    }
+    if (config_.rx_batch_size_ > 1) {
+        LOG4CXX_DEBUG_LEVEL(1, logger_, "AF_PACKET RX thread receives whole ring blocks, ignoring batch size");
+    }
+
+    if (!this->create_packet_socket() || !this->attach_port_filter() || !this->map_receive_ring()) {
+        this->close_packet_socket();
+        return;
+    }
+
+    // The socket is closed by the base class when the thread terminates, the ring is unmapped
+    // in cleanup_specific_service
+    this->register_socket(packet_socket_, boost::bind(&FrameReceiverAFPacketRxThread::handle_receive_ring, this));
+
+    LOG4CXX_INFO(
+        logger_,
+        "AF_PACKET RX thread receiving on " << (interface_name_.empty() ? "all interfaces" : interface_name_)
+                                            << " ports " << config_.rx_port_list() << " with a ring of "
+                                            << ring_blocks_ << " blocks of " << ring_block_size << " bytes"
+    );
+#else
+    this->set_thread_init_error("AF_PACKET RX thread is not supported on this platform");
+#endif
+}
+
+void FrameReceiverAFPacketRxThread::cleanup_specific_service(void)
+{
+    // The packet socket has already been closed by the base class
+    packet_socket_ = -1;
+    this->close_packet_socket();
+}
+
+//! Create the AF_PACKET socket.
+//!
+//! This method creates a datagram packet socket, which delivers packets with their link layer
+//! header removed, receiving IPv4 packets. If a receive address is configured, the socket is bound
+//! to the interface carrying that address, otherwise it receives on all interfaces. Any error is
+//! signalled as a thread initialisation error.
+//!
+//! \return - bool indicating if the socket was created successfully
+//!
+bool FrameReceiverAFPacketRxThread::create_packet_socket(void)
+{
+#ifdef __linux__
+    packet_socket_ = socket(AF_PACKET, SOCK_DGRAM, htons(ETH_P_IP));
+    if (packet_socket_ < 0) {
+        std::stringstream ss;
+        ss << "RX channel failed to create AF_PACKET socket: " << strerror(errno);
+        this->set_thread_init_error(ss.str());
+        return false;
+    }
+
+    in_addr_t rx_address = inet_addr(config_.rx_address_.c_str());
+    if (rx_address == INADDR_NONE) {
+        std::stringstream ss;
+        ss << "Illegal receive address specified: " << config_.rx_address_;
+        this->set_thread_init_error(ss.str());
+        return false;
+    }
+
+    // Find the interface carrying the receive address, unless receiving on any address
+    interface_name_.clear();
+    if (rx_address != htonl(INADDR_ANY)) {
+        struct ifaddrs* if_addrs;
+        if (getifaddrs(&if_addrs) == 0) {
+            for (struct ifaddrs* if_addr = if_addrs; if_addr != NULL; if_addr = if_addr->ifa_next) {
+                if (if_addr->ifa_addr && (if_addr->ifa_addr->sa_family == AF_INET)
+                    && (((struct sockaddr_in*)if_addr->ifa_addr)->sin_addr.s_addr == rx_address)) {
+                    interface_name_ = if_addr->ifa_name;
+                    break;
+                }
+            }
+            freeifaddrs(if_addrs);
+        }
+        if (interface_name_.empty()) {
+            std::stringstream ss;
+            ss << "No interface found with receive address " << config_.rx_address_;
+            this->set_thread_init_error(ss.str());
+            return false;
+        }
+    }
+
+    struct sockaddr_ll bind_addr;
+    memset(&bind_addr, 0, sizeof(bind_addr));
+    bind_addr.sll_family = AF_PACKET;
+    bind_addr.sll_protocol = htons(ETH_P_IP);
+    bind_addr.sll_ifindex = interface_name_.empty() ? 0 : if_nametoindex(interface_name_.c_str());
+    if (bind(packet_socket_, (struct sockaddr*)&bind_addr, sizeof(bind_addr)) < 0) {
+        std::stringstream ss;
+        ss << "RX channel failed to bind AF_PACKET socket to interface "
+           << (interface_name_.empty() ? "any" : interface_name_) << " : " << strerror(errno);
+        this->set_thread_init_error(ss.str());
+        return false;
+    }
+#endif
+    return true;
+}
+
+//! Attach a BPF filter for the receive address and ports to the packet socket.
+//!
+//! The filter accepts only unfragmented UDP packets addressed to one of the configured ports and,
+//! if one is configured, the receive address, so that no other traffic is copied into the ring.
+//!
+//! \return - bool indicating if the filter was attached successfully
+//!
+bool FrameReceiverAFPacketRxThread::attach_port_filter(void)
+{
+#ifdef __linux__
+    const std::size_t num_ports = config_.rx_ports_.size();
+    in_addr_t rx_address = inet_addr(config_.rx_address_.c_str());
+    bool match_address = (rx_address != htonl(INADDR_ANY));
+
+    // Offsets are relative to the start of the IP header. The final two instructions drop and
+    // accept the packet respectively, and the jumps to them are calculated from the position of
+    // each test.
+    std::vector<struct sock_filter> filter;
+    std::size_t program_length = 6 + (match_address ? 2 : 0) + num_ports + 2;
+    uint8_t drop = static_cast<uint8_t>(program_length - 2);
+    if (program_length > max_filter_length) {
+        std::stringstream ss;
+        ss << "Too many receive ports (" << num_ports << ") to filter on AF_PACKET socket";
+        this->set_thread_init_error(ss.str());
+        return false;
+    }
+
+    filter.push_back((struct sock_filter)BPF_STMT(BPF_LD | BPF_B | BPF_ABS, offsetof(struct iphdr, protocol)));
+    filter.push_back((struct sock_filter)BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, IPPROTO_UDP, 0, (uint8_t)(drop - 2)));
+    filter.push_back((struct sock_filter)BPF_STMT(BPF_LD | BPF_H | BPF_ABS, offsetof(struct iphdr, frag_off)));
+    filter.push_back((struct sock_filter)BPF_JUMP(BPF_JMP | BPF_JSET | BPF_K, 0x3fff, (uint8_t)(drop - 4), 0));
+    if (match_address) {
+        filter.push_back((struct sock_filter)BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(struct iphdr, daddr)));
+        filter.push_back(
+            (struct sock_filter)BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, ntohl(rx_address), 0, (uint8_t)(drop - 6))
+        );
+    }
+    filter.push_back((struct sock_filter)BPF_STMT(BPF_LDX | BPF_B | BPF_MSH, 0));
+    filter.push_back((struct sock_filter)BPF_STMT(BPF_LD | BPF_H | BPF_IND, offsetof(struct udphdr, dest)));
+    for (std::size_t port_idx = 0; port_idx < num_ports; port_idx++) {
+        uint8_t to_accept = static_cast<uint8_t>(drop - filter.size());
+        filter.push_back(
+            (struct sock_filter)BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, config_.rx_ports_[port_idx], to_accept, 0)
+        );
+    }
+    filter.push_back((struct sock_filter)BPF_STMT(BPF_RET | BPF_K, 0));
+    filter.push_back((struct sock_filter)BPF_STMT(BPF_RET | BPF_K, 0x40000));
+
+    struct sock_fprog program;
+    program.len = filter.size();
+    program.filter = &filter[0];
+    if (setsockopt(packet_socket_, SOL_SOCKET, SO_ATTACH_FILTER, &program, sizeof(program)) < 0) {
+        std::stringstream ss;
+        ss << "RX channel failed to attach port filter to AF_PACKET socket: " << strerror(errno);
+        this->set_thread_init_error(ss.str());
+        return false;
+    }
+#endif
+    return true;
+}
+
+//! Set up and map the TPACKET_V3 receive ring.
+//!
+//! The ring is sized from the configured receive buffer size, in blocks which the kernel fills
+//! with packets and retires to user space when full or after a short timeout.
+//!
+//! \return - bool indicating if the ring was mapped successfully
+//!
+bool FrameReceiverAFPacketRxThread::map_receive_ring(void)
+{
+#ifdef __linux__
+    int version = TPACKET_V3;
+    if (setsockopt(packet_socket_, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) < 0) {
+        std::stringstream ss;
+        ss << "RX channel failed to select TPACKET_V3 on AF_PACKET socket: " << strerror(errno);
+        this->set_thread_init_error(ss.str());
+        return false;
+    }
+
+    ring_blocks_ = config_.rx_recv_buffer_size_ / ring_block_size;
+    if (ring_blocks_ < min_ring_blocks) {
+        ring_blocks_ = min_ring_blocks;
+    }
+
+    struct tpacket_req3 ring_req;
+    memset(&ring_req, 0, sizeof(ring_req));
+    ring_req.tp_block_size = ring_block_size;
+    ring_req.tp_block_nr = ring_blocks_;
+    ring_req.tp_frame_size = ring_frame_size;
+    ring_req.tp_frame_nr = (ring_block_size * ring_blocks_) / ring_frame_size;
+    ring_req.tp_retire_blk_tov = ring_block_timeout_ms;
+    if (setsockopt(packet_socket_, SOL_PACKET, PACKET_RX_RING, &ring_req, sizeof(ring_req)) < 0) {
+        std::stringstream ss;
+        ss << "RX channel failed to create AF_PACKET receive ring of " << ring_blocks_
+           << " blocks: " << strerror(errno);
+        this->set_thread_init_error(ss.str());
+        return false;
+    }
+
+    void* ring = mmap(
+        NULL, ring_block_size * ring_blocks_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_LOCKED, packet_socket_, 0
+    );
+    if (ring == MAP_FAILED) {
+        // Locking the ring may exceed the memory lock limit, so fall back to an unlocked mapping
+        ring = mmap(NULL, ring_block_size * ring_blocks_, PROT_READ | PROT_WRITE, MAP_SHARED, packet_socket_, 0);
+    }
+    if (ring == MAP_FAILED) {
+        std::stringstream ss;
+        ss << "RX channel failed to map AF_PACKET receive ring: " << strerror(errno);
+        this->set_thread_init_error(ss.str());
+        return false;
+    }
+    ring_ = reinterpret_cast<uint8_t*>(ring);
+    next_block_ = 0;
+#endif
+    return true;
+}
+
+//! Close the packet socket, if open, and unmap the receive ring.
+//!
+void FrameReceiverAFPacketRxThread::close_packet_socket(void)
+{
+#ifdef __linux__
+    if (ring_) {
+        munmap(ring_, ring_block_size * ring_blocks_);
+        ring_ = NULL;
+    }
+#endif
+    if (packet_socket_ >= 0) {
+        close(packet_socket_);
+        packet_socket_ = -1;
+    }
+}
+
+//! Handle blocks of packets retired to the receive ring.
+//!
+//! This method is called by the reactor when the packet socket is readable, i.e. the kernel has
+//! retired at least one block to user space. Every block owned by user space is processed in ring
+//! order and then handed back to the kernel.
+//!
+void FrameReceiverAFPacketRxThread::handle_receive_ring(void)
+{
+#ifdef __linux__
+    for (std::size_t block_count = 0; block_count < ring_blocks_; block_count++) {
+        struct tpacket_block_desc* block
+            = reinterpret_cast<struct tpacket_block_desc*>(ring_ + (next_block_ * ring_block_size));
+        if (!(block->hdr.bh1.block_status & TP_STATUS_USER)) {
+            break;
+        }
+        __sync_synchronize();
+
+        this->process_ring_block(block);
+
+        __sync_synchronize();
+        block->hdr.bh1.block_status = TP_STATUS_KERNEL;
+        next_block_ = (next_block_ + 1) % ring_blocks_;
+    }
+#endif
+}
+
+//! Process the packets in a block of the receive ring.
+//!
+//! \param[in] block - pointer to the block descriptor at the start of the block
+//!
+void FrameReceiverAFPacketRxThread::process_ring_block(void* block)
+{
+#ifdef __linux__
+    struct tpacket_block_desc* block_desc = reinterpret_cast<struct tpacket_block_desc*>(block);
+    uint32_t num_packets = block_desc->hdr.bh1.num_pkts;
+    struct tpacket3_hdr* packet_hdr = reinterpret_cast<struct tpacket3_hdr*>(
+        reinterpret_cast<uint8_t*>(block) + block_desc->hdr.bh1.offset_to_first_pkt
+    );
+
+    LOG4CXX_DEBUG_LEVEL(3, logger_, "RX thread processing ring block of " << num_packets << " packets");
+
+    for (uint32_t packet_idx = 0; packet_idx < num_packets; packet_idx++) {
+
+        // Packets sent by this host are also seen on loopback interfaces, so ignore them
+        struct sockaddr_ll* link_addr = reinterpret_cast<struct sockaddr_ll*>(
+            reinterpret_cast<uint8_t*>(packet_hdr) + TPACKET_ALIGN(sizeof(struct tpacket3_hdr))
+        );
+        if (link_addr->sll_pkttype == PACKET_OUTGOING) {
+            // Not counted as discarded
+        } else if (packet_hdr->tp_snaplen < packet_hdr->tp_len) {
+            packets_discarded_++;
+        } else {
+            this->process_udp_packet(
+                reinterpret_cast<uint8_t*>(packet_hdr) + packet_hdr->tp_net, packet_hdr->tp_snaplen
+            );
+        }
+        packet_hdr = reinterpret_cast<struct tpacket3_hdr*>(
+            reinterpret_cast<uint8_t*>(packet_hdr) + packet_hdr->tp_next_offset
+        );
+    }
+#endif
+}
+
+//! Pass a UDP packet from the receive ring to the frame decoder.
+//!
+//! The UDP payload is copied into the header and payload buffers provided by the decoder in the
+//! same way as a packet received on a UDP socket, and the decoder then processes the packet.
+//!
+//! \param[in] packet - pointer to the IP header of the packet
+//! \param[in] length - length of the packet from the start of the IP header
+//!
+void FrameReceiverAFPacketRxThread::process_udp_packet(const uint8_t* packet, std::size_t length)
+{
+#ifdef __linux__
+    const struct iphdr* ip_hdr = reinterpret_cast<const struct iphdr*>(packet);
+    std::size_t ip_hdr_len = ip_hdr->ihl * 4;
+    if ((length < sizeof(struct iphdr)) || (length < ip_hdr_len + sizeof(struct udphdr))) {
+        packets_discarded_++;
+        return;
+    }
+    const struct udphdr* udp_hdr = reinterpret_cast<const struct udphdr*>(packet + ip_hdr_len);
+    std::size_t udp_len = ntohs(udp_hdr->len);
+    if ((udp_len < sizeof(struct udphdr)) || (ip_hdr_len + udp_len > length)) {
+        packets_discarded_++;
+        return;
+    }
+
+    const uint8_t* payload = packet + ip_hdr_len + sizeof(struct udphdr);
+    std::size_t payload_len = udp_len - sizeof(struct udphdr);
+    int recv_port = ntohs(udp_hdr->dest);
+
+    struct sockaddr_in from_addr;
+    memset(&from_addr, 0, sizeof(from_addr));
+    from_addr.sin_family = AF_INET;
+    from_addr.sin_port = udp_hdr->source;
+    from_addr.sin_addr.s_addr = ip_hdr->saddr;
+
+    std::size_t bytes_received = 0;
+    if (frame_decoder_->requires_header_peek()) {
+        std::size_t header_size = frame_decoder_->get_packet_header_size();
+        std::size_t header_bytes = (payload_len < header_size) ? payload_len : header_size;
+        memcpy(frame_decoder_->get_packet_header_buffer(), payload, header_bytes);
+        frame_decoder_->process_packet_header(header_bytes, recv_port, &from_addr);
+        payload += header_bytes;
+        payload_len -= header_bytes;
+        bytes_received += header_bytes;
+    }
+
+    std::size_t payload_size = frame_decoder_->get_next_payload_size();
+    std::size_t payload_bytes = (payload_len < payload_size) ? payload_len : payload_size;
+    memcpy(frame_decoder_->get_next_payload_buffer(), payload, payload_bytes);
+    bytes_received += payload_bytes;
+
+    frame_decoder_->process_packet(bytes_received, recv_port, &from_addr);
+    packets_received_++;
+#endif
+}
+
+//! Update the receive ring statistics from the kernel.
+//!
+//! The kernel counters are reset each time they are read, so are accumulated here.
+//!
+void FrameReceiverAFPacketRxThread::update_ring_stats(void)
+{
+#ifdef __linux__
+    if (packet_socket_ < 0) {
+        return;
+    }
+    struct tpacket_stats_v3 stats;
+    socklen_t len = sizeof(stats);
+    if (getsockopt(packet_socket_, SOL_PACKET, PACKET_STATISTICS, &stats, &len) == 0) {
+        ring_packets_ += stats.tp_packets;
+        ring_drops_ += stats.tp_drops;
+        ring_freezes_ += stats.tp_freeze_q_cnt;
+    }
+#endif
+}
+
+//! Fill AF_PACKET RX thread specific status parameters into a message.
+//!
+//! This method adds the number of packets passed into the receive ring by the kernel and dropped
+//! because the ring was full, along with the number of packets handed to the frame decoder and
+//! discarded as truncated or malformed. Ring drops are also reported as kernel drops.
+//!
+//! \param[in,out] status_msg - IpcMessage to fill with status parameters
+//!
+void FrameReceiverAFPacketRxThread::fill_specific_status_params(IpcMessage& status_msg)
+{
+    this->update_ring_stats();
+
+    status_msg.set_param("rx_thread/ring/packets", ring_packets_);
+    status_msg.set_param("rx_thread/ring/drops", ring_drops_);
+    status_msg.set_param("rx_thread/ring/freezes", ring_freezes_);
+    status_msg.set_param("rx_thread/ring/packets_received", packets_received_);
+    status_msg.set_param("rx_thread/ring/packets_discarded", packets_discarded_);
+    status_msg.set_param("rx_thread/kernel_drops", ring_drops_);
+}
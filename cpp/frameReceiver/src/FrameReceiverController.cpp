@@ -41,6 +41,9 @@ FrameReceiverController::FrameReceiverController(unsigned int num_io_threads) :
     frame_release_channel_(ZMQ_SUB),
     frames_received_(0),
     frames_released_(0),
+    frame_notify_direct_active_(false),
+    rx_frames_ready_(0),
+    rx_frames_released_(0),
     rx_thread_identity_(RX_THREAD_ID)
 {
     LOG4CXX_TRACE(logger_, "FrameRecevierController constructor");
@@ -146,6 +149,9 @@ void FrameReceiverController::run(void)
     // Stop the RX thread
     this->stop_rx_thread();
 
+    // Remove any shared memory ring frame notifier from the reactor
+    this->cleanup_frame_notifier();
+
     // Destroy the frame decoder
     if (frame_decoder_) {
         frame_decoder_.reset();
@@ -223,6 +229,7 @@ void FrameReceiverController::configure_ipc_channels(OdinData::IpcMessage& confi
     if (config_msg.has_param(CONFIG_FRAME_READY_ENDPOINT)) {
         std::string frame_ready_endpoint = config_msg.get_param<std::string>(CONFIG_FRAME_READY_ENDPOINT);
         if (frame_ready_endpoint != config_.frame_ready_endpoint_) {
+            boost::lock_guard<boost::mutex> ready_lock(frame_ready_mutex_);
             this->unbind_channel(&frame_ready_channel_, config_.frame_ready_endpoint_, false);
             this->setup_frame_ready_channel(frame_ready_endpoint);
             config_.frame_ready_endpoint_ = frame_ready_endpoint;
@@ -234,6 +241,13 @@ void FrameReceiverController::configure_ipc_channels(OdinData::IpcMessage& confi
     if (config_msg.has_param(CONFIG_FRAME_RELEASE_ENDPOINT)) {
         std::string frame_release_endpoint = config_msg.get_param<std::string>(CONFIG_FRAME_RELEASE_ENDPOINT);
         if (frame_release_endpoint != config_.frame_release_endpoint_) {
+
+            // An RX thread receiving frame release notifications directly must be stopped, and
+            // therefore reconfigured, before the channel can be rebound
+            if (frame_notify_direct_active_) {
+                this->stop_rx_thread();
+                need_rx_thread_reconfig_ = true;
+            }
             this->unbind_channel(&frame_release_channel_, config_.frame_release_endpoint_, false);
             this->setup_frame_release_channel(frame_release_endpoint);
             config_.frame_release_endpoint_ = frame_release_endpoint;
@@ -289,8 +303,10 @@ void FrameReceiverController::setup_rx_channel(const std::string& endpoint)
         throw FrameReceiverException(sstr.str());
     }
 
-    // Add channel to the reactor
-    reactor_.register_channel(rx_channel_, boost::bind(&FrameReceiverController::handle_rx_channel, this));
+    // Add channel to the reactor, draining pending frame notifications on each wakeup
+    reactor_.register_channel(
+        rx_channel_, boost::bind(&FrameReceiverController::handle_rx_channel, this), IpcReactor::default_drain_budget
+    );
 }
 
 //! Set up the frame ready notification channel.
@@ -335,9 +351,10 @@ void FrameReceiverController::setup_frame_release_channel(const std::string& end
     // Set default subscription on frame release channel
     frame_release_channel_.subscribe("");
 
-    // Add channel to the reactor
+    // Add channel to the reactor, draining pending frame release notifications on each wakeup
     reactor_.register_channel(
-        frame_release_channel_, boost::bind(&FrameReceiverController::handle_frame_release_channel, this)
+        frame_release_channel_, boost::bind(&FrameReceiverController::handle_frame_release_channel, this),
+        IpcReactor::default_drain_budget
     );
 }
 
@@ -542,6 +559,68 @@ void FrameReceiverController::configure_buffer_manager(OdinData::IpcMessage& con
         need_buffer_manager_reconfig_ = true;
     }
 
+    bool frame_notify_ring = config_msg.get_param<bool>(CONFIG_FRAME_NOTIFY_RING, config_.frame_notify_ring_);
+    if (frame_notify_ring != config_.frame_notify_ring_) {
+        config_.frame_notify_ring_ = frame_notify_ring;
+        need_buffer_manager_reconfig_ = true;
+    }
+
+    // Frame notification batching is applied by the RX thread to frame ready notifications and
+    // passed to downstream processes with the buffer configuration for frame release notifications
+    bool notify_batch_changed = false;
+    unsigned int frame_notify_batch
+        = config_msg.get_param<unsigned int>(CONFIG_FRAME_NOTIFY_BATCH, config_.frame_notify_batch_);
+    if (frame_notify_batch != config_.frame_notify_batch_) {
+        config_.frame_notify_batch_ = frame_notify_batch;
+        notify_batch_changed = true;
+    }
+
+    unsigned int frame_notify_batch_ms
+        = config_msg.get_param<unsigned int>(CONFIG_FRAME_NOTIFY_BATCH_MS, config_.frame_notify_batch_ms_);
+    if (frame_notify_batch_ms != config_.frame_notify_batch_ms_) {
+        config_.frame_notify_batch_ms_ = frame_notify_batch_ms;
+        notify_batch_changed = true;
+    }
+
+    if (notify_batch_changed) {
+        need_rx_thread_reconfig_ = true;
+        if (buffer_manager_configured_) {
+            this->notify_buffer_config(false);
+        }
+    }
+
+    std::string huge_page_dir
+        = config_msg.get_param<std::string>(CONFIG_SHARED_BUFFER_HUGE_PAGE_DIR, config_.shared_buffer_huge_page_dir_);
+    if (huge_page_dir != config_.shared_buffer_huge_page_dir_) {
+        config_.shared_buffer_huge_page_dir_ = huge_page_dir;
+        need_buffer_manager_reconfig_ = true;
+    }
+
+    int numa_node = config_msg.get_param<int>(CONFIG_SHARED_BUFFER_NUMA_NODE, config_.shared_buffer_numa_node_);
+    if (numa_node != config_.shared_buffer_numa_node_) {
+        config_.shared_buffer_numa_node_ = numa_node;
+        need_buffer_manager_reconfig_ = true;
+    }
+
+    bool lock_memory = config_msg.get_param<bool>(CONFIG_SHARED_BUFFER_LOCK, config_.shared_buffer_lock_);
+    if (lock_memory != config_.shared_buffer_lock_) {
+        config_.shared_buffer_lock_ = lock_memory;
+        need_buffer_manager_reconfig_ = true;
+    }
+
+    bool prefault = config_msg.get_param<bool>(CONFIG_SHARED_BUFFER_PREFAULT, config_.shared_buffer_prefault_);
+    if (prefault != config_.shared_buffer_prefault_) {
+        config_.shared_buffer_prefault_ = prefault;
+        need_buffer_manager_reconfig_ = true;
+    }
+
+    unsigned int block_size
+        = config_msg.get_param<unsigned int>(CONFIG_SHARED_BUFFER_BLOCK_SIZE, config_.shared_buffer_block_size_);
+    if (block_size != config_.shared_buffer_block_size_) {
+        config_.shared_buffer_block_size_ = block_size;
+        need_buffer_manager_reconfig_ = true;
+    }
+
     if (need_buffer_manager_reconfig_) {
 
         // Clear the buffer manager configuration status until succesful completion
@@ -560,14 +639,37 @@ void FrameReceiverController::configure_buffer_manager(OdinData::IpcMessage& con
 
             // If an there is already an existing shared buffer manager, delete it first to ensure
             // cleanup of shared memory segment occurs before creation of new manager.
+            this->cleanup_frame_notifier();
             if (buffer_manager_) {
                 buffer_manager_.reset();
             }
 
-            // Create a new shared buffer manager
-            buffer_manager_.reset(new SharedBufferManager(
-                shared_buffer_name, max_buffer_mem, frame_decoder_->get_frame_buffer_size(), true
-            ));
+            // Create a new shared buffer manager, backed and mapped as configured. If a block size is
+            // set, the buffer is divided into blocks from which variable-length frames are allocated,
+            // otherwise into buffers of the maximum frame size.
+            SharedBufferManager::MappingOptions mapping_options;
+            mapping_options.huge_page_dir = config_.shared_buffer_huge_page_dir_;
+            mapping_options.numa_node = config_.shared_buffer_numa_node_;
+            mapping_options.lock_memory = config_.shared_buffer_lock_;
+            mapping_options.prefault = config_.shared_buffer_prefault_;
+            bool variable_frames = (config_.shared_buffer_block_size_ > 0);
+            size_t buffer_size
+                = variable_frames ? config_.shared_buffer_block_size_ : frame_decoder_->get_frame_buffer_size();
+            try {
+                buffer_manager_.reset(new SharedBufferManager(
+                    shared_buffer_name, max_buffer_mem, buffer_size, true, config_.frame_notify_ring_,
+                    mapping_options, variable_frames
+                ));
+            } catch (OdinData::SharedBufferManagerException& e) {
+                std::stringstream sstr;
+                sstr << "Failed to configure frame buffer manager: " << e.what();
+                throw FrameReceiverException(sstr.str());
+            }
+
+            // Set up frame notification through the shared memory rings if enabled
+            if (config_.frame_notify_ring_) {
+                this->setup_frame_notifier();
+            }
 
             // Record the total number of buffers in the system here
             total_buffers_ = buffer_manager_->get_num_buffers();
@@ -577,6 +679,12 @@ void FrameReceiverController::configure_buffer_manager(OdinData::IpcMessage& con
                 "Configured frame buffer manager of total size " << max_buffer_mem << " with " << total_buffers_
                                                                  << " buffers"
             );
+            if (config_.shared_buffer_prefault_) {
+                LOG4CXX_INFO(
+                    logger_,
+                    "Pre-faulted frame buffer memory in " << buffer_manager_->get_prefault_duration() << "us"
+                );
+            }
 
             // Register buffer manager with the frame decoder
             frame_decoder_->register_buffer_manager(buffer_manager_);
@@ -627,6 +735,91 @@ void FrameReceiverController::configure_rx_thread(OdinData::IpcMessage& config_m
         need_rx_thread_reconfig_ = true;
     }
 
+    unsigned int rx_batch_size = config_msg.get_param<unsigned int>(CONFIG_RX_BATCH_SIZE, config_.rx_batch_size_);
+    if (rx_batch_size != config_.rx_batch_size_) {
+        config_.rx_batch_size_ = rx_batch_size;
+        need_rx_thread_reconfig_ = true;
+    }
+
+    bool rx_socket_stats = config_msg.get_param<bool>(CONFIG_RX_SOCKET_STATS, config_.rx_socket_stats_);
+    if (rx_socket_stats != config_.rx_socket_stats_) {
+        config_.rx_socket_stats_ = rx_socket_stats;
+        need_rx_thread_reconfig_ = true;
+    }
+
+    unsigned int rx_threads = config_msg.get_param<unsigned int>(CONFIG_RX_THREADS, config_.rx_threads_);
+    if (rx_threads != config_.rx_threads_) {
+        config_.rx_threads_ = rx_threads;
+        need_rx_thread_reconfig_ = true;
+    }
+
+    std::string rx_thread_cores = config_msg.get_param<std::string>(CONFIG_RX_THREAD_CORES, config_.rx_thread_cores_);
+    if (rx_thread_cores != config_.rx_thread_cores_) {
+        config_.rx_thread_cores_ = rx_thread_cores;
+        need_rx_thread_reconfig_ = true;
+    }
+
+    int rx_thread_priority = config_msg.get_param<int>(CONFIG_RX_THREAD_PRIORITY, config_.rx_thread_priority_);
+    if (rx_thread_priority != config_.rx_thread_priority_) {
+        config_.rx_thread_priority_ = rx_thread_priority;
+        need_rx_thread_reconfig_ = true;
+    }
+
+    bool rx_reuseport = config_msg.get_param<bool>(CONFIG_RX_REUSEPORT, config_.rx_reuseport_);
+    if (rx_reuseport != config_.rx_reuseport_) {
+        config_.rx_reuseport_ = rx_reuseport;
+        need_rx_thread_reconfig_ = true;
+    }
+
+    bool rx_tcp_listen = config_msg.get_param<bool>(CONFIG_RX_TCP_LISTEN, config_.rx_tcp_listen_);
+    if (rx_tcp_listen != config_.rx_tcp_listen_) {
+        config_.rx_tcp_listen_ = rx_tcp_listen;
+        need_rx_thread_reconfig_ = true;
+    }
+
+    bool rx_epoll = config_msg.get_param<bool>(CONFIG_RX_EPOLL, config_.rx_epoll_);
+    if (rx_epoll != config_.rx_epoll_) {
+        config_.rx_epoll_ = rx_epoll;
+        need_rx_thread_reconfig_ = true;
+    }
+
+    bool rx_busy_poll = config_msg.get_param<bool>(CONFIG_RX_BUSY_POLL, config_.rx_busy_poll_);
+    if (rx_busy_poll != config_.rx_busy_poll_) {
+        config_.rx_busy_poll_ = rx_busy_poll;
+        need_rx_thread_reconfig_ = true;
+    }
+
+    unsigned int rx_busy_poll_us = config_msg.get_param<unsigned int>(CONFIG_RX_BUSY_POLL_US, config_.rx_busy_poll_us_);
+    if (rx_busy_poll_us != config_.rx_busy_poll_us_) {
+        config_.rx_busy_poll_us_ = rx_busy_poll_us;
+        need_rx_thread_reconfig_ = true;
+    }
+
+    std::string rx_pcap_file = config_msg.get_param<std::string>(CONFIG_RX_PCAP_FILE, config_.rx_pcap_file_);
+    if (rx_pcap_file != config_.rx_pcap_file_) {
+        config_.rx_pcap_file_ = rx_pcap_file;
+        need_rx_thread_reconfig_ = true;
+    }
+
+    unsigned int rx_pcap_snaplen = config_msg.get_param<unsigned int>(CONFIG_RX_PCAP_SNAPLEN, config_.rx_pcap_snaplen_);
+    if (rx_pcap_snaplen != config_.rx_pcap_snaplen_) {
+        config_.rx_pcap_snaplen_ = rx_pcap_snaplen;
+        need_rx_thread_reconfig_ = true;
+    }
+
+    unsigned int rx_pcap_buffer_size
+        = config_msg.get_param<unsigned int>(CONFIG_RX_PCAP_BUFFER_SIZE, config_.rx_pcap_buffer_size_);
+    if (rx_pcap_buffer_size != config_.rx_pcap_buffer_size_) {
+        config_.rx_pcap_buffer_size_ = rx_pcap_buffer_size;
+        need_rx_thread_reconfig_ = true;
+    }
+
+    bool frame_notify_direct = config_msg.get_param<bool>(CONFIG_FRAME_NOTIFY_DIRECT, config_.frame_notify_direct_);
+    if (frame_notify_direct != config_.frame_notify_direct_) {
+        config_.frame_notify_direct_ = frame_notify_direct;
+        need_rx_thread_reconfig_ = true;
+    }
+
     std::string current_rx_port_list = config_.rx_port_list();
     std::string rx_port_list = config_msg.get_param<std::string>(CONFIG_RX_PORTS, current_rx_port_list);
     if (rx_port_list != current_rx_port_list) {
@@ -657,10 +850,29 @@ void FrameReceiverController::configure_rx_thread(OdinData::IpcMessage& config_m
                 rx_thread_.reset(new FrameReceiverTCPRxThread(config_, buffer_manager_, frame_decoder_));
                 break;
 
+            case Defaults::RxTypeAFPacket:
+                rx_thread_.reset(new FrameReceiverAFPacketRxThread(config_, buffer_manager_, frame_decoder_));
+                break;
+
             default:
                 throw FrameReceiverException("Cannot create RX thread - RX type not recognised");
             }
 
+            // If notifying frames directly, hand the frame release channel and ring doorbell over to the
+            // RX thread, which shares the frame ready channel with this thread
+            if (config_.frame_notify_direct_) {
+                reactor_.remove_channel(frame_release_channel_);
+                if (frame_notifier_) {
+                    reactor_.remove_socket(frame_notifier_->get_doorbell_fd(SharedBufferNotifier::ReleaseRing));
+                }
+                rx_thread_->set_direct_notification(
+                    &frame_ready_channel_, &frame_ready_mutex_, &frame_release_channel_, frame_notifier_
+                );
+                frame_notify_direct_active_ = true;
+                rx_frames_ready_ = 0;
+                rx_frames_released_ = 0;
+            }
+
             // Start the RX thread, Flagging successful completion of configuration
             rx_thread_configured_ = rx_thread_->start();
 
@@ -684,6 +896,22 @@ void FrameReceiverController::stop_rx_thread(void)
         // Reset the scoped pointer to the RX thread
         rx_thread_.reset();
 
+        // If the RX thread was notifying frames directly, return the frame release channel and ring
+        // doorbell to the reactor
+        if (frame_notify_direct_active_) {
+            reactor_.register_channel(
+                frame_release_channel_, boost::bind(&FrameReceiverController::handle_frame_release_channel, this),
+                IpcReactor::default_drain_budget
+            );
+            if (frame_notifier_) {
+                reactor_.register_socket(
+                    frame_notifier_->get_doorbell_fd(SharedBufferNotifier::ReleaseRing),
+                    boost::bind(&FrameReceiverController::handle_frame_release_ring, this)
+                );
+            }
+            frame_notify_direct_active_ = false;
+        }
+
         // Clear the RX thread configured flag
         rx_thread_configured_ = false;
     }
@@ -828,6 +1056,11 @@ void FrameReceiverController::handle_rx_channel(void)
                 this->precharge_buffers();
                 break;
 
+            case IpcMessage::MsgValCmdBufferConfigRequest:
+                LOG4CXX_DEBUG_LEVEL(2, logger_, "Got shared buffer config request passed on by RX thread");
+                this->notify_buffer_config(false);
+                break;
+
             default:
                 LOG4CXX_ERROR(logger_, "Got unexpected value on command message from RX thread: " << rx_msg_encoded);
                 break;
@@ -836,16 +1069,66 @@ void FrameReceiverController::handle_rx_channel(void)
 
         case IpcMessage::MsgTypeNotify:
             switch (msg_val) {
-            case IpcMessage::MsgValNotifyFrameReady:
+            case IpcMessage::MsgValNotifyFrameReady: {
+                int frame_number = rx_msg.get_param<int>("frame", -1);
+                int buffer_id = rx_msg.get_param<int>("buffer_id", -1);
                 LOG4CXX_DEBUG_LEVEL(
                     2, logger_,
                     "Got frame ready notification from RX thread"
                     " for frame "
-                        << rx_msg.get_param<int>("frame", -1) << " in buffer " << rx_msg.get_param<int>("buffer_id", -1)
+                        << frame_number << " in buffer " << buffer_id
                 );
-                frame_ready_channel_.send(rx_msg_encoded);
+
+                // Post the notification to the ready ring if enabled, otherwise or if the ring is full
+                // fall back to publishing the message on the frame ready channel
+                if (!frame_notifier_
+                    || !frame_notifier_->post(SharedBufferNotifier::ReadyRing, buffer_id, frame_number)) {
+                    if (frame_notifier_) {
+                        LOG4CXX_WARN(
+                            logger_, "Frame ready ring full, publishing notification for frame " << frame_number
+                        );
+                    }
+                    boost::lock_guard<boost::mutex> ready_lock(frame_ready_mutex_);
+                    frame_ready_channel_.send(rx_msg_encoded);
+                }
                 frames_received_++;
-                break;
+            } break;
+
+            case IpcMessage::MsgValNotifyFrameReadyBatch: {
+                FrameNotifyBatch::FrameList frames;
+                std::size_t num_frames = FrameNotifyBatch::decode(rx_msg, frames);
+                LOG4CXX_DEBUG_LEVEL(
+                    2, logger_, "Got batched frame ready notification from RX thread for " << num_frames << " frames"
+                );
+
+                // Post each frame to the ready ring if enabled, publishing any that do not fit in a batch on
+                // the frame ready channel. Without the ring the batch is forwarded unchanged.
+                if (frame_notifier_) {
+                    FrameNotifyBatch::FrameList unposted;
+                    for (FrameNotifyBatch::FrameList::iterator frame_iter = frames.begin(); frame_iter != frames.end();
+                         ++frame_iter) {
+                        if (!frame_notifier_->post(
+                                SharedBufferNotifier::ReadyRing, frame_iter->second, frame_iter->first
+                            )) {
+                            unposted.push_back(*frame_iter);
+                        }
+                    }
+                    if (!unposted.empty()) {
+                        LOG4CXX_WARN(
+                            logger_,
+                            "Frame ready ring full, publishing notification for " << unposted.size() << " frames"
+                        );
+                        IpcMessage unposted_msg(IpcMessage::MsgTypeNotify, IpcMessage::MsgValNotifyFrameReadyBatch);
+                        FrameNotifyBatch::encode(unposted, unposted_msg);
+                        boost::lock_guard<boost::mutex> ready_lock(frame_ready_mutex_);
+                        frame_ready_channel_.send(unposted_msg.encode());
+                    }
+                } else {
+                    boost::lock_guard<boost::mutex> ready_lock(frame_ready_mutex_);
+                    frame_ready_channel_.send(rx_msg_encoded);
+                }
+                frames_received_ += num_frames;
+            } break;
 
             case IpcMessage::MsgValNotifyIdentity:
                 LOG4CXX_DEBUG_LEVEL(1, logger_, "Got identity announcement from RX thread: " << msg_indentity);
@@ -902,15 +1185,17 @@ void FrameReceiverController::handle_frame_release_channel(void)
             );
             rx_channel_.send(frame_release_encoded, 0, rx_thread_identity_);
 
-            frames_released_++;
+            this->frame_released();
+        } else if ((frame_release.get_msg_type() == IpcMessage::MsgTypeNotify)
+                   && (frame_release.get_msg_val() == IpcMessage::MsgValNotifyFrameReleaseBatch)) {
+            FrameNotifyBatch::FrameList frames;
+            std::size_t num_frames = FrameNotifyBatch::decode(frame_release, frames);
+            LOG4CXX_DEBUG_LEVEL(
+                2, logger_, "Got batched frame release notification from processor for " << num_frames << " frames"
+            );
+            rx_channel_.send(frame_release_encoded, 0, rx_thread_identity_);
 
-            if (config_.frame_count_ && (frames_released_ >= config_.frame_count_)) {
-                LOG4CXX_INFO(
-                    logger_,
-                    "Specified number of frames (" << config_.frame_count_ << ") received and released, terminating"
-                );
-                this->stop(true);
-            }
+            this->frame_released(num_frames);
         } else if ((frame_release.get_msg_type() == IpcMessage::MsgTypeCmd)
                    && (frame_release.get_msg_val() == IpcMessage::MsgValCmdBufferConfigRequest)) {
             LOG4CXX_DEBUG_LEVEL(2, logger_, "Got shared buffer config request from processor");
@@ -923,6 +1208,99 @@ void FrameReceiverController::handle_frame_release_channel(void)
     }
 }
 
+//! Handle frame release ring notifications.
+//!
+//! This method is the handler registered with the reactor for the doorbell of the frame release
+//! ring in the shared buffer. All frame release descriptors posted by the processor are taken from
+//! the ring and passed on to the RX thread so the associated buffers can be re-used.
+//!
+void FrameReceiverController::handle_frame_release_ring(void)
+{
+    frame_notifier_->clear_doorbell(SharedBufferNotifier::ReleaseRing);
+
+    // Take all descriptors posted since the doorbell was signalled, passing them on to the RX thread
+    // coalesced into a single batched release notification
+    FrameNotifyBatch::FrameList frames;
+    SharedBufferRing::Descriptor desc;
+    while (frame_notifier_->take(SharedBufferNotifier::ReleaseRing, desc)) {
+        LOG4CXX_DEBUG_LEVEL(
+            2, logger_,
+            "Got frame release ring notification from processor"
+            " from frame "
+                << desc.frame_number << " in buffer " << desc.buffer_id
+        );
+        frames.push_back(std::make_pair(static_cast<int>(desc.frame_number), static_cast<int>(desc.buffer_id)));
+    }
+
+    if (!frames.empty()) {
+        IpcMessage frame_release(IpcMessage::MsgTypeNotify, IpcMessage::MsgValNotifyFrameReleaseBatch);
+        FrameNotifyBatch::encode(frames, frame_release);
+        rx_channel_.send(frame_release.encode(), 0, rx_thread_identity_);
+
+        this->frame_released(frames.size());
+    }
+}
+
+//! Account for frames released by the downstream processor.
+//!
+//! This method increments the released frame counter and, if a frame count has been specified,
+//! stops the controller once that number of frames has been released.
+//!
+//! \param[in] num_frames - number of frames released
+//!
+void FrameReceiverController::frame_released(const unsigned int num_frames)
+{
+    frames_released_ += num_frames;
+
+    if (config_.frame_count_ && (frames_released_ >= config_.frame_count_)) {
+        LOG4CXX_INFO(
+            logger_, "Specified number of frames (" << config_.frame_count_ << ") received and released, terminating"
+        );
+        this->stop(true);
+    }
+}
+
+//! Set up frame notification through the shared buffer rings.
+//!
+//! This method creates the frame notifier for the current shared buffer manager, registering the
+//! socket on which downstream processors obtain the ring doorbells, and the doorbell of the
+//! frame release ring, with the reactor. If the notifier cannot be created, frame notifications
+//! fall back to the frame ready and release channels.
+//!
+void FrameReceiverController::setup_frame_notifier(void)
+{
+    try {
+        frame_notifier_.reset(new SharedBufferNotifier(buffer_manager_, true));
+    } catch (OdinData::OdinDataException& e) {
+        LOG4CXX_ERROR(logger_, "Failed to set up shared buffer frame notification rings: " << e.what());
+        frame_notifier_.reset();
+        return;
+    }
+
+    reactor_.register_socket(
+        frame_notifier_->get_listen_fd(), boost::bind(&SharedBufferNotifier::handle_connection, frame_notifier_.get())
+    );
+    reactor_.register_socket(
+        frame_notifier_->get_doorbell_fd(SharedBufferNotifier::ReleaseRing),
+        boost::bind(&FrameReceiverController::handle_frame_release_ring, this)
+    );
+
+    LOG4CXX_DEBUG_LEVEL(1, logger_, "Frame notifications enabled through shared buffer rings");
+}
+
+//! Clean up frame notification through the shared buffer rings.
+//!
+//! This method removes the frame notifier sockets from the reactor and destroys the notifier.
+//!
+void FrameReceiverController::cleanup_frame_notifier(void)
+{
+    if (frame_notifier_) {
+        reactor_.remove_socket(frame_notifier_->get_listen_fd());
+        reactor_.remove_socket(frame_notifier_->get_doorbell_fd(SharedBufferNotifier::ReleaseRing));
+        frame_notifier_.reset();
+    }
+}
+
 //! Precharge empty frame buffers for use by the receiver thread.
 //!
 //! This method precharges all the buffers available in the shared buffer manager onto the
@@ -968,7 +1346,16 @@ void FrameReceiverController::notify_buffer_config(const bool deferred)
 
         IpcMessage config_msg(IpcMessage::MsgTypeNotify, IpcMessage::MsgValNotifyBufferConfig);
         config_msg.set_param("shared_buffer_name", config_.shared_buffer_name_);
-
+        config_msg.set_param("frame_notify_ring", (bool)frame_notifier_);
+        config_msg.set_param("frame_release_batch", config_.frame_notify_batch_);
+        config_msg.set_param("frame_release_batch_ms", config_.frame_notify_batch_ms_);
+        config_msg.set_param("huge_page_dir", config_.shared_buffer_huge_page_dir_);
+        config_msg.set_param("numa_node", config_.shared_buffer_numa_node_);
+        config_msg.set_param("lock_memory", config_.shared_buffer_lock_);
+        config_msg.set_param("prefault", config_.shared_buffer_prefault_);
+        config_msg.set_param("block_size", config_.shared_buffer_block_size_);
+
+        boost::lock_guard<boost::mutex> ready_lock(frame_ready_mutex_);
         frame_ready_channel_.send(config_msg.encode());
     }
 }
@@ -976,7 +1363,9 @@ void FrameReceiverController::notify_buffer_config(const bool deferred)
 //! Store the RX thread status.
 //!
 //! This method stores all the parameters present in the RX thread status message passed as an
-//! argument, allowing them to be returned in subsequent get_status calls
+//! argument, allowing them to be returned in subsequent get_status calls. If the RX thread is
+//! notifying frames directly, the frame received and released counters are updated from the
+//! counts reported in the status.
 //!
 //! \param[in] rx_status_msg - IpcMessage containing RX thread status parameters
 //!
@@ -984,6 +1373,21 @@ void FrameReceiverController::store_rx_thread_status(OdinData::IpcMessage& rx_st
 {
     rx_thread_status_.reset(new IpcMessage(rx_status_msg.encode()));
     LOG4CXX_DEBUG_LEVEL(4, logger_, "RX thread status: " << rx_thread_status_->encode());
+
+    if (frame_notify_direct_active_) {
+        uint64_t frames_ready = rx_status_msg.get_param<uint64_t>("rx_thread/frames_ready", rx_frames_ready_);
+        uint64_t frames_released
+            = rx_status_msg.get_param<uint64_t>("rx_thread/frames_released", rx_frames_released_);
+
+        frames_received_ += (frames_ready - rx_frames_ready_);
+        rx_frames_ready_ = frames_ready;
+
+        if (frames_released != rx_frames_released_) {
+            unsigned int num_released = frames_released - rx_frames_released_;
+            rx_frames_released_ = frames_released;
+            this->frame_released(num_released);
+        }
+    }
 }
 
 //! Get the frame receiver status.
@@ -1015,6 +1419,61 @@ void FrameReceiverController::get_status(OdinData::IpcMessage& status_reply)
         frames_timedout = rx_thread_status_->get_param<unsigned int>("rx_thread/frames_timedout");
         frames_dropped = rx_thread_status_->get_param<unsigned int>("rx_thread/frames_dropped");
 
+        // If there are kernel socket statistics present, also copy those into the reply
+        if (rx_thread_status_->has_param("rx_thread/socket_stats")) {
+            status_reply.set_param(
+                "rx_thread/socket_stats",
+                rx_thread_status_->get_param<const rapidjson::Value&>("rx_thread/socket_stats")
+            );
+        }
+
+        // If there are ZMQ receive channel statistics present, also copy those into the reply
+        if (rx_thread_status_->has_param("rx_thread/zmq")) {
+            status_reply.set_param(
+                "rx_thread/zmq", rx_thread_status_->get_param<const rapidjson::Value&>("rx_thread/zmq")
+            );
+        }
+
+        // If there are TCP connection statistics present, also copy those into the reply
+        if (rx_thread_status_->has_param("rx_thread/tcp")) {
+            status_reply.set_param(
+                "rx_thread/tcp", rx_thread_status_->get_param<const rapidjson::Value&>("rx_thread/tcp")
+            );
+        }
+
+        // If there are spill pool statistics present, also copy those into the reply
+        if (rx_thread_status_->has_param("rx_thread/spill")) {
+            status_reply.set_param(
+                "rx_thread/spill", rx_thread_status_->get_param<const rapidjson::Value&>("rx_thread/spill")
+            );
+        }
+
+        // If there are AF_PACKET receive ring statistics present, also copy those into the reply
+        if (rx_thread_status_->has_param("rx_thread/ring")) {
+            status_reply.set_param(
+                "rx_thread/ring", rx_thread_status_->get_param<const rapidjson::Value&>("rx_thread/ring")
+            );
+        }
+        if (rx_thread_status_->has_param("rx_thread/kernel_drops")) {
+            status_reply.set_param(
+                "rx_thread/kernel_drops", rx_thread_status_->get_param<uint64_t>("rx_thread/kernel_drops")
+            );
+        }
+
+        // If there are busy-poll receive loop statistics present, also copy those into the reply
+        if (rx_thread_status_->has_param("rx_thread/busy_poll")) {
+            status_reply.set_param(
+                "rx_thread/busy_poll", rx_thread_status_->get_param<const rapidjson::Value&>("rx_thread/busy_poll")
+            );
+        }
+
+        // If there are packet capture statistics present, also copy those into the reply
+        if (rx_thread_status_->has_param("rx_thread/pcap")) {
+            status_reply.set_param(
+                "rx_thread/pcap", rx_thread_status_->get_param<const rapidjson::Value&>("rx_thread/pcap")
+            );
+        }
+
         // If there is decoder status info present, also copy that into the reply
         if (rx_thread_status_->has_param("decoder")) {
             status_reply.set_param("decoder", rx_thread_status_->get_param<const rapidjson::Value&>("decoder"));
@@ -1024,11 +1483,40 @@ void FrameReceiverController::get_status(OdinData::IpcMessage& status_reply)
     status_reply.set_param("buffers/total", total_buffers_);
     status_reply.set_param("buffers/empty", empty_buffers);
     status_reply.set_param("buffers/mapped", mapped_buffers);
+    if (buffer_manager_) {
+        status_reply.set_param("buffers/page_size", buffer_manager_->get_page_size());
+        status_reply.set_param("buffers/numa_node", buffer_manager_->get_numa_node());
+        status_reply.set_param("buffers/prefault_duration", buffer_manager_->get_prefault_duration());
+    }
 
     status_reply.set_param("frames/timedout", frames_timedout);
     status_reply.set_param("frames/received", frames_received_);
     status_reply.set_param("frames/released", frames_released_);
     status_reply.set_param("frames/dropped", frames_dropped);
+
+    this->get_channel_stats(status_reply, "ipc/rx_channel/", rx_channel_);
+    this->get_channel_stats(status_reply, "ipc/frame_release_channel/", frame_release_channel_);
+}
+
+//! Get the reactor batching statistics of a channel.
+//!
+//! This method adds the number of reactor wakeups on which a channel had messages pending, the
+//! number of messages handled and the largest number handled on one wakeup to a status reply.
+//!
+//! \param[in,out] status_reply - IpcMessage reply to status request
+//! \param[in] param_prefix - prefix of the status parameter names
+//! \param[in] channel - IpcChannel to get statistics for
+//!
+void FrameReceiverController::get_channel_stats(
+    OdinData::IpcMessage& status_reply,
+    const std::string& param_prefix,
+    OdinData::IpcChannel& channel
+)
+{
+    IpcReactorChannelStats stats = reactor_.get_channel_stats(channel);
+    status_reply.set_param(param_prefix + "wakeups", stats.wakeups);
+    status_reply.set_param(param_prefix + "messages", stats.messages);
+    status_reply.set_param(param_prefix + "max_batch", stats.max_batch);
 }
 
 //! Get the frame receiver version information.
@@ -1089,6 +1577,15 @@ void FrameReceiverController::request_configuration(OdinData::IpcMessage& config
 
     // Add the buffer manager configuration to the reply parameters
     config_reply.set_param(CONFIG_SHARED_BUFFER_NAME, config_.shared_buffer_name_);
+    config_reply.set_param(CONFIG_FRAME_NOTIFY_RING, config_.frame_notify_ring_);
+    config_reply.set_param(CONFIG_FRAME_NOTIFY_BATCH, config_.frame_notify_batch_);
+    config_reply.set_param(CONFIG_FRAME_NOTIFY_BATCH_MS, config_.frame_notify_batch_ms_);
+    config_reply.set_param(CONFIG_FRAME_NOTIFY_DIRECT, config_.frame_notify_direct_);
+    config_reply.set_param(CONFIG_SHARED_BUFFER_HUGE_PAGE_DIR, config_.shared_buffer_huge_page_dir_);
+    config_reply.set_param(CONFIG_SHARED_BUFFER_NUMA_NODE, config_.shared_buffer_numa_node_);
+    config_reply.set_param(CONFIG_SHARED_BUFFER_LOCK, config_.shared_buffer_lock_);
+    config_reply.set_param(CONFIG_SHARED_BUFFER_PREFAULT, config_.shared_buffer_prefault_);
+    config_reply.set_param(CONFIG_SHARED_BUFFER_BLOCK_SIZE, config_.shared_buffer_block_size_);
     config_reply.set_param(CONFIG_MAX_BUFFER_MEM, config_.max_buffer_mem_);
 
     // Add the RX thread configuration to the reply parameters
@@ -1096,6 +1593,19 @@ void FrameReceiverController::request_configuration(OdinData::IpcMessage& config
     config_reply.set_param(CONFIG_RX_ADDRESS, config_.rx_address_);
     config_reply.set_param(CONFIG_RX_PORTS, config_.rx_port_list());
     config_reply.set_param(CONFIG_RX_RECV_BUFFER_SIZE, config_.rx_recv_buffer_size_);
+    config_reply.set_param(CONFIG_RX_BATCH_SIZE, config_.rx_batch_size_);
+    config_reply.set_param(CONFIG_RX_SOCKET_STATS, config_.rx_socket_stats_);
+    config_reply.set_param(CONFIG_RX_THREADS, config_.rx_threads_);
+    config_reply.set_param(CONFIG_RX_THREAD_CORES, config_.rx_thread_cores_);
+    config_reply.set_param(CONFIG_RX_THREAD_PRIORITY, config_.rx_thread_priority_);
+    config_reply.set_param(CONFIG_RX_REUSEPORT, config_.rx_reuseport_);
+    config_reply.set_param(CONFIG_RX_TCP_LISTEN, config_.rx_tcp_listen_);
+    config_reply.set_param(CONFIG_RX_EPOLL, config_.rx_epoll_);
+    config_reply.set_param(CONFIG_RX_BUSY_POLL, config_.rx_busy_poll_);
+    config_reply.set_param(CONFIG_RX_BUSY_POLL_US, config_.rx_busy_poll_us_);
+    config_reply.set_param(CONFIG_RX_PCAP_FILE, config_.rx_pcap_file_);
+    config_reply.set_param(CONFIG_RX_PCAP_SNAPLEN, config_.rx_pcap_snaplen_);
+    config_reply.set_param(CONFIG_RX_PCAP_BUFFER_SIZE, config_.rx_pcap_buffer_size_);
 
     // Add frame count to reply parameters
     config_reply.set_param(CONFIG_FRAME_COUNT, config_.frame_count_);
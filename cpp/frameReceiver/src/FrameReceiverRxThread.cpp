@@ -5,6 +5,8 @@
  *      Author: Tim Nicholls, STFC Application Engineering Group
  */
 
+#include <algorithm>
+
 #include "FrameReceiverRxThread.h"
 
 #ifdef BOOST_HAS_PLACEHOLDERS
@@ -25,11 +27,20 @@ FrameReceiverRxThread::FrameReceiverRxThread(
     unsigned int tick_period_ms
 ) :
     config_(config),
+    reactor_(config.rx_epoll_ ? IpcReactor::ReactorBackendEpoll : IpcReactor::ReactorBackendPoll),
     logger_(log4cxx::Logger::getLogger("FR.RxThread")),
     buffer_manager_(buffer_manager),
     frame_decoder_(frame_decoder),
     tick_period_ms_(tick_period_ms),
     rx_channel_(ZMQ_DEALER),
+    frame_ready_batch_(
+        IpcMessage::MsgValNotifyFrameReadyBatch, config.frame_notify_batch_, config.frame_notify_batch_ms_
+    ),
+    frame_ready_channel_(NULL),
+    frame_ready_mutex_(NULL),
+    frame_release_channel_(NULL),
+    frames_ready_(0),
+    frames_released_(0),
     run_thread_(true),
     thread_running_(false),
     thread_init_error_(false)
@@ -102,6 +113,33 @@ void FrameReceiverRxThread::stop()
     cleanup_specific_service();
 }
 
+//! Enable direct frame notification between the RX thread and downstream processes.
+//!
+//! This method, which must be called before the thread is started, allows the RX thread to
+//! publish frame ready notifications directly on the frame ready channel, and to receive frame
+//! release notifications directly from the frame release channel and frame release ring, rather
+//! than passing them via the main thread. The frame ready channel remains bound and used by the
+//! main thread, so access to it is serialised by the mutex passed. The main thread must not use the
+//! frame release channel or take from the frame release ring until the RX thread has stopped.
+//!
+//! \param[in] frame_ready_channel - channel to publish frame ready notifications on
+//! \param[in] frame_ready_mutex - mutex serialising access to the frame ready channel
+//! \param[in] frame_release_channel - channel to receive frame release notifications on
+//! \param[in] frame_notifier - shared memory ring frame notifier, which may be empty
+//!
+void FrameReceiverRxThread::set_direct_notification(
+    IpcChannel* frame_ready_channel,
+    boost::mutex* frame_ready_mutex,
+    IpcChannel* frame_release_channel,
+    SharedBufferNotifierPtr frame_notifier
+)
+{
+    frame_ready_channel_ = frame_ready_channel;
+    frame_ready_mutex_ = frame_ready_mutex;
+    frame_release_channel_ = frame_release_channel;
+    frame_notifier_ = frame_notifier;
+}
+
 //! Run the RX thread event loop service
 //!
 //! This method is the entry point for the RX thread and, having configured message channels
@@ -126,8 +164,25 @@ void FrameReceiverRxThread::run_service(void)
         return;
     }
 
-    // Add the RX channel to the reactor
-    reactor_.register_channel(rx_channel_, boost::bind(&FrameReceiverRxThread::handle_rx_channel, this));
+    // Add the RX channel to the reactor, draining pending frame release notifications on each wakeup
+    reactor_.register_channel(
+        rx_channel_, boost::bind(&FrameReceiverRxThread::handle_rx_channel, this), IpcReactor::default_drain_budget
+    );
+
+    // If notifying frames directly, add the frame release channel and ring doorbell to the reactor so
+    // that released buffers are returned to the frame decoder without passing via the main thread
+    if (frame_release_channel_) {
+        reactor_.register_channel(
+            *frame_release_channel_, boost::bind(&FrameReceiverRxThread::handle_frame_release_channel, this),
+            IpcReactor::default_drain_budget
+        );
+    }
+    if (frame_ready_channel_ && frame_notifier_) {
+        reactor_.register_socket(
+            frame_notifier_->get_doorbell_fd(SharedBufferNotifier::ReleaseRing),
+            boost::bind(&FrameReceiverRxThread::handle_frame_release_ring, this)
+        );
+    }
 
     // Run the specific service setup implemented in subclass
     run_specific_service();
@@ -141,6 +196,22 @@ void FrameReceiverRxThread::run_service(void)
         frame_decoder_->get_frame_timeout_ms(), 0, boost::bind(&FrameReceiverRxThread::buffer_monitor_timer, this)
     );
 
+    // Add the frame expiry timer to the reactor, firing at a fraction of the frame timeout so that
+    // incomplete frames are released close to their deadline
+    int frame_expiry_timer_id = reactor_.register_timer(
+        frame_decoder_->get_frame_expiry_period_ms(), 0, boost::bind(&FrameReceiverRxThread::frame_expiry_timer, this)
+    );
+
+    // If frame ready notifications are batched, add a timer to the reactor to flush partial batches
+    // within the batch latency bound
+    int frame_ready_flush_timer_id = -1;
+    if (frame_ready_batch_.enabled()) {
+        frame_ready_flush_timer_id = reactor_.register_timer(
+            std::max(frame_ready_batch_.get_max_latency_ms(), 1U), 0,
+            boost::bind(&FrameReceiverRxThread::frame_ready_flush_timer, this)
+        );
+    }
+
     // Register the frame release callback with the decoder
     frame_decoder_->register_frame_ready_callback(boost::bind(&FrameReceiverRxThread::frame_ready, this, _1, _2));
 
@@ -160,13 +231,26 @@ void FrameReceiverRxThread::run_service(void)
         this->request_buffer_precharge();
     }
 
-    // Run the reactor event loop
-    reactor_.run();
+    // Run the event loop, which by default runs the reactor until the thread is stopped
+    this->run_event_loop();
 
     // Cleanup - remove channels, sockets and timers from the reactor and close the receive socket
     reactor_.remove_channel(rx_channel_);
     reactor_.remove_timer(tick_timer_id);
     reactor_.remove_timer(buffer_monitor_timer_id);
+    reactor_.remove_timer(frame_expiry_timer_id);
+    if (frame_ready_flush_timer_id != -1) {
+        reactor_.remove_timer(frame_ready_flush_timer_id);
+    }
+    if (frame_release_channel_) {
+        reactor_.remove_channel(*frame_release_channel_);
+    }
+    if (frame_ready_channel_ && frame_notifier_) {
+        reactor_.remove_socket(frame_notifier_->get_doorbell_fd(SharedBufferNotifier::ReleaseRing));
+    }
+
+    // Send any frame ready notifications remaining in a partial batch
+    this->flush_frame_ready_batch();
 
     for (std::vector<int>::iterator recv_sock_it = recv_sockets_.begin(); recv_sock_it != recv_sockets_.end();
          recv_sock_it++) {
@@ -217,6 +301,9 @@ void FrameReceiverRxThread::handle_rx_channel(void)
     // Receive a message from the main thread channel
     std::string rx_msg_encoded = rx_channel_.recv();
 
+    // Serialise access to the frame decoder with any receive worker threads
+    boost::lock_guard<boost::mutex> decoder_lock(decoder_mutex_);
+
     // Decode the message and handle appropriately
     try {
 
@@ -285,11 +372,18 @@ void FrameReceiverRxThread::handle_rx_channel(void)
                 }
             } break;
 
+            case IpcMessage::MsgValNotifyFrameReleaseBatch: {
+                FrameNotifyBatch::FrameList frames;
+                FrameNotifyBatch::decode(rx_msg, frames);
+                this->release_frames(frames);
+            } break;
+
             case IpcMessage::MsgValNotifyFrameRelease: {
 
                 int buffer_id = rx_msg.get_param<int>("buffer_id", -1);
                 if (buffer_id != -1) {
                     frame_decoder_->push_empty_buffer(buffer_id);
+                    frames_released_++;
                     LOG4CXX_DEBUG_LEVEL(
                         3, logger_,
                         "Added empty buffer ID " << buffer_id << " to queue, length is now "
@@ -320,6 +414,89 @@ void FrameReceiverRxThread::handle_rx_channel(void)
     }
 }
 
+//! Handle messages on the frame release channel.
+//!
+//! This method is the handler registered with the thread reactor when notifying frames directly.
+//! Buffers of frames released by downstream processes are pushed onto the frame decoder empty
+//! buffer queue. Any other message, e.g. a shared buffer configuration request, is passed on
+//! to the main thread.
+//!
+void FrameReceiverRxThread::handle_frame_release_channel(void)
+{
+    std::string frame_release_encoded = frame_release_channel_->recv();
+
+    try {
+        IpcMessage frame_release(frame_release_encoded.c_str());
+        LOG4CXX_DEBUG_LEVEL(4, logger_, "Got message on frame release channel : " << frame_release_encoded);
+
+        FrameNotifyBatch::FrameList frames;
+        if ((frame_release.get_msg_type() == IpcMessage::MsgTypeNotify)
+            && (frame_release.get_msg_val() == IpcMessage::MsgValNotifyFrameRelease)) {
+            int buffer_id = frame_release.get_param<int>("buffer_id", -1);
+            if (buffer_id != -1) {
+                frames.push_back(std::make_pair(frame_release.get_param<int>("frame", -1), buffer_id));
+            } else {
+                LOG4CXX_ERROR(logger_, "RX thread received frame release notification without buffer ID");
+            }
+        } else if ((frame_release.get_msg_type() == IpcMessage::MsgTypeNotify)
+                   && (frame_release.get_msg_val() == IpcMessage::MsgValNotifyFrameReleaseBatch)) {
+            FrameNotifyBatch::decode(frame_release, frames);
+        } else {
+            rx_channel_.send(frame_release_encoded);
+            return;
+        }
+
+        boost::lock_guard<boost::mutex> decoder_lock(decoder_mutex_);
+        this->release_frames(frames);
+    } catch (IpcMessageException& e) {
+        LOG4CXX_ERROR(logger_, "Error decoding message on frame release channel: " << e.what());
+    }
+}
+
+//! Handle frame release ring notifications.
+//!
+//! This method is the handler registered with the thread reactor for the doorbell of the frame
+//! release ring when notifying frames directly. All frame release descriptors posted by downstream
+//! processes are taken from the ring and their buffers pushed onto the empty buffer queue.
+//!
+void FrameReceiverRxThread::handle_frame_release_ring(void)
+{
+    frame_notifier_->clear_doorbell(SharedBufferNotifier::ReleaseRing);
+
+    FrameNotifyBatch::FrameList frames;
+    SharedBufferRing::Descriptor desc;
+    while (frame_notifier_->take(SharedBufferNotifier::ReleaseRing, desc)) {
+        frames.push_back(std::make_pair(static_cast<int>(desc.frame_number), static_cast<int>(desc.buffer_id)));
+    }
+
+    boost::lock_guard<boost::mutex> decoder_lock(decoder_mutex_);
+    this->release_frames(frames);
+}
+
+//! Release frames for re-use by the frame decoder.
+//!
+//! This method pushes the buffers of released frames onto the frame decoder empty buffer queue.
+//! The caller must hold the decoder mutex.
+//!
+//! \param[in] frames - list of released frame numbers and buffer IDs
+//!
+void FrameReceiverRxThread::release_frames(const FrameNotifyBatch::FrameList& frames)
+{
+    if (frames.empty()) {
+        return;
+    }
+    for (FrameNotifyBatch::FrameList::const_iterator frame_iter = frames.begin(); frame_iter != frames.end();
+         ++frame_iter) {
+        frame_decoder_->push_empty_buffer(frame_iter->second);
+    }
+    frames_released_ += frames.size();
+    LOG4CXX_DEBUG_LEVEL(
+        3, logger_,
+        "Added " << frames.size() << " empty buffers to queue, length is now "
+                 << frame_decoder_->get_num_empty_buffers()
+    );
+}
+
 //! Tick timer handler for the RX thread.
 //!
 //! This method is the tick timer handler for the RX thread and is called periodically
@@ -335,6 +512,29 @@ void FrameReceiverRxThread::tick_timer(void)
     }
 }
 
+//! Frame expiry timer handler for the RX thread.
+//!
+//! This method is the frame expiry timer handler for the RX thread and is called by the thread
+//! reactor event loop at a fraction of the frame timeout period. It calls the frame decoder to
+//! release exactly those incomplete frames whose timeout has passed.
+//!
+void FrameReceiverRxThread::frame_expiry_timer(void)
+{
+    boost::lock_guard<boost::mutex> decoder_lock(decoder_mutex_);
+    frame_decoder_->expire_frames();
+}
+
+//! Frame ready flush timer handler for the RX thread.
+//!
+//! This method is called by the thread reactor event loop at the frame notification batch
+//! latency period when batching is enabled, sending any partial batch of frame ready
+//! notifications to the main thread.
+//!
+void FrameReceiverRxThread::frame_ready_flush_timer(void)
+{
+    this->flush_frame_ready_batch();
+}
+
 //! Buffer monitor timer handler for the RX thread.
 //!
 //! This method is the buffer monitor timer handler for the RX thread and is called periodically
@@ -345,6 +545,7 @@ void FrameReceiverRxThread::tick_timer(void)
 void FrameReceiverRxThread::buffer_monitor_timer(void)
 {
     LOG4CXX_DEBUG_LEVEL(4, logger_, "RX thread buffer monitor thread fired");
+    boost::lock_guard<boost::mutex> decoder_lock(decoder_mutex_);
     frame_decoder_->monitor_buffers();
 
     // Send status notification to main thread
@@ -368,16 +569,55 @@ void FrameReceiverRxThread::fill_status_params(IpcMessage& status_msg)
     status_msg.set_param("rx_thread/mapped_buffers", frame_decoder_->get_num_mapped_buffers());
     status_msg.set_param("rx_thread/frames_timedout", frame_decoder_->get_num_frames_timedout());
     status_msg.set_param("rx_thread/frames_dropped", frame_decoder_->get_num_frames_dropped());
+    status_msg.set_param("rx_thread/frames_ready", frames_ready_);
+    status_msg.set_param("rx_thread/frames_released", frames_released_);
+
+    // Report spill pool occupancy and traffic if the decoder has a spill pool
+    if (frame_decoder_->get_spill_pool_size() > 0) {
+        status_msg.set_param("rx_thread/spill/buffers", frame_decoder_->get_spill_pool_size());
+        status_msg.set_param("rx_thread/spill/in_use", frame_decoder_->get_num_spilled_buffers());
+        status_msg.set_param("rx_thread/spill/peak", frame_decoder_->get_spill_pool_peak());
+        status_msg.set_param("rx_thread/spill/frames_spilled", frame_decoder_->get_num_frames_spilled());
+        status_msg.set_param("rx_thread/spill/frames_unspilled", frame_decoder_->get_num_frames_unspilled());
+    }
+
+    // Allow the specific RX thread type to add its own status
+    this->fill_specific_status_params(status_msg);
 
     // Get the specific frame decoder instance to fill its own status into message
     frame_decoder_->get_status(std::string("decoder/"), status_msg);
 }
 
+//! Run the RX thread event loop.
+//!
+//! This method runs the event loop of the RX thread until the thread is signalled to stop. The
+//! default implementation runs the reactor, which sleeps until a channel, socket or timer is
+//! ready. It can be overridden by specific RX thread types to run their own loop, which must
+//! service the reactor regularly so that the RX channel and timers are handled.
+//!
+void FrameReceiverRxThread::run_event_loop(void)
+{
+    reactor_.run();
+}
+
+//! Fill RX thread type specific status parameters into a message.
+//!
+//! This method can be overridden by specific RX thread types to add their own parameters to
+//! status messages. The default implementation adds nothing.
+//!
+//! \param[in,out] status_msg - IpcMessage to fill with status parameters
+//!
+void FrameReceiverRxThread::fill_specific_status_params(IpcMessage& status_msg)
+{
+}
+
 //! Signal that a frame is ready for processing.
 //!
 //! This method is called to signal to the main thread that a frame is ready (either complete or
 //! timed out) for processing by the downstream application. An IpcMessage is created with
-//! the appropriate parameters and passed to the amin thread via the RX channel.
+//! the appropriate parameters and passed to the amin thread via the RX channel. When notifying
+//! frames directly, the frame is instead posted to the frame ready ring if enabled, or published
+//! on the frame ready channel, with the number of frames reported in the RX thread status.
 //!
 //! \param[in] buffer_id - buffer manager ID that is ready
 //! \param[in] frame_number - frame number contained in that buffer
@@ -385,12 +625,75 @@ void FrameReceiverRxThread::fill_status_params(IpcMessage& status_msg)
 void FrameReceiverRxThread::frame_ready(int buffer_id, int frame_number)
 {
     LOG4CXX_DEBUG_LEVEL(2, logger_, "Releasing frame " << frame_number << " in buffer " << buffer_id);
+    frames_ready_++;
+
+    // If notifying directly, post the frame to the ready ring if enabled. Otherwise, or if the ring is
+    // full, the frame ready channel shared with the main thread is held while publishing the notification
+    boost::unique_lock<boost::mutex> ready_lock;
+    if (frame_ready_channel_) {
+        if (frame_notifier_ && frame_notifier_->post(SharedBufferNotifier::ReadyRing, buffer_id, frame_number)) {
+            return;
+        }
+        ready_lock = boost::unique_lock<boost::mutex>(*frame_ready_mutex_);
+    }
+    IpcChannel& ready_channel = frame_ready_channel_ ? *frame_ready_channel_ : this->get_frame_ready_channel();
+
+    // If batching is enabled, add the frame to the batch for the calling thread, which is sent
+    // once full or when its latency bound is reached
+    FrameNotifyBatch& ready_batch = this->get_frame_ready_batch();
+    if (ready_batch.enabled()) {
+        ready_batch.add(frame_number, buffer_id, ready_channel);
+        return;
+    }
 
     IpcMessage ready_msg(IpcMessage::MsgTypeNotify, IpcMessage::MsgValNotifyFrameReady);
     ready_msg.set_param("frame", frame_number);
     ready_msg.set_param("buffer_id", buffer_id);
 
-    rx_channel_.send(ready_msg.encode());
+    ready_channel.send(ready_msg.encode());
+}
+
+//! Send any partial batch of frame ready notifications.
+//!
+//! This method sends the pending notifications in the batch of the calling thread, either on the
+//! frame ready channel when notifying directly or on the channel returned by get_frame_ready_channel().
+//!
+void FrameReceiverRxThread::flush_frame_ready_batch(void)
+{
+    if (frame_ready_channel_) {
+        boost::lock_guard<boost::mutex> ready_lock(*frame_ready_mutex_);
+        this->get_frame_ready_batch().flush(*frame_ready_channel_);
+    } else {
+        this->get_frame_ready_batch().flush(this->get_frame_ready_channel());
+    }
+}
+
+//! Get the channel on which to send frame ready notifications.
+//!
+//! This method returns the channel that frame ready notifications should be sent on from the
+//! calling thread. The default implementation returns the RX channel to the main thread. Specific
+//! RX thread types which call the frame decoder from other threads can override this to return
+//! a channel owned by the calling thread.
+//!
+//! \return - reference to the channel to send frame ready notifications on
+//!
+IpcChannel& FrameReceiverRxThread::get_frame_ready_channel(void)
+{
+    return rx_channel_;
+}
+
+//! Get the batch in which to accumulate frame ready notifications.
+//!
+//! This method returns the batch that frame ready notifications should be accumulated in by the
+//! calling thread, which is sent on the channel returned by get_frame_ready_channel(). The default
+//! implementation returns the batch of the RX thread. Specific RX thread types which call the
+//! frame decoder from other threads should override this alongside get_frame_ready_channel().
+//!
+//! \return - reference to the batch to add frame ready notifications to
+//!
+FrameNotifyBatch& FrameReceiverRxThread::get_frame_ready_batch(void)
+{
+    return frame_ready_batch_;
 }
 
 //! Set thread initialisation error condition.
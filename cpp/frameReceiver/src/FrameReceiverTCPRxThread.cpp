@@ -3,8 +3,16 @@
  *
  */
 
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <sys/socket.h>
 #include <unistd.h>
 
+#include <sstream>
+
 #include "FrameReceiverTCPRxThread.h"
 
 using namespace FrameReceiver;
@@ -17,7 +25,10 @@ FrameReceiverTCPRxThread::FrameReceiverTCPRxThread(
 ) :
     FrameReceiverRxThread(config, buffer_manager, frame_decoder, tick_period_ms),
     logger_(log4cxx::Logger::getLogger("FR.TCPRxThread")),
-    recv_socket_(-1)
+    connections_accepted_(0),
+    connections_closed_(0),
+    messages_received_(0),
+    bytes_received_(0)
 {
     LOG4CXX_DEBUG_LEVEL(1, logger_, "FrameReceiverTCPRxThread constructor entered....");
 
@@ -39,61 +50,67 @@ void FrameReceiverTCPRxThread::run_specific_service(void)
 
         uint16_t rx_port = *rx_port_itr;
 
-        // Create the receive socket
-        int recv_socket_ = socket(AF_INET, SOCK_STREAM, 0);
-        if (recv_socket_ < 0) {
-            std::stringstream ss;
-            ss << "RX channel failed to create receive socket for port " << rx_port << " : " << strerror(errno);
-            this->set_thread_init_error(ss.str());
+        struct sockaddr_in recv_addr;
+        int recv_socket = this->create_socket(rx_port, recv_addr);
+        if (recv_socket < 0) {
             return;
         }
 
-        // Set the socket receive buffer size
-        if (setsockopt(
-                recv_socket_, SOL_SOCKET, SO_REUSEADDR, &config_.rx_recv_buffer_size_,
-                sizeof(config_.rx_recv_buffer_size_)
-            )
-            < 0) {
-            std::stringstream ss;
-            ss << "RX channel failed to set receive socket buffer size for port " << rx_port << " : "
-               << strerror(errno);
-            this->set_thread_init_error(ss.str());
-            return;
-        }
+        if (config_.rx_tcp_listen_) {
 
-        // Read it back and display
-        int buffer_size;
-        socklen_t len = sizeof(buffer_size);
-        getsockopt(recv_socket_, SOL_SOCKET, SO_REUSEADDR, &buffer_size, &len);
-        LOG4CXX_DEBUG_LEVEL(1, logger_, "RX thread receive buffer size for port " << rx_port << " is " << buffer_size);
+            // Bind the socket to the receive address and listen for connections from senders
+            int reuse_addr = 1;
+            setsockopt(recv_socket, SOL_SOCKET, SO_REUSEADDR, &reuse_addr, sizeof(reuse_addr));
 
-        // Connect the socket to the specified endpoint
-        struct sockaddr_in recv_addr;
-        memset(&recv_addr, 0, sizeof(recv_addr));
-        recv_addr.sin_family = AF_INET;
-        recv_addr.sin_port = htons(rx_port);
-        recv_addr.sin_addr.s_addr = inet_addr(config_.rx_address_.c_str());
-
-        if (recv_addr.sin_addr.s_addr == INADDR_NONE) {
-            std::stringstream ss;
-            ss << "Illegal receive address specified: " << config_.rx_address_;
-            this->set_thread_init_error(ss.str());
-            return;
-        }
+            if (bind(recv_socket, (struct sockaddr*)&recv_addr, sizeof(recv_addr)) == -1) {
+                std::stringstream ss;
+                ss << "RX channel failed to bind listening socket to address " << config_.rx_address_ << " port "
+                   << rx_port << " : " << strerror(errno);
+                close(recv_socket);
+                this->set_thread_init_error(ss.str());
+                return;
+            }
 
-        if (connect(recv_socket_, (struct sockaddr*)&recv_addr, sizeof(recv_addr)) == -1) {
-            std::stringstream ss;
-            ss << "RX channel failed to connect receive socket to address " << config_.rx_address_ << " port "
-               << rx_port << " : " << strerror(errno);
-            this->set_thread_init_error(ss.str());
-            return;
-        }
+            if ((listen(recv_socket, SOMAXCONN) == -1) || (fcntl(recv_socket, F_SETFL, O_NONBLOCK) == -1)) {
+                std::stringstream ss;
+                ss << "RX channel failed to listen for connections on port " << rx_port << " : " << strerror(errno);
+                close(recv_socket);
+                this->set_thread_init_error(ss.str());
+                return;
+            }
 
-        // Register this socket
-        this->register_socket(
-            recv_socket_,
-            boost::bind(&FrameReceiverTCPRxThread::handle_receive_socket, this, recv_socket_, (int)rx_port)
-        );
+            // Register the listening socket, which is closed by the base class when the thread terminates
+            this->register_socket(
+                recv_socket, boost::bind(&FrameReceiverTCPRxThread::handle_accept, this, recv_socket, (int)rx_port)
+            );
+
+            LOG4CXX_INFO(
+                logger_, "RX thread listening for TCP connections on " << config_.rx_address_ << ":" << rx_port
+            );
+
+        } else {
+
+            // Connect the socket to the specified endpoint
+            if (connect(recv_socket, (struct sockaddr*)&recv_addr, sizeof(recv_addr)) == -1) {
+                std::stringstream ss;
+                ss << "RX channel failed to connect receive socket to address " << config_.rx_address_ << " port "
+                   << rx_port << " : " << strerror(errno);
+                close(recv_socket);
+                this->set_thread_init_error(ss.str());
+                return;
+            }
+
+            if (fcntl(recv_socket, F_SETFL, O_NONBLOCK) == -1) {
+                std::stringstream ss;
+                ss << "RX channel failed to set receive socket for port " << rx_port
+                   << " non-blocking : " << strerror(errno);
+                close(recv_socket);
+                this->set_thread_init_error(ss.str());
+                return;
+            }
+
+            this->add_connection(recv_socket, rx_port, recv_addr);
+        }
     }
 }
 
@@ -101,35 +118,267 @@ void FrameReceiverTCPRxThread::cleanup_specific_service(void)
 {
     LOG4CXX_DEBUG_LEVEL(1, logger_, "Cleaning up TCP RX thread service");
 
-    // Remove the IPC socket from the reactor
-    reactor_.remove_socket(recv_socket_);
-    close(recv_socket_);
+    // Close any connections still open, the listening sockets are closed by the base class
+    while (!connections_.empty()) {
+        this->close_connection(connections_.begin()->first);
+    }
 }
 
-void FrameReceiverTCPRxThread::handle_receive_socket(int recv_socket_, int recv_port)
+//! Create a TCP socket for a receive port.
+//!
+//! This method creates a TCP socket with the configured receive buffer size and resolves the
+//! configured receive address and the port into the address to connect or bind the socket to.
+//! Any error is signalled as a thread initialisation error.
+//!
+//! \param[in] rx_port - port to receive on
+//! \param[out] addr - address to connect or bind the socket to
+//! \return - socket file descriptor, or -1 on error
+//!
+int FrameReceiverTCPRxThread::create_socket(uint16_t rx_port, struct sockaddr_in& addr)
 {
-    // Receive a message from the main thread channel and place it directly into
-    // the provided memory buffer
-    void* frame_buffer = frame_decoder_->get_next_message_buffer();
-    size_t message_size = frame_decoder_->get_next_message_size();
-    ssize_t bytes_read = 0;
-    size_t total_bytes_read = 0;
-
-    unsigned char* fb_bytePtr = reinterpret_cast<unsigned char*>(frame_buffer
-    ); // reinterpret the void* address as an unsigned char pointer so we can do arithmetic
-    while (total_bytes_read < message_size
-           && ((bytes_read = read(recv_socket_, reinterpret_cast<void*>(fb_bytePtr), message_size - total_bytes_read))
-               > 0)) {
-        total_bytes_read += bytes_read;
-        fb_bytePtr += bytes_read;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(rx_port);
+    addr.sin_addr.s_addr = inet_addr(config_.rx_address_.c_str());
+
+    if (addr.sin_addr.s_addr == INADDR_NONE) {
+        std::stringstream ss;
+        ss << "Illegal receive address specified: " << config_.rx_address_;
+        this->set_thread_init_error(ss.str());
+        return -1;
     }
 
-    if (bytes_read < 0) {
-        LOG_WITH_ERRNO(logger_, "read() Failed");
-        return;
-    } else if (total_bytes_read < message_size) {
-        LOG4CXX_ERROR(logger_, "read() returned 0 bytes (incomplete data)");
+    int recv_socket = socket(AF_INET, SOCK_STREAM, 0);
+    if (recv_socket < 0) {
+        std::stringstream ss;
+        ss << "RX channel failed to create receive socket for port " << rx_port << " : " << strerror(errno);
+        this->set_thread_init_error(ss.str());
+        return -1;
+    }
+
+    // Set the socket receive buffer size, which is inherited by connections accepted on a
+    // listening socket
+    if (setsockopt(
+            recv_socket, SOL_SOCKET, SO_RCVBUF, &config_.rx_recv_buffer_size_, sizeof(config_.rx_recv_buffer_size_)
+        )
+        < 0) {
+        std::stringstream ss;
+        ss << "RX channel failed to set receive socket buffer size for port " << rx_port << " : " << strerror(errno);
+        close(recv_socket);
+        this->set_thread_init_error(ss.str());
+        return -1;
+    }
+
+    // Read it back and display
+    int buffer_size;
+    socklen_t len = sizeof(buffer_size);
+    getsockopt(recv_socket, SOL_SOCKET, SO_RCVBUF, &buffer_size, &len);
+    LOG4CXX_DEBUG_LEVEL(1, logger_, "RX thread receive buffer size for port " << rx_port << " is " << buffer_size);
+
+    return recv_socket;
+}
+
+//! Add a connection to the RX thread.
+//!
+//! This method creates the receive state for a connected, non-blocking socket and registers the
+//! socket with the reactor.
+//!
+//! \param[in] socket_fd - socket file descriptor of the connection
+//! \param[in] port - local port the connection was made to
+//! \param[in] peer_addr - address of the remote end of the connection
+//!
+void FrameReceiverTCPRxThread::add_connection(int socket_fd, int port, const struct sockaddr_in& peer_addr)
+{
+    TCPConnectionPtr connection(new TCPConnection());
+    connection->socket_fd = socket_fd;
+    connection->port = port;
+    std::stringstream peer;
+    peer << inet_ntoa(peer_addr.sin_addr) << ":" << ntohs(peer_addr.sin_port);
+    connection->peer = peer.str();
+    connection->iov_count = 0;
+    connection->iov_index = 0;
+    connection->message_bytes = 0;
+
+    connections_[socket_fd] = connection;
+    connections_accepted_++;
+
+    // Connection sockets are registered directly with the reactor as they are closed by this
+    // class when the remote end disconnects
+    reactor_.register_socket(socket_fd, boost::bind(&FrameReceiverTCPRxThread::handle_receive_socket, this, socket_fd));
+
+    LOG4CXX_INFO(logger_, "RX thread receiving on TCP connection with " << connection->peer << " on port " << port);
+}
+
+//! Close a connection.
+//!
+//! This method removes the socket of a connection from the reactor, closes it and discards the
+//! receive state of the connection.
+//!
+//! \param[in] socket_fd - socket file descriptor of the connection
+//!
+void FrameReceiverTCPRxThread::close_connection(int socket_fd)
+{
+    reactor_.remove_socket(socket_fd);
+    close(socket_fd);
+    connections_.erase(socket_fd);
+    connections_closed_++;
+}
+
+//! Handle incoming connections on a listening socket.
+//!
+//! This method is called by the reactor when a listening socket is readable and accepts all
+//! pending connections on it.
+//!
+//! \param[in] listen_socket - listening socket file descriptor
+//! \param[in] recv_port - port the socket is listening on
+//!
+void FrameReceiverTCPRxThread::handle_accept(int listen_socket, int recv_port)
+{
+    while (true) {
+        struct sockaddr_in peer_addr;
+        socklen_t peer_addr_len = sizeof(peer_addr);
+        int socket_fd = accept(listen_socket, (struct sockaddr*)&peer_addr, &peer_addr_len);
+        if (socket_fd < 0) {
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
+                LOG_WITH_ERRNO(logger_, "accept() failed on port " << recv_port);
+            }
+            if (errno != EINTR) {
+                break;
+            }
+            continue;
+        }
+
+        if (fcntl(socket_fd, F_SETFL, O_NONBLOCK) == -1) {
+            LOG_WITH_ERRNO(logger_, "Failed to set accepted TCP connection on port " << recv_port << " non-blocking");
+            close(socket_fd);
+            continue;
+        }
+
+        this->add_connection(socket_fd, recv_port, peer_addr);
+    }
+}
+
+//! Start receiving the next message on a connection.
+//!
+//! This method obtains the buffer locations for the next message on the connection from the
+//! frame decoder.
+//!
+//! \param[in,out] connection - receive state of the connection
+//! \return - bool indicating if the decoder provided somewhere to receive the message
+//!
+bool FrameReceiverTCPRxThread::start_message(TCPConnection& connection)
+{
+    frame_decoder_->select_connection(connection.socket_fd);
+    connection.iov_count = frame_decoder_->get_next_message_iov(connection.iov, max_message_iov);
+    connection.iov_index = 0;
+    connection.message_bytes = 0;
+
+    std::size_t message_size = 0;
+    for (std::size_t iov_idx = 0; iov_idx < connection.iov_count; iov_idx++) {
+        message_size += connection.iov[iov_idx].iov_len;
+    }
+    if (message_size == 0) {
+        connection.iov_count = 0;
+        return false;
+    }
+    return true;
+}
+
+//! Handle data received on a connection.
+//!
+//! This method is called by the reactor when a connection is readable. Data is received directly
+//! into the buffer locations of the message in progress on the connection with readv() until the
+//! socket has no more data, at which point any partly received message is resumed on the next
+//! call. Each completed message is passed to the frame decoder. The number of messages received
+//! in one call is limited so that busy connections do not starve the others.
+//!
+//! \param[in] socket_fd - socket file descriptor of the connection
+//!
+void FrameReceiverTCPRxThread::handle_receive_socket(int socket_fd)
+{
+    std::map<int, TCPConnectionPtr>::iterator conn_itr = connections_.find(socket_fd);
+    if (conn_itr == connections_.end()) {
         return;
     }
-    frame_decoder_->process_message(total_bytes_read);
+    TCPConnection& connection = *(conn_itr->second);
+
+    unsigned int messages = 0;
+    while (messages < max_messages_per_wakeup) {
+
+        if ((connection.iov_count == 0) && !this->start_message(connection)) {
+            LOG4CXX_ERROR(
+                logger_, "Frame decoder has no buffer for the next message on connection with " << connection.peer
+            );
+            this->close_connection(socket_fd);
+            return;
+        }
+
+        ssize_t bytes_read = readv(
+            socket_fd, &connection.iov[connection.iov_index], connection.iov_count - connection.iov_index
+        );
+
+        if (bytes_read < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+                LOG_WITH_ERRNO(logger_, "readv() failed on connection with " << connection.peer);
+                this->close_connection(socket_fd);
+            }
+            return;
+        }
+
+        if (bytes_read == 0) {
+            if (connection.message_bytes > 0) {
+                LOG4CXX_WARN(
+                    logger_, "Connection with " << connection.peer << " closed with " << connection.message_bytes
+                                                << " bytes of a message received"
+                );
+            } else {
+                LOG4CXX_INFO(logger_, "Connection with " << connection.peer << " closed");
+            }
+            this->close_connection(socket_fd);
+            return;
+        }
+
+        bytes_received_ += bytes_read;
+        connection.message_bytes += bytes_read;
+
+        // Advance through the buffer locations of the message by the number of bytes received
+        std::size_t remaining = bytes_read;
+        while ((connection.iov_index < connection.iov_count)
+               && (remaining >= connection.iov[connection.iov_index].iov_len)) {
+            remaining -= connection.iov[connection.iov_index].iov_len;
+            connection.iov_index++;
+        }
+        if (connection.iov_index < connection.iov_count) {
+            // The socket has been drained part way through the message, so resume when more data arrives
+            connection.iov[connection.iov_index].iov_base
+                = static_cast<char*>(connection.iov[connection.iov_index].iov_base) + remaining;
+            connection.iov[connection.iov_index].iov_len -= remaining;
+            return;
+        }
+
+        frame_decoder_->select_connection(socket_fd);
+        frame_decoder_->process_message(connection.message_bytes);
+        connection.iov_count = 0;
+        messages_received_++;
+        messages++;
+    }
+}
+
+//! Fill TCP RX thread specific status parameters into a message.
+//!
+//! This method adds the number of open connections, the number of connections made and closed and
+//! the number of messages and bytes received to the status message.
+//!
+//! \param[in,out] status_msg - IpcMessage to fill with status parameters
+//!
+void FrameReceiverTCPRxThread::fill_specific_status_params(IpcMessage& status_msg)
+{
+    status_msg.set_param("rx_thread/tcp/connections", (uint64_t)connections_.size());
+    status_msg.set_param("rx_thread/tcp/connections_accepted", connections_accepted_);
+    status_msg.set_param("rx_thread/tcp/connections_closed", connections_closed_);
+    status_msg.set_param("rx_thread/tcp/messages_received", messages_received_);
+    status_msg.set_param("rx_thread/tcp/bytes_received", bytes_received_);
 }
@@ -5,10 +5,20 @@
  *      Author: Tim Nicholls, STFC Application Engineering Group
  */
 
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <sstream>
+
 #include "FrameReceiverUDPRxThread.h"
 
+#ifdef BOOST_HAS_PLACEHOLDERS
+using namespace boost::placeholders;
+#endif
+
 using namespace FrameReceiver;
 
 FrameReceiverUDPRxThread::FrameReceiverUDPRxThread(
@@ -18,7 +28,12 @@ FrameReceiverUDPRxThread::FrameReceiverUDPRxThread(
     unsigned int tick_period_ms
 ) :
     FrameReceiverRxThread(config, buffer_manager, frame_decoder, tick_period_ms),
-    logger_(log4cxx::Logger::getLogger("FR.UDPRxThread"))
+    logger_(log4cxx::Logger::getLogger("FR.UDPRxThread")),
+    socket_stats_enabled_(false),
+    control_size_(0),
+    batch_size_(0),
+    run_workers_(false),
+    busy_poll_(false)
 {
     LOG4CXX_DEBUG_LEVEL(1, logger_, "FrameReceiverUDPRxThread constructor entered....");
 
@@ -35,76 +50,799 @@ void FrameReceiverUDPRxThread::run_specific_service(void)
 {
     LOG4CXX_DEBUG_LEVEL(1, logger_, "Running UDP RX thread service");
 
-    for (std::vector<uint16_t>::iterator rx_port_itr = config_.rx_ports_.begin();
-         rx_port_itr != config_.rx_ports_.end(); rx_port_itr++) {
+    // Start capturing received packets to a pcap file if configured. Failure to open the file is
+    // not fatal to the thread, since packet reception can proceed without the capture.
+    if (!config_.rx_pcap_file_.empty()) {
+        packet_tap_.reset(
+            new PacketCaptureTap(config_.rx_address_, config_.rx_pcap_snaplen_, config_.rx_pcap_buffer_size_)
+        );
+        if (packet_tap_->start(config_.rx_pcap_file_)) {
+            LOG4CXX_INFO(
+                logger_,
+                "Capturing up to " << packet_tap_->get_snaplen() << " bytes of each received packet to "
+                                   << config_.rx_pcap_file_
+            );
+        } else {
+            LOG_WITH_ERRNO(logger_, "Failed to open packet capture file " << config_.rx_pcap_file_);
+            packet_tap_.reset();
+        }
+    }
 
-        uint16_t rx_port = *rx_port_itr;
+    // Size the ancillary data buffers if kernel socket statistics are enabled
+    socket_stats_enabled_ = false;
+    control_size_ = 0;
+    socket_stats_.clear();
+#if defined(SO_RXQ_OVFL) && defined(SO_TIMESTAMPNS)
+    if (config_.rx_socket_stats_) {
+        socket_stats_enabled_ = true;
+        control_size_ = CMSG_SPACE(sizeof(uint32_t)) + CMSG_SPACE(sizeof(struct timespec));
+        control_buffer_.assign(control_size_, 0);
+    }
+#else
+    if (config_.rx_socket_stats_) {
+        LOG4CXX_WARN(logger_, "Kernel socket statistics not supported on this platform, ignoring");
+    }
+#endif
 
-        // Create the receive socket
-        int recv_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
-        if (recv_socket < 0) {
-            std::stringstream ss;
-            ss << "RX channel failed to create receive socket for port " << rx_port << " : " << strerror(errno);
-            this->set_thread_init_error(ss.str());
-            return;
+    // Determine the number of receive worker threads to run. If the ports are being divided
+    // between workers rather than shared in a SO_REUSEPORT group, there is no point running
+    // more workers than ports.
+    std::size_t num_workers = config_.rx_threads_;
+    if ((num_workers > 1) && !config_.rx_reuseport_ && (num_workers > config_.rx_ports_.size())) {
+        LOG4CXX_WARN(
+            logger_,
+            "Requested " << num_workers << " receive threads for " << config_.rx_ports_.size()
+                         << " ports, limiting to one thread per port"
+        );
+        num_workers = config_.rx_ports_.size();
+    }
+    if (num_workers < 1) {
+        num_workers = 1;
+    }
+
+    // Set up batched receive if configured and supported by the decoder, allocating a set of
+    // batch slots for each worker
+    this->init_batch_receive(num_workers);
+
+    // Use the receive loop specialised on the decoder type for single packet receive if it has one,
+    // passing each packet back for socket statistics and capture if either is enabled
+    packet_receiver_ = frame_decoder_->create_packet_receiver();
+    packet_received_callback_.clear();
+    if (socket_stats_enabled_ || packet_tap_) {
+        packet_received_callback_ = boost::bind(&FrameReceiverUDPRxThread::packet_received, this, _1, _2, _3);
+    }
+    if (packet_receiver_ && (batch_size_ == 0)) {
+        LOG4CXX_DEBUG_LEVEL(1, logger_, "UDP RX thread receiving with decoder specialised receive loop");
+    }
+
+    // Determine if the receiving threads busy-poll their sockets rather than sleeping in their reactor
+    busy_poll_ = config_.rx_busy_poll_;
+    busy_poll_stats_.reset();
+
+    // Parse the list of CPU cores to pin the receiving threads to
+    std::vector<int> cores;
+    std::stringstream cores_stream(config_.rx_thread_cores_);
+    std::string core_str;
+    while (std::getline(cores_stream, core_str, ',')) {
+        cores.push_back(static_cast<int>(strtol(core_str.c_str(), NULL, 0)));
+    }
+
+    // If only one worker is needed, receive directly in this thread, either busy-polling the sockets
+    // or in its reactor. This thread is then pinned to the first core listed.
+    if (num_workers == 1) {
+        this->configure_receive_thread("RX thread", cores.empty() ? -1 : cores[0]);
+
+        for (std::vector<uint16_t>::iterator rx_port_itr = config_.rx_ports_.begin();
+             rx_port_itr != config_.rx_ports_.end(); rx_port_itr++) {
+
+            uint16_t rx_port = *rx_port_itr;
+
+            int recv_socket = this->create_receive_socket(rx_port, false);
+            if (recv_socket < 0) {
+                return;
+            }
+            if (busy_poll_) {
+                busy_poll_sockets_.push_back(std::make_pair(recv_socket, rx_port));
+            } else {
+                this->register_receive_socket(reactor_, recv_socket, rx_port, 0);
+            }
+        }
+        if (busy_poll_) {
+            LOG4CXX_INFO(logger_, "UDP RX thread busy-polling " << busy_poll_sockets_.size() << " receive sockets");
+        }
+        return;
+    }
+
+    // Otherwise create the receive workers, either sharing every port in SO_REUSEPORT groups or
+    // dividing the ports between them, and start them
+    for (std::size_t worker_idx = 0; worker_idx < num_workers; worker_idx++) {
+        workers_.push_back(RxWorkerPtr(new RxWorker(worker_idx, worker_idx * batch_size_, reactor_.get_backend())));
+        workers_.back()->ready_batch.configure(config_.frame_notify_batch_, config_.frame_notify_batch_ms_);
+    }
+
+    for (std::size_t worker_idx = 0; (worker_idx < cores.size()) && (worker_idx < num_workers); worker_idx++) {
+        workers_[worker_idx]->core = cores[worker_idx];
+    }
+
+    for (std::size_t port_idx = 0; port_idx < config_.rx_ports_.size(); port_idx++) {
+
+        uint16_t rx_port = config_.rx_ports_[port_idx];
+
+        for (std::size_t worker_idx = 0; worker_idx < num_workers; worker_idx++) {
+            if (!config_.rx_reuseport_ && ((port_idx % num_workers) != worker_idx)) {
+                continue;
+            }
+
+            int recv_socket = this->create_receive_socket(rx_port, config_.rx_reuseport_);
+            if (recv_socket < 0) {
+                this->stop_workers();
+                return;
+            }
+            workers_[worker_idx]->sockets.push_back(std::make_pair(recv_socket, rx_port));
         }
+    }
+
+    if (!this->start_workers()) {
+        this->stop_workers();
+    }
+}
+
+void FrameReceiverUDPRxThread::cleanup_specific_service(void)
+{
+    this->stop_workers();
+
+    // Close any sockets busy-polled by the RX thread, since they are not registered with its reactor
+    for (std::size_t sock_idx = 0; sock_idx < busy_poll_sockets_.size(); sock_idx++) {
+        close(busy_poll_sockets_[sock_idx].first);
+    }
+    busy_poll_sockets_.clear();
+
+    // Stop any packet capture, writing out packets remaining in the capture ring
+    if (packet_tap_) {
+        LOG4CXX_INFO(
+            logger_,
+            "Packet capture stopped: " << packet_tap_->get_packets_written() << " packets written, "
+                                       << packet_tap_->get_packets_dropped() << " dropped"
+        );
+        packet_tap_.reset();
+    }
+}
 
-        // Set the socket receive buffer size
-        if (setsockopt(
-                recv_socket, SOL_SOCKET, SO_RCVBUF, &config_.rx_recv_buffer_size_, sizeof(config_.rx_recv_buffer_size_)
-            )
-            < 0) {
+//! Create a receive socket.
+//!
+//! This method creates a UDP receive socket, sets its receive buffer size and binds it to the
+//! specified port on the configured receive address. If requested, the socket is bound as a member
+//! of a SO_REUSEPORT group, allowing multiple sockets to receive on the same port with the kernel
+//! distributing packet flows between them. Kernel socket statistics are enabled if configured.
+//! Any error is signalled as a thread initialisation error.
+//!
+//! \param[in] rx_port - port number to bind the socket to
+//! \param[in] reuse_port - bind the socket as a member of a SO_REUSEPORT group
+//! \return - file descriptor of the socket, or -1 if an error occurred
+//!
+int FrameReceiverUDPRxThread::create_receive_socket(uint16_t rx_port, bool reuse_port)
+{
+    // Create the receive socket
+    int recv_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (recv_socket < 0) {
+        std::stringstream ss;
+        ss << "RX channel failed to create receive socket for port " << rx_port << " : " << strerror(errno);
+        this->set_thread_init_error(ss.str());
+        return -1;
+    }
+
+    // Set the socket receive buffer size
+    if (setsockopt(
+            recv_socket, SOL_SOCKET, SO_RCVBUF, &config_.rx_recv_buffer_size_, sizeof(config_.rx_recv_buffer_size_)
+        )
+        < 0) {
+        std::stringstream ss;
+        ss << "RX channel failed to set receive socket buffer size for port " << rx_port << " : " << strerror(errno);
+        this->set_thread_init_error(ss.str());
+        close(recv_socket);
+        return -1;
+    }
+
+    // Read it back and display
+    int buffer_size;
+    socklen_t len = sizeof(buffer_size);
+    getsockopt(recv_socket, SOL_SOCKET, SO_RCVBUF, &buffer_size, &len);
+    LOG4CXX_DEBUG_LEVEL(1, logger_, "RX thread receive buffer size for port " << rx_port << " is " << buffer_size / 2);
+
+    // Allow multiple sockets to bind to the same port if requested
+    if (reuse_port) {
+        int enable = 1;
+        if (setsockopt(recv_socket, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) < 0) {
             std::stringstream ss;
-            ss << "RX channel failed to set receive socket buffer size for port " << rx_port << " : "
+            ss << "RX channel failed to set SO_REUSEPORT on receive socket for port " << rx_port << " : "
                << strerror(errno);
             this->set_thread_init_error(ss.str());
-            return;
+            close(recv_socket);
+            return -1;
+        }
+    }
+
+    // Bind the socket to the specified port
+    struct sockaddr_in recv_addr;
+    memset(&recv_addr, 0, sizeof(recv_addr));
+
+    recv_addr.sin_family = AF_INET;
+    recv_addr.sin_port = htons(rx_port);
+    recv_addr.sin_addr.s_addr = inet_addr(config_.rx_address_.c_str());
+
+    if (recv_addr.sin_addr.s_addr == INADDR_NONE) {
+        std::stringstream ss;
+        ss << "Illegal receive address specified: " << config_.rx_address_;
+        this->set_thread_init_error(ss.str());
+        close(recv_socket);
+        return -1;
+    }
+
+    if (bind(recv_socket, (struct sockaddr*)&recv_addr, sizeof(recv_addr)) == -1) {
+        std::stringstream ss;
+        ss << "RX channel failed to bind receive socket for address " << config_.rx_address_ << " port " << rx_port
+           << " : " << strerror(errno);
+        this->set_thread_init_error(ss.str());
+        close(recv_socket);
+        return -1;
+    }
+
+    // Enable kernel drop counter and receive timestamps on the socket if requested
+    if (socket_stats_enabled_ && !this->enable_socket_stats(recv_socket, rx_port)) {
+        close(recv_socket);
+        return -1;
+    }
+
+    // If busy-polling, set the time for which the kernel busy-polls the device queue on receive.
+    // Raising this above the system default requires CAP_NET_ADMIN, so failure is not fatal.
+    if (busy_poll_ && (config_.rx_busy_poll_us_ > 0)) {
+#ifdef SO_BUSY_POLL
+        int busy_poll_us = static_cast<int>(config_.rx_busy_poll_us_);
+        if (setsockopt(recv_socket, SOL_SOCKET, SO_BUSY_POLL, &busy_poll_us, sizeof(busy_poll_us)) < 0) {
+            LOG4CXX_WARN(
+                logger_, "Failed to set SO_BUSY_POLL to " << busy_poll_us << "us on receive socket for port " << rx_port
+                                                          << ": " << strerror(errno)
+            );
         }
+#else
+        LOG4CXX_WARN(logger_, "SO_BUSY_POLL not supported on this platform, ignoring");
+#endif
+    }
+
+    return recv_socket;
+}
 
-        // Read it back and display
-        int buffer_size;
-        socklen_t len = sizeof(buffer_size);
-        getsockopt(recv_socket, SOL_SOCKET, SO_RCVBUF, &buffer_size, &len);
-        LOG4CXX_DEBUG_LEVEL(
-            1, logger_, "RX thread receive buffer size for port " << rx_port << " is " << buffer_size / 2
+//! Register a receive socket with a reactor.
+//!
+//! This method registers a receive socket with the specified reactor, using the batched receive
+//! handler if batching is enabled. Sockets registered with the RX thread reactor are tracked by
+//! the base class so they are closed when the thread terminates.
+//!
+//! \param[in] reactor - reactor to register the socket with
+//! \param[in] recv_socket - file descriptor of the receive socket
+//! \param[in] rx_port - port number the socket is bound to
+//! \param[in] first_slot - first batch receive slot to use for packets on this socket
+//!
+void FrameReceiverUDPRxThread::register_receive_socket(
+    IpcReactor& reactor, int recv_socket, uint16_t rx_port, std::size_t first_slot
+)
+{
+    ReactorCallback callback;
+    if (batch_size_ > 0) {
+        callback = boost::bind(
+            &FrameReceiverUDPRxThread::handle_receive_socket_batch, this, recv_socket, (int)rx_port, first_slot
         );
+    } else {
+        callback = boost::bind(&FrameReceiverUDPRxThread::handle_receive_socket, this, recv_socket, (int)rx_port);
+    }
 
-        // Bind the socket to the specified port
-        struct sockaddr_in recv_addr;
-        memset(&recv_addr, 0, sizeof(recv_addr));
+    if (&reactor == &reactor_) {
+        this->register_socket(recv_socket, callback);
+    } else {
+        reactor.register_socket(recv_socket, callback);
+    }
+}
 
-        recv_addr.sin_family = AF_INET;
-        recv_addr.sin_port = htons(rx_port);
-        recv_addr.sin_addr.s_addr = inet_addr(config_.rx_address_.c_str());
+//! Configure the scheduling of a receiving thread.
+//!
+//! This method, called on the receiving thread itself, pins the thread to a CPU core if one is
+//! specified and, if a priority is configured, switches it to the SCHED_FIFO real-time scheduling
+//! policy at that priority. Since this requires privileges, failures are logged as warnings and
+//! the thread continues with its existing scheduling. A busy-polling thread never yields the CPU,
+//! so at real-time priority it should be pinned to a core isolated from other work.
+//!
+//! \param[in] thread_name - name of the thread used in log messages
+//! \param[in] core - CPU core to pin the thread to, or -1 to leave it unpinned
+//!
+void FrameReceiverUDPRxThread::configure_receive_thread(const std::string& thread_name, int core)
+{
+#ifdef __linux__
+    if (core >= 0) {
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET(core, &cpu_set);
+        int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+        if (rc != 0) {
+            LOG4CXX_WARN(logger_, "Failed to pin " << thread_name << " to core " << core << ": " << strerror(rc));
+        } else {
+            LOG4CXX_DEBUG_LEVEL(1, logger_, thread_name << " pinned to core " << core);
+        }
+    }
+#endif
 
-        if (recv_addr.sin_addr.s_addr == INADDR_NONE) {
-            std::stringstream ss;
-            ss << "Illegal receive address specified: " << config_.rx_address_;
-            this->set_thread_init_error(ss.str());
-            return;
+    if (config_.rx_thread_priority_ > 0) {
+        struct sched_param sched_param;
+        memset(&sched_param, 0, sizeof(sched_param));
+        sched_param.sched_priority = config_.rx_thread_priority_;
+        int rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &sched_param);
+        if (rc != 0) {
+            LOG4CXX_WARN(
+                logger_, "Failed to set SCHED_FIFO priority " << config_.rx_thread_priority_ << " for " << thread_name
+                                                              << ": " << strerror(rc)
+            );
+        } else {
+            LOG4CXX_DEBUG_LEVEL(
+                1, logger_, thread_name << " scheduled SCHED_FIFO at priority " << config_.rx_thread_priority_
+            );
         }
+    }
+}
 
-        if (bind(recv_socket, (struct sockaddr*)&recv_addr, sizeof(recv_addr)) == -1) {
+//! Start the receive worker threads.
+//!
+//! This method starts a thread for each configured receive worker. Workers share the frame
+//! decoder, with all calls into it serialised by the decoder mutex, so that frames whose packets
+//! arrive on sockets serviced by different workers are still assembled correctly.
+//!
+//! \return - bool indicating if all workers started successfully
+//!
+bool FrameReceiverUDPRxThread::start_workers(void)
+{
+    run_workers_ = true;
+
+    for (std::vector<RxWorkerPtr>::iterator worker_itr = workers_.begin(); worker_itr != workers_.end();
+         ++worker_itr) {
+        RxWorker* worker = worker_itr->get();
+        try {
+            worker->channel.connect(config_.rx_channel_endpoint_);
+        } catch (zmq::error_t& e) {
             std::stringstream ss;
-            ss << "RX channel failed to bind receive socket for address " << config_.rx_address_ << " port " << rx_port
-               << " : " << strerror(errno);
+            ss << "RX worker " << worker->index << " channel connect to endpoint " << config_.rx_channel_endpoint_
+               << " failed: " << e.what();
             this->set_thread_init_error(ss.str());
-            return;
+            return false;
         }
+        worker->thread = boost::shared_ptr<boost::thread>(
+            new boost::thread(boost::bind(&FrameReceiverUDPRxThread::run_worker, this, worker))
+        );
+    }
+
+    LOG4CXX_INFO(logger_, "Started " << workers_.size() << " UDP receive worker threads");
+    return true;
+}
+
+//! Stop the receive worker threads.
+//!
+//! This method signals the receive worker threads to stop, waits for them to join and then
+//! closes their receive sockets and channels.
+//!
+void FrameReceiverUDPRxThread::stop_workers(void)
+{
+    run_workers_ = false;
+
+    for (std::vector<RxWorkerPtr>::iterator worker_itr = workers_.begin(); worker_itr != workers_.end();
+         ++worker_itr) {
+        RxWorker* worker = worker_itr->get();
+        if (worker->thread) {
+            worker->thread->join();
+        }
+        for (std::size_t sock_idx = 0; sock_idx < worker->sockets.size(); sock_idx++) {
+            close(worker->sockets[sock_idx].first);
+        }
+        worker->channel.close();
+    }
+    workers_.clear();
+}
+
+//! Thread-local pointer to the channel of the receive worker running on the calling thread
+static thread_local IpcChannel* worker_channel = NULL;
+static thread_local FrameNotifyBatch* worker_ready_batch = NULL;
+
+//! Run a receive worker thread.
+//!
+//! This method is the entry point for a receive worker thread. The thread is pinned to its
+//! configured CPU core, if any, and scheduled at the configured priority. Its receive sockets are
+//! then either busy-polled or registered with its own reactor, and the busy-poll loop or reactor
+//! event loop is run until the worker is signalled to stop.
+//!
+//! \param[in] worker - pointer to the worker to run
+//!
+void FrameReceiverUDPRxThread::run_worker(RxWorker* worker)
+{
+    OdinData::configure_logging_mdc(OdinData::app_path.c_str());
+
+    std::stringstream thread_name;
+    thread_name << "RX worker " << worker->index;
+    this->configure_receive_thread(thread_name.str(), worker->core);
 
-        // Register this socket
-        this->register_socket(
-            recv_socket, boost::bind(&FrameReceiverUDPRxThread::handle_receive_socket, this, recv_socket, (int)rx_port)
+    // Frame ready notifications raised by the decoder on this thread are sent on the worker channel
+    worker_channel = &(worker->channel);
+    worker_ready_batch = &(worker->ready_batch);
+
+    if (!busy_poll_) {
+        for (std::size_t sock_idx = 0; sock_idx < worker->sockets.size(); sock_idx++) {
+            this->register_receive_socket(
+                worker->reactor, worker->sockets[sock_idx].first, worker->sockets[sock_idx].second, worker->first_slot
+            );
+        }
+    }
+    int tick_timer_id = worker->reactor.register_timer(
+        worker_tick_period_ms, 0, boost::bind(&FrameReceiverUDPRxThread::worker_tick_timer, this, worker)
+    );
+    int flush_timer_id = -1;
+    if (worker->ready_batch.enabled()) {
+        flush_timer_id = worker->reactor.register_timer(
+            std::max(worker->ready_batch.get_max_latency_ms(), 1U), 0,
+            boost::bind(&FrameReceiverUDPRxThread::worker_flush_timer, this, worker)
         );
     }
+
+    LOG4CXX_DEBUG_LEVEL(
+        1, logger_, "RX worker " << worker->index << " receiving on " << worker->sockets.size() << " sockets"
+    );
+
+    if (busy_poll_) {
+        this->run_busy_poll(worker->reactor, worker->sockets, worker->first_slot, worker->busy_poll_stats);
+    } else {
+        worker->reactor.run();
+    }
+
+    worker->reactor.remove_timer(tick_timer_id);
+    if (flush_timer_id != -1) {
+        worker->reactor.remove_timer(flush_timer_id);
+    }
+    for (std::size_t sock_idx = 0; sock_idx < worker->sockets.size(); sock_idx++) {
+        worker->reactor.remove_socket(worker->sockets[sock_idx].first);
+    }
+    this->flush_frame_ready_batch();
+    worker_channel = NULL;
+    worker_ready_batch = NULL;
 }
 
-void FrameReceiverUDPRxThread::cleanup_specific_service(void)
+//! Tick timer handler for a receive worker thread.
+//!
+//! This method detects requests to stop the receive workers and stops the worker reactor.
+//!
+//! \param[in] worker - pointer to the worker the timer belongs to
+//!
+void FrameReceiverUDPRxThread::worker_tick_timer(RxWorker* worker)
+{
+    if (!run_workers_) {
+        worker->reactor.stop();
+    }
+}
+
+//! Flush timer handler for a receive worker thread.
+//!
+//! This method sends any partial batch of frame ready notifications from the worker, so that
+//! notifications are not held beyond the batch latency bound when frames stop arriving.
+//!
+//! \param[in] worker - pointer to the worker the timer belongs to
+//!
+void FrameReceiverUDPRxThread::worker_flush_timer(RxWorker* worker)
+{
+    this->flush_frame_ready_batch();
+}
+
+//! Get the channel on which to send frame ready notifications.
+//!
+//! Frames completed by the decoder while called from a receive worker thread are notified on that
+//! worker's own channel to the main thread, since channels cannot be shared between threads.
+//!
+//! \return - reference to the channel to send frame ready notifications on
+//!
+IpcChannel& FrameReceiverUDPRxThread::get_frame_ready_channel(void)
+{
+    if (worker_channel) {
+        return *worker_channel;
+    }
+    return FrameReceiverRxThread::get_frame_ready_channel();
+}
+
+//! Get the batch in which to accumulate frame ready notifications.
+//!
+//! Frames completed by the decoder while called from a receive worker thread are batched in that
+//! worker's own batch, which is sent on the worker channel.
+//!
+//! \return - reference to the batch to add frame ready notifications to
+//!
+FrameNotifyBatch& FrameReceiverUDPRxThread::get_frame_ready_batch(void)
+{
+    if (worker_ready_batch) {
+        return *worker_ready_batch;
+    }
+    return FrameReceiverRxThread::get_frame_ready_batch();
+}
+
+//! Run the UDP RX thread event loop.
+//!
+//! If the RX thread receives packets itself and busy-polling is enabled, this method runs the
+//! busy-poll loop on the receive sockets in place of the reactor event loop. Otherwise the reactor
+//! is run as normal, including when the sockets are busy-polled by receive worker threads.
+//!
+void FrameReceiverUDPRxThread::run_event_loop(void)
+{
+    if (busy_poll_ && workers_.empty()) {
+        this->run_busy_poll(reactor_, busy_poll_sockets_, 0, busy_poll_stats_);
+    } else {
+        FrameReceiverRxThread::run_event_loop();
+    }
+}
+
+//! Return the current monotonic clock time in nanoseconds, used to time busy-poll loop iterations
+static inline uint64_t busy_poll_clock_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000UL + now.tv_nsec;
+}
+
+//! Run a busy-poll receive loop.
+//!
+//! This method receives on a set of sockets with non-blocking calls in a tight loop, rather than
+//! sleeping in a reactor until a socket is readable, removing the wakeup latency and jitter of
+//! the poll. The reactor is serviced without blocking every busy_poll_service_ns, handling its
+//! channels and timers, and the loop runs until a timer callback stops the reactor. Each loop
+//! iteration is timed and counted as receiving if any packets were received or idle otherwise.
+//! Receive workers share the frame decoder under a mutex, so a worker first checks which of its
+//! sockets are readable with a single zero-timeout poll, so that empty iterations do not contend
+//! for the decoder with other workers.
+//!
+//! \param[in] reactor - reactor to service from the loop
+//! \param[in] sockets - receive sockets to poll and their ports
+//! \param[in] first_slot - first batch receive slot to use for packets on the sockets
+//! \param[in,out] stats - busy-poll statistics to update
+//!
+void FrameReceiverUDPRxThread::run_busy_poll(
+    IpcReactor& reactor,
+    const std::vector<std::pair<int, uint16_t> >& sockets,
+    std::size_t first_slot,
+    BusyPollStats& stats
+)
+{
+    bool check_ready = !workers_.empty() && !sockets.empty();
+    std::vector<struct pollfd> poll_fds(sockets.size());
+    for (std::size_t sock_idx = 0; sock_idx < sockets.size(); sock_idx++) {
+        poll_fds[sock_idx].fd = sockets[sock_idx].first;
+        poll_fds[sock_idx].events = POLLIN;
+        poll_fds[sock_idx].revents = POLLIN;
+    }
+
+    uint64_t last_ns = busy_poll_clock_ns();
+    uint64_t next_service_ns = last_ns;
+    bool running = true;
+
+    while (running) {
+        std::size_t packets_received = 0;
+        bool sockets_ready = !check_ready || (::poll(&poll_fds[0], poll_fds.size(), 0) > 0);
+        for (std::size_t sock_idx = 0; sockets_ready && (sock_idx < sockets.size()); sock_idx++) {
+            if (!(poll_fds[sock_idx].revents & POLLIN)) {
+                continue;
+            }
+            if (batch_size_ > 0) {
+                packets_received += this->handle_receive_socket_batch(
+                    sockets[sock_idx].first, sockets[sock_idx].second, first_slot
+                );
+            } else {
+                packets_received += this->handle_receive_socket(sockets[sock_idx].first, sockets[sock_idx].second);
+            }
+        }
+
+        uint64_t now_ns = busy_poll_clock_ns();
+        BusyPollStats::add(stats.iterations, 1);
+        if (packets_received > 0) {
+            BusyPollStats::add(stats.receive_ns, now_ns - last_ns);
+        } else {
+            BusyPollStats::add(stats.empty_polls, 1);
+            BusyPollStats::add(stats.idle_ns, now_ns - last_ns);
+        }
+        last_ns = now_ns;
+
+        if (now_ns >= next_service_ns) {
+            running = reactor.service();
+            last_ns = busy_poll_clock_ns();
+            BusyPollStats::add(stats.service_ns, last_ns - now_ns);
+            next_service_ns = last_ns + busy_poll_service_ns;
+        }
+    }
+}
+
+//! Fill UDP RX thread specific status parameters into a message.
+//!
+//! If busy-polling is enabled, this method adds the number of busy-poll loop iterations, the
+//! number in which no packets were received and the time in seconds spent receiving, idle and
+//! servicing the reactor, totalled over the receiving threads. If packet capture is enabled, this
+//! method adds the numbers of packets captured, dropped because the capture ring was full and
+//! written to the capture file. If kernel socket statistics are
+//! enabled, this method adds the total number of packets dropped by the kernel and, for each
+//! receive port, the packet and drop counts, the maximum socket-to-decoder latency and histograms
+//! of packet inter-arrival time and latency. Histogram bins are logarithmic, with lower edges in
+//! microseconds reported alongside.
+//!
+//! \param[in,out] status_msg - IpcMessage to fill with status parameters
+//!
+void FrameReceiverUDPRxThread::fill_specific_status_params(IpcMessage& status_msg)
+{
+    if (busy_poll_) {
+        // Worker statistics are updated concurrently by the worker threads, so each counter is read
+        // atomically. The totals are therefore not a consistent snapshot across counters.
+        uint64_t iterations = 0;
+        uint64_t empty_polls = 0;
+        uint64_t receive_ns = 0;
+        uint64_t idle_ns = 0;
+        uint64_t service_ns = 0;
+        std::vector<const BusyPollStats*> all_stats(1, &busy_poll_stats_);
+        for (std::vector<RxWorkerPtr>::iterator worker_itr = workers_.begin(); worker_itr != workers_.end();
+             ++worker_itr) {
+            all_stats.push_back(&(*worker_itr)->busy_poll_stats);
+        }
+        for (std::size_t stats_idx = 0; stats_idx < all_stats.size(); stats_idx++) {
+            const BusyPollStats& stats = *all_stats[stats_idx];
+            iterations += stats.iterations.load(std::memory_order_relaxed);
+            empty_polls += stats.empty_polls.load(std::memory_order_relaxed);
+            receive_ns += stats.receive_ns.load(std::memory_order_relaxed);
+            idle_ns += stats.idle_ns.load(std::memory_order_relaxed);
+            service_ns += stats.service_ns.load(std::memory_order_relaxed);
+        }
+        status_msg.set_param("rx_thread/busy_poll/iterations", iterations);
+        status_msg.set_param("rx_thread/busy_poll/empty_polls", empty_polls);
+        status_msg.set_param("rx_thread/busy_poll/receive_time", (double)receive_ns / 1.0e9);
+        status_msg.set_param("rx_thread/busy_poll/idle_time", (double)idle_ns / 1.0e9);
+        status_msg.set_param("rx_thread/busy_poll/service_time", (double)service_ns / 1.0e9);
+    }
+
+    if (packet_tap_) {
+        status_msg.set_param("rx_thread/pcap/captured", packet_tap_->get_packets_captured());
+        status_msg.set_param("rx_thread/pcap/dropped", packet_tap_->get_packets_dropped());
+        status_msg.set_param("rx_thread/pcap/written", packet_tap_->get_packets_written());
+        status_msg.set_param("rx_thread/pcap/bytes_written", packet_tap_->get_bytes_written());
+        status_msg.set_param("rx_thread/pcap/write_errors", packet_tap_->get_write_errors());
+    }
+
+    if (!socket_stats_enabled_) {
+        return;
+    }
+
+    uint64_t total_kernel_drops = 0;
+
+    status_msg.set_param("rx_thread/socket_stats/hist_bin_lower_us[]", 0);
+    for (std::size_t bin = 1; bin < num_hist_bins; bin++) {
+        status_msg.set_param("rx_thread/socket_stats/hist_bin_lower_us[]", 1 << (bin - 1));
+    }
+
+    for (std::map<int, SocketStats>::iterator stats_itr = socket_stats_.begin(); stats_itr != socket_stats_.end();
+         ++stats_itr) {
+        const SocketStats& stats = stats_itr->second;
+        std::stringstream port_path;
+        port_path << "rx_thread/socket_stats/" << stats_itr->first << "/";
+
+        status_msg.set_param(port_path.str() + "packets", stats.packets);
+        status_msg.set_param(port_path.str() + "kernel_drops", stats.kernel_drops);
+        status_msg.set_param(port_path.str() + "max_latency_us", (double)stats.max_latency_ns / 1000.0);
+        for (std::size_t bin = 0; bin < num_hist_bins; bin++) {
+            status_msg.set_param(port_path.str() + "inter_arrival_hist[]", stats.inter_arrival_hist[bin]);
+            status_msg.set_param(port_path.str() + "latency_hist[]", stats.latency_hist[bin]);
+        }
+        total_kernel_drops += stats.kernel_drops;
+    }
+
+    status_msg.set_param("rx_thread/kernel_drops", total_kernel_drops);
+}
+
+//! Enable kernel socket statistics on a receive socket.
+//!
+//! This method enables the SO_RXQ_OVFL and SO_TIMESTAMPNS socket options so that the kernel
+//! attaches its cumulative socket drop counter and a nanosecond receive timestamp to each packet
+//! as ancillary data.
+//!
+//! \param[in] recv_socket - file descriptor of the receive socket
+//! \param[in] rx_port - port number the socket is bound to
+//! \return - bool indicating if the socket options were set successfully
+//!
+bool FrameReceiverUDPRxThread::enable_socket_stats(int recv_socket, uint16_t rx_port)
 {
+#if defined(SO_RXQ_OVFL) && defined(SO_TIMESTAMPNS)
+    int enable = 1;
+    if ((setsockopt(recv_socket, SOL_SOCKET, SO_RXQ_OVFL, &enable, sizeof(enable)) < 0)
+        || (setsockopt(recv_socket, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable)) < 0)) {
+        std::stringstream ss;
+        ss << "RX channel failed to enable socket statistics for port " << rx_port << " : " << strerror(errno);
+        this->set_thread_init_error(ss.str());
+        return false;
+    }
+    socket_stats_[rx_port] = SocketStats();
+#endif
+    return true;
 }
 
-void FrameReceiverUDPRxThread::handle_receive_socket(int recv_socket, int recv_port)
+//! Initialise batched packet receive.
+//!
+//! This method sets up the message header, iovec and address arrays used to receive multiple
+//! packets per system call with recvmmsg. Batched receive is only enabled if the configured batch
+//! size is greater than one and the frame decoder supports it, otherwise the thread falls back to
+//! receiving a single packet per call. A separate set of batch slots is allocated for each
+//! receive worker thread.
+//!
+//! \param[in] num_slot_sets - number of sets of batch slots to allocate
+//!
+void FrameReceiverUDPRxThread::init_batch_receive(std::size_t num_slot_sets)
 {
+    batch_size_ = 0;
+
+    if (config_.rx_batch_size_ <= 1) {
+        return;
+    }
+
+#ifdef __linux__
+    if (!frame_decoder_->supports_batch_receive()) {
+        LOG4CXX_WARN(
+            logger_, "Frame decoder does not support batched receive, ignoring batch size " << config_.rx_batch_size_
+        );
+        return;
+    }
+
+    batch_size_ = config_.rx_batch_size_;
+
+    std::size_t num_slots = batch_size_ * num_slot_sets;
+    batch_msgs_.assign(num_slots, mmsghdr());
+    batch_iovecs_.assign(num_slots * FrameDecoderUDP::max_batch_iovecs, iovec());
+    batch_addrs_.assign(num_slots, sockaddr_in());
+    batch_bytes_.assign(num_slots, 0);
+    batch_control_.assign(num_slots * control_size_, 0);
+
+    // Payloads can only be received directly into predicted frame buffer locations by a single
+    // thread, since workers receive in parallel with other workers processing their packets
+    frame_decoder_->init_batch_receive(num_slots, (num_slot_sets == 1));
+
+    LOG4CXX_DEBUG_LEVEL(1, logger_, "UDP RX thread receiving up to " << batch_size_ << " packets per call");
+#else
+    LOG4CXX_WARN(logger_, "Batched receive not supported on this platform, ignoring batch size");
+#endif
+}
+
+//! Handle a packet on a receive socket.
+//!
+//! This method receives a single packet from a receive socket into the buffers specified by the
+//! frame decoder, first peeking at the packet header if the decoder requires it, and passes the
+//! packet to the decoder for processing. The receive does not block, so that the method can be
+//! called from a busy-poll loop whether or not a packet is queued on the socket. If the decoder
+//! provides a receive loop specialised on its type, that is used instead to receive up to
+//! max_receive_loop_packets packets queued on the socket, avoiding virtual calls into the decoder
+//! for each packet.
+//!
+//! \param[in] recv_socket - file descriptor of the receive socket
+//! \param[in] recv_port - port number the socket is bound to
+//! \return - number of packets received
+//!
+std::size_t FrameReceiverUDPRxThread::handle_receive_socket(int recv_socket, int recv_port)
+{
+    // If running receive workers, hold the decoder for the whole packet since it is received
+    // directly into the buffers specified by the decoder
+    boost::unique_lock<boost::mutex> decoder_lock(decoder_mutex_, boost::defer_lock);
+    if (!workers_.empty()) {
+        decoder_lock.lock();
+    }
+
+    if (packet_receiver_) {
+        std::size_t packets_received = packet_receiver_->receive(
+            recv_socket, recv_port, max_receive_loop_packets, socket_stats_enabled_ ? &control_buffer_[0] : NULL,
+            control_size_, packet_received_callback_
+        );
+        if ((packets_received < max_receive_loop_packets) && (errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+            LOG_WITH_ERRNO(logger_, "RX thread receive failed on port " << recv_port);
+        }
+        return packets_received;
+    }
 
     struct iovec io_vec[2];
     uint8_t iovec_entry = 0;
@@ -115,8 +853,16 @@ void FrameReceiverUDPRxThread::handle_receive_socket(int recv_socket, int recv_p
         size_t header_size = frame_decoder_->get_packet_header_size();
         void* header_buffer = frame_decoder_->get_packet_header_buffer();
         socklen_t from_len = sizeof(from_addr);
-        size_t bytes_received
-            = recvfrom(recv_socket, header_buffer, header_size, MSG_PEEK, (struct sockaddr*)&from_addr, &from_len);
+        ssize_t bytes_peeked = recvfrom(
+            recv_socket, header_buffer, header_size, MSG_PEEK | MSG_DONTWAIT, (struct sockaddr*)&from_addr, &from_len
+        );
+        if (bytes_peeked < 0) {
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+                LOG_WITH_ERRNO(logger_, "RX thread header receive failed on port " << recv_port);
+            }
+            return 0;
+        }
+        size_t bytes_received = bytes_peeked;
         LOG4CXX_DEBUG_LEVEL(3, logger_, "RX thread received " << bytes_received << " header bytes on recv socket");
         frame_decoder_->process_packet_header(bytes_received, recv_port, &from_addr);
 
@@ -135,8 +881,19 @@ void FrameReceiverUDPRxThread::handle_receive_socket(int recv_socket, int recv_p
     msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
     msg_hdr.msg_iov = io_vec;
     msg_hdr.msg_iovlen = iovec_entry;
+    if (socket_stats_enabled_) {
+        msg_hdr.msg_control = &control_buffer_[0];
+        msg_hdr.msg_controllen = control_size_;
+    }
 
-    size_t bytes_received = recvmsg(recv_socket, &msg_hdr, 0);
+    ssize_t recv_rc = recvmsg(recv_socket, &msg_hdr, MSG_DONTWAIT);
+    if (recv_rc < 0) {
+        if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+            LOG_WITH_ERRNO(logger_, "RX thread receive failed on port " << recv_port);
+        }
+        return 0;
+    }
+    size_t bytes_received = recv_rc;
     LOG4CXX_DEBUG_LEVEL(
         3, logger_,
         "RX thread received " << bytes_received
@@ -145,6 +902,277 @@ void FrameReceiverUDPRxThread::handle_receive_socket(int recv_socket, int recv_p
                               << frame_decoder_->get_next_payload_buffer()
     );
 
+    this->packet_received(msg_hdr, bytes_received, recv_port);
+
     FrameDecoder::FrameReceiveState frame_receive_state
         = frame_decoder_->process_packet(bytes_received, recv_port, &from_addr);
+
+    return 1;
+}
+
+//! Record a packet received on a receive socket.
+//!
+//! This method updates the socket statistics and captures a packet received with a single
+//! packet receive, if either is enabled. It is called before the packet is processed by the
+//! decoder, since processing may release the buffer the packet was received into.
+//!
+//! \param[in] msg_hdr - message header the packet was received with
+//! \param[in] bytes_received - number of bytes received
+//! \param[in] recv_port - port number the packet was received on
+//!
+void FrameReceiverUDPRxThread::packet_received(const struct msghdr& msg_hdr, std::size_t bytes_received, int recv_port)
+{
+    if (socket_stats_enabled_) {
+        struct timespec recv_time;
+        clock_gettime(CLOCK_REALTIME, &recv_time);
+        socket_stats_[recv_port].update(msg_hdr, recv_time);
+    }
+
+    if (packet_tap_ && (bytes_received > 0)) {
+        packet_tap_->capture(
+            msg_hdr.msg_iov, msg_hdr.msg_iovlen, bytes_received, static_cast<struct sockaddr_in*>(msg_hdr.msg_name),
+            recv_port
+        );
+    }
+}
+
+//! Handle a batch of packets on a receive socket.
+//!
+//! This method is the batched equivalent of handle_receive_socket. The frame decoder is queried
+//! for the receive buffers of each packet slot in the batch, up to the configured batch size of
+//! packets currently queued on the socket are received with a single recvmmsg call, and the whole
+//! batch is then passed to the decoder for processing. When running receive workers, the
+//! recvmmsg call is made without holding the decoder, allowing workers to receive in parallel.
+//!
+//! \param[in] recv_socket - file descriptor of the receive socket
+//! \param[in] recv_port - port number the socket is bound to
+//! \param[in] first_slot - first batch slot to receive packets into
+//! \return - number of packets received
+//!
+std::size_t FrameReceiverUDPRxThread::handle_receive_socket_batch(
+    int recv_socket,
+    int recv_port,
+    std::size_t first_slot
+)
+{
+#ifdef __linux__
+    boost::unique_lock<boost::mutex> decoder_lock(decoder_mutex_, boost::defer_lock);
+    if (!workers_.empty()) {
+        decoder_lock.lock();
+    }
+
+    for (std::size_t slot = first_slot; slot < first_slot + batch_size_; slot++) {
+        struct iovec* slot_iovecs = &batch_iovecs_[slot * FrameDecoderUDP::max_batch_iovecs];
+        struct msghdr& msg_hdr = batch_msgs_[slot].msg_hdr;
+
+        msg_hdr.msg_name = (void*)&batch_addrs_[slot];
+        msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+        msg_hdr.msg_iov = slot_iovecs;
+        msg_hdr.msg_iovlen = frame_decoder_->get_batch_iovecs(slot, slot_iovecs);
+        if (socket_stats_enabled_) {
+            msg_hdr.msg_control = &batch_control_[slot * control_size_];
+            msg_hdr.msg_controllen = control_size_;
+        }
+        batch_msgs_[slot].msg_len = 0;
+    }
+
+    if (decoder_lock.owns_lock()) {
+        decoder_lock.unlock();
+    }
+
+    int packets_received = recvmmsg(recv_socket, &batch_msgs_[first_slot], batch_size_, MSG_DONTWAIT, NULL);
+    if (packets_received < 0) {
+        if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+            LOG_WITH_ERRNO(logger_, "RX thread batched receive failed on port " << recv_port);
+        }
+        return 0;
+    }
+
+    for (std::size_t slot = first_slot; slot < first_slot + packets_received; slot++) {
+        batch_bytes_[slot] = batch_msgs_[slot].msg_len;
+    }
+
+    if (!workers_.empty()) {
+        decoder_lock.lock();
+    }
+
+    if (socket_stats_enabled_) {
+        struct timespec recv_time;
+        clock_gettime(CLOCK_REALTIME, &recv_time);
+        SocketStats& stats = socket_stats_[recv_port];
+        for (std::size_t slot = first_slot; slot < first_slot + packets_received; slot++) {
+            stats.update(batch_msgs_[slot].msg_hdr, recv_time);
+        }
+    }
+
+    LOG4CXX_DEBUG_LEVEL(3, logger_, "RX thread received batch of " << packets_received << " packets on recv socket");
+
+    if (packet_tap_) {
+        for (std::size_t slot = first_slot; slot < first_slot + packets_received; slot++) {
+            const struct msghdr& msg_hdr = batch_msgs_[slot].msg_hdr;
+            packet_tap_->capture(
+                msg_hdr.msg_iov, msg_hdr.msg_iovlen, batch_bytes_[slot], &batch_addrs_[slot], recv_port
+            );
+        }
+    }
+
+    frame_decoder_->process_packet_batch(
+        first_slot, packets_received, &batch_bytes_[first_slot], recv_port, &batch_addrs_[first_slot]
+    );
+
+    return packets_received;
+#else
+    return 0;
+#endif
+}
+
+//! Constructor for the SocketStats class.
+//!
+//! This constructor zeroes all counters and histogram bins.
+//!
+FrameReceiverUDPRxThread::SocketStats::SocketStats() :
+    packets(0),
+    kernel_drops(0),
+    max_latency_ns(0),
+    have_last_arrival(false)
+{
+    memset(&last_arrival, 0, sizeof(last_arrival));
+    memset(inter_arrival_hist, 0, sizeof(inter_arrival_hist));
+    memset(latency_hist, 0, sizeof(latency_hist));
+}
+
+//! Update socket statistics from the ancillary data of a received packet.
+//!
+//! This method parses the kernel drop counter and receive timestamp control messages attached
+//! to a packet. The drop counter is cumulative for the socket and only present once non-zero, so
+//! the largest value seen is retained. The timestamp is used to update the inter-arrival and
+//! socket-to-decoder latency histograms.
+//!
+//! \param[in] msg_hdr - message header of the received packet
+//! \param[in] recv_time - time at which the packet was handed to the decoder
+//!
+void FrameReceiverUDPRxThread::SocketStats::update(const struct msghdr& msg_hdr, const struct timespec& recv_time)
+{
+    packets++;
+
+#if defined(SO_RXQ_OVFL) && defined(SO_TIMESTAMPNS)
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg_hdr); cmsg != NULL;
+         cmsg = CMSG_NXTHDR(const_cast<struct msghdr*>(&msg_hdr), cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET) {
+            continue;
+        }
+        if (cmsg->cmsg_type == SO_RXQ_OVFL) {
+            uint32_t drops;
+            memcpy(&drops, CMSG_DATA(cmsg), sizeof(drops));
+            if (drops > kernel_drops) {
+                kernel_drops = drops;
+            }
+        } else if (cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+            struct timespec arrival;
+            memcpy(&arrival, CMSG_DATA(cmsg), sizeof(arrival));
+
+            int64_t latency_ns = (int64_t)(recv_time.tv_sec - arrival.tv_sec) * 1000000000L
+                + (recv_time.tv_nsec - arrival.tv_nsec);
+            if (latency_ns < 0) {
+                latency_ns = 0;
+            }
+            latency_hist[hist_bin(latency_ns)]++;
+            if ((uint64_t)latency_ns > max_latency_ns) {
+                max_latency_ns = latency_ns;
+            }
+
+            if (have_last_arrival) {
+                int64_t interval_ns = (int64_t)(arrival.tv_sec - last_arrival.tv_sec) * 1000000000L
+                    + (arrival.tv_nsec - last_arrival.tv_nsec);
+                if (interval_ns < 0) {
+                    interval_ns = 0;
+                }
+                inter_arrival_hist[hist_bin(interval_ns)]++;
+            }
+            last_arrival = arrival;
+            have_last_arrival = true;
+        }
+    }
+#endif
+}
+
+//! Determine the histogram bin for a time interval.
+//!
+//! Bins are logarithmic in microseconds: bin 0 holds intervals below 1us, bin N holds intervals
+//! from 2^(N-1)us up to 2^N us, and the last bin holds all longer intervals.
+//!
+//! \param[in] interval_ns - time interval in nanoseconds
+//! \return - histogram bin index
+//!
+std::size_t FrameReceiverUDPRxThread::SocketStats::hist_bin(uint64_t interval_ns)
+{
+    uint64_t interval_us = interval_ns / 1000;
+    std::size_t bin = 0;
+    while ((interval_us > 0) && (bin < (num_hist_bins - 1))) {
+        interval_us >>= 1;
+        bin++;
+    }
+    return bin;
+}
+
+//! Constructor for the BusyPollStats class.
+//!
+//! This constructor zeroes all counters and times.
+//!
+FrameReceiverUDPRxThread::BusyPollStats::BusyPollStats() :
+    iterations(0),
+    empty_polls(0),
+    receive_ns(0),
+    idle_ns(0),
+    service_ns(0)
+{
+}
+
+//! Reset the busy-poll statistics.
+//!
+//! This method zeroes all counters and times. It must only be called while no loop is updating
+//! the statistics.
+//!
+void FrameReceiverUDPRxThread::BusyPollStats::reset(void)
+{
+    iterations.store(0, std::memory_order_relaxed);
+    empty_polls.store(0, std::memory_order_relaxed);
+    receive_ns.store(0, std::memory_order_relaxed);
+    idle_ns.store(0, std::memory_order_relaxed);
+    service_ns.store(0, std::memory_order_relaxed);
+}
+
+//! Add a value to a busy-poll statistics counter.
+//!
+//! Each set of statistics is only updated by the loop that owns it, so the counter is updated with
+//! a relaxed load and store rather than an atomic read-modify-write, keeping the cost of the update
+//! in the busy-poll loop to that of a plain increment while allowing the status to be read safely
+//! from another thread.
+//!
+//! \param[in,out] counter - counter to update
+//! \param[in] value - value to add to the counter
+//!
+void FrameReceiverUDPRxThread::BusyPollStats::add(std::atomic<uint64_t>& counter, uint64_t value)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+//! Constructor for the RxWorker class.
+//!
+//! \param[in] index - index of the worker
+//! \param[in] first_slot - first batch receive slot used by the worker
+//! \param[in] backend - polling backend of the worker reactor
+//!
+FrameReceiverUDPRxThread::RxWorker::RxWorker(
+    unsigned int index,
+    std::size_t first_slot,
+    IpcReactor::ReactorBackend backend
+) :
+    index(index),
+    first_slot(first_slot),
+    core(-1),
+    channel(ZMQ_DEALER),
+    ready_batch(IpcMessage::MsgValNotifyFrameReadyBatch),
+    reactor(backend)
+{
 }
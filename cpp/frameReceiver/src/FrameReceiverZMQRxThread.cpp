@@ -42,8 +42,11 @@ void FrameReceiverZMQRxThread::run_specific_service(void)
         ss << "tcp://" << config_.rx_address_ << ":" << rx_port;
         skt_channel_.connect(ss.str().c_str());
 
-        // Register the IPC channel with the reactor
-        reactor_.register_channel(skt_channel_, boost::bind(&FrameReceiverZMQRxThread::handle_receive_socket, this));
+        // Register the IPC channel with the reactor, draining pending message parts on each wakeup
+        reactor_.register_channel(
+            skt_channel_, boost::bind(&FrameReceiverZMQRxThread::handle_receive_socket, this),
+            IpcReactor::default_drain_budget
+        );
     }
 }
 
@@ -80,3 +83,19 @@ void FrameReceiverZMQRxThread::handle_receive_socket()
         frame_decoder_->frame_meta_data(1);
     }
 }
+
+//! Fill ZMQ RX thread specific status parameters into a message.
+//!
+//! This method adds the reactor batching statistics of the receive channel, i.e. the number of
+//! wakeups on which messages were pending, the number of message parts received and the largest
+//! number received on one wakeup, to the status message.
+//!
+//! \param[in,out] status_msg - IpcMessage to fill with status parameters
+//!
+void FrameReceiverZMQRxThread::fill_specific_status_params(IpcMessage& status_msg)
+{
+    IpcReactorChannelStats stats = reactor_.get_channel_stats(skt_channel_);
+    status_msg.set_param("rx_thread/zmq/wakeups", stats.wakeups);
+    status_msg.set_param("rx_thread/zmq/messages", stats.messages);
+    status_msg.set_param("rx_thread/zmq/max_batch", stats.max_batch);
+}
@@ -0,0 +1,106 @@
+/*
+ * DummyUDPDecoderTestFixture.h
+ *
+ * Common test fixture driving a DummyUDP frame decoder directly, passing packets through it as
+ * the receiver thread does and recording the frames it notifies as ready
+ */
+
+#ifndef FRAMERECEIVER_TEST_DUMMYUDPDECODERTESTFIXTURE_H_
+#define FRAMERECEIVER_TEST_DUMMYUDPDECODERTESTFIXTURE_H_
+
+#include <string.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/bind/bind.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <log4cxx/basicconfigurator.h>
+#include <log4cxx/logger.h>
+
+#include "DummyUDPFrameDecoder.h"
+#include "IpcMessage.h"
+#include "SharedBufferManager.h"
+
+#ifdef BOOST_HAS_PLACEHOLDERS
+using namespace boost::placeholders;
+#endif
+
+//! Test fixture driving a DummyUDP frame decoder with a shared buffer manager
+//!
+//! Fixtures derived from this class add any further decoder configuration parameters, call
+//! init_decoder() and then register a buffer manager sized from the decoder frame size.
+class DummyUDPDecoderTestFixture {
+public:
+    DummyUDPDecoderTestFixture(
+        const std::string& logger_name,
+        unsigned int packets_per_frame,
+        unsigned int packet_size
+    ) :
+        logger(log4cxx::Logger::getLogger(logger_name)),
+        decoder(new FrameReceiver::DummyUDPFrameDecoder()),
+        packets_per_frame_(packets_per_frame)
+    {
+        log4cxx::BasicConfigurator::configure();
+        log4cxx::Logger::getRootLogger()->setLevel(log4cxx::Level::getWarn());
+
+        decoder_config.set_param<unsigned int>(FrameReceiver::CONFIG_DECODER_UDP_PACKETS_PER_FRAME, packets_per_frame);
+        decoder_config.set_param<unsigned int>(FrameReceiver::CONFIG_DECODER_UDP_PACKET_SIZE, packet_size);
+    }
+
+    //! Initialise the decoder with the fixture decoder configuration
+    void init_decoder(void)
+    {
+        decoder->init(logger, decoder_config);
+    }
+
+    //! Register a buffer manager with the decoder and precharge the decoder with its buffers
+    void register_buffer_manager(OdinData::SharedBufferManagerPtr manager, unsigned int num_buffers)
+    {
+        buffer_manager = manager;
+        decoder->register_buffer_manager(buffer_manager);
+        decoder->register_frame_ready_callback(boost::bind(&DummyUDPDecoderTestFixture::frame_ready, this, _1, _2));
+        for (unsigned int buffer_id = 0; buffer_id < num_buffers; buffer_id++) {
+            decoder->push_empty_buffer(buffer_id);
+        }
+    }
+
+    //! Record a frame notified as ready by the decoder
+    void frame_ready(int buffer_id, int frame)
+    {
+        ready_frames.push_back(std::make_pair(buffer_id, frame));
+    }
+
+    //! Pass a packet through the decoder as the receiver thread does, filling its payload with a
+    //! value derived from the frame number
+    void receive_packet(uint32_t frame, uint32_t packet_number)
+    {
+        DummyUDP::PacketHeader* header = static_cast<DummyUDP::PacketHeader*>(decoder->get_packet_header_buffer());
+        header->frame_number = frame;
+        header->packet_number_flags = packet_number;
+        decoder->process_packet_header(sizeof(DummyUDP::PacketHeader), 0, NULL);
+        memset(decoder->get_next_payload_buffer(), static_cast<int>(frame + 1), decoder->get_next_payload_size());
+        decoder->process_packet(decoder->get_next_payload_size(), 0, NULL);
+    }
+
+    //! Pass all the packets of a frame through the decoder in order
+    void receive_frame(uint32_t frame)
+    {
+        for (uint32_t packet_number = 0; packet_number < packets_per_frame_; packet_number++) {
+            receive_packet(frame, packet_number);
+        }
+    }
+
+    log4cxx::LoggerPtr logger;
+    boost::shared_ptr<FrameReceiver::DummyUDPFrameDecoder> decoder;
+    OdinData::IpcMessage decoder_config;
+    OdinData::SharedBufferManagerPtr buffer_manager;
+    std::vector<std::pair<int, int>> ready_frames;
+
+private:
+    unsigned int packets_per_frame_;
+};
+
+#endif /* FRAMERECEIVER_TEST_DUMMYUDPDECODERTESTFIXTURE_H_ */
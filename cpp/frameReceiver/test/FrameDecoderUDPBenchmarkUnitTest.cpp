@@ -0,0 +1,168 @@
+/*
+ * FrameDecoderUDPBenchmarkUnitTest.cpp
+ *
+ * Unit tests for the socket-free UDP frame decoder benchmark harness
+ */
+
+#define BOOST_TEST_MODULE "FrameDecoderUDPBenchmarkUnitTests"
+#define BOOST_TEST_MAIN
+
+#include <unistd.h>
+
+#include <sstream>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <log4cxx/basicconfigurator.h>
+#include <log4cxx/logger.h>
+
+#include "DummyUDPFrameDecoder.h"
+#include "FrameDecoderUDPBenchmark.h"
+#include "PacketCaptureTap.h"
+
+const unsigned int packets_per_frame = 10;
+const unsigned int packet_size = 1000;
+const unsigned int num_buffers = 8;
+
+struct FrameDecoderUDPBenchmarkTestFixture {
+    FrameDecoderUDPBenchmarkTestFixture() :
+        logger(log4cxx::Logger::getLogger("FrameDecoderUDPBenchmarkUnitTest")),
+        decoder(new FrameReceiver::DummyUDPFrameDecoder())
+    {
+        log4cxx::BasicConfigurator::configure();
+        log4cxx::Logger::getRootLogger()->setLevel(log4cxx::Level::getWarn());
+
+        OdinData::IpcMessage decoder_config;
+        decoder_config.set_param<unsigned int>(FrameReceiver::CONFIG_DECODER_UDP_PACKETS_PER_FRAME, packets_per_frame);
+        decoder_config.set_param<unsigned int>(FrameReceiver::CONFIG_DECODER_UDP_PACKET_SIZE, packet_size);
+        decoder_config.set_param<unsigned int>(FrameReceiver::CONFIG_DECODER_FRAME_TIMEOUT_MS, 10);
+        decoder->init(logger, decoder_config);
+
+        buffer_manager.reset(new OdinData::SharedBufferManager(
+            "FrameDecoderUDPBenchmarkTest", num_buffers * decoder->get_frame_buffer_size(),
+            decoder->get_frame_buffer_size()
+        ));
+    }
+
+    //! Build a DummyUDP packet for the specified frame and packet number
+    std::vector<uint8_t> make_packet(uint32_t frame, uint32_t packet_number)
+    {
+        std::vector<uint8_t> packet(sizeof(DummyUDP::PacketHeader) + packet_size, 0);
+        DummyUDP::PacketHeader* header = reinterpret_cast<DummyUDP::PacketHeader*>(&packet[0]);
+        header->frame_number = frame;
+        header->packet_number_flags = packet_number;
+        return packet;
+    }
+
+    //! Add the packets of a number of frames to the benchmark stream, optionally omitting one
+    //! packet from each frame
+    void add_frames(FrameReceiver::FrameDecoderUDPBenchmark& benchmark, unsigned int num_frames, int lost_packet = -1)
+    {
+        for (uint32_t frame = 0; frame < num_frames; frame++) {
+            for (uint32_t packet_number = 0; packet_number < packets_per_frame; packet_number++) {
+                if (static_cast<int>(packet_number) != lost_packet) {
+                    std::vector<uint8_t> packet = make_packet(frame, packet_number);
+                    benchmark.add_packet(&packet[0], packet.size());
+                }
+            }
+        }
+    }
+
+    log4cxx::LoggerPtr logger;
+    FrameReceiver::FrameDecoderUDPPtr decoder;
+    OdinData::SharedBufferManagerPtr buffer_manager;
+};
+
+BOOST_FIXTURE_TEST_SUITE(FrameDecoderUDPBenchmarkUnitTest, FrameDecoderUDPBenchmarkTestFixture);
+
+BOOST_AUTO_TEST_CASE(FrameDecoderUDPBenchmarkInOrderStream)
+{
+    const unsigned int num_frames = 20;
+    const unsigned int passes = 3;
+
+    // More frames than buffers are received in each pass, so buffers must be returned to the decoder
+    FrameReceiver::FrameDecoderUDPBenchmark benchmark(decoder, buffer_manager);
+    add_frames(benchmark, num_frames);
+    BOOST_CHECK_EQUAL(benchmark.get_num_packets(), num_frames * packets_per_frame);
+
+    FrameReceiver::FrameDecoderUDPBenchmark::Result result = benchmark.run(passes);
+    BOOST_CHECK_EQUAL(result.packets, num_frames * packets_per_frame * passes);
+    BOOST_CHECK_EQUAL(result.bytes, result.packets * (sizeof(DummyUDP::PacketHeader) + packet_size));
+    BOOST_CHECK_EQUAL(result.frames_ready, num_frames * passes);
+    BOOST_CHECK_EQUAL(result.frames_timedout, 0);
+    BOOST_CHECK_EQUAL(result.frames_dropped, 0);
+    BOOST_CHECK_GT(result.ns_per_packet, 0.0);
+    BOOST_CHECK_GT(result.frames_per_s, 0.0);
+    BOOST_CHECK_EQUAL(decoder->get_num_empty_buffers(), num_buffers);
+}
+
+BOOST_AUTO_TEST_CASE(FrameDecoderUDPBenchmarkBatchedStream)
+{
+    const unsigned int num_frames = 20;
+
+    // A batch size which does not divide the stream leaves a partial batch at the end of each pass
+    FrameReceiver::FrameDecoderUDPBenchmark benchmark(decoder, buffer_manager, 7);
+    add_frames(benchmark, num_frames);
+
+    FrameReceiver::FrameDecoderUDPBenchmark::Result result = benchmark.run(2);
+    BOOST_CHECK_EQUAL(result.packets, num_frames * packets_per_frame * 2);
+    BOOST_CHECK_EQUAL(result.frames_ready, num_frames * 2);
+    BOOST_CHECK_EQUAL(result.frames_timedout, 0);
+}
+
+BOOST_AUTO_TEST_CASE(FrameDecoderUDPBenchmarkLossyStream)
+{
+    const unsigned int num_frames = 4;
+
+    // Frames missing a packet time out, leaving the decoder with all buffers empty at the end
+    // of each pass
+    FrameReceiver::FrameDecoderUDPBenchmark benchmark(decoder, buffer_manager);
+    add_frames(benchmark, num_frames, 3);
+
+    FrameReceiver::FrameDecoderUDPBenchmark::Result result = benchmark.run(2);
+    BOOST_CHECK_EQUAL(result.packets, num_frames * (packets_per_frame - 1) * 2);
+    BOOST_CHECK_EQUAL(result.frames_timedout, num_frames * 2);
+    BOOST_CHECK_EQUAL(result.frames_dropped, 0);
+    BOOST_CHECK_EQUAL(decoder->get_num_mapped_buffers(), 0);
+    BOOST_CHECK_EQUAL(decoder->get_num_empty_buffers(), num_buffers);
+}
+
+BOOST_AUTO_TEST_CASE(FrameDecoderUDPBenchmarkLoadPcap)
+{
+    std::stringstream file_name;
+    file_name << "/tmp/FrameDecoderUDPBenchmarkUnitTest_" << getpid() << ".pcap";
+
+    struct sockaddr_in from_addr;
+    memset(&from_addr, 0, sizeof(from_addr));
+    from_addr.sin_family = AF_INET;
+    from_addr.sin_addr.s_addr = inet_addr("10.0.0.2");
+    from_addr.sin_port = htons(5000);
+
+    // Capture one frame to each of two ports
+    FrameReceiver::PacketCaptureTap tap("10.0.0.1", 0, 1 << 20);
+    BOOST_REQUIRE(tap.start(file_name.str()));
+    for (int port = 61649; port <= 61650; port++) {
+        for (uint32_t packet_number = 0; packet_number < packets_per_frame; packet_number++) {
+            std::vector<uint8_t> packet = make_packet(port - 61649, packet_number);
+            struct iovec iov;
+            iov.iov_base = &packet[0];
+            iov.iov_len = packet.size();
+            BOOST_REQUIRE(tap.capture(&iov, 1, packet.size(), &from_addr, port));
+        }
+    }
+    tap.stop();
+
+    FrameReceiver::FrameDecoderUDPBenchmark benchmark(decoder, buffer_manager);
+    BOOST_CHECK_EQUAL(benchmark.load_pcap(file_name.str(), 61650), packets_per_frame);
+    BOOST_CHECK_EQUAL(benchmark.load_pcap(file_name.str()), packets_per_frame * 2);
+    unlink(file_name.str().c_str());
+
+    FrameReceiver::FrameDecoderUDPBenchmark::Result result = benchmark.run();
+    BOOST_CHECK_EQUAL(result.packets, packets_per_frame * 3);
+    BOOST_CHECK_EQUAL(result.frames_ready, 3);
+
+    BOOST_CHECK_THROW(benchmark.load_pcap(file_name.str()), FrameReceiver::FrameDecoderException);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
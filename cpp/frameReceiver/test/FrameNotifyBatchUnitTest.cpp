@@ -0,0 +1,126 @@
+/*
+ * FrameNotifyBatchUnitTest.cpp
+ *
+ * Unit tests for batched frame ready and release notifications
+ */
+
+#define BOOST_TEST_MODULE "FrameNotifyBatchUnitTests"
+#define BOOST_TEST_MAIN
+
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+#include <sstream>
+
+#include "FrameNotifyBatch.h"
+
+struct FrameNotifyBatchTestFixture {
+    FrameNotifyBatchTestFixture() :
+        send_channel(ZMQ_PAIR),
+        recv_channel(ZMQ_PAIR)
+    {
+        static int id = 0;
+        std::stringstream channel_string;
+        channel_string << "inproc://notify_batch_channel" << id++;
+        send_channel.bind(channel_string.str().c_str());
+        recv_channel.connect(channel_string.str().c_str());
+    }
+
+    OdinData::IpcChannel send_channel;
+    OdinData::IpcChannel recv_channel;
+};
+
+BOOST_FIXTURE_TEST_SUITE(FrameNotifyBatchUnitTest, FrameNotifyBatchTestFixture);
+
+BOOST_AUTO_TEST_CASE(FrameNotifyBatchEncodeDecode)
+{
+    OdinData::FrameNotifyBatch::FrameList frames;
+    frames.push_back(std::make_pair(100, 3));
+    frames.push_back(std::make_pair(101, 7));
+    frames.push_back(std::make_pair(102, 0));
+
+    OdinData::IpcMessage batch_msg(
+        OdinData::IpcMessage::MsgTypeNotify, OdinData::IpcMessage::MsgValNotifyFrameReadyBatch
+    );
+    OdinData::FrameNotifyBatch::encode(frames, batch_msg);
+
+    OdinData::IpcMessage decoded_msg(batch_msg.encode());
+    BOOST_CHECK_EQUAL(decoded_msg.get_msg_val(), OdinData::IpcMessage::MsgValNotifyFrameReadyBatch);
+
+    OdinData::FrameNotifyBatch::FrameList decoded_frames;
+    BOOST_CHECK_EQUAL(OdinData::FrameNotifyBatch::decode(decoded_msg, decoded_frames), frames.size());
+    BOOST_CHECK(decoded_frames == frames);
+
+    // A message without frame arrays decodes to no frames
+    OdinData::IpcMessage empty_msg(
+        OdinData::IpcMessage::MsgTypeNotify, OdinData::IpcMessage::MsgValNotifyFrameReleaseBatch
+    );
+    decoded_frames.clear();
+    BOOST_CHECK_EQUAL(OdinData::FrameNotifyBatch::decode(empty_msg, decoded_frames), 0);
+    BOOST_CHECK(decoded_frames.empty());
+}
+
+BOOST_AUTO_TEST_CASE(FrameNotifyBatchDisabledByDefault)
+{
+    OdinData::FrameNotifyBatch batch(OdinData::IpcMessage::MsgValNotifyFrameReleaseBatch);
+    BOOST_CHECK(!batch.enabled());
+
+    batch.configure(16, 10);
+    BOOST_CHECK(batch.enabled());
+    BOOST_CHECK_EQUAL(batch.get_max_latency_ms(), 10);
+}
+
+BOOST_AUTO_TEST_CASE(FrameNotifyBatchSendsWhenFull)
+{
+    const int max_frames = 4;
+    OdinData::FrameNotifyBatch batch(OdinData::IpcMessage::MsgValNotifyFrameReleaseBatch, max_frames, 10000);
+
+    for (int frame = 0; frame < (max_frames * 2) + 1; frame++) {
+        batch.add(frame, frame + 10, send_channel);
+    }
+
+    // Two full batches are sent, with the last frame still pending
+    for (int batch_idx = 0; batch_idx < 2; batch_idx++) {
+        BOOST_REQUIRE(recv_channel.poll(100));
+        OdinData::IpcMessage batch_msg(recv_channel.recv().c_str());
+        BOOST_CHECK_EQUAL(batch_msg.get_msg_val(), OdinData::IpcMessage::MsgValNotifyFrameReleaseBatch);
+
+        OdinData::FrameNotifyBatch::FrameList frames;
+        BOOST_REQUIRE_EQUAL(OdinData::FrameNotifyBatch::decode(batch_msg, frames), max_frames);
+        for (int idx = 0; idx < max_frames; idx++) {
+            BOOST_CHECK_EQUAL(frames[idx].first, (batch_idx * max_frames) + idx);
+            BOOST_CHECK_EQUAL(frames[idx].second, (batch_idx * max_frames) + idx + 10);
+        }
+    }
+    BOOST_CHECK(!recv_channel.poll(10));
+    BOOST_CHECK_EQUAL(batch.get_messages_sent(), 2);
+    BOOST_CHECK_EQUAL(batch.get_frames_sent(), max_frames * 2);
+
+    // Flushing sends the partial batch, and flushing an empty batch sends nothing
+    batch.flush(send_channel);
+    batch.flush(send_channel);
+    BOOST_REQUIRE(recv_channel.poll(100));
+    OdinData::IpcMessage partial_msg(recv_channel.recv().c_str());
+    OdinData::FrameNotifyBatch::FrameList frames;
+    BOOST_REQUIRE_EQUAL(OdinData::FrameNotifyBatch::decode(partial_msg, frames), 1);
+    BOOST_CHECK_EQUAL(frames[0].first, max_frames * 2);
+    BOOST_CHECK(!recv_channel.poll(10));
+}
+
+BOOST_AUTO_TEST_CASE(FrameNotifyBatchSendsAtLatencyBound)
+{
+    OdinData::FrameNotifyBatch batch(OdinData::IpcMessage::MsgValNotifyFrameReadyBatch, 100, 5);
+
+    batch.add(1, 1, send_channel);
+    BOOST_CHECK(!recv_channel.poll(0));
+
+    // A notification added after the oldest has been held for the latency bound sends the batch
+    boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+    batch.add(2, 2, send_channel);
+
+    BOOST_REQUIRE(recv_channel.poll(100));
+    OdinData::IpcMessage batch_msg(recv_channel.recv().c_str());
+    OdinData::FrameNotifyBatch::FrameList frames;
+    BOOST_CHECK_EQUAL(OdinData::FrameNotifyBatch::decode(batch_msg, frames), 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
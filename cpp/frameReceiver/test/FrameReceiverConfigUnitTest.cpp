@@ -32,6 +32,29 @@ public:
             BOOST_CHECK_EQUAL(mConfig.rx_ports_[i], port_list[i]);
         }
         BOOST_CHECK_EQUAL(mConfig.rx_address_, FrameReceiver::Defaults::default_rx_address);
+        BOOST_CHECK_EQUAL(mConfig.rx_batch_size_, FrameReceiver::Defaults::default_rx_batch_size);
+        BOOST_CHECK_EQUAL(mConfig.rx_socket_stats_, FrameReceiver::Defaults::default_rx_socket_stats);
+        BOOST_CHECK_EQUAL(mConfig.rx_threads_, FrameReceiver::Defaults::default_rx_threads);
+        BOOST_CHECK_EQUAL(mConfig.rx_thread_priority_, FrameReceiver::Defaults::default_rx_thread_priority);
+        BOOST_CHECK_EQUAL(mConfig.rx_reuseport_, FrameReceiver::Defaults::default_rx_reuseport);
+        BOOST_CHECK_EQUAL(mConfig.rx_tcp_listen_, FrameReceiver::Defaults::default_rx_tcp_listen);
+        BOOST_CHECK_EQUAL(mConfig.rx_epoll_, FrameReceiver::Defaults::default_rx_epoll);
+        BOOST_CHECK_EQUAL(mConfig.rx_busy_poll_, FrameReceiver::Defaults::default_rx_busy_poll);
+        BOOST_CHECK_EQUAL(mConfig.rx_busy_poll_us_, FrameReceiver::Defaults::default_rx_busy_poll_us);
+        BOOST_CHECK_EQUAL(mConfig.rx_pcap_file_, FrameReceiver::Defaults::default_rx_pcap_file);
+        BOOST_CHECK_EQUAL(mConfig.rx_pcap_snaplen_, FrameReceiver::Defaults::default_rx_pcap_snaplen);
+        BOOST_CHECK_EQUAL(mConfig.rx_pcap_buffer_size_, FrameReceiver::Defaults::default_rx_pcap_buffer_size);
+        BOOST_CHECK_EQUAL(mConfig.frame_notify_ring_, FrameReceiver::Defaults::default_frame_notify_ring);
+        BOOST_CHECK_EQUAL(mConfig.frame_notify_batch_, FrameReceiver::Defaults::default_frame_notify_batch);
+        BOOST_CHECK_EQUAL(mConfig.frame_notify_batch_ms_, FrameReceiver::Defaults::default_frame_notify_batch_ms);
+        BOOST_CHECK_EQUAL(mConfig.frame_notify_direct_, FrameReceiver::Defaults::default_frame_notify_direct);
+        BOOST_CHECK_EQUAL(
+            mConfig.shared_buffer_huge_page_dir_, FrameReceiver::Defaults::default_shared_buffer_huge_page_dir
+        );
+        BOOST_CHECK_EQUAL(mConfig.shared_buffer_numa_node_, FrameReceiver::Defaults::default_shared_buffer_numa_node);
+        BOOST_CHECK_EQUAL(mConfig.shared_buffer_lock_, FrameReceiver::Defaults::default_shared_buffer_lock);
+        BOOST_CHECK_EQUAL(mConfig.shared_buffer_prefault_, FrameReceiver::Defaults::default_shared_buffer_prefault);
+        BOOST_CHECK_EQUAL(mConfig.shared_buffer_block_size_, FrameReceiver::Defaults::default_shared_buffer_block_size);
     }
 
 private:
@@ -0,0 +1,167 @@
+/*
+ * FrameReceiverControllerUnitTest.cpp
+ *
+ * Unit tests for the status reported by the frame receiver controller from the RX thread status
+ * and for the configuration it reports back to clients
+ */
+
+#define BOOST_TEST_MODULE "FrameReceiverControllerUnitTests"
+#define BOOST_TEST_MAIN
+
+#include <boost/test/unit_test.hpp>
+
+#include "FrameReceiverController.h"
+#include "IpcMessage.h"
+
+namespace FrameReceiver {
+// This class, which is a friend of FrameReceiverController, allows the status reply built from
+// a stored RX thread status, and the configuration reply built from the stored configuration, to
+// be tested without running the controller
+class FrameReceiverControllerTestProxy {
+public:
+    FrameReceiverControllerTestProxy(FrameReceiver::FrameReceiverController& controller) :
+        controller_(controller)
+    {
+    }
+
+    void store_rx_thread_status(OdinData::IpcMessage& rx_status_msg)
+    {
+        controller_.store_rx_thread_status(rx_status_msg);
+    }
+
+    void get_status(OdinData::IpcMessage& status_reply)
+    {
+        controller_.get_status(status_reply);
+    }
+
+    void set_frame_notify_config(bool ring, unsigned int batch, unsigned int batch_ms, bool direct)
+    {
+        controller_.config_.frame_notify_ring_ = ring;
+        controller_.config_.frame_notify_batch_ = batch;
+        controller_.config_.frame_notify_batch_ms_ = batch_ms;
+        controller_.config_.frame_notify_direct_ = direct;
+    }
+
+    void request_configuration(OdinData::IpcMessage& config_reply)
+    {
+        controller_.request_configuration(config_reply);
+    }
+
+private:
+    FrameReceiver::FrameReceiverController& controller_;
+};
+}
+
+class FrameReceiverControllerTestFixture {
+public:
+    FrameReceiverControllerTestFixture() :
+        controller(1),
+        proxy(controller),
+        rx_status_msg(OdinData::IpcMessage::MsgTypeAck, OdinData::IpcMessage::MsgValCmdStatus)
+    {
+        BOOST_TEST_MESSAGE("Setting up FrameReceiverControllerTestFixture");
+
+        // Fill in the parameters every RX thread reports in its status
+        rx_status_msg.set_param("rx_thread/empty_buffers", 1);
+        rx_status_msg.set_param("rx_thread/mapped_buffers", 2);
+        rx_status_msg.set_param("rx_thread/frames_timedout", 3);
+        rx_status_msg.set_param("rx_thread/frames_dropped", 4);
+    }
+
+    ~FrameReceiverControllerTestFixture()
+    {
+        BOOST_TEST_MESSAGE("Tearing down FrameReceiverControllerTestFixture");
+    }
+
+    FrameReceiver::FrameReceiverController controller;
+    FrameReceiver::FrameReceiverControllerTestProxy proxy;
+    OdinData::IpcMessage rx_status_msg;
+};
+
+BOOST_FIXTURE_TEST_SUITE(FrameReceiverControllerUnitTest, FrameReceiverControllerTestFixture);
+
+BOOST_AUTO_TEST_CASE(StatusReportsRxThreadCounters)
+{
+    proxy.store_rx_thread_status(rx_status_msg);
+
+    OdinData::IpcMessage status_reply;
+    proxy.get_status(status_reply);
+
+    BOOST_CHECK_EQUAL(status_reply.get_msg_type(), OdinData::IpcMessage::MsgTypeAck);
+    BOOST_CHECK_EQUAL(status_reply.get_param<unsigned int>("buffers/empty"), 1);
+    BOOST_CHECK_EQUAL(status_reply.get_param<unsigned int>("buffers/mapped"), 2);
+    BOOST_CHECK_EQUAL(status_reply.get_param<unsigned int>("frames/timedout"), 3);
+    BOOST_CHECK_EQUAL(status_reply.get_param<unsigned int>("frames/dropped"), 4);
+    BOOST_CHECK(!status_reply.has_param("rx_thread/busy_poll"));
+    BOOST_CHECK(!status_reply.has_param("rx_thread/pcap"));
+}
+
+BOOST_AUTO_TEST_CASE(StatusForwardsBusyPollStats)
+{
+    rx_status_msg.set_param<uint64_t>("rx_thread/busy_poll/iterations", 100);
+    rx_status_msg.set_param<uint64_t>("rx_thread/busy_poll/empty_polls", 90);
+    rx_status_msg.set_param("rx_thread/busy_poll/receive_time", 0.5);
+    rx_status_msg.set_param("rx_thread/busy_poll/idle_time", 0.25);
+    rx_status_msg.set_param("rx_thread/busy_poll/service_time", 0.125);
+    proxy.store_rx_thread_status(rx_status_msg);
+
+    OdinData::IpcMessage status_reply;
+    proxy.get_status(status_reply);
+
+    BOOST_REQUIRE(status_reply.has_param("rx_thread/busy_poll"));
+    BOOST_CHECK_EQUAL(status_reply.get_param<uint64_t>("rx_thread/busy_poll/iterations"), 100);
+    BOOST_CHECK_EQUAL(status_reply.get_param<uint64_t>("rx_thread/busy_poll/empty_polls"), 90);
+    BOOST_CHECK_EQUAL(status_reply.get_param<double>("rx_thread/busy_poll/receive_time"), 0.5);
+    BOOST_CHECK_EQUAL(status_reply.get_param<double>("rx_thread/busy_poll/idle_time"), 0.25);
+    BOOST_CHECK_EQUAL(status_reply.get_param<double>("rx_thread/busy_poll/service_time"), 0.125);
+}
+
+BOOST_AUTO_TEST_CASE(StatusForwardsPacketCaptureStats)
+{
+    rx_status_msg.set_param<uint64_t>("rx_thread/pcap/captured", 10);
+    rx_status_msg.set_param<uint64_t>("rx_thread/pcap/dropped", 2);
+    rx_status_msg.set_param<uint64_t>("rx_thread/pcap/written", 8);
+    rx_status_msg.set_param<uint64_t>("rx_thread/pcap/bytes_written", 1024);
+    rx_status_msg.set_param<uint64_t>("rx_thread/pcap/write_errors", 0);
+    proxy.store_rx_thread_status(rx_status_msg);
+
+    OdinData::IpcMessage status_reply;
+    proxy.get_status(status_reply);
+
+    BOOST_REQUIRE(status_reply.has_param("rx_thread/pcap"));
+    BOOST_CHECK_EQUAL(status_reply.get_param<uint64_t>("rx_thread/pcap/captured"), 10);
+    BOOST_CHECK_EQUAL(status_reply.get_param<uint64_t>("rx_thread/pcap/dropped"), 2);
+    BOOST_CHECK_EQUAL(status_reply.get_param<uint64_t>("rx_thread/pcap/written"), 8);
+    BOOST_CHECK_EQUAL(status_reply.get_param<uint64_t>("rx_thread/pcap/bytes_written"), 1024);
+    BOOST_CHECK_EQUAL(status_reply.get_param<uint64_t>("rx_thread/pcap/write_errors"), 0);
+}
+
+BOOST_AUTO_TEST_CASE(ConfigurationReportsFrameNotifyParams)
+{
+    // Defaults are reported back as configured
+    OdinData::IpcMessage default_reply;
+    proxy.request_configuration(default_reply);
+    BOOST_CHECK_EQUAL(default_reply.get_msg_type(), OdinData::IpcMessage::MsgTypeAck);
+    BOOST_CHECK_EQUAL(
+        default_reply.get_param<bool>(FrameReceiver::CONFIG_FRAME_NOTIFY_RING),
+        FrameReceiver::Defaults::default_frame_notify_ring
+    );
+    BOOST_CHECK_EQUAL(
+        default_reply.get_param<bool>(FrameReceiver::CONFIG_FRAME_NOTIFY_DIRECT),
+        FrameReceiver::Defaults::default_frame_notify_direct
+    );
+
+    // Non-default values are reported back as configured
+    bool notify_ring = !FrameReceiver::Defaults::default_frame_notify_ring;
+    bool notify_direct = !FrameReceiver::Defaults::default_frame_notify_direct;
+    proxy.set_frame_notify_config(notify_ring, 16, 5, notify_direct);
+
+    OdinData::IpcMessage config_reply;
+    proxy.request_configuration(config_reply);
+    BOOST_CHECK_EQUAL(config_reply.get_param<bool>(FrameReceiver::CONFIG_FRAME_NOTIFY_RING), notify_ring);
+    BOOST_CHECK_EQUAL(config_reply.get_param<unsigned int>(FrameReceiver::CONFIG_FRAME_NOTIFY_BATCH), 16);
+    BOOST_CHECK_EQUAL(config_reply.get_param<unsigned int>(FrameReceiver::CONFIG_FRAME_NOTIFY_BATCH_MS), 5);
+    BOOST_CHECK_EQUAL(config_reply.get_param<bool>(FrameReceiver::CONFIG_FRAME_NOTIFY_DIRECT), notify_direct);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
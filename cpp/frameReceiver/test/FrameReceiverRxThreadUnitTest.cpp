@@ -14,6 +14,7 @@
 
 #include "DummyTCPFrameDecoder.h"
 #include "DummyUDPFrameDecoder.h"
+#include "FrameReceiverAFPacketRxThread.h"
 #include "FrameReceiverTCPRxThread.h"
 #include "FrameReceiverUDPRxThread.h"
 #include "IpcMessage.h"
@@ -23,6 +24,11 @@
 #include <log4cxx/logger.h>
 #include <log4cxx/simplelayout.h>
 
+#ifdef __linux__
+#include <linux/if_ether.h>
+#include <sys/socket.h>
+#endif
+
 namespace FrameReceiver {
 class FrameReceiverRxThreadTestProxy {
 public:
@@ -44,6 +50,31 @@ public:
         return config_.rx_channel_endpoint_;
     }
 
+    void set_rx_batch_size(unsigned int rx_batch_size)
+    {
+        config_.rx_batch_size_ = rx_batch_size;
+    }
+
+    void set_rx_socket_stats(bool rx_socket_stats)
+    {
+        config_.rx_socket_stats_ = rx_socket_stats;
+    }
+
+    void set_rx_ports(const std::string& rx_ports)
+    {
+        config_.tokenize_port_list(config_.rx_ports_, rx_ports);
+    }
+
+    void set_rx_threads(unsigned int rx_threads)
+    {
+        config_.rx_threads_ = rx_threads;
+    }
+
+    void set_rx_busy_poll(bool rx_busy_poll)
+    {
+        config_.rx_busy_poll_ = rx_busy_poll;
+    }
+
 private:
     FrameReceiver::FrameReceiverConfig& config_;
 };
@@ -221,6 +252,651 @@ BOOST_AUTO_TEST_CASE(CreateAndPingUDPRxThread)
     BOOST_REQUIRE_EQUAL(initOK, true);
 }
 
+BOOST_AUTO_TEST_CASE(BatchedUDPRxThreadReceivesFrames)
+{
+    const unsigned int packets_per_frame = 4;
+    const unsigned int packet_size = 64;
+    const unsigned int num_frames = 5;
+    const unsigned int num_buffers = 8;
+
+    // Configure the decoder for small frames and create a buffer manager sized to match
+    IpcMessage decoder_config;
+    decoder_config.set_param<unsigned int>(FrameReceiver::CONFIG_DECODER_UDP_PACKETS_PER_FRAME, packets_per_frame);
+    decoder_config.set_param<unsigned int>(FrameReceiver::CONFIG_DECODER_UDP_PACKET_SIZE, packet_size);
+    frame_decoder->init(logger, decoder_config);
+
+    std::size_t frame_size = frame_decoder->get_frame_buffer_size();
+    OdinData::SharedBufferManagerPtr batch_buffer_manager(
+        new OdinData::SharedBufferManager("TestSharedBufferBatch", frame_size * num_buffers, frame_size)
+    );
+    frame_decoder->register_buffer_manager(batch_buffer_manager);
+
+    proxy.set_rx_batch_size(16);
+
+    FrameReceiver::FrameReceiverUDPRxThread rxThread(config, batch_buffer_manager, frame_decoder, 1);
+    BOOST_REQUIRE_EQUAL(rxThread.start(), true);
+
+    // Consume the identity and precharge request, then precharge the empty buffer queue
+    std::string rx_thread_identity;
+    std::string msg_identity;
+    rx_channel.recv(&rx_thread_identity);
+    rx_channel.recv(&msg_identity);
+
+    IpcMessage precharge_msg(IpcMessage::MsgTypeNotify, IpcMessage::MsgValNotifyBufferPrecharge);
+    precharge_msg.set_param<int>("start_buffer_id", 0);
+    precharge_msg.set_param<int>("num_buffers", num_buffers);
+    rx_channel.send(precharge_msg.encode(), 0, rx_thread_identity);
+
+    // Round-trip a status request to ensure the precharge has been handled before sending packets
+    IpcMessage status_msg(IpcMessage::MsgTypeCmd, IpcMessage::MsgValCmdStatus);
+    rx_channel.send(status_msg.encode(), 0, rx_thread_identity);
+    bool status_ack = false;
+    for (int retry = 0; (retry < 10) && !status_ack; retry++) {
+        if (rx_channel.poll(100)) {
+            IpcMessage reply(rx_channel.recv(&msg_identity).c_str());
+            status_ack = (reply.get_msg_type() == IpcMessage::MsgTypeAck);
+        }
+    }
+    BOOST_REQUIRE(status_ack);
+
+    // Send frames of packets to the receive port, with the payload bytes encoding frame and packet
+    int send_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    struct sockaddr_in dest_addr;
+    memset(&dest_addr, 0, sizeof(dest_addr));
+    dest_addr.sin_family = AF_INET;
+    dest_addr.sin_port = htons(6342);
+    dest_addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+
+    std::vector<uint8_t> packet(sizeof(DummyUDP::PacketHeader) + packet_size);
+    DummyUDP::PacketHeader* packet_header = reinterpret_cast<DummyUDP::PacketHeader*>(&packet[0]);
+    for (unsigned int frame = 0; frame < num_frames; frame++) {
+        for (unsigned int packet_num = 0; packet_num < packets_per_frame; packet_num++) {
+            packet_header->frame_number = frame;
+            packet_header->packet_number_flags = packet_num;
+            memset(&packet[sizeof(DummyUDP::PacketHeader)], (frame << 4) | packet_num, packet_size);
+            sendto(send_socket, &packet[0], packet.size(), 0, (struct sockaddr*)&dest_addr, sizeof(dest_addr));
+        }
+    }
+    close(send_socket);
+
+    // Collect frame ready notifications and validate the frame contents
+    unsigned int frames_ready = 0;
+    bool payload_ok = true;
+    for (int retry = 0; (retry < 20) && (frames_ready < num_frames); retry++) {
+        if (!rx_channel.poll(100)) {
+            continue;
+        }
+        IpcMessage notify(rx_channel.recv(&msg_identity).c_str());
+        if (notify.get_msg_val() != IpcMessage::MsgValNotifyFrameReady) {
+            continue;
+        }
+        int frame = notify.get_param<int>("frame");
+        uint8_t* buffer
+            = reinterpret_cast<uint8_t*>(batch_buffer_manager->get_buffer_address(notify.get_param<int>("buffer_id")));
+        DummyUDP::FrameHeader* frame_header = reinterpret_cast<DummyUDP::FrameHeader*>(buffer);
+        BOOST_CHECK_EQUAL(frame_header->frame_number, frame);
+        BOOST_CHECK_EQUAL(frame_header->total_packets_received, packets_per_frame);
+        for (unsigned int packet_num = 0; packet_num < packets_per_frame; packet_num++) {
+            uint8_t* payload = buffer + frame_decoder->get_frame_header_size() + (packet_num * packet_size);
+            payload_ok &= (payload[0] == ((frame << 4) | packet_num));
+            payload_ok &= (payload[packet_size - 1] == ((frame << 4) | packet_num));
+        }
+        frames_ready++;
+    }
+
+    rxThread.stop();
+
+    BOOST_CHECK_EQUAL(frames_ready, num_frames);
+    BOOST_CHECK(payload_ok);
+}
+
+BOOST_AUTO_TEST_CASE(BusyPollUDPRxThreadReceivesFrames)
+{
+    const unsigned int packets_per_frame = 4;
+    const unsigned int packet_size = 64;
+    const unsigned int num_frames = 5;
+    const unsigned int num_buffers = 8;
+
+    IpcMessage decoder_config;
+    decoder_config.set_param<unsigned int>(FrameReceiver::CONFIG_DECODER_UDP_PACKETS_PER_FRAME, packets_per_frame);
+    decoder_config.set_param<unsigned int>(FrameReceiver::CONFIG_DECODER_UDP_PACKET_SIZE, packet_size);
+    frame_decoder->init(logger, decoder_config);
+
+    std::size_t frame_size = frame_decoder->get_frame_buffer_size();
+    OdinData::SharedBufferManagerPtr busy_buffer_manager(
+        new OdinData::SharedBufferManager("TestSharedBufferBusyPoll", frame_size * num_buffers, frame_size)
+    );
+    frame_decoder->register_buffer_manager(busy_buffer_manager);
+
+    proxy.set_rx_busy_poll(true);
+
+    FrameReceiver::FrameReceiverUDPRxThread rxThread(config, busy_buffer_manager, frame_decoder, 1);
+    BOOST_REQUIRE_EQUAL(rxThread.start(), true);
+
+    // Consume the identity and precharge request, then precharge the empty buffer queue. The
+    // channel is serviced from the busy-poll loop rather than by the reactor sleeping on it.
+    std::string rx_thread_identity;
+    std::string msg_identity;
+    rx_channel.recv(&rx_thread_identity);
+    rx_channel.recv(&msg_identity);
+
+    IpcMessage precharge_msg(IpcMessage::MsgTypeNotify, IpcMessage::MsgValNotifyBufferPrecharge);
+    precharge_msg.set_param<int>("start_buffer_id", 0);
+    precharge_msg.set_param<int>("num_buffers", num_buffers);
+    rx_channel.send(precharge_msg.encode(), 0, rx_thread_identity);
+
+    IpcMessage status_msg(IpcMessage::MsgTypeCmd, IpcMessage::MsgValCmdStatus);
+    rx_channel.send(status_msg.encode(), 0, rx_thread_identity);
+    bool status_ack = false;
+    for (int retry = 0; (retry < 10) && !status_ack; retry++) {
+        if (rx_channel.poll(100)) {
+            IpcMessage reply(rx_channel.recv(&msg_identity).c_str());
+            status_ack = (reply.get_msg_type() == IpcMessage::MsgTypeAck);
+        }
+    }
+    BOOST_REQUIRE(status_ack);
+
+    int send_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    struct sockaddr_in dest_addr;
+    memset(&dest_addr, 0, sizeof(dest_addr));
+    dest_addr.sin_family = AF_INET;
+    dest_addr.sin_port = htons(6342);
+    dest_addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+
+    std::vector<uint8_t> packet(sizeof(DummyUDP::PacketHeader) + packet_size, 0);
+    DummyUDP::PacketHeader* packet_header = reinterpret_cast<DummyUDP::PacketHeader*>(&packet[0]);
+    for (unsigned int frame = 0; frame < num_frames; frame++) {
+        for (unsigned int packet_num = 0; packet_num < packets_per_frame; packet_num++) {
+            packet_header->frame_number = frame;
+            packet_header->packet_number_flags = packet_num;
+            sendto(send_socket, &packet[0], packet.size(), 0, (struct sockaddr*)&dest_addr, sizeof(dest_addr));
+        }
+    }
+    close(send_socket);
+
+    unsigned int frames_ready = 0;
+    for (int retry = 0; (retry < 20) && (frames_ready < num_frames); retry++) {
+        if (!rx_channel.poll(100)) {
+            continue;
+        }
+        IpcMessage notify(rx_channel.recv(&msg_identity).c_str());
+        if (notify.get_msg_val() == IpcMessage::MsgValNotifyFrameReady) {
+            frames_ready++;
+        }
+    }
+
+    // The busy-poll loop statistics are reported in the thread status
+    uint64_t iterations = 0;
+    uint64_t empty_polls = 0;
+    rx_channel.send(status_msg.encode(), 0, rx_thread_identity);
+    for (int retry = 0; (retry < 10) && (iterations == 0); retry++) {
+        if (!rx_channel.poll(100)) {
+            continue;
+        }
+        IpcMessage reply(rx_channel.recv(&msg_identity).c_str());
+        if ((reply.get_msg_type() == IpcMessage::MsgTypeAck) && reply.has_param("rx_thread/busy_poll")) {
+            iterations = reply.get_param<uint64_t>("rx_thread/busy_poll/iterations");
+            empty_polls = reply.get_param<uint64_t>("rx_thread/busy_poll/empty_polls");
+        }
+    }
+
+    rxThread.stop();
+
+    BOOST_CHECK_EQUAL(frames_ready, num_frames);
+    BOOST_CHECK_GT(empty_polls, 0);
+    BOOST_CHECK_GE(iterations, empty_polls + 1);
+}
+
+BOOST_AUTO_TEST_CASE(MultiWorkerUDPRxThreadAssemblesFramesAcrossPorts)
+{
+    const unsigned int packets_per_frame = 4;
+    const unsigned int packet_size = 64;
+    const unsigned int num_frames = 5;
+    const unsigned int num_buffers = 8;
+    const uint16_t rx_ports[] = {6342, 6343};
+
+    IpcMessage decoder_config;
+    decoder_config.set_param<unsigned int>(FrameReceiver::CONFIG_DECODER_UDP_PACKETS_PER_FRAME, packets_per_frame);
+    decoder_config.set_param<unsigned int>(FrameReceiver::CONFIG_DECODER_UDP_PACKET_SIZE, packet_size);
+    frame_decoder->init(logger, decoder_config);
+
+    std::size_t frame_size = frame_decoder->get_frame_buffer_size();
+    OdinData::SharedBufferManagerPtr worker_buffer_manager(
+        new OdinData::SharedBufferManager("TestSharedBufferWorkers", frame_size * num_buffers, frame_size)
+    );
+    frame_decoder->register_buffer_manager(worker_buffer_manager);
+
+    // Run one worker per port, so the packets of each frame are split between workers
+    proxy.set_rx_ports("6342,6343");
+    proxy.set_rx_threads(2);
+    proxy.set_rx_batch_size(16);
+
+    FrameReceiver::FrameReceiverUDPRxThread rxThread(config, worker_buffer_manager, frame_decoder, 1);
+    BOOST_REQUIRE_EQUAL(rxThread.start(), true);
+
+    // Consume the identity and precharge request, then precharge the empty buffer queue
+    std::string rx_thread_identity;
+    std::string msg_identity;
+    rx_channel.recv(&rx_thread_identity);
+    rx_channel.recv(&msg_identity);
+
+    IpcMessage precharge_msg(IpcMessage::MsgTypeNotify, IpcMessage::MsgValNotifyBufferPrecharge);
+    precharge_msg.set_param<int>("start_buffer_id", 0);
+    precharge_msg.set_param<int>("num_buffers", num_buffers);
+    rx_channel.send(precharge_msg.encode(), 0, rx_thread_identity);
+
+    // Round-trip a status request to ensure the precharge has been handled before sending packets
+    IpcMessage status_msg(IpcMessage::MsgTypeCmd, IpcMessage::MsgValCmdStatus);
+    rx_channel.send(status_msg.encode(), 0, rx_thread_identity);
+    bool status_ack = false;
+    for (int retry = 0; (retry < 10) && !status_ack; retry++) {
+        if (rx_channel.poll(100)) {
+            IpcMessage reply(rx_channel.recv(&msg_identity).c_str());
+            status_ack = (reply.get_msg_type() == IpcMessage::MsgTypeAck);
+        }
+    }
+    BOOST_REQUIRE(status_ack);
+
+    // Send the first half of the packets of each frame to one port and the second half to the other
+    int send_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    struct sockaddr_in dest_addr;
+    memset(&dest_addr, 0, sizeof(dest_addr));
+    dest_addr.sin_family = AF_INET;
+    dest_addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+
+    std::vector<uint8_t> packet(sizeof(DummyUDP::PacketHeader) + packet_size);
+    DummyUDP::PacketHeader* packet_header = reinterpret_cast<DummyUDP::PacketHeader*>(&packet[0]);
+    for (unsigned int frame = 0; frame < num_frames; frame++) {
+        for (unsigned int packet_num = 0; packet_num < packets_per_frame; packet_num++) {
+            packet_header->frame_number = frame;
+            packet_header->packet_number_flags = packet_num;
+            memset(&packet[sizeof(DummyUDP::PacketHeader)], (frame << 4) | packet_num, packet_size);
+            dest_addr.sin_port = htons(rx_ports[(packet_num * 2) / packets_per_frame]);
+            sendto(send_socket, &packet[0], packet.size(), 0, (struct sockaddr*)&dest_addr, sizeof(dest_addr));
+        }
+    }
+    close(send_socket);
+
+    // Collect frame ready notifications, which arrive on the worker channels, and validate the frames
+    unsigned int frames_ready = 0;
+    bool payload_ok = true;
+    for (int retry = 0; (retry < 20) && (frames_ready < num_frames); retry++) {
+        if (!rx_channel.poll(100)) {
+            continue;
+        }
+        IpcMessage notify(rx_channel.recv(&msg_identity).c_str());
+        if (notify.get_msg_val() != IpcMessage::MsgValNotifyFrameReady) {
+            continue;
+        }
+        uint8_t* buffer
+            = reinterpret_cast<uint8_t*>(worker_buffer_manager->get_buffer_address(notify.get_param<int>("buffer_id")));
+        DummyUDP::FrameHeader* frame_header = reinterpret_cast<DummyUDP::FrameHeader*>(buffer);
+        int frame = notify.get_param<int>("frame");
+        BOOST_CHECK_EQUAL(frame_header->frame_number, frame);
+        BOOST_CHECK_EQUAL(frame_header->total_packets_received, packets_per_frame);
+        for (unsigned int packet_num = 0; packet_num < packets_per_frame; packet_num++) {
+            uint8_t* payload = buffer + frame_decoder->get_frame_header_size() + (packet_num * packet_size);
+            payload_ok &= (payload[0] == ((frame << 4) | packet_num));
+        }
+        frames_ready++;
+    }
+
+    rxThread.stop();
+
+    BOOST_CHECK_EQUAL(frames_ready, num_frames);
+    BOOST_CHECK(payload_ok);
+}
+
+BOOST_AUTO_TEST_CASE(DummyUDPDecoderSpecialisedReceiveLoop)
+{
+    const unsigned int num_packets = 3;
+    const unsigned int packet_size = 64;
+
+    IpcMessage decoder_config;
+    decoder_config.set_param<unsigned int>(FrameReceiver::CONFIG_DECODER_UDP_PACKET_SIZE, packet_size);
+    frame_decoder->init(logger, decoder_config);
+
+    FrameReceiver::FrameDecoderUDPPtr udp_decoder
+        = boost::dynamic_pointer_cast<FrameReceiver::FrameDecoderUDP>(frame_decoder);
+    FrameReceiver::UDPPacketReceiverPtr receiver = udp_decoder->create_packet_receiver();
+    BOOST_REQUIRE(receiver);
+
+    // Bind a receive socket to an ephemeral loopback port and queue packets on it
+    int recv_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    struct sockaddr_in recv_addr;
+    memset(&recv_addr, 0, sizeof(recv_addr));
+    recv_addr.sin_family = AF_INET;
+    recv_addr.sin_port = 0;
+    recv_addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    BOOST_REQUIRE_EQUAL(bind(recv_socket, (struct sockaddr*)&recv_addr, sizeof(recv_addr)), 0);
+    socklen_t addr_len = sizeof(recv_addr);
+    getsockname(recv_socket, (struct sockaddr*)&recv_addr, &addr_len);
+
+    int send_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    std::vector<uint8_t> packet(sizeof(DummyUDP::PacketHeader) + packet_size, 0);
+    DummyUDP::PacketHeader* packet_header = reinterpret_cast<DummyUDP::PacketHeader*>(&packet[0]);
+    for (unsigned int packet_num = 0; packet_num < num_packets; packet_num++) {
+        packet_header->frame_number = 0;
+        packet_header->packet_number_flags = packet_num;
+        sendto(send_socket, &packet[0], packet.size(), 0, (struct sockaddr*)&recv_addr, sizeof(recv_addr));
+    }
+    close(send_socket);
+
+    // The loop stops at the maximum number of packets, then at the empty socket with errno set,
+    // passing each packet received to the callback
+    std::size_t packets_seen = 0;
+    std::size_t bytes_seen = 0;
+    FrameReceiver::PacketReceivedCallback callback
+        = [&](const struct msghdr&, std::size_t bytes_received, int) {
+              packets_seen++;
+              bytes_seen += bytes_received;
+          };
+    int recv_port = ntohs(recv_addr.sin_port);
+    BOOST_CHECK_EQUAL(receiver->receive(recv_socket, recv_port, 2, NULL, 0, callback), 2);
+    BOOST_CHECK_EQUAL(receiver->receive(recv_socket, recv_port, 2, NULL, 0, callback), 1);
+    BOOST_CHECK((errno == EAGAIN) || (errno == EWOULDBLOCK));
+    close(recv_socket);
+
+    BOOST_CHECK_EQUAL(packets_seen, num_packets);
+    BOOST_CHECK_EQUAL(bytes_seen, num_packets * packet.size());
+}
+
+BOOST_AUTO_TEST_CASE(DummyUDPDecoderBatchReceivesPayloadsInPlace)
+{
+    const unsigned int packets_per_frame = 4;
+    const unsigned int packet_size = 64;
+    const unsigned int num_buffers = 4;
+
+    IpcMessage decoder_config;
+    decoder_config.set_param<unsigned int>(FrameReceiver::CONFIG_DECODER_UDP_PACKETS_PER_FRAME, packets_per_frame);
+    decoder_config.set_param<unsigned int>(FrameReceiver::CONFIG_DECODER_UDP_PACKET_SIZE, packet_size);
+    frame_decoder->init(logger, decoder_config);
+
+    std::size_t frame_size = frame_decoder->get_frame_buffer_size();
+    OdinData::SharedBufferManagerPtr direct_buffer_manager(
+        new OdinData::SharedBufferManager("TestSharedBufferDirect", frame_size * num_buffers, frame_size)
+    );
+    frame_decoder->register_buffer_manager(direct_buffer_manager);
+    std::vector<std::pair<int, int>> ready_frames;
+    frame_decoder->register_frame_ready_callback([&](int buffer_id, int frame) {
+        ready_frames.push_back(std::make_pair(buffer_id, frame));
+    });
+    for (unsigned int buffer_id = 0; buffer_id < num_buffers; buffer_id++) {
+        frame_decoder->push_empty_buffer(buffer_id);
+    }
+
+    FrameReceiver::FrameDecoderUDPPtr udp_decoder
+        = boost::dynamic_pointer_cast<FrameReceiver::FrameDecoderUDP>(frame_decoder);
+    udp_decoder->init_batch_receive(packets_per_frame, true);
+
+    // Deliver a batch of packets as recvmmsg would, scattering each into the iovecs of its slot,
+    // and check whether each payload is received directly into the frame buffer
+    std::vector<std::size_t> bytes_received(packets_per_frame);
+    std::vector<struct sockaddr_in> from_addrs(packets_per_frame);
+    std::size_t num_placed = 0;
+    auto deliver_batch = [&](const std::vector<std::pair<uint32_t, uint32_t>>& packets) {
+        num_placed = 0;
+        for (std::size_t slot = 0; slot < packets.size(); slot++) {
+            struct iovec iov[FrameReceiver::FrameDecoderUDP::max_batch_iovecs];
+            BOOST_REQUIRE_EQUAL(udp_decoder->get_batch_iovecs(slot, iov), 2);
+            DummyUDP::PacketHeader* header = static_cast<DummyUDP::PacketHeader*>(iov[0].iov_base);
+            header->frame_number = packets[slot].first;
+            header->packet_number_flags = packets[slot].second;
+            memset(iov[1].iov_base, (packets[slot].first << 4) | packets[slot].second, packet_size);
+            bytes_received[slot] = sizeof(DummyUDP::PacketHeader) + packet_size;
+
+            uint8_t* buffers_start = static_cast<uint8_t*>(direct_buffer_manager->get_buffer_address(0));
+            uint8_t* payload = static_cast<uint8_t*>(iov[1].iov_base);
+            num_placed += ((payload >= buffers_start) && (payload < buffers_start + (frame_size * num_buffers)));
+        }
+        udp_decoder->process_packet_batch(0, packets.size(), &bytes_received[0], 6342, &from_addrs[0]);
+    };
+
+    // Check that a ready frame holds the payloads of all its packets
+    auto frame_holds_payloads = [&](const std::pair<int, int>& ready_frame) {
+        uint8_t* buffer = static_cast<uint8_t*>(direct_buffer_manager->get_buffer_address(ready_frame.first));
+        bool payload_ok = true;
+        for (unsigned int packet_num = 0; packet_num < packets_per_frame; packet_num++) {
+            uint8_t* payload = buffer + frame_decoder->get_frame_header_size() + (packet_num * packet_size);
+            payload_ok &= (payload[0] == ((ready_frame.second << 4) | packet_num));
+            payload_ok &= (payload[packet_size - 1] == ((ready_frame.second << 4) | packet_num));
+        }
+        return payload_ok;
+    };
+
+    // Payloads are staged until the first packet of a frame has been processed, then received in
+    // place while packets arrive in order
+    deliver_batch({ { 0, 0 } });
+    BOOST_CHECK_EQUAL(num_placed, 0);
+    deliver_batch({ { 0, 1 }, { 0, 2 }, { 0, 3 } });
+    BOOST_CHECK_EQUAL(num_placed, 3);
+    BOOST_REQUIRE_EQUAL(ready_frames.size(), 1);
+    BOOST_CHECK(frame_holds_payloads(ready_frames[0]));
+
+    // Packets arriving out of order are received at mispredicted locations, which must not
+    // corrupt the packets received there before them
+    deliver_batch({ { 1, 0 } });
+    deliver_batch({ { 1, 2 }, { 1, 1 }, { 1, 3 } });
+    BOOST_CHECK_EQUAL(num_placed, 3);
+    BOOST_REQUIRE_EQUAL(ready_frames.size(), 2);
+    BOOST_CHECK(frame_holds_payloads(ready_frames[1]));
+
+    // Locations of packets already received are not predicted, and the packet of the next frame
+    // received at a predicted location is moved before the staged packet is copied over it
+    deliver_batch({ { 2, 0 }, { 2, 2 } });
+    BOOST_CHECK_EQUAL(num_placed, 0);
+    deliver_batch({ { 2, 1 } });
+    BOOST_CHECK_EQUAL(num_placed, 1);
+    deliver_batch({ { 2, 3 }, { 3, 0 } });
+    BOOST_CHECK_EQUAL(num_placed, 1);
+    BOOST_REQUIRE_EQUAL(ready_frames.size(), 3);
+    BOOST_CHECK(frame_holds_payloads(ready_frames[2]));
+    deliver_batch({ { 3, 1 }, { 3, 2 }, { 3, 3 } });
+    BOOST_CHECK_EQUAL(num_placed, 3);
+    BOOST_REQUIRE_EQUAL(ready_frames.size(), 4);
+    BOOST_CHECK(frame_holds_payloads(ready_frames[3]));
+}
+
+#if defined(SO_RXQ_OVFL) && defined(SO_TIMESTAMPNS)
+BOOST_AUTO_TEST_CASE(UDPRxThreadReportsSocketStats)
+{
+    const unsigned int num_packets = 10;
+    const unsigned int packet_size = 64;
+
+    IpcMessage decoder_config;
+    decoder_config.set_param<unsigned int>(FrameReceiver::CONFIG_DECODER_UDP_PACKET_SIZE, packet_size);
+    frame_decoder->init(logger, decoder_config);
+
+    proxy.set_rx_socket_stats(true);
+
+    FrameReceiver::FrameReceiverUDPRxThread rxThread(config, buffer_manager, frame_decoder, 1);
+    BOOST_REQUIRE_EQUAL(rxThread.start(), true);
+
+    // Consume the identity and precharge request
+    std::string rx_thread_identity;
+    std::string msg_identity;
+    rx_channel.recv(&rx_thread_identity);
+    rx_channel.recv(&msg_identity);
+
+    // Send packets to the receive port
+    int send_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    struct sockaddr_in dest_addr;
+    memset(&dest_addr, 0, sizeof(dest_addr));
+    dest_addr.sin_family = AF_INET;
+    dest_addr.sin_port = htons(6342);
+    dest_addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+
+    std::vector<uint8_t> packet(sizeof(DummyUDP::PacketHeader) + packet_size, 0);
+    DummyUDP::PacketHeader* packet_header = reinterpret_cast<DummyUDP::PacketHeader*>(&packet[0]);
+    for (unsigned int packet_num = 0; packet_num < num_packets; packet_num++) {
+        packet_header->frame_number = 0;
+        packet_header->packet_number_flags = packet_num;
+        sendto(send_socket, &packet[0], packet.size(), 0, (struct sockaddr*)&dest_addr, sizeof(dest_addr));
+    }
+    close(send_socket);
+
+    // Poll the thread status until all packets are accounted for in the socket statistics
+    uint64_t packets_received = 0;
+    uint64_t kernel_drops = 1;
+    std::size_t num_hist_bins = 0;
+    uint64_t latency_hist_total = 0;
+    for (int retry = 0; (retry < 20) && (packets_received < num_packets); retry++) {
+        IpcMessage status_msg(IpcMessage::MsgTypeCmd, IpcMessage::MsgValCmdStatus);
+        rx_channel.send(status_msg.encode(), 0, rx_thread_identity);
+        if (!rx_channel.poll(100)) {
+            continue;
+        }
+        IpcMessage reply(rx_channel.recv(&msg_identity).c_str());
+        if ((reply.get_msg_type() != IpcMessage::MsgTypeAck) || !reply.has_param("rx_thread/socket_stats/6342")) {
+            continue;
+        }
+        packets_received = reply.get_param<uint64_t>("rx_thread/socket_stats/6342/packets");
+        kernel_drops = reply.get_param<uint64_t>("rx_thread/kernel_drops");
+
+        const rapidjson::Value& latency_hist = reply.get_param<const rapidjson::Value&>(
+            "rx_thread/socket_stats/6342/latency_hist"
+        );
+        num_hist_bins = latency_hist.Size();
+        latency_hist_total = 0;
+        for (rapidjson::SizeType bin = 0; bin < latency_hist.Size(); bin++) {
+            latency_hist_total += latency_hist[bin].GetUint64();
+        }
+    }
+
+    rxThread.stop();
+
+    BOOST_CHECK_EQUAL(packets_received, num_packets);
+    BOOST_CHECK_EQUAL(kernel_drops, 0);
+    BOOST_CHECK_EQUAL(num_hist_bins, 16);
+    BOOST_CHECK_EQUAL(latency_hist_total, num_packets);
+}
+#endif
+
+#ifdef __linux__
+BOOST_AUTO_TEST_CASE(AFPacketRxThreadReceivesFrames)
+{
+    const unsigned int packets_per_frame = 4;
+    const unsigned int packet_size = 64;
+    const unsigned int num_frames = 5;
+    const unsigned int num_buffers = 8;
+
+    // AF_PACKET sockets require CAP_NET_RAW, so skip the test if one cannot be created
+    int packet_socket = socket(AF_PACKET, SOCK_DGRAM, htons(ETH_P_IP));
+    if (packet_socket < 0) {
+        BOOST_TEST_MESSAGE("Skipping AF_PACKET RX thread test, cannot create packet socket: " << strerror(errno));
+        return;
+    }
+    close(packet_socket);
+
+    IpcMessage decoder_config;
+    decoder_config.set_param<unsigned int>(FrameReceiver::CONFIG_DECODER_UDP_PACKETS_PER_FRAME, packets_per_frame);
+    decoder_config.set_param<unsigned int>(FrameReceiver::CONFIG_DECODER_UDP_PACKET_SIZE, packet_size);
+    frame_decoder->init(logger, decoder_config);
+
+    std::size_t frame_size = frame_decoder->get_frame_buffer_size();
+    OdinData::SharedBufferManagerPtr ring_buffer_manager(
+        new OdinData::SharedBufferManager("TestSharedBufferAFPacket", frame_size * num_buffers, frame_size)
+    );
+    frame_decoder->register_buffer_manager(ring_buffer_manager);
+
+    FrameReceiver::FrameReceiverAFPacketRxThread rxThread(config, ring_buffer_manager, frame_decoder, 1);
+    BOOST_REQUIRE_EQUAL(rxThread.start(), true);
+
+    // Consume the identity and precharge request, then precharge the empty buffer queue
+    std::string rx_thread_identity;
+    std::string msg_identity;
+    rx_channel.recv(&rx_thread_identity);
+    rx_channel.recv(&msg_identity);
+
+    IpcMessage precharge_msg(IpcMessage::MsgTypeNotify, IpcMessage::MsgValNotifyBufferPrecharge);
+    precharge_msg.set_param<int>("start_buffer_id", 0);
+    precharge_msg.set_param<int>("num_buffers", num_buffers);
+    rx_channel.send(precharge_msg.encode(), 0, rx_thread_identity);
+
+    IpcMessage status_msg(IpcMessage::MsgTypeCmd, IpcMessage::MsgValCmdStatus);
+    rx_channel.send(status_msg.encode(), 0, rx_thread_identity);
+    bool status_ack = false;
+    for (int retry = 0; (retry < 10) && !status_ack; retry++) {
+        if (rx_channel.poll(100)) {
+            IpcMessage reply(rx_channel.recv(&msg_identity).c_str());
+            status_ack = (reply.get_msg_type() == IpcMessage::MsgTypeAck);
+        }
+    }
+    BOOST_REQUIRE(status_ack);
+
+    // Send frames of packets to the receive port, and a packet to another port which the ring
+    // filter should exclude
+    int send_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    struct sockaddr_in dest_addr;
+    memset(&dest_addr, 0, sizeof(dest_addr));
+    dest_addr.sin_family = AF_INET;
+    dest_addr.sin_port = htons(6343);
+    dest_addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+
+    std::vector<uint8_t> packet(sizeof(DummyUDP::PacketHeader) + packet_size, 0);
+    sendto(send_socket, &packet[0], packet.size(), 0, (struct sockaddr*)&dest_addr, sizeof(dest_addr));
+
+    dest_addr.sin_port = htons(6342);
+    DummyUDP::PacketHeader* packet_header = reinterpret_cast<DummyUDP::PacketHeader*>(&packet[0]);
+    for (unsigned int frame = 0; frame < num_frames; frame++) {
+        for (unsigned int packet_num = 0; packet_num < packets_per_frame; packet_num++) {
+            packet_header->frame_number = frame;
+            packet_header->packet_number_flags = packet_num;
+            memset(&packet[sizeof(DummyUDP::PacketHeader)], (frame << 4) | packet_num, packet_size);
+            sendto(send_socket, &packet[0], packet.size(), 0, (struct sockaddr*)&dest_addr, sizeof(dest_addr));
+        }
+    }
+    close(send_socket);
+
+    // Collect frame ready notifications and validate the frame contents
+    unsigned int frames_ready = 0;
+    bool payload_ok = true;
+    for (int retry = 0; (retry < 20) && (frames_ready < num_frames); retry++) {
+        if (!rx_channel.poll(100)) {
+            continue;
+        }
+        IpcMessage notify(rx_channel.recv(&msg_identity).c_str());
+        if (notify.get_msg_val() != IpcMessage::MsgValNotifyFrameReady) {
+            continue;
+        }
+        int frame = notify.get_param<int>("frame");
+        uint8_t* buffer
+            = reinterpret_cast<uint8_t*>(ring_buffer_manager->get_buffer_address(notify.get_param<int>("buffer_id")));
+        DummyUDP::FrameHeader* frame_header = reinterpret_cast<DummyUDP::FrameHeader*>(buffer);
+        BOOST_CHECK_EQUAL(frame_header->frame_number, frame);
+        BOOST_CHECK_EQUAL(frame_header->total_packets_received, packets_per_frame);
+        for (unsigned int packet_num = 0; packet_num < packets_per_frame; packet_num++) {
+            uint8_t* payload = buffer + frame_decoder->get_frame_header_size() + (packet_num * packet_size);
+            payload_ok &= (payload[0] == ((frame << 4) | packet_num));
+            payload_ok &= (payload[packet_size - 1] == ((frame << 4) | packet_num));
+        }
+        frames_ready++;
+    }
+
+    // Check the ring statistics account for the frame packets only
+    uint64_t packets_received = 0;
+    uint64_t ring_drops = 1;
+    rx_channel.send(status_msg.encode(), 0, rx_thread_identity);
+    for (int retry = 0; retry < 10; retry++) {
+        if (rx_channel.poll(100)) {
+            IpcMessage reply(rx_channel.recv(&msg_identity).c_str());
+            if ((reply.get_msg_type() == IpcMessage::MsgTypeAck) && reply.has_param("rx_thread/ring")) {
+                packets_received = reply.get_param<uint64_t>("rx_thread/ring/packets_received");
+                ring_drops = reply.get_param<uint64_t>("rx_thread/ring/drops");
+                break;
+            }
+        }
+    }
+
+    rxThread.stop();
+
+    BOOST_CHECK_EQUAL(frames_ready, num_frames);
+    BOOST_CHECK(payload_ok);
+    BOOST_CHECK_EQUAL(packets_received, num_frames * packets_per_frame);
+    BOOST_CHECK_EQUAL(ring_drops, 0);
+}
+#endif
+
 BOOST_AUTO_TEST_SUITE_END(); // FrameReceiverUDPRxThreadUnitTest
 
 BOOST_FIXTURE_TEST_SUITE(FrameReceiverTCPRxThreadUnitTest, FrameReceiverTCPRxThreadTestFixture);
@@ -0,0 +1,179 @@
+/*
+ * FrameSlotTableUnitTest.cpp
+ *
+ * Unit tests for the frame slot table and packet bitmap decoder helpers
+ */
+
+#define BOOST_TEST_MODULE "FrameSlotTableUnitTests"
+#define BOOST_TEST_MAIN
+
+#include <algorithm>
+
+#include <boost/test/unit_test.hpp>
+
+#include "FrameSlotTable.h"
+#include "PacketBitmap.h"
+
+BOOST_AUTO_TEST_SUITE(FrameSlotTableUnitTest);
+
+BOOST_AUTO_TEST_CASE(FrameSlotTableEmpty)
+{
+    FrameReceiver::FrameSlotTable table;
+    BOOST_CHECK(table.empty());
+    BOOST_CHECK_EQUAL(table.find(0), -1);
+    BOOST_CHECK(!table.insert(0, 0));
+    BOOST_CHECK(!table.erase(0));
+
+    table.reset(4);
+    BOOST_CHECK(table.empty());
+    BOOST_CHECK_EQUAL(table.find(0), -1);
+}
+
+BOOST_AUTO_TEST_CASE(FrameSlotTableInsertFindErase)
+{
+    FrameReceiver::FrameSlotTable table;
+    table.reset(4);
+
+    BOOST_CHECK(table.insert(10, 1));
+    BOOST_CHECK(table.insert(11, 2));
+    BOOST_CHECK_EQUAL(table.size(), 2);
+    BOOST_CHECK_EQUAL(table.find(10), 1);
+    BOOST_CHECK_EQUAL(table.find(11), 2);
+    BOOST_CHECK_EQUAL(table.find(12), -1);
+
+    // Re-inserting a frame updates its buffer ID rather than adding an entry
+    BOOST_CHECK(table.insert(10, 3));
+    BOOST_CHECK_EQUAL(table.size(), 2);
+    BOOST_CHECK_EQUAL(table.find(10), 3);
+
+    BOOST_CHECK(table.erase(10));
+    BOOST_CHECK(!table.erase(10));
+    BOOST_CHECK_EQUAL(table.find(10), -1);
+    BOOST_CHECK_EQUAL(table.find(11), 2);
+    BOOST_CHECK_EQUAL(table.size(), 1);
+
+    table.clear();
+    BOOST_CHECK(table.empty());
+    BOOST_CHECK_EQUAL(table.find(11), -1);
+}
+
+BOOST_AUTO_TEST_CASE(FrameSlotTableCollidingFrames)
+{
+    // Frames differing by multiples of the table capacity share a home slot, so exercise probe
+    // runs that wrap around the table and backward-shift deletion from the middle of a run
+    FrameReceiver::FrameSlotTable table;
+    table.reset(4);
+
+    const int frames[] = {7, 15, 23, 31, 0, 8};
+    const int num_frames = sizeof(frames) / sizeof(frames[0]);
+    for (int idx = 0; idx < num_frames; idx++) {
+        BOOST_REQUIRE(table.insert(frames[idx], idx));
+    }
+    BOOST_CHECK_EQUAL(table.size(), num_frames);
+
+    BOOST_CHECK(table.erase(15));
+    BOOST_CHECK(table.erase(0));
+    for (int idx = 0; idx < num_frames; idx++) {
+        int expected = ((frames[idx] == 15) || (frames[idx] == 0)) ? -1 : idx;
+        BOOST_CHECK_EQUAL(table.find(frames[idx]), expected);
+    }
+
+    std::vector<std::pair<int, int>> entries;
+    table.entries(entries);
+    BOOST_CHECK_EQUAL(entries.size(), num_frames - 2);
+}
+
+BOOST_AUTO_TEST_CASE(FrameSlotTableOutOfOrderRelease)
+{
+    // Interleave insertion and out-of-order release of frames over many more frames than the
+    // table holds, as a decoder does when frames complete or time out in arbitrary order
+    const int max_frames = 8;
+    FrameReceiver::FrameSlotTable table;
+    table.reset(max_frames);
+
+    std::vector<int> active;
+    for (int frame = 0; frame < 1000; frame++) {
+        if (static_cast<int>(active.size()) == max_frames) {
+            int release_idx = (frame * 5) % max_frames;
+            BOOST_REQUIRE(table.erase(active[release_idx]));
+            active.erase(active.begin() + release_idx);
+        }
+        BOOST_REQUIRE(table.insert(frame, frame % 100));
+        active.push_back(frame);
+
+        for (std::vector<int>::iterator iter = active.begin(); iter != active.end(); ++iter) {
+            BOOST_REQUIRE_EQUAL(table.find(*iter), *iter % 100);
+        }
+        BOOST_REQUIRE_EQUAL(table.size(), active.size());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(FrameSlotTableFull)
+{
+    FrameReceiver::FrameSlotTable table;
+    table.reset(2);
+
+    // A table reset for two frames has four slots, one of which is always kept free
+    BOOST_CHECK(table.insert(0, 0));
+    BOOST_CHECK(table.insert(1, 1));
+    BOOST_CHECK(table.insert(2, 2));
+    BOOST_CHECK(!table.insert(3, 3));
+    BOOST_CHECK_EQUAL(table.find(3), -1);
+    BOOST_CHECK_EQUAL(table.size(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(PacketBitmapSetAndCount)
+{
+    const size_t num_packets = 130;
+    uint64_t words[3];
+    BOOST_CHECK_EQUAL(OdinData::PacketBitmap::words_for(num_packets), 3);
+    BOOST_CHECK_EQUAL(OdinData::PacketBitmap::words_for(128), 2);
+
+    // Fill the words with set bits to check that clear resets them and that bits beyond the
+    // number of packets are ignored
+    std::fill(words, words + 3, ~static_cast<uint64_t>(0));
+    OdinData::PacketBitmap bitmap(words, num_packets);
+    BOOST_CHECK(bitmap.complete());
+    bitmap.clear();
+    BOOST_CHECK_EQUAL(bitmap.count(), 0);
+    BOOST_CHECK(!bitmap.complete());
+
+    BOOST_CHECK(bitmap.set(0));
+    BOOST_CHECK(bitmap.set(64));
+    BOOST_CHECK(bitmap.set(129));
+    BOOST_CHECK(!bitmap.set(64));
+    BOOST_CHECK(bitmap.test(64));
+    BOOST_CHECK(!bitmap.test(65));
+    BOOST_CHECK_EQUAL(bitmap.count(), 3);
+
+    for (size_t packet = 0; packet < num_packets; packet++) {
+        bitmap.set(packet);
+    }
+    BOOST_CHECK_EQUAL(bitmap.count(), num_packets);
+    BOOST_CHECK(bitmap.complete());
+}
+
+BOOST_AUTO_TEST_CASE(PacketBitmapMissing)
+{
+    const size_t num_packets = 100;
+    uint64_t words[2];
+    OdinData::PacketBitmap bitmap(words, num_packets);
+    bitmap.clear();
+
+    for (size_t packet = 0; packet < num_packets; packet++) {
+        if ((packet != 3) && (packet != 63) && (packet != 64) && (packet != 99)) {
+            bitmap.set(packet);
+        }
+    }
+
+    std::vector<size_t> missing;
+    BOOST_CHECK_EQUAL(bitmap.missing(missing), 4);
+    BOOST_REQUIRE_EQUAL(missing.size(), 4);
+    BOOST_CHECK_EQUAL(missing[0], 3);
+    BOOST_CHECK_EQUAL(missing[1], 63);
+    BOOST_CHECK_EQUAL(missing[2], 64);
+    BOOST_CHECK_EQUAL(missing[3], 99);
+    BOOST_CHECK_EQUAL(bitmap.count(), num_packets - 4);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
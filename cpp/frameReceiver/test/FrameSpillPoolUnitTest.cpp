@@ -0,0 +1,171 @@
+/*
+ * FrameSpillPoolUnitTest.cpp
+ *
+ * Unit tests for the frame spill pool and its use by frame decoders when shared buffers are exhausted
+ */
+
+#define BOOST_TEST_MODULE "FrameSpillPoolUnitTests"
+#define BOOST_TEST_MAIN
+
+#include <string.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include "DummyUDPDecoderTestFixture.h"
+#include "FrameSpillPool.h"
+
+BOOST_AUTO_TEST_SUITE(FrameSpillPoolUnitTest);
+
+BOOST_AUTO_TEST_CASE(FrameSpillPoolEmpty)
+{
+    FrameReceiver::FrameSpillPool pool;
+    size_t slot;
+    BOOST_CHECK_EQUAL(pool.capacity(), 0);
+    BOOST_CHECK_EQUAL(pool.in_use(), 0);
+    BOOST_CHECK(!pool.acquire(slot));
+
+    BOOST_CHECK(pool.reset(0, 1024));
+    BOOST_CHECK_EQUAL(pool.capacity(), 0);
+    BOOST_CHECK(!pool.acquire(slot));
+}
+
+BOOST_AUTO_TEST_CASE(FrameSpillPoolAcquireRelease)
+{
+    FrameReceiver::FrameSpillPool pool;
+    BOOST_REQUIRE(pool.reset(3, 4096));
+    BOOST_CHECK_EQUAL(pool.capacity(), 3);
+    BOOST_CHECK_EQUAL(pool.frame_size(), 4096);
+
+    // Slots are handed out lowest first and are distinct, writable regions of the pool
+    size_t slots[3];
+    for (size_t idx = 0; idx < 3; idx++) {
+        BOOST_REQUIRE(pool.acquire(slots[idx]));
+        BOOST_CHECK_EQUAL(slots[idx], idx);
+        memset(pool.address(slots[idx]), static_cast<int>(idx + 1), pool.frame_size());
+    }
+    size_t slot;
+    BOOST_CHECK(!pool.acquire(slot));
+    BOOST_CHECK_EQUAL(pool.in_use(), 3);
+    BOOST_CHECK_EQUAL(static_cast<uint8_t*>(pool.address(1))[4095], 2);
+
+    // Released slots are reused, and the peak is retained until reset
+    pool.release(slots[1]);
+    pool.release(slots[2]);
+    BOOST_CHECK_EQUAL(pool.in_use(), 1);
+    BOOST_CHECK_EQUAL(pool.peak_in_use(), 3);
+    BOOST_REQUIRE(pool.acquire(slot));
+    BOOST_CHECK_EQUAL(slot, slots[2]);
+
+    pool.reset_peak();
+    BOOST_CHECK_EQUAL(pool.peak_in_use(), 2);
+
+    BOOST_REQUIRE(pool.reset(2, 1024));
+    BOOST_CHECK_EQUAL(pool.in_use(), 0);
+    BOOST_CHECK_EQUAL(pool.peak_in_use(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+
+const unsigned int packets_per_frame = 2;
+const unsigned int packet_size = 64;
+const unsigned int num_shared_buffers = 2;
+const unsigned int num_spill_buffers = 2;
+
+struct FrameDecoderSpillTestFixture : public DummyUDPDecoderTestFixture {
+    FrameDecoderSpillTestFixture() :
+        DummyUDPDecoderTestFixture("FrameSpillPoolUnitTest", packets_per_frame, packet_size)
+    {
+        decoder_config.set_param<unsigned int>(FrameReceiver::CONFIG_DECODER_SPILL_POOL_FRAMES, num_spill_buffers);
+        init_decoder();
+
+        register_buffer_manager(
+            OdinData::SharedBufferManagerPtr(new OdinData::SharedBufferManager(
+                "FrameSpillPoolTest", num_shared_buffers * decoder->get_frame_buffer_size(),
+                decoder->get_frame_buffer_size()
+            )),
+            num_shared_buffers
+        );
+    }
+
+    //! Check that a shared buffer holds the complete header and payload of a frame
+    bool buffer_holds_frame(int buffer_id, uint32_t frame)
+    {
+        uint8_t* buffer = static_cast<uint8_t*>(buffer_manager->get_buffer_address(buffer_id));
+        DummyUDP::FrameHeader* header = reinterpret_cast<DummyUDP::FrameHeader*>(buffer);
+        uint8_t* payload_end = buffer + decoder->get_frame_buffer_size() - 1;
+        return (header->frame_number == frame) && (header->total_packets_received == packets_per_frame)
+            && (*payload_end == static_cast<uint8_t>(frame + 1));
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(FrameDecoderSpillUnitTest, FrameDecoderSpillTestFixture);
+
+BOOST_AUTO_TEST_CASE(FrameDecoderSpillsAndUnspillsFrames)
+{
+    BOOST_CHECK_EQUAL(decoder->get_spill_pool_size(), num_spill_buffers);
+
+    // Frames beyond the shared buffers are spilled until the spill pool is full, then dropped
+    for (uint32_t frame = 0; frame < 5; frame++) {
+        receive_frame(frame);
+    }
+    BOOST_REQUIRE_EQUAL(ready_frames.size(), 2);
+    BOOST_CHECK_EQUAL(decoder->get_num_frames_spilled(), 2);
+    BOOST_CHECK_EQUAL(decoder->get_num_spilled_buffers(), 2);
+    BOOST_CHECK_EQUAL(decoder->get_num_frames_dropped(), 1);
+
+    // Each released buffer receives the next spilled frame, which is then notified
+    decoder->push_empty_buffer(ready_frames[0].first);
+    decoder->push_empty_buffer(ready_frames[1].first);
+    BOOST_REQUIRE_EQUAL(ready_frames.size(), 4);
+    for (int frame = 2; frame < 4; frame++) {
+        BOOST_CHECK_EQUAL(ready_frames[frame].second, frame);
+        BOOST_CHECK_LT(ready_frames[frame].first, static_cast<int>(num_shared_buffers));
+        BOOST_CHECK(buffer_holds_frame(ready_frames[frame].first, frame));
+    }
+    BOOST_CHECK_EQUAL(decoder->get_num_frames_unspilled(), 2);
+    BOOST_CHECK_EQUAL(decoder->get_num_spilled_buffers(), 0);
+    BOOST_CHECK_EQUAL(decoder->get_spill_pool_peak(), 2);
+    BOOST_CHECK_EQUAL(decoder->get_num_empty_buffers(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(FrameDecoderSpillPreservesFrameOrder)
+{
+    // Frame 0 is left incomplete in a shared buffer, frame 1 completes in the other and frame 2
+    // completes in the spill pool with no shared buffer to copy it into
+    receive_packet(0, 0);
+    for (uint32_t frame = 1; frame < 3; frame++) {
+        receive_frame(frame);
+    }
+    BOOST_REQUIRE_EQUAL(ready_frames.size(), 1);
+    BOOST_CHECK_EQUAL(ready_frames[0].second, 1);
+
+    // Frame 0 completes after frame 2, so is held back behind it
+    receive_packet(0, 1);
+    BOOST_CHECK_EQUAL(ready_frames.size(), 1);
+
+    // Releasing frame 1 allows frame 2 to be unspilled, followed by frame 0
+    decoder->push_empty_buffer(ready_frames[0].first);
+    BOOST_REQUIRE_EQUAL(ready_frames.size(), 3);
+    BOOST_CHECK_EQUAL(ready_frames[1].second, 2);
+    BOOST_CHECK_EQUAL(ready_frames[1].first, ready_frames[0].first);
+    BOOST_CHECK(buffer_holds_frame(ready_frames[1].first, 2));
+    BOOST_CHECK_EQUAL(ready_frames[2].second, 0);
+    BOOST_CHECK(buffer_holds_frame(ready_frames[2].first, 0));
+}
+
+BOOST_AUTO_TEST_CASE(FrameDecoderSpillDroppedWithBuffers)
+{
+    for (uint32_t frame = 0; frame < 3; frame++) {
+        receive_frame(frame);
+    }
+    BOOST_CHECK_EQUAL(decoder->get_num_spilled_buffers(), 1);
+
+    // Dropping all buffers discards the spilled frame, so a released buffer is queued as empty
+    decoder->drop_all_buffers();
+    BOOST_CHECK_EQUAL(decoder->get_num_spilled_buffers(), 0);
+    decoder->push_empty_buffer(0);
+    BOOST_CHECK_EQUAL(ready_frames.size(), 2);
+    BOOST_CHECK_EQUAL(decoder->get_num_empty_buffers(), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,124 @@
+/*
+ * FrameTimeoutQueueUnitTest.cpp
+ *
+ * Unit tests for the deadline-ordered frame timeout queue used by frame decoders
+ */
+
+#define BOOST_TEST_MODULE "FrameTimeoutQueueUnitTests"
+#define BOOST_TEST_MAIN
+
+#include <boost/test/unit_test.hpp>
+
+#include "FrameTimeoutQueue.h"
+
+BOOST_AUTO_TEST_SUITE(FrameTimeoutQueueUnitTest);
+
+BOOST_AUTO_TEST_CASE(FrameTimeoutQueueEmpty)
+{
+    FrameReceiver::FrameTimeoutQueue queue;
+    queue.reset(4);
+
+    int frame = -1;
+    int buffer_id = -1;
+    uint64_t deadline_ns = 0;
+    BOOST_CHECK(queue.empty());
+    BOOST_CHECK(!queue.pop_expired(1000, frame, buffer_id));
+    BOOST_CHECK(!queue.next_deadline(deadline_ns));
+    BOOST_CHECK(!queue.cancel(0));
+}
+
+BOOST_AUTO_TEST_CASE(FrameTimeoutQueueExpiresInDeadlineOrder)
+{
+    FrameReceiver::FrameTimeoutQueue queue;
+    queue.reset(4);
+
+    queue.add(10, 0, 300);
+    queue.add(11, 1, 100);
+    queue.add(12, 2, 200);
+    BOOST_CHECK_EQUAL(queue.size(), 3);
+
+    uint64_t deadline_ns = 0;
+    BOOST_REQUIRE(queue.next_deadline(deadline_ns));
+    BOOST_CHECK_EQUAL(deadline_ns, 100);
+
+    // Only frames whose deadline has passed are expired, earliest first
+    int frame = -1;
+    int buffer_id = -1;
+    BOOST_CHECK(!queue.pop_expired(99, frame, buffer_id));
+    BOOST_REQUIRE(queue.pop_expired(250, frame, buffer_id));
+    BOOST_CHECK_EQUAL(frame, 11);
+    BOOST_CHECK_EQUAL(buffer_id, 1);
+    BOOST_REQUIRE(queue.pop_expired(250, frame, buffer_id));
+    BOOST_CHECK_EQUAL(frame, 12);
+    BOOST_CHECK_EQUAL(buffer_id, 2);
+    BOOST_CHECK(!queue.pop_expired(250, frame, buffer_id));
+    BOOST_CHECK_EQUAL(queue.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(FrameTimeoutQueueCancel)
+{
+    FrameReceiver::FrameTimeoutQueue queue;
+    queue.reset(4);
+
+    queue.add(20, 0, 100);
+    queue.add(21, 1, 200);
+    queue.add(22, 2, 300);
+
+    // Cancelled frames are never expired, whether at the top of the heap or behind it
+    BOOST_CHECK(queue.cancel(0));
+    BOOST_CHECK(queue.cancel(2));
+    BOOST_CHECK(!queue.cancel(2));
+    BOOST_CHECK_EQUAL(queue.size(), 1);
+
+    int frame = -1;
+    int buffer_id = -1;
+    BOOST_REQUIRE(queue.pop_expired(1000, frame, buffer_id));
+    BOOST_CHECK_EQUAL(frame, 21);
+    BOOST_CHECK(!queue.pop_expired(1000, frame, buffer_id));
+    BOOST_CHECK(queue.empty());
+}
+
+BOOST_AUTO_TEST_CASE(FrameTimeoutQueueBufferReuse)
+{
+    FrameReceiver::FrameTimeoutQueue queue;
+    queue.reset(2);
+
+    // A buffer released and reused for a new frame must only carry the new frame's deadline
+    queue.add(30, 0, 100);
+    BOOST_CHECK(queue.cancel(0));
+    queue.add(31, 0, 500);
+
+    int frame = -1;
+    int buffer_id = -1;
+    BOOST_CHECK(!queue.pop_expired(200, frame, buffer_id));
+    BOOST_REQUIRE(queue.pop_expired(500, frame, buffer_id));
+    BOOST_CHECK_EQUAL(frame, 31);
+    BOOST_CHECK_EQUAL(buffer_id, 0);
+
+    // Adding a deadline for a buffer which already has one replaces it
+    queue.add(32, 1, 100);
+    queue.add(33, 1, 400);
+    BOOST_CHECK_EQUAL(queue.size(), 1);
+    BOOST_CHECK(!queue.pop_expired(300, frame, buffer_id));
+    BOOST_REQUIRE(queue.pop_expired(400, frame, buffer_id));
+    BOOST_CHECK_EQUAL(frame, 33);
+}
+
+BOOST_AUTO_TEST_CASE(FrameTimeoutQueueClear)
+{
+    FrameReceiver::FrameTimeoutQueue queue;
+    queue.reset(2);
+
+    queue.add(40, 0, 100);
+    queue.add(41, 5, 100);
+    BOOST_CHECK_EQUAL(queue.size(), 2);
+
+    queue.clear();
+    BOOST_CHECK(queue.empty());
+
+    int frame = -1;
+    int buffer_id = -1;
+    BOOST_CHECK(!queue.pop_expired(1000, frame, buffer_id));
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -8,6 +8,9 @@
 #define BOOST_TEST_MODULE "IpcReactorTests"
 #define BOOST_TEST_MAIN
 
+#include <unistd.h>
+
+#include <boost/shared_ptr.hpp>
 #include <boost/test/unit_test.hpp>
 
 #include "IpcChannel.h"
@@ -19,6 +22,8 @@ public:
         send_channel(ZMQ_PAIR),
         recv_channel(ZMQ_PAIR),
         timer_count(0),
+        drain_count(0),
+        drain_target(0),
         test_message("This is a test message")
     {
         BOOST_TEST_MESSAGE("Setup test fixture");
@@ -54,6 +59,14 @@ public:
         reactor.stop();
     }
 
+    void drain_handler(void)
+    {
+        received_message = recv_channel.recv();
+        if (++drain_count == drain_target) {
+            reactor.stop();
+        }
+    }
+
     void timed_send_handler(void)
     {
         send_channel.send(test_message);
@@ -63,6 +76,8 @@ public:
     OdinData::IpcChannel recv_channel;
     OdinData::IpcReactor reactor;
     unsigned int timer_count;
+    unsigned int drain_count;
+    unsigned int drain_target;
     std::string test_message;
     std::string received_message;
 };
@@ -97,4 +112,277 @@ BOOST_AUTO_TEST_CASE(ReactorSendFromTimerTest)
 
     BOOST_CHECK_EQUAL(test_message, received_message);
 }
+
+BOOST_AUTO_TEST_CASE(ReactorChannelDrainTest)
+{
+    drain_target = 10;
+    reactor.register_channel(
+        recv_channel, boost::bind(&ReactorTestFixture::drain_handler, this), OdinData::IpcReactor::default_drain_budget
+    );
+
+    for (unsigned int msg = 0; msg < drain_target; msg++) {
+        send_channel.send(test_message);
+    }
+    reactor.run();
+
+    OdinData::IpcReactorChannelStats stats = reactor.get_channel_stats(recv_channel);
+    BOOST_CHECK_EQUAL(drain_count, drain_target);
+    BOOST_CHECK_EQUAL(stats.messages, drain_target);
+    BOOST_CHECK(stats.wakeups < stats.messages);
+    BOOST_CHECK(stats.max_batch > 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+
+//! Test fixture driving a reactor with a given backend through a set of channels, sockets and timers
+class ReactorBackendFixture {
+public:
+    ReactorBackendFixture() :
+        message_count(0),
+        message_target(0),
+        timer_count(0),
+        socket_count(0)
+    {
+    }
+
+    //! Create a number of connected send and receive channel pairs
+    void create_channels(std::size_t num_channels)
+    {
+        for (std::size_t idx = 0; idx < num_channels; idx++) {
+            std::stringstream ss;
+            ss << "inproc://reactor_backend_" << random() << "_" << idx;
+            boost::shared_ptr<OdinData::IpcChannel> send(new OdinData::IpcChannel(ZMQ_PAIR));
+            boost::shared_ptr<OdinData::IpcChannel> recv(new OdinData::IpcChannel(ZMQ_PAIR));
+            send->bind(ss.str().c_str());
+            recv->connect(ss.str().c_str());
+            send_channels.push_back(send);
+            recv_channels.push_back(recv);
+        }
+    }
+
+    ~ReactorBackendFixture()
+    {
+        for (std::size_t idx = 0; idx < recv_channels.size(); idx++) {
+            recv_channels[idx]->close();
+            send_channels[idx]->close();
+        }
+    }
+
+    void recv_handler(OdinData::IpcReactor* reactor, OdinData::IpcChannel* channel)
+    {
+        channel->recv();
+        if (++message_count == message_target) {
+            reactor->stop();
+        }
+    }
+
+    void timer_handler(void)
+    {
+        timer_count++;
+    }
+
+    void socket_handler(OdinData::IpcReactor* reactor, int fd)
+    {
+        char buf;
+        if (read(fd, &buf, 1) == 1) {
+            socket_count++;
+        }
+        reactor->stop();
+    }
+
+    //! Send a message to the first receive channel and a reply back on it, as a callback handling
+    //! one message while sending on the same channel would
+    void send_and_reply_handler(void)
+    {
+        std::string message("inbound message");
+        std::string reply("outbound message");
+        send_channels[0]->send(message);
+        recv_channels[0]->send(reply);
+    }
+
+    void stop_handler(OdinData::IpcReactor* reactor)
+    {
+        reactor->stop();
+    }
+
+    //! Receive a number of messages spread over all channels, returning the elapsed time in ms
+    OdinData::TimeMs run_messages(
+        OdinData::IpcReactor::ReactorBackend backend,
+        std::size_t messages_per_channel,
+        std::size_t num_idle_timers
+    )
+    {
+        OdinData::IpcReactor reactor(backend);
+        message_count = 0;
+        message_target = messages_per_channel * recv_channels.size();
+
+        for (std::size_t idx = 0; idx < recv_channels.size(); idx++) {
+            reactor.register_channel(
+                *recv_channels[idx],
+                boost::bind(&ReactorBackendFixture::recv_handler, this, &reactor, recv_channels[idx].get())
+            );
+        }
+        for (std::size_t idx = 0; idx < num_idle_timers; idx++) {
+            reactor.register_timer(3600000, 0, boost::bind(&ReactorBackendFixture::timer_handler, this));
+        }
+
+        std::string message("benchmark message");
+        for (std::size_t msg = 0; msg < messages_per_channel; msg++) {
+            for (std::size_t idx = 0; idx < send_channels.size(); idx++) {
+                send_channels[idx]->send(message);
+            }
+        }
+
+        OdinData::TimeMs start = OdinData::IpcReactorTimer::clock_mono_ms();
+        reactor.run();
+        return OdinData::IpcReactorTimer::clock_mono_ms() - start;
+    }
+
+    std::vector<boost::shared_ptr<OdinData::IpcChannel>> send_channels;
+    std::vector<boost::shared_ptr<OdinData::IpcChannel>> recv_channels;
+    std::size_t message_count;
+    std::size_t message_target;
+    unsigned int timer_count;
+    unsigned int socket_count;
+};
+
+BOOST_FIXTURE_TEST_SUITE(IpcReactorBackendUnitTest, ReactorBackendFixture);
+
+BOOST_AUTO_TEST_CASE(ReactorEpollTimerTest)
+{
+    OdinData::IpcReactor reactor(OdinData::IpcReactor::ReactorBackendEpoll);
+    unsigned int max_count = 10;
+    reactor.register_timer(10, max_count, boost::bind(&ReactorBackendFixture::timer_handler, this));
+    reactor.register_timer(5, 2, boost::bind(&ReactorBackendFixture::timer_handler, this));
+    int removed_id = reactor.register_timer(1, 0, boost::bind(&ReactorBackendFixture::timer_handler, this));
+    reactor.remove_timer(removed_id);
+    reactor.run();
+    BOOST_CHECK_EQUAL(timer_count, max_count + 2);
+}
+
+BOOST_AUTO_TEST_CASE(ReactorEpollChannelTest)
+{
+    create_channels(4);
+    run_messages(OdinData::IpcReactor::ReactorBackendEpoll, 100, 0);
+    BOOST_CHECK_EQUAL(message_count, message_target);
+}
+
+BOOST_AUTO_TEST_CASE(ReactorEpollSocketTest)
+{
+    OdinData::IpcReactor reactor(OdinData::IpcReactor::ReactorBackendEpoll);
+    int fds[2];
+    BOOST_REQUIRE_EQUAL(pipe(fds), 0);
+    reactor.register_socket(fds[0], boost::bind(&ReactorBackendFixture::socket_handler, this, &reactor, fds[0]));
+    BOOST_REQUIRE_EQUAL(write(fds[1], "x", 1), 1);
+    reactor.run();
+    reactor.remove_socket(fds[0]);
+    close(fds[0]);
+    close(fds[1]);
+    BOOST_CHECK_EQUAL(socket_count, 1);
+}
+
+BOOST_AUTO_TEST_CASE(ReactorSendOnChannelFromTimerTest)
+{
+    const OdinData::IpcReactor::ReactorBackend backends[]
+        = { OdinData::IpcReactor::ReactorBackendPoll, OdinData::IpcReactor::ReactorBackendEpoll };
+    create_channels(1);
+
+    for (std::size_t backend_idx = 0; backend_idx < 2; backend_idx++) {
+        OdinData::IpcReactor reactor(backends[backend_idx]);
+        message_count = 0;
+        message_target = 1;
+
+        // Sending on the channel after the inbound message arrives consumes the edge of its
+        // ZMQ_FD, so the message must still be dispatched well before the fallback timer
+        reactor.register_channel(
+            *recv_channels[0], boost::bind(&ReactorBackendFixture::recv_handler, this, &reactor, recv_channels[0].get())
+        );
+        reactor.register_timer(10, 1, boost::bind(&ReactorBackendFixture::send_and_reply_handler, this));
+        reactor.register_timer(1000, 1, boost::bind(&ReactorBackendFixture::stop_handler, this, &reactor));
+
+        OdinData::TimeMs start = OdinData::IpcReactorTimer::clock_mono_ms();
+        reactor.run();
+        BOOST_CHECK_EQUAL(message_count, message_target);
+        BOOST_CHECK_LT(OdinData::IpcReactorTimer::clock_mono_ms() - start, 1000);
+        BOOST_CHECK_EQUAL(send_channels[0]->recv(), std::string("outbound message"));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ReactorServiceTest)
+{
+    const OdinData::IpcReactor::ReactorBackend backends[]
+        = { OdinData::IpcReactor::ReactorBackendPoll, OdinData::IpcReactor::ReactorBackendEpoll };
+    const std::size_t messages_per_channel = 100;
+    const unsigned int timer_target = 5;
+    create_channels(2);
+
+    for (std::size_t backend_idx = 0; backend_idx < 2; backend_idx++) {
+        OdinData::IpcReactor reactor(backends[backend_idx]);
+        message_count = 0;
+        message_target = 0;
+        timer_count = 0;
+        socket_count = 0;
+
+        for (std::size_t idx = 0; idx < recv_channels.size(); idx++) {
+            reactor.register_channel(
+                *recv_channels[idx],
+                boost::bind(&ReactorBackendFixture::recv_handler, this, &reactor, recv_channels[idx].get()),
+                OdinData::IpcReactor::default_drain_budget
+            );
+        }
+        reactor.register_timer(1, timer_target, boost::bind(&ReactorBackendFixture::timer_handler, this));
+
+        std::string message("service message");
+        for (std::size_t msg = 0; msg < messages_per_channel; msg++) {
+            for (std::size_t idx = 0; idx < send_channels.size(); idx++) {
+                send_channels[idx]->send(message);
+            }
+        }
+
+        // Servicing never blocks, so channels are drained and timers fired over repeated calls
+        OdinData::TimeMs start = OdinData::IpcReactorTimer::clock_mono_ms();
+        while ((message_count < messages_per_channel * recv_channels.size()) || (timer_count < timer_target)) {
+            BOOST_REQUIRE(reactor.service());
+            BOOST_REQUIRE_LT(OdinData::IpcReactorTimer::clock_mono_ms() - start, 1000);
+        }
+        BOOST_CHECK_EQUAL(message_count, messages_per_channel * recv_channels.size());
+        BOOST_CHECK_EQUAL(timer_count, timer_target);
+
+        // A ready socket whose callback stops the reactor ends servicing
+        int fds[2];
+        BOOST_REQUIRE_EQUAL(pipe(fds), 0);
+        reactor.register_socket(fds[0], boost::bind(&ReactorBackendFixture::socket_handler, this, &reactor, fds[0]));
+        BOOST_CHECK(reactor.service());
+        BOOST_REQUIRE_EQUAL(write(fds[1], "x", 1), 1);
+        BOOST_CHECK(!reactor.service());
+        BOOST_CHECK_EQUAL(socket_count, 1);
+        BOOST_CHECK(!reactor.service());
+        reactor.remove_socket(fds[0]);
+        close(fds[0]);
+        close(fds[1]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ReactorBackendBenchmark)
+{
+    const std::size_t num_channels = 64;
+    const std::size_t messages_per_channel = 500;
+    const std::size_t num_idle_timers = 1000;
+    create_channels(num_channels);
+
+    OdinData::TimeMs poll_ms
+        = run_messages(OdinData::IpcReactor::ReactorBackendPoll, messages_per_channel, num_idle_timers);
+    BOOST_CHECK_EQUAL(message_count, message_target);
+
+    OdinData::TimeMs epoll_ms
+        = run_messages(OdinData::IpcReactor::ReactorBackendEpoll, messages_per_channel, num_idle_timers);
+    BOOST_CHECK_EQUAL(message_count, message_target);
+
+    BOOST_TEST_MESSAGE(
+        "Reactor backends receiving " << message_target << " messages on " << num_channels << " channels with "
+                                      << num_idle_timers << " idle timers: poll " << poll_ms << "ms, epoll "
+                                      << epoll_ms << "ms"
+    );
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,192 @@
+/*
+ * PacketCaptureTapUnitTest.cpp
+ *
+ * Unit tests for the asynchronous pcap capture of received UDP packets
+ */
+
+#define BOOST_TEST_MODULE "PacketCaptureTapUnitTests"
+#define BOOST_TEST_MAIN
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <sstream>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "PacketCaptureTap.h"
+
+struct PacketCaptureTapTestFixture {
+    PacketCaptureTapTestFixture()
+    {
+        std::stringstream file_name;
+        file_name << "/tmp/PacketCaptureTapUnitTest_" << getpid() << ".pcap";
+        pcap_file = file_name.str();
+
+        memset(&from_addr, 0, sizeof(from_addr));
+        from_addr.sin_family = AF_INET;
+        from_addr.sin_addr.s_addr = inet_addr("10.0.0.2");
+        from_addr.sin_port = htons(5000);
+    }
+
+    ~PacketCaptureTapTestFixture()
+    {
+        unlink(pcap_file.c_str());
+    }
+
+    //! Capture a packet of the specified size split into a header and payload, filled with a
+    //! pattern derived from the packet index
+    bool capture_packet(FrameReceiver::PacketCaptureTap& tap, size_t size, int index)
+    {
+        std::vector<uint8_t> packet(size);
+        for (size_t idx = 0; idx < size; idx++) {
+            packet[idx] = static_cast<uint8_t>(idx + index);
+        }
+        size_t header_len = std::min(size, static_cast<size_t>(8));
+        struct iovec iov[2];
+        iov[0].iov_base = &packet[0];
+        iov[0].iov_len = header_len;
+        iov[1].iov_base = &packet[header_len];
+        iov[1].iov_len = size - header_len;
+        return tap.capture(iov, 2, size, &from_addr, 61649);
+    }
+
+    //! Read the contents of the capture file
+    std::vector<uint8_t> read_file(void)
+    {
+        std::vector<uint8_t> contents;
+        FILE* file = fopen(pcap_file.c_str(), "rb");
+        if (file != NULL) {
+            uint8_t buffer[4096];
+            size_t bytes_read;
+            while ((bytes_read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+                contents.insert(contents.end(), buffer, buffer + bytes_read);
+            }
+            fclose(file);
+        }
+        return contents;
+    }
+
+    static uint32_t read_u32(const std::vector<uint8_t>& data, size_t offset)
+    {
+        uint32_t value;
+        memcpy(&value, &data[offset], sizeof(value));
+        return value;
+    }
+
+    static uint16_t read_be16(const std::vector<uint8_t>& data, size_t offset)
+    {
+        return static_cast<uint16_t>((data[offset] << 8) | data[offset + 1]);
+    }
+
+    std::string pcap_file;
+    struct sockaddr_in from_addr;
+};
+
+BOOST_FIXTURE_TEST_SUITE(PacketCaptureTapUnitTest, PacketCaptureTapTestFixture);
+
+BOOST_AUTO_TEST_CASE(PacketCaptureTapWritesPcapFile)
+{
+    const size_t packet_sizes[] = {100, 8000, 1};
+    const size_t num_packets = sizeof(packet_sizes) / sizeof(packet_sizes[0]);
+
+    FrameReceiver::PacketCaptureTap tap("10.0.0.1", 0, 1 << 20);
+    BOOST_REQUIRE(tap.start(pcap_file));
+    for (size_t idx = 0; idx < num_packets; idx++) {
+        BOOST_CHECK(capture_packet(tap, packet_sizes[idx], idx));
+    }
+    tap.stop();
+
+    BOOST_CHECK_EQUAL(tap.get_packets_captured(), num_packets);
+    BOOST_CHECK_EQUAL(tap.get_packets_written(), num_packets);
+    BOOST_CHECK_EQUAL(tap.get_packets_dropped(), 0);
+    BOOST_CHECK_EQUAL(tap.get_write_errors(), 0);
+
+    std::vector<uint8_t> contents = read_file();
+    BOOST_REQUIRE_GE(contents.size(), 24);
+    BOOST_CHECK_EQUAL(read_u32(contents, 0), 0xa1b2c3d4);
+    BOOST_CHECK_EQUAL(read_u32(contents, 20), 1);
+
+    size_t offset = 24;
+    for (size_t idx = 0; idx < num_packets; idx++) {
+        size_t size = packet_sizes[idx];
+        BOOST_REQUIRE_LE(offset + 16, contents.size());
+        BOOST_CHECK_EQUAL(read_u32(contents, offset + 8), 42 + size);
+        BOOST_CHECK_EQUAL(read_u32(contents, offset + 12), 42 + size);
+        offset += 16;
+
+        BOOST_REQUIRE_LE(offset + 42 + size, contents.size());
+        BOOST_CHECK_EQUAL(read_be16(contents, offset + 12), 0x0800);
+
+        // The IPv4 header must carry the packet length, addresses and a valid checksum
+        size_t ip_offset = offset + 14;
+        BOOST_CHECK_EQUAL(contents[ip_offset], 0x45);
+        BOOST_CHECK_EQUAL(read_be16(contents, ip_offset + 2), 28 + size);
+        BOOST_CHECK_EQUAL(contents[ip_offset + 9], IPPROTO_UDP);
+        BOOST_CHECK_EQUAL(read_u32(contents, ip_offset + 12), inet_addr("10.0.0.2"));
+        BOOST_CHECK_EQUAL(read_u32(contents, ip_offset + 16), inet_addr("10.0.0.1"));
+        uint32_t sum = 0;
+        for (size_t word = 0; word < 20; word += 2) {
+            sum += read_be16(contents, ip_offset + word);
+        }
+        sum = (sum & 0xffff) + (sum >> 16);
+        BOOST_CHECK_EQUAL(sum, 0xffff);
+
+        size_t udp_offset = offset + 34;
+        BOOST_CHECK_EQUAL(read_be16(contents, udp_offset), 5000);
+        BOOST_CHECK_EQUAL(read_be16(contents, udp_offset + 2), 61649);
+        BOOST_CHECK_EQUAL(read_be16(contents, udp_offset + 4), 8 + size);
+
+        for (size_t byte = 0; byte < size; byte++) {
+            BOOST_REQUIRE_EQUAL(contents[offset + 42 + byte], static_cast<uint8_t>(byte + idx));
+        }
+        offset += 42 + size;
+    }
+    BOOST_CHECK_EQUAL(offset, contents.size());
+}
+
+BOOST_AUTO_TEST_CASE(PacketCaptureTapSnaplen)
+{
+    FrameReceiver::PacketCaptureTap tap("10.0.0.1", 16, 1 << 20);
+    BOOST_CHECK_EQUAL(tap.get_snaplen(), 16);
+    BOOST_REQUIRE(tap.start(pcap_file));
+    BOOST_CHECK(capture_packet(tap, 1000, 0));
+    tap.stop();
+
+    // Only the snap length of the payload is written, with the original length recorded
+    std::vector<uint8_t> contents = read_file();
+    BOOST_REQUIRE_EQUAL(contents.size(), 24 + 16 + 42 + 16);
+    BOOST_CHECK_EQUAL(read_u32(contents, 16), 42 + 16);
+    BOOST_CHECK_EQUAL(read_u32(contents, 24 + 8), 42 + 16);
+    BOOST_CHECK_EQUAL(read_u32(contents, 24 + 12), 42 + 1000);
+    BOOST_CHECK_EQUAL(contents[24 + 16 + 42 + 15], 15);
+}
+
+BOOST_AUTO_TEST_CASE(PacketCaptureTapDropsWhenFull)
+{
+    // Without the writer running the ring fills, after which packets are counted as dropped
+    FrameReceiver::PacketCaptureTap tap("10.0.0.1", 0, 0);
+    size_t attempts = 0;
+    while (tap.get_packets_dropped() < 10) {
+        capture_packet(tap, 9000, attempts++);
+        BOOST_REQUIRE_LT(attempts, 1000);
+    }
+    uint64_t captured = tap.get_packets_captured();
+    BOOST_CHECK_GT(captured, 0);
+    BOOST_CHECK_EQUAL(captured + tap.get_packets_dropped(), attempts);
+
+    // Once the writer drains the ring, the packets captured are written and capture resumes,
+    // including records which wrap around the end of the ring
+    BOOST_REQUIRE(tap.start(pcap_file));
+    for (size_t idx = 0; idx < 100; idx++) {
+        while (!capture_packet(tap, 9000, idx)) {
+            usleep(100);
+        }
+    }
+    tap.stop();
+    BOOST_CHECK_EQUAL(tap.get_packets_written(), captured + 100);
+    BOOST_CHECK_EQUAL(read_file().size(), 24 + (captured + 100) * (16 + 42 + 9000));
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,181 @@
+/*
+ * SharedBufferAllocatorUnitTest.cpp
+ *
+ * Unit tests for the shared buffer block allocator and its use by frame decoders to receive
+ * variable-length frames
+ */
+
+#define BOOST_TEST_MODULE "SharedBufferAllocatorUnitTests"
+#define BOOST_TEST_MAIN
+
+#include <boost/test/unit_test.hpp>
+
+#include "DummyUDPDecoderTestFixture.h"
+#include "SharedBufferAllocator.h"
+
+//! Release every block of an allocator, as precharging does for a frame decoder
+static void precharge(OdinData::SharedBufferAllocator& allocator)
+{
+    for (size_t block = 0; block < allocator.num_blocks(); block++) {
+        allocator.release(block);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(SharedBufferAllocatorUnitTest);
+
+BOOST_AUTO_TEST_CASE(SharedBufferAllocatorEmpty)
+{
+    OdinData::SharedBufferAllocator allocator;
+    size_t first_block;
+    BOOST_CHECK_EQUAL(allocator.num_blocks(), 0);
+    BOOST_CHECK(!allocator.allocate(1, first_block));
+
+    // Blocks are held outside the allocator until released
+    allocator.reset(4);
+    BOOST_CHECK_EQUAL(allocator.num_blocks(), 4);
+    BOOST_CHECK_EQUAL(allocator.free_blocks(), 0);
+    BOOST_CHECK(!allocator.allocate(1, first_block));
+
+    precharge(allocator);
+    BOOST_CHECK_EQUAL(allocator.free_blocks(), 4);
+    BOOST_CHECK(!allocator.allocate(0, first_block));
+    BOOST_CHECK(!allocator.allocate(5, first_block));
+}
+
+BOOST_AUTO_TEST_CASE(SharedBufferAllocatorAllocateRelease)
+{
+    OdinData::SharedBufferAllocator allocator;
+    allocator.reset(8);
+    precharge(allocator);
+
+    // Runs are allocated contiguously from the start of the blocks
+    size_t first[3];
+    BOOST_REQUIRE(allocator.allocate(3, first[0]));
+    BOOST_REQUIRE(allocator.allocate(2, first[1]));
+    BOOST_REQUIRE(allocator.allocate(3, first[2]));
+    BOOST_CHECK_EQUAL(first[0], 0);
+    BOOST_CHECK_EQUAL(first[1], 3);
+    BOOST_CHECK_EQUAL(first[2], 5);
+    BOOST_CHECK_EQUAL(allocator.free_blocks(), 0);
+    BOOST_CHECK_EQUAL(allocator.get_run_length(3), 2);
+
+    // Only the first block of a run can be released
+    BOOST_CHECK(!allocator.release(4));
+    BOOST_CHECK_EQUAL(allocator.get_run_length(4), 0);
+    BOOST_CHECK(allocator.release(first[1]));
+    BOOST_CHECK(!allocator.release(first[1]));
+    BOOST_CHECK_EQUAL(allocator.free_blocks(), 2);
+
+    // A run longer than any free run cannot be allocated, even if enough blocks are free
+    size_t first_block;
+    BOOST_CHECK(allocator.release(first[2]));
+    BOOST_CHECK_EQUAL(allocator.free_blocks(), 5);
+    BOOST_CHECK(allocator.allocate(5, first_block));
+    BOOST_CHECK_EQUAL(first_block, 3);
+    BOOST_CHECK(allocator.release(first_block));
+    BOOST_CHECK(allocator.release(first[0]));
+    BOOST_CHECK_EQUAL(allocator.free_blocks(), 8);
+}
+
+BOOST_AUTO_TEST_CASE(SharedBufferAllocatorWrapsAround)
+{
+    OdinData::SharedBufferAllocator allocator;
+    allocator.reset(8);
+    precharge(allocator);
+
+    // Runs released in allocation order are reused as a ring, continuing from the last allocation
+    size_t first[4];
+    for (size_t idx = 0; idx < 4; idx++) {
+        BOOST_REQUIRE(allocator.allocate(2, first[idx]));
+    }
+    BOOST_CHECK(allocator.release(first[0]));
+    BOOST_CHECK(allocator.release(first[1]));
+
+    size_t first_block;
+    BOOST_REQUIRE(allocator.allocate(3, first_block));
+    BOOST_CHECK_EQUAL(first_block, 0);
+    BOOST_CHECK(!allocator.allocate(2, first_block));
+    BOOST_REQUIRE(allocator.allocate(1, first_block));
+    BOOST_CHECK_EQUAL(first_block, 3);
+}
+
+BOOST_AUTO_TEST_CASE(SharedBufferAllocatorShrink)
+{
+    OdinData::SharedBufferAllocator allocator;
+    allocator.reset(8);
+    precharge(allocator);
+
+    // Shrinking a run frees the blocks beyond its new length for the next allocation
+    size_t first_block;
+    BOOST_REQUIRE(allocator.allocate(6, first_block));
+    allocator.shrink(first_block, 2);
+    BOOST_CHECK_EQUAL(allocator.get_run_length(first_block), 2);
+    BOOST_CHECK_EQUAL(allocator.free_blocks(), 6);
+
+    // A run cannot be shrunk to nothing or grown
+    allocator.shrink(first_block, 0);
+    allocator.shrink(first_block, 4);
+    BOOST_CHECK_EQUAL(allocator.get_run_length(first_block), 2);
+
+    size_t next_block;
+    BOOST_REQUIRE(allocator.allocate(6, next_block));
+    BOOST_CHECK_EQUAL(next_block, 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+
+const unsigned int packets_per_frame = 4;
+const unsigned int packet_size = 64;
+const unsigned int block_size = 256;
+const unsigned int num_blocks = 16;
+
+struct FrameDecoderVariableFramesTestFixture : public DummyUDPDecoderTestFixture {
+    FrameDecoderVariableFramesTestFixture() :
+        DummyUDPDecoderTestFixture("SharedBufferAllocatorUnitTest", packets_per_frame, packet_size)
+    {
+        init_decoder();
+
+        register_buffer_manager(
+            OdinData::SharedBufferManagerPtr(new OdinData::SharedBufferManager(
+                "SharedBufferAllocatorTest", num_blocks * block_size, block_size, true, false,
+                OdinData::SharedBufferManager::MappingOptions(), true
+            )),
+            num_blocks
+        );
+        frame_blocks = (decoder->get_frame_buffer_size() + block_size - 1) / block_size;
+    }
+
+    size_t frame_blocks;
+};
+
+BOOST_FIXTURE_TEST_SUITE(FrameDecoderVariableFramesUnitTest, FrameDecoderVariableFramesTestFixture);
+
+BOOST_AUTO_TEST_CASE(FrameDecoderAllocatesFrameBlocks)
+{
+    BOOST_REQUIRE_GT(frame_blocks, 1);
+    BOOST_CHECK_EQUAL(decoder->get_num_empty_buffers(), num_blocks);
+
+    // Each frame occupies a run of blocks, identified by its first block, with its length recorded
+    // in the shared buffer
+    size_t max_frames = num_blocks / frame_blocks;
+    for (uint32_t frame = 0; frame <= max_frames; frame++) {
+        receive_frame(frame);
+    }
+    BOOST_REQUIRE_EQUAL(ready_frames.size(), max_frames);
+    BOOST_CHECK_EQUAL(decoder->get_num_frames_dropped(), 1);
+    for (size_t idx = 0; idx < max_frames; idx++) {
+        BOOST_CHECK_EQUAL(ready_frames[idx].first, static_cast<int>(idx * frame_blocks));
+        BOOST_CHECK_EQUAL(buffer_manager->get_frame_length(ready_frames[idx].first), decoder->get_frame_buffer_size());
+    }
+    BOOST_CHECK_EQUAL(decoder->get_num_empty_buffers(), num_blocks - (max_frames * frame_blocks));
+
+    // Releasing a frame returns all of its blocks
+    decoder->push_empty_buffer(ready_frames[0].first);
+    BOOST_CHECK_EQUAL(decoder->get_num_empty_buffers(), num_blocks - ((max_frames - 1) * frame_blocks));
+
+    // Dropping all buffers leaves no blocks free until they are precharged again
+    decoder->drop_all_buffers();
+    BOOST_CHECK_EQUAL(decoder->get_num_empty_buffers(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
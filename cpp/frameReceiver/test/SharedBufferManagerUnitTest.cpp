@@ -8,10 +8,13 @@
 #define BOOST_TEST_MODULE "SharedBufferManagerTests"
 #define BOOST_TEST_MAIN
 
+#include <boost/filesystem.hpp>
 #include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
 #include <sys/wait.h>
 
 #include "SharedBufferManager.h"
+#include "SharedBufferNotifier.h"
 
 const std::string shared_mem_name = "TestSharedBuffer";
 const size_t buffer_size = 100;
@@ -163,4 +166,189 @@ BOOST_AUTO_TEST_CASE(SharedMemSizeSetToZeroTest)
         OdinData::SharedBufferManagerException
     );
 }
+
+BOOST_AUTO_TEST_CASE(SharedBufferNoNotifyRingsTest)
+{
+    BOOST_CHECK(!shared_buffer_manager.has_notify_rings());
+
+    OdinData::SharedBufferManager mapped_manager(shared_mem_name);
+    BOOST_CHECK(!mapped_manager.has_notify_rings());
+    BOOST_CHECK_EQUAL(num_buffers, mapped_manager.get_num_buffers());
+}
+
+BOOST_AUTO_TEST_CASE(SharedBufferNotifyRingsTest)
+{
+    const std::string ring_mem_name = "TestSharedBufferRings";
+    OdinData::SharedBufferManagerPtr creator(
+        new OdinData::SharedBufferManager(ring_mem_name, shared_mem_size, buffer_size, false, true)
+    );
+    BOOST_REQUIRE(creator->has_notify_rings());
+    BOOST_CHECK_EQUAL(num_buffers, creator->get_num_buffers());
+    BOOST_CHECK_GE(creator->get_ready_ring()->capacity(), num_buffers);
+
+    // Map the existing shared buffer and check the rings are located correctly
+    OdinData::SharedBufferManagerPtr mapper(new OdinData::SharedBufferManager(ring_mem_name));
+    BOOST_REQUIRE(mapper->has_notify_rings());
+    BOOST_CHECK_EQUAL(num_buffers, mapper->get_num_buffers());
+
+    // Create the notifier on the creating side and connect to it from the mapping side, handling the
+    // connection in a separate thread
+    OdinData::SharedBufferNotifier creator_notifier(creator, true);
+    boost::thread connect_thread(boost::bind(&OdinData::SharedBufferNotifier::handle_connection, &creator_notifier));
+    OdinData::SharedBufferNotifier mapper_notifier(mapper, false);
+    connect_thread.join();
+
+    // Post all buffers to the ready ring and check it then reports full
+    for (uint32_t buffer_id = 0; buffer_id < creator->get_ready_ring()->capacity(); buffer_id++) {
+        BOOST_CHECK(creator_notifier.post(OdinData::SharedBufferNotifier::ReadyRing, buffer_id, buffer_id + 100));
+    }
+    BOOST_CHECK(!creator_notifier.post(OdinData::SharedBufferNotifier::ReadyRing, 0, 0));
+
+    // Take the descriptors on the mapping side and post them to the release ring
+    mapper_notifier.clear_doorbell(OdinData::SharedBufferNotifier::ReadyRing);
+    OdinData::SharedBufferRing::Descriptor desc;
+    uint32_t expected_buffer_id = 0;
+    while (mapper_notifier.take(OdinData::SharedBufferNotifier::ReadyRing, desc)) {
+        BOOST_CHECK_EQUAL(desc.buffer_id, expected_buffer_id);
+        BOOST_CHECK_EQUAL(desc.frame_number, expected_buffer_id + 100);
+        BOOST_CHECK(
+            mapper_notifier.post(OdinData::SharedBufferNotifier::ReleaseRing, desc.buffer_id, desc.frame_number)
+        );
+        expected_buffer_id++;
+    }
+    BOOST_CHECK_EQUAL(expected_buffer_id, creator->get_ready_ring()->capacity());
+
+    // Check the releases arrive back on the creating side
+    std::size_t num_released = 0;
+    while (creator_notifier.take(OdinData::SharedBufferNotifier::ReleaseRing, desc)) {
+        num_released++;
+    }
+    BOOST_CHECK_EQUAL(num_released, expected_buffer_id);
+}
+
+BOOST_AUTO_TEST_CASE(SharedBufferMappingOptionsTest)
+{
+    // Back the segment with a file in a directory, as would be done with a hugetlbfs mount
+    const std::string file_mem_name = "TestSharedBufferMapped";
+    const std::string file_mem_path = "/tmp/" + file_mem_name;
+    OdinData::SharedBufferManager::MappingOptions options;
+    options.huge_page_dir = "/tmp";
+    options.lock_memory = true;
+    options.prefault = true;
+
+    {
+        OdinData::SharedBufferManagerPtr creator(
+            new OdinData::SharedBufferManager(file_mem_name, shared_mem_size, buffer_size, true, true, options)
+        );
+        BOOST_CHECK(boost::filesystem::exists(file_mem_path));
+        BOOST_CHECK_EQUAL(boost::filesystem::file_size(file_mem_path) % creator->get_page_size(), 0);
+        BOOST_CHECK_EQUAL(num_buffers, creator->get_num_buffers());
+        BOOST_CHECK_EQUAL(-1, creator->get_numa_node());
+        BOOST_CHECK(creator->has_notify_rings());
+        memset(creator->get_buffer_address(num_buffers - 1), 0x5a, buffer_size);
+
+        // The segment can only be found by mapping it with the same options
+        BOOST_CHECK_THROW(OdinData::SharedBufferManager missing(file_mem_name), OdinData::SharedBufferManagerException);
+        OdinData::SharedBufferManager mapper(file_mem_name, options);
+        BOOST_CHECK_EQUAL(creator->get_manager_id(), mapper.get_manager_id());
+        BOOST_CHECK_EQUAL(num_buffers, mapper.get_num_buffers());
+        BOOST_CHECK(mapper.has_notify_rings());
+        char* mapped_buffer = reinterpret_cast<char*>(mapper.get_buffer_address(num_buffers - 1));
+        BOOST_CHECK_EQUAL(mapped_buffer[0], 0x5a);
+        BOOST_CHECK_EQUAL(mapped_buffer[buffer_size - 1], 0x5a);
+    }
+
+    // The backing file is removed with the creating manager
+    BOOST_CHECK(!boost::filesystem::exists(file_mem_path));
+}
+
+BOOST_AUTO_TEST_CASE(SharedBufferRoundedSegmentNotifyRingsTest)
+{
+    // Back the segment with a file, so that its size is rounded up to a whole number of pages
+    const std::string file_mem_name = "TestSharedBufferRounded";
+    const size_t rounded_mem_size = shared_mem_size + 1;
+    OdinData::SharedBufferManager::MappingOptions options;
+    options.huge_page_dir = "/tmp";
+
+    OdinData::SharedBufferManagerPtr creator(
+        new OdinData::SharedBufferManager(file_mem_name, rounded_mem_size, buffer_size, true, true, options)
+    );
+    BOOST_REQUIRE(creator->has_notify_rings());
+    BOOST_REQUIRE_NE(rounded_mem_size % creator->get_page_size(), 0);
+
+    // The mapping side must find the rings at the same offset in the segment as the creator
+    OdinData::SharedBufferManager mapper(file_mem_name, options);
+    BOOST_REQUIRE(mapper.has_notify_rings());
+    char* creator_base = reinterpret_cast<char*>(creator->get_buffer_address(0));
+    char* mapper_base = reinterpret_cast<char*>(mapper.get_buffer_address(0));
+    BOOST_CHECK_EQUAL(
+        reinterpret_cast<char*>(creator->get_ready_ring()) - creator_base,
+        reinterpret_cast<char*>(mapper.get_ready_ring()) - mapper_base
+    );
+    BOOST_CHECK_EQUAL(
+        reinterpret_cast<char*>(creator->get_release_ring()) - creator_base,
+        reinterpret_cast<char*>(mapper.get_release_ring()) - mapper_base
+    );
+    BOOST_CHECK_EQUAL(creator->get_ready_ring()->capacity(), mapper.get_ready_ring()->capacity());
+
+    // Descriptors pushed on one side are popped from the other
+    OdinData::SharedBufferRing::Descriptor desc = {123, 4, 0};
+    BOOST_REQUIRE(creator->get_ready_ring()->push(desc));
+    OdinData::SharedBufferRing::Descriptor popped;
+    BOOST_REQUIRE(mapper.get_ready_ring()->pop(popped));
+    BOOST_CHECK_EQUAL(popped.frame_number, desc.frame_number);
+    BOOST_CHECK_EQUAL(popped.buffer_id, desc.buffer_id);
+    BOOST_REQUIRE(mapper.get_release_ring()->push(popped));
+    BOOST_REQUIRE(creator->get_release_ring()->pop(popped));
+    BOOST_CHECK_EQUAL(popped.frame_number, desc.frame_number);
+    BOOST_CHECK_EQUAL(creator->get_ready_ring()->size(), 0);
+
+    // The buffers are not disturbed by the ring traffic
+    memset(creator->get_buffer_address(num_buffers - 1), 0x5a, buffer_size);
+    char* mapped_buffer = reinterpret_cast<char*>(mapper.get_buffer_address(num_buffers - 1));
+    BOOST_CHECK_EQUAL(mapped_buffer[buffer_size - 1], 0x5a);
+    BOOST_CHECK_EQUAL(mapper.get_ready_ring()->size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(SharedBufferVariableFramesTest)
+{
+    // Fixed-size buffers report the buffer size as the frame length and cannot have it set
+    BOOST_CHECK(!shared_buffer_manager.has_variable_frames());
+    BOOST_CHECK_EQUAL(buffer_size, shared_buffer_manager.get_frame_length(0));
+    BOOST_CHECK_THROW(shared_buffer_manager.set_frame_length(0, 10), OdinData::SharedBufferManagerException);
+
+    const std::string variable_mem_name = "TestSharedBufferVariable";
+    OdinData::SharedBufferManagerPtr creator(new OdinData::SharedBufferManager(
+        variable_mem_name, shared_mem_size, buffer_size, true, true, OdinData::SharedBufferManager::MappingOptions(),
+        true
+    ));
+    BOOST_REQUIRE(creator->has_variable_frames());
+    BOOST_CHECK(creator->has_notify_rings());
+    BOOST_CHECK_EQUAL(num_buffers, creator->get_num_buffers());
+    BOOST_CHECK_EQUAL(0, creator->get_frame_length(0));
+
+    // A frame can span blocks up to the end of the segment, but no further
+    creator->set_frame_length(2, 3 * buffer_size + 1);
+    creator->set_frame_length(num_buffers - 1, buffer_size);
+    BOOST_CHECK_THROW(
+        creator->set_frame_length(num_buffers - 1, buffer_size + 1), OdinData::SharedBufferManagerException
+    );
+    BOOST_CHECK_THROW(creator->set_frame_length(num_buffers, 1), OdinData::SharedBufferManagerException);
+    memset(creator->get_buffer_address(num_buffers - 1), 0x5a, buffer_size);
+
+    // A process mapping the segment finds the frame lengths and the blocks following the table
+    OdinData::SharedBufferManager mapper(variable_mem_name);
+    BOOST_REQUIRE(mapper.has_variable_frames());
+    BOOST_CHECK(mapper.has_notify_rings());
+    BOOST_CHECK_EQUAL(3 * buffer_size + 1, mapper.get_frame_length(2));
+    BOOST_CHECK_EQUAL(buffer_size, mapper.get_frame_length(num_buffers - 1));
+    char* mapped_buffer = reinterpret_cast<char*>(mapper.get_buffer_address(num_buffers - 1));
+    BOOST_CHECK_EQUAL(mapped_buffer[buffer_size - 1], 0x5a);
+}
+
+BOOST_AUTO_TEST_CASE(SharedBufferNotifierWithoutRingsTest)
+{
+    OdinData::SharedBufferManagerPtr manager(new OdinData::SharedBufferManager(shared_mem_name));
+    BOOST_CHECK_THROW(OdinData::SharedBufferNotifier notifier(manager, true), OdinData::SharedBufferNotifierException);
+}
 BOOST_AUTO_TEST_SUITE_END();